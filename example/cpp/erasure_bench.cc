@@ -0,0 +1,72 @@
+/**
+Copyright 2021 PIDL(Petabyte-scale In-memory Database Lab) http://kdb.snu.ac.kr
+This work was supported by Next-Generation Information Computing Development
+Program through the National Research Foundation of Korea(NRF)
+funded by the Ministry of Science, ICT (NRF-2016M3C4A7952587)
+Author: Ilju Lee, Jongin Kim, Hyerim Jeon, Youngjune Park
+Contact: sdmt@kdb.snu.ac.kr
+
+comparing encode throughput of sdmt erasure coded checkpoints
+against FTI level 3 checkpoints, which are Reed-Solomon encoded by FTI
+usage: erasure_bench [MB per rank] [repeat]
+ */
+
+#include "sdmt.h"
+
+#include <cstdlib>
+#include <iostream>
+
+int main(int argc, char* argv[]) {
+    using namespace std;
+    long mb = (argc > 1) ? atol(argv[1]) : 64;
+    int repeat = (argc > 2) ? atoi(argv[2]) : 5;
+
+    // init sdmt manager
+    SDMT::init("./config_cpp_test.xml", false);
+
+    long n = mb * 1024 * 1024 / sizeof(double);
+    SDMT::register_snapshot("bench_field", SDMT_DOUBLE, SDMT_ARRAY, {(int)n});
+    double* field = SDMT::doubleptr("bench_field");
+    for (long i = 0; i < n; i++) {
+        field[i] = i * 1e-3;
+    }
+
+    int rank;
+    MPI_Comm_rank(SDMT::comm(), &rank);
+
+    // start sdmt module
+    SDMT::start();
+
+    // time a checkpoint function, slowest rank counts
+    auto measure = [&](SDMT_Code (*ckpt)()) {
+        double best = 1e30;
+        for (int r = 0; r < repeat; r++) {
+            MPI_Barrier(SDMT::comm());
+            double begin = MPI_Wtime();
+            if (ckpt() != SDMT_SUCCESS) {
+                return -1.0;
+            }
+            double elapsed = MPI_Wtime() - begin;
+            double slowest;
+            MPI_Allreduce(&elapsed, &slowest, 1, MPI_DOUBLE, MPI_MAX,
+                    SDMT::comm());
+            best = min(best, slowest);
+            SDMT::iter()++;
+        }
+        return mb / best;
+    };
+
+    double erasure = measure(&SDMT::checkpoint_erasure);
+    double fti = measure([]() { return SDMT::checkpoint(3); });
+
+    if (rank == 0) {
+        cout << "checkpoint of " << mb << " MB per rank" << endl;
+        cout << "sdmt erasure : " << erasure << " MB/s per rank" << endl;
+        cout << "FTI level 3  : " << fti << " MB/s per rank" << endl;
+    }
+
+    // finalize sdmt module
+    SDMT::finalize();
+
+    return 0;
+}
@@ -22,6 +22,28 @@ _vt_map = {
         'float': sdmtpy.vt.float,
         'double': sdmtpy.vt.float,
         }
+_im_map = {
+        None: sdmtpy.im.none,
+        'page': sdmtpy.im.page,
+        'hash': sdmtpy.im.hash,
+        }
+_cc_map = {
+        None: sdmtpy.cc.none,
+        'lz': sdmtpy.cc.lz,
+        'shuffle_lz': sdmtpy.cc.shuffle_lz,
+        'lossy': sdmtpy.cc.lossy,
+        }
+_hp_map = {
+        None: sdmtpy.hp.none,
+        'transparent': sdmtpy.hp.transparent,
+        'explicit': sdmtpy.hp.explicit,
+        }
+_np_map = {
+        None: sdmtpy.np.default,
+        'bind': sdmtpy.np.bind,
+        'interleave': sdmtpy.np.interleave,
+        'first_touch': sdmtpy.np.first_touch,
+        }
 _dt_map = {
         'scalar': sdmtpy.dt.scalar,
         'array': sdmtpy.dt.array,
@@ -42,7 +64,10 @@ def init(config, restart=True):
     except Exception as e:
         sdmt.cli.error('Failed to initialize sdmt library, ' + str(e))
 
-def register_snapshot(name, vt=None, dt=None, dim=None, init=0):
+def register_snapshot(name, vt=None, dt=None, dim=None, init=0,
+        incremental=None, codec=None, error_bound=0, alignment=0,
+        double_buffer=False, global_shape=None, axis=0, block=0,
+        huge_pages=None, prefault=False, placement=None, numa_node=0):
     """Register snapshot to sdmt module
     Parameters:
     -----------
@@ -51,6 +76,20 @@ def register_snapshot(name, vt=None, dt=None, dim=None, init=0):
     dt: data type of snapshot
     dim: dimension of snapshot
     init: initial value of snapshot
+    incremental: incremental checkpoint mode, None, 'page' or 'hash'
+    codec: compression codec, None, 'lz', 'shuffle_lz' or 'lossy'
+    error_bound: absolute error bound of 'lossy' codec
+    alignment: byte alignment of snapshot memory, 0 for default
+    double_buffer: whether asynchronous checkpoints swap two buffers
+        instead of copying, see on_flip()
+    global_shape: global shape of a snapshot distributed over ranks,
+        dim is the part of this rank, see local_extent()
+    axis: dimension the global shape is split along
+    block: block size of block-cyclic decomposition, 0 for contiguous blocks
+    huge_pages: huge page backing, None, 'transparent' or 'explicit'
+    prefault: whether pages are mapped at registration
+    placement: NUMA placement, None, 'bind', 'interleave' or 'first_touch'
+    numa_node: NUMA node of 'bind' placement
     """
     try:
         if not sdmtpy.exist(name):
@@ -72,7 +111,34 @@ def register_snapshot(name, vt=None, dt=None, dim=None, init=0):
                     or (dt == sdmtpy.dt.tensor and len(dim) < 1):
                 raise ValueError('wrong dimension definition')
 
-            sdmtpy.register(name, vt, dt, dim)
+            if incremental not in _im_map:
+                raise ValueError("invalied incremental mode, "
+                    "shoud be one of (None, 'page', 'hash')")
+            if codec not in _cc_map:
+                raise ValueError("invalied codec, "
+                    "shoud be one of (None, 'lz', 'shuffle_lz', 'lossy')")
+            if huge_pages not in _hp_map:
+                raise ValueError("invalied huge pages, "
+                    "shoud be one of (None, 'transparent', 'explicit')")
+            if placement not in _np_map:
+                raise ValueError("invalied placement, "
+                    "shoud be one of (None, 'bind', 'interleave', 'first_touch')")
+            options = sdmtpy.options()
+            options.incremental = _im_map[incremental]
+            options.codec = _cc_map[codec]
+            options.error_bound = error_bound
+            options.alignment = alignment
+            options.double_buffer = double_buffer
+            options.huge_pages = _hp_map[huge_pages]
+            options.prefault = prefault
+            options.placement = _np_map[placement]
+            options.numa_node = numa_node
+            if global_shape is not None:
+                options.global_shape = list(global_shape)
+                options.axis = axis
+                options.block = block
+
+            sdmtpy.register(name, vt, dt, dim, options)
             res = np.array(sdmtpy.get(name), copy=False)
             if type(init) in (int, float):
                 res.fill(init)
@@ -88,6 +154,60 @@ def register_snapshot(name, vt=None, dt=None, dim=None, init=0):
     except Exception as e:
         sdmt.cli.error('Failed to register sdmt snapshot, ' + str(e))
 
+def register_external(name, array, incremental=None, codec=None,
+        error_bound=0, global_shape=None, axis=0, block=0):
+    """Register an array of the application as a snapshot, kept in place
+    Parameters:
+    -----------
+    name: name of snapshot
+    array: contiguous numpy array of int32, int64, float32 or float64,
+        C or Fortran order
+    incremental: incremental checkpoint mode, None or 'hash'
+    codec: compression codec, None, 'lz', 'shuffle_lz' or 'lossy'
+    error_bound: absolute error bound of 'lossy' codec
+    global_shape: global shape of a snapshot distributed over ranks,
+        array is the part of this rank in C order, see local_extent()
+    axis: dimension the global shape is split along
+    block: block size of block-cyclic decomposition, 0 for contiguous blocks
+    """
+    try:
+        if incremental not in _im_map:
+            raise ValueError("invalied incremental mode, "
+                "shoud be one of (None, 'hash')")
+        if codec not in _cc_map:
+            raise ValueError("invalied codec, "
+                "shoud be one of (None, 'lz', 'shuffle_lz', 'lossy')")
+        options = sdmtpy.options()
+        options.incremental = _im_map[incremental]
+        options.codec = _cc_map[codec]
+        options.error_bound = error_bound
+        if global_shape is not None:
+            options.global_shape = list(global_shape)
+            options.axis = axis
+            options.block = block
+
+        if sdmtpy.register_external(name, array, options) \
+                != sdmtpy.sdmt_code.success:
+            raise ValueError('wrong array or options')
+        return array
+    except Exception as e:
+        sdmt.cli.error('Failed to register sdmt snapshot, ' + str(e))
+
+def rebind(name, array):
+    """Protect another array of the application as a snapshot,
+    recovered values are copied into it after a restart
+    Parameters:
+    -----------
+    name: name of snapshot
+    array: contiguous numpy array of the value type of the snapshot
+    """
+    try:
+        if sdmtpy.rebind(name, array) != sdmtpy.sdmt_code.success:
+            raise ValueError('wrong array')
+        return array
+    except Exception as e:
+        sdmt.cli.error('Failed to rebind sdmt snapshot, ' + str(e))
+
 def start():
     """Start sdmt module
     """
@@ -96,36 +216,203 @@ def start():
     except Exception as e:
         sdmt.cli.error('Failed to start sdmt, ' + str(e))
 
-def checkpoint(level=1):
+def checkpoint(level=1, async_=False):
     """Generate a snapshot
     Parameters:
     -----------
     level: snapshot level(arguments for FTI library)
+    async_: return as soon as snapshots are staged,
+        and write them in background
     """
     try:
-        sdmtpy.checkpoint(level)
+        sdmtpy.checkpoint(level, async_)
     except Exception as e:
         sdmt.cli.error('Failed to make sdmt snapshot, ' + str(e))
 
-def recover():
+def wait_checkpoint():
+    """Wait until the asynchronous checkpoint is written
+    """
+    try:
+        return sdmtpy.wait_checkpoint()
+    except Exception as e:
+        sdmt.cli.error('Failed to wait sdmt snapshot, ' + str(e))
+
+def checkpoint_status():
+    """Get status of the asynchronous checkpoint
+    """
+    try:
+        return sdmtpy.checkpoint_status()
+    except Exception as e:
+        sdmt.cli.error('Failed to get sdmt snapshot status, ' + str(e))
+
+def wait_drain():
+    """Wait until checkpoints are copied to the global directory
+    """
+    try:
+        return sdmtpy.wait_drain()
+    except Exception as e:
+        sdmt.cli.error('Failed to wait sdmt snapshot drain, ' + str(e))
+
+def wait_recovery():
+    """Wait until lazily recovered Snapshots are fully loaded
+    """
+    try:
+        return sdmtpy.wait_recovery()
+    except Exception as e:
+        sdmt.cli.error('Failed to wait for sdmt recovery, ' + str(e))
+
+def flip(name):
+    """Swap the buffers of a double buffered snapshot
+    Parameters:
+    -----------
+    name: name of snapshot
+    """
+    try:
+        return sdmtpy.flip(name)
+    except Exception as e:
+        sdmt.cli.error('Failed to flip sdmt snapshot, ' + str(e))
+
+def on_flip(callback):
+    """Set function called after buffers of a snapshot are swapped,
+    arrays of the snapshot have to be rebound to the new buffer
+    Parameters:
+    -----------
+    callback: function(name, array) with the new buffer, None to remove
+    """
+    try:
+        if callback is None:
+            sdmtpy.set_flip_hook(None)
+        else:
+            sdmtpy.set_flip_hook(
+                lambda name: callback(name, np.array(sdmtpy.get(name), copy=False)))
+    except Exception as e:
+        sdmt.cli.error('Failed to set sdmt flip hook, ' + str(e))
+
+def checkpoint_stats():
+    """Get volume of the last checkpoint,
+    ratio is written bytes over snapshot bytes
+    """
+    try:
+        return sdmtpy.checkpoint_stats()
+    except Exception as e:
+        sdmt.cli.error('Failed to get sdmt snapshot stats, ' + str(e))
+
+def recovery_stats():
+    """Get timings of the last recovery in seconds,
+    allocate is set only when snapshots are deserialized at restart
+    """
+    try:
+        return sdmtpy.recovery_stats()
+    except Exception as e:
+        sdmt.cli.error('Failed to get sdmt recovery stats, ' + str(e))
+
+def catalog():
+    """List checkpoints every rank can recover from, ascending by id,
+    with id, level, iter, time, rawsize and size of each
+    """
+    try:
+        return sdmtpy.catalog()
+    except Exception as e:
+        sdmt.cli.error('Failed to get sdmt checkpoint catalog, ' + str(e))
+
+def recover(names=None, id=None):
     """Recover snapshots
+    Parameters:
+        names: names of snapshots to recover, None for all
+            with the iteration sequence
+        id: checkpoint id of catalog() to recover every snapshot from,
+            None for the newest
     """
     try:
-        sdmtpy.recover()
+        if id is not None:
+            return sdmtpy.recover(id=id)
+        if names is None:
+            return sdmtpy.recover()
+        return sdmtpy.recover(list(names))
     except Exception as e:
         sdmt.cli.error('Failed to recover snapshot, ' + str(e))
 
+def recover_snapshot(name):
+    """Recover a snapshot only, the others are left as they are
+    """
+    try:
+        return sdmtpy.recover_snapshot(name)
+    except Exception as e:
+        sdmt.cli.error('Failed to recover snapshot ' + name + ', ' + str(e))
+
+def checkpoint_memory():
+    """Copy snapshots to an in-memory checkpoint
+    """
+    try:
+        return sdmtpy.checkpoint_memory()
+    except Exception as e:
+        sdmt.cli.error('Failed to make in-memory snapshot, ' + str(e))
+
+def rollback(k=0):
+    """Restore snapshots from an in-memory checkpoint
+    Parameters:
+    -----------
+    k: 0 for the newest in-memory checkpoint, 1 for the one before
+    """
+    try:
+        return sdmtpy.rollback(k)
+    except Exception as e:
+        sdmt.cli.error('Failed to rollback snapshot, ' + str(e))
+
+def checkpoint_partner():
+    """Replicate snapshots in the memory of a partner rank
+    """
+    try:
+        return sdmtpy.checkpoint_partner()
+    except Exception as e:
+        sdmt.cli.error('Failed to make partner snapshot, ' + str(e))
+
+def recover_partner():
+    """Recover snapshots from the copy kept by the partner rank
+    """
+    try:
+        return sdmtpy.recover_partner()
+    except Exception as e:
+        sdmt.cli.error('Failed to recover partner snapshot, ' + str(e))
+
+def checkpoint_erasure():
+    """Keep snapshots in memory protected by erasure codes
+    """
+    try:
+        return sdmtpy.checkpoint_erasure()
+    except Exception as e:
+        sdmt.cli.error('Failed to make erasure coded snapshot, ' + str(e))
+
+def recover_erasure():
+    """Recover snapshots, rebuilding those of lost ranks
+    """
+    try:
+        return sdmtpy.recover_erasure()
+    except Exception as e:
+        sdmt.cli.error('Failed to recover erasure coded snapshot, ' + str(e))
+
 def get(name):
     """Get snapshot
     Parameters:
     -----------
-    name: name of snapshot
+    name: name of snapshot, or its handle from lookup()
     """
     try:
         return np.array(sdmtpy.get(name), copy=False)
     except Exception as e:
         sdmt.cli.error('Failed to get sdmt snapshot, ' + str(e))
 
+def lookup(name):
+    """Get the handle of a snapshot, -1 if none
+    Parameters:
+    -----------
+    name: name of snapshot
+    """
+    try:
+        return sdmtpy.lookup(name)
+    except Exception as e:
+        sdmt.cli.error('Failed to look up sdmt snapshot, ' + str(e))
+
 def change(name, vt=None, dt=None, dim=None, init=0):
     """Assign new snapshot size
     Parameters:
@@ -192,6 +479,18 @@ def next():
     except Exception as e:
         sdmt.cli.error('Failed to proceed sdmt iterator, ' + str(e))
 
+def local_extent(extent, block=0):
+    """Get the extent of a distributed dimension on this rank
+    Parameters:
+    -----------
+    extent: global extent of the dimension
+    block: block size of block-cyclic decomposition, 0 for contiguous blocks
+    """
+    try:
+        return sdmtpy.local_extent(extent, block)
+    except Exception as e:
+        sdmt.cli.error('Failed to get local extent, ' + str(e))
+
 def exist(name):
     """Check snapshot exists in archive
     Parameters:
@@ -0,0 +1,269 @@
+/**
+Copyright 2021 PIDL(Petabyte-scale In-memory Database Lab) http://kdb.snu.ac.kr
+This work was supported by Next-Generation Information Computing Development
+Program through the National Research Foundation of Korea(NRF)
+funded by the Ministry of Science, ICT (NRF-2016M3C4A7952587)
+Author: Ilju Lee, Jongin Kim, Hyerim Jeon, Youngjune Park
+Contact: sdmt@kdb.snu.ac.kr
+ */
+
+#include "ckpt_async.h"
+#include "ckpt_shared.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/** @brief alignment of shadow buffers, a page */
+static const size_t kShadowAlign = 4096;
+
+/**
+ * @brief write a Job as a native checkpoint file
+ * @param job checkpoint to write
+ * @param direct writer used if the Job is written by direct I/O
+ * @return true if success
+ */
+static bool write_job(CkptAsync::Job& job, CkptDirect& direct) {
+    const CkptFile::Header& h = job.m_header;
+    std::string path = CkptFile::path(job.m_dir, h.m_id, h.m_rank);
+    if (!CkptFile::make_dir(job.m_dir)) {
+        return false;
+    }
+    if (job.m_direct) {
+        return direct.write(path, h, job.m_records, job.m_tuning);
+    }
+    return CkptFile::write(path, h, job.m_records);
+}
+
+/**
+ * @brief write at an offset, in a forked child
+ * @details async-signal-safe. a short write is written again
+ *  from the last multiple of align, as O_DIRECT takes aligned offsets only
+ * @param fd file descriptor
+ * @param p source memory
+ * @param size byte size
+ * @param offset byte offset in the file
+ * @param align alignment of offsets, 1 without O_DIRECT
+ * @return true if success
+ */
+static bool write_at(int fd, const char* p, size_t size, uint64_t offset,
+        size_t align) {
+    while (size > 0) {
+        if (::lseek(fd, offset, SEEK_SET) < 0) {
+            return false;
+        }
+        ssize_t n = ::write(fd, p, size);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        size_t done = n > 0 ? (size_t)n / align * align : 0;
+        if (done == 0) {
+            return false;
+        }
+        p += done;
+        size -= done;
+        offset += done;
+    }
+    return true;
+}
+
+CkptAsync::CkptAsync()
+    : m_busy(false),
+    m_stop(false),
+    m_status(SDMT_CKPT_NONE),
+    m_child(-1),
+    m_written(false) {}
+
+CkptAsync::~CkptAsync() {
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cv.notify_all();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+void* CkptAsync::shadow(const std::string& name, size_t size) {
+    std::vector<char>& buf = m_shadow[name];
+    buf.resize(size + kShadowAlign);
+    uintptr_t p = reinterpret_cast<uintptr_t>(buf.data());
+    return buf.data() + (kShadowAlign - p % kShadowAlign) % kShadowAlign;
+}
+
+void CkptAsync::submit(const Job& job) {
+    // memory is frozen at fork, before returning to the application
+    pid_t child = -1;
+    bool written = false;
+    if (job.m_fork) {
+        child = fork_(job);
+        if (child < 0) {
+            Job copy = job;
+            written = write(copy);
+        }
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_job = job;
+        m_child = child;
+        m_written = written;
+        m_busy = true;
+        m_status = SDMT_CKPT_PENDING;
+    }
+
+    if (!m_thread.joinable()) {
+        m_thread = std::thread(&CkptAsync::run_, this);
+    }
+    m_cv.notify_all();
+}
+
+bool CkptAsync::write(Job& job) {
+    return write_job(job, m_direct);
+}
+
+SDMT_CS CkptAsync::wait() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cv.wait(lock, [this] { return !m_busy; });
+    return m_status;
+}
+
+SDMT_CS CkptAsync::status() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    return m_status;
+}
+
+void CkptAsync::run_() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        // drain the Job in flight before exiting
+        m_cv.wait(lock, [this] { return m_busy || m_stop; });
+        if (!m_busy) {
+            return;
+        }
+
+        // the application thread does not touch m_job while busy
+        lock.unlock();
+        const CkptFile::Header& h = m_job.m_header;
+        bool ok = false;
+        if (m_job.m_written) {
+            ok = true;
+        } else if (!m_job.m_fork) {
+            ok = write(m_job);
+        } else if (m_child > 0) {
+            int status = 0;
+            while (::waitpid(m_child, &status, 0) < 0 && errno == EINTR) {}
+            ok = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+        } else {
+            ok = m_written;
+        }
+        if (ok) {
+            // drop old checkpoints of this rank, or shared ones on rank 0
+            if (!m_job.m_shared) {
+                CkptFile::prune(m_job.m_dir, h.m_rank, m_job.m_retention);
+            } else if (h.m_rank == 0) {
+                CkptShared::prune(m_job.m_dir, m_job.m_retention);
+            }
+            if (m_job.m_done) {
+                m_job.m_done();
+            }
+        }
+        lock.lock();
+
+        m_status = ok ? SDMT_CKPT_COMPLETED : SDMT_CKPT_FAILED;
+        m_busy = false;
+        m_cv.notify_all();
+    }
+}
+
+pid_t CkptAsync::fork_(const Job& job) {
+    // the child may only call async-signal-safe functions, another thread
+    // may hold a lock of malloc or stdio at fork. so the file is laid out
+    // and every buffer is allocated here, and the child does system calls
+    const CkptFile::Header& h = job.m_header;
+    if (!CkptFile::make_dir(job.m_dir)) {
+        return -1;
+    }
+    ForkPlan plan;
+    plan.m_path = CkptFile::path(job.m_dir, h.m_id, h.m_rank);
+    plan.m_tmp = plan.m_path + ".tmp";
+    plan.m_align = job.m_direct ? std::max<size_t>(job.m_tuning.m_align, 512)
+        : 1;
+    plan.m_block = (std::max(job.m_tuning.m_block, plan.m_align)
+            + plan.m_align - 1) / plan.m_align * plan.m_align;
+
+    std::vector<CkptFile::Record> records = job.m_records;
+    std::string head;
+    plan.m_end = CkptFile::layout(h, records, head, plan.m_align);
+    plan.m_pieces.push_back(ForkPlan::Piece{head.data(), head.size(), 0});
+    for (auto& r : records) {
+        plan.m_pieces.push_back(ForkPlan::Piece{
+                reinterpret_cast<const char*>(r.m_data), r.m_size,
+                r.m_offset});
+    }
+    void* bounce = nullptr;
+    if (posix_memalign(&bounce, plan.m_align, plan.m_block) != 0) {
+        return -1;
+    }
+    plan.m_bounce = reinterpret_cast<char*>(bounce);
+
+    pid_t pid = ::fork();
+    if (pid == 0) {
+        // the child must not touch MPI, and returns nowhere
+        ::_exit(write_forked_(plan) ? 0 : 1);
+    }
+    std::free(bounce);
+    return pid;
+}
+
+bool CkptAsync::write_forked_(const ForkPlan& plan) {
+    size_t align = plan.m_align;
+    int flags = O_WRONLY | O_CREAT | O_TRUNC;
+    int fd = ::open(plan.m_tmp.c_str(), flags | (align > 1 ? O_DIRECT : 0),
+            0644);
+    if (fd < 0 && align > 1 && errno == EINVAL) {
+        // file system without direct I/O
+        align = 1;
+        fd = ::open(plan.m_tmp.c_str(), flags, 0644);
+    }
+    if (fd < 0) {
+        return false;
+    }
+
+    bool ok = true;
+    for (auto& piece : plan.m_pieces) {
+        const char* p = piece.m_ptr;
+        size_t body = 0;
+        if (align == 1) {
+            body = piece.m_size;
+        } else if (reinterpret_cast<uintptr_t>(p) % align == 0) {
+            body = piece.m_size / align * align;
+        }
+        ok = ok && write_at(fd, p, body, piece.m_offset, align);
+        for (size_t done = body; ok && done < piece.m_size; ) {
+            size_t n = std::min(plan.m_block, piece.m_size - done);
+            size_t padded = (n + align - 1) / align * align;
+            std::memcpy(plan.m_bounce, p + done, n);
+            std::memset(plan.m_bounce + n, 0, padded - n);
+            ok = write_at(fd, plan.m_bounce, padded, piece.m_offset + done,
+                    align);
+            done += n;
+        }
+    }
+
+    // the last block was padded
+    ok = ok && ::ftruncate(fd, plan.m_end) == 0 && ::fsync(fd) == 0;
+    ok = (::close(fd) == 0) && ok;
+    if (!ok || ::rename(plan.m_tmp.c_str(), plan.m_path.c_str()) != 0) {
+        ::unlink(plan.m_tmp.c_str());
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,227 @@
+/**
+Copyright 2021 PIDL(Petabyte-scale In-memory Database Lab) http://kdb.snu.ac.kr
+This work was supported by Next-Generation Information Computing Development
+Program through the National Research Foundation of Korea(NRF)
+funded by the Ministry of Science, ICT (NRF-2016M3C4A7952587)
+Author: Ilju Lee, Jongin Kim, Hyerim Jeon, Youngjune Park
+Contact: sdmt@kdb.snu.ac.kr
+ */
+
+#ifndef CKPT_ASYNC_H_
+#define CKPT_ASYNC_H_
+
+#include "common.h"
+#include "ckpt_direct.h"
+#include "ckpt_file.h"
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <sys/types.h>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief background checkpoint writer
+ * @details the application thread stages Snapshots into shadow buffers
+ *  and submits a Job, a dedicated I/O thread writes the Job
+ *  as a native checkpoint file.
+ *  only one Job is in flight at a time,
+ *  so shadow buffers are reused by the next checkpoint.<p>
+ *  a Job may instead be written by a forked child process, which sees
+ *  the memory as of submit() while the kernel copies only the pages
+ *  the application writes afterwards, so Snapshots need not be staged.<p>
+ *  old checkpoints are dropped by the I/O thread after a Job, also after
+ *  one written synchronously, so the application never waits for it
+ */
+class CkptAsync
+{
+  public:
+    /**
+     * @brief a checkpoint to be written in background
+     */
+    struct Job {
+        /** @brief native checkpoint directory */
+        std::string m_dir;
+
+        /** @brief checkpoint metadata */
+        CkptFile::Header m_header;
+
+        /** @brief staged Snapshots */
+        std::vector<CkptFile::Record> m_records;
+
+        /** @brief checkpoints to keep after writing */
+        CkptFile::Retention m_retention;
+
+        /** @brief called by the I/O thread once the file is written */
+        std::function<void()> m_done;
+
+        /** @brief whether the file is written by direct I/O */
+        bool m_direct;
+
+        /** @brief direct I/O tuning */
+        CkptDirect::Tuning m_tuning;
+
+        /** @brief whether the file is written by a forked child process,
+         *  records may then point to Snapshot memory */
+        bool m_fork;
+
+        /** @brief whether the file is written by the caller already,
+         *  only old checkpoints are then dropped in background */
+        bool m_written;
+
+        /** @brief whether the file is a CkptShared file of every rank,
+         *  old ones are then dropped by rank 0 */
+        bool m_shared;
+    };
+
+    /**
+     * @brief CkptAsync constructor, the I/O thread starts on first submit
+     */
+    CkptAsync();
+
+    /**
+     * @brief CkptAsync destructor, waits for the Job in flight
+     */
+    ~CkptAsync();
+
+    /**
+     * @brief get a shadow buffer to stage a Snapshot
+     * @details shadow buffers are page aligned for direct I/O.
+     *  must not be called while a Job is in flight
+     * @param name name of Snapshot
+     * @param size byte size of Snapshot
+     * @return pointer of shadow buffer
+     */
+    void* shadow(const std::string& name, size_t size);
+
+    /**
+     * @brief hand a staged checkpoint to the I/O thread
+     * @details a Job to fork is forked here, and written in the calling
+     *  thread if fork fails. must not be called while a Job is in flight
+     * @param job checkpoint to write
+     */
+    void submit(const Job& job);
+
+    /**
+     * @brief write a Job in the calling thread
+     * @details must not be called while a Job is in flight
+     * @param job checkpoint to write, offsets of records are assigned
+     * @return true if success
+     */
+    bool write(Job& job);
+
+    /**
+     * @brief block until the Job in flight is written
+     * @return status of the last Job
+     */
+    SDMT_CS wait();
+
+    /**
+     * @brief get status of the last Job without blocking
+     * @return status of the last Job
+     */
+    SDMT_CS status();
+
+  private:
+    /**
+     * @brief a checkpoint file laid out for a forked child to write
+     */
+    struct ForkPlan {
+        /**
+         * @brief memory written at an offset of the file
+         */
+        struct Piece {
+            /** @brief source memory */
+            const char* m_ptr;
+
+            /** @brief byte size */
+            size_t m_size;
+
+            /** @brief byte offset in the file */
+            uint64_t m_offset;
+        };
+
+        /** @brief path of the file */
+        std::string m_path;
+
+        /** @brief temporary path, renamed to m_path when written */
+        std::string m_tmp;
+
+        /** @brief head and payloads of the file */
+        std::vector<Piece> m_pieces;
+
+        /** @brief byte size of the file */
+        uint64_t m_end;
+
+        /** @brief alignment of O_DIRECT, 1 to write through the cache */
+        size_t m_align;
+
+        /** @brief byte size of m_bounce */
+        size_t m_block;
+
+        /** @brief aligned buffer to copy unaligned memory into */
+        char* m_bounce;
+    };
+
+    /**
+     * @brief main loop of the I/O thread
+     */
+    void run_();
+
+    /**
+     * @brief fork a child process writing a Job
+     * @details the child calls async-signal-safe functions only,
+     *  on a ForkPlan prepared before fork
+     * @param job checkpoint to write
+     * @return pid of the child, -1 if fork failed
+     */
+    pid_t fork_(const Job& job);
+
+    /**
+     * @brief write a laid out checkpoint file, in a forked child
+     * @details async-signal-safe, everything is allocated by the parent.
+     *  memory which is not aligned and unaligned tails are copied to
+     *  the bounce buffer and padded with zeros
+     * @param plan laid out file
+     * @return true if success
+     */
+    static bool write_forked_(const ForkPlan& plan);
+
+    /** @brief I/O thread */
+    std::thread m_thread;
+
+    /** @brief lock for the fields below */
+    std::mutex m_mutex;
+
+    /** @brief signaled when a Job is submitted or finished */
+    std::condition_variable m_cv;
+
+    /** @brief Job in flight */
+    Job m_job;
+
+    /** @brief true while a Job is in flight */
+    bool m_busy;
+
+    /** @brief true when the I/O thread has to exit */
+    bool m_stop;
+
+    /** @brief status of the last Job */
+    SDMT_CS m_status;
+
+    /** @brief child process writing the Job in flight, -1 if none */
+    pid_t m_child;
+
+    /** @brief result of a Job to fork written in submit() */
+    bool m_written;
+
+    /** @brief writer of Jobs by direct I/O */
+    CkptDirect m_direct;
+
+    /** @brief shadow buffers by Snapshot name */
+    std::unordered_map<std::string, std::vector<char>> m_shadow;
+};
+
+#endif  // CKPT_ASYNC_H_
@@ -0,0 +1,523 @@
+/**
+Copyright 2021 PIDL(Petabyte-scale In-memory Database Lab) http://kdb.snu.ac.kr
+This work was supported by Next-Generation Information Computing Development
+Program through the National Research Foundation of Korea(NRF)
+funded by the Ministry of Science, ICT (NRF-2016M3C4A7952587)
+Author: Ilju Lee, Jongin Kim, Hyerim Jeon, Youngjune Park
+Contact: sdmt@kdb.snu.ac.kr
+ */
+
+#include "ckpt_codec.h"
+#include "parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+/** @brief byte size of the fixed part of the header */
+const size_t kHeader = 2 * sizeof(uint32_t) + sizeof(uint64_t)
+    + 2 * sizeof(uint32_t);
+
+/** @brief shortest match encoded by LZ */
+const size_t kMinMatch = 4;
+
+/** @brief farthest match encoded by LZ */
+const size_t kMaxOffset = 65535;
+
+/** @brief number of bits of LZ hash table index */
+const int kHashLog = 14;
+
+template<typename T>
+T load(const uint8_t* p) {
+    T v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+template<typename T>
+void store(uint8_t* p, T v) {
+    std::memcpy(p, &v, sizeof(v));
+}
+
+/**
+ * @brief gather k-th bytes of elements together
+ */
+void shuffle(const uint8_t* src, size_t size, size_t esize, uint8_t* dst) {
+    size_t count = size / esize;
+    for (size_t b = 0; b < esize; b++) {
+        for (size_t i = 0; i < count; i++) {
+            dst[b * count + i] = src[i * esize + b];
+        }
+    }
+    std::memcpy(dst + count * esize, src + count * esize,
+            size - count * esize);
+}
+
+void unshuffle(const uint8_t* src, size_t size, size_t esize, uint8_t* dst) {
+    size_t count = size / esize;
+    for (size_t b = 0; b < esize; b++) {
+        for (size_t i = 0; i < count; i++) {
+            dst[i * esize + b] = src[b * count + i];
+        }
+    }
+    std::memcpy(dst + count * esize, src + count * esize,
+            size - count * esize);
+}
+
+void put_length(uint8_t*& op, size_t len) {
+    while (len >= 255) {
+        *op++ = 255;
+        len -= 255;
+    }
+    *op++ = len;
+}
+
+bool get_length(const uint8_t*& ip, const uint8_t* iend, size_t& len) {
+    uint8_t b;
+    do {
+        if (ip >= iend) {
+            return false;
+        }
+        b = *ip++;
+        len += b;
+    } while (b == 255);
+    return true;
+}
+
+/**
+ * @brief write a LZ sequence: [token][literals][offset][match length]
+ * @details the high nibble of token is literal length,
+ *  the low nibble is match length, 15 is extended by following bytes.
+ *  the last sequence has literals only
+ */
+bool emit(uint8_t*& op, uint8_t* oend,
+        const uint8_t* lit, size_t nlit, size_t offset, size_t mlen) {
+    size_t need = 1 + nlit / 255 + 1 + nlit + 2 + mlen / 255 + 1;
+    if (need > size_t(oend - op)) {
+        return false;
+    }
+
+    size_t ml = mlen ? mlen - kMinMatch : 0;
+    *op++ = (std::min<size_t>(nlit, 15) << 4) | std::min<size_t>(ml, 15);
+    if (nlit >= 15) {
+        put_length(op, nlit - 15);
+    }
+    std::memcpy(op, lit, nlit);
+    op += nlit;
+
+    if (mlen) {
+        *op++ = offset & 0xff;
+        *op++ = offset >> 8;
+        if (ml >= 15) {
+            put_length(op, ml - 15);
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief LZ77 compression with a single-entry hash table
+ * @return compressed size, 0 if it does not fit in cap
+ */
+size_t lz_compress(const uint8_t* src, size_t size,
+        uint8_t* dst, size_t cap, uint32_t* table) {
+    std::memset(table, 0, sizeof(uint32_t) << kHashLog);
+    uint8_t* op = dst;
+    uint8_t* oend = dst + cap;
+    size_t ip = 0;
+    size_t anchor = 0;
+
+    while (ip + kMinMatch <= size) {
+        uint32_t seq = load<uint32_t>(src + ip);
+        uint32_t h = (seq * 2654435761u) >> (32 - kHashLog);
+        // table holds position + 1, 0 is empty
+        size_t ref = table[h];
+        table[h] = ip + 1;
+
+        if (ref == 0 || ip - (ref - 1) > kMaxOffset
+                || load<uint32_t>(src + ref - 1) != seq) {
+            // step faster over incompressible data
+            ip += 1 + ((ip - anchor) >> 6);
+            continue;
+        }
+        ref--;
+
+        // extend match 8 bytes at a time, little endian
+        size_t len = kMinMatch;
+        while (ip + len + 8 <= size) {
+            uint64_t diff = load<uint64_t>(src + ref + len)
+                ^ load<uint64_t>(src + ip + len);
+            if (diff) {
+                len += __builtin_ctzll(diff) >> 3;
+                break;
+            }
+            len += 8;
+        }
+        if (ip + len + 8 > size) {
+            while (ip + len < size && src[ref + len] == src[ip + len]) {
+                len++;
+            }
+        }
+
+        if (!emit(op, oend, src + anchor, ip - anchor, ip - ref, len)) {
+            return 0;
+        }
+        ip += len;
+        anchor = ip;
+    }
+
+    if (!emit(op, oend, src + anchor, size - anchor, 0, 0)) {
+        return 0;
+    }
+    return op - dst;
+}
+
+bool lz_decompress(const uint8_t* src, size_t csize,
+        uint8_t* dst, size_t size) {
+    const uint8_t* ip = src;
+    const uint8_t* iend = src + csize;
+    uint8_t* op = dst;
+    uint8_t* oend = dst + size;
+
+    while (ip < iend) {
+        uint8_t token = *ip++;
+        size_t nlit = token >> 4;
+        if (nlit == 15 && !get_length(ip, iend, nlit)) {
+            return false;
+        }
+        if (nlit > size_t(iend - ip) || nlit > size_t(oend - op)) {
+            return false;
+        }
+        std::memcpy(op, ip, nlit);
+        op += nlit;
+        ip += nlit;
+
+        // the last sequence has no match
+        if (ip == iend) {
+            break;
+        }
+
+        if (iend - ip < 2) {
+            return false;
+        }
+        size_t offset = ip[0] | (size_t(ip[1]) << 8);
+        ip += 2;
+        size_t mlen = token & 15;
+        if (mlen == 15 && !get_length(ip, iend, mlen)) {
+            return false;
+        }
+        mlen += kMinMatch;
+        if (offset == 0 || offset > size_t(op - dst)
+                || mlen > size_t(oend - op)) {
+            return false;
+        }
+
+        // an overlapping match repeats the bytes between ref and op,
+        // the copyable span doubles every step
+        const uint8_t* ref = op - offset;
+        while (mlen > 0) {
+            size_t n = std::min<size_t>(op - ref, mlen);
+            std::memcpy(op, ref, n);
+            op += n;
+            mlen -= n;
+        }
+    }
+    return op == oend;
+}
+
+/** @brief quantization codes are in (0, 2 * kRadius), 0 marks an outlier */
+const int kRadius = 32768;
+
+/** @brief byte size of the header of a lossy chunk */
+const size_t kLossyHeader = 2 * sizeof(double) + 2 * sizeof(uint64_t);
+
+/**
+ * @brief reconstruct a value from prediction and quantization code
+ * @details shared by compression and decompression,
+ *  so both sides predict from identical values
+ */
+template<typename T>
+inline T reconstruct(double pred, int q, double bound) {
+    return T(pred + 2 * bound * q);
+}
+
+/**
+ * @brief error bounded lossy compression of floating point values
+ * @details each value is predicted from the previous two reconstructed
+ *  values by linear extrapolation, the error of prediction is quantized
+ *  by twice the bound. codes are compressed by byte shuffle and LZ,
+ *  values which can not be quantized are stored as is.<p>
+ *  layout: [bound][max error][outlier count][code size][codes][outliers]
+ * @return compressed size, 0 if it does not fit in cap
+ */
+template<typename T>
+size_t lossy_compress(const T* src, size_t count, double bound,
+        uint8_t* dst, size_t cap, uint32_t* table) {
+    std::vector<uint16_t> codes(count);
+    std::vector<T> outliers;
+    double error = 0;
+    T r1 = 0;
+    T r2 = 0;
+    for (size_t i = 0; i < count; i++) {
+        double pred = 2.0 * r1 - r2;
+        double q = std::round((double(src[i]) - pred) / (2 * bound));
+        if (std::isfinite(src[i]) && std::fabs(q) < kRadius - 1) {
+            T r = reconstruct<T>(pred, int(q), bound);
+            double e = std::fabs(double(src[i]) - double(r));
+            if (e <= bound) {
+                codes[i] = int(q) + kRadius;
+                error = std::max(error, e);
+                r2 = r1;
+                r1 = r;
+                continue;
+            }
+        }
+        codes[i] = 0;
+        outliers.push_back(src[i]);
+        r2 = r1;
+        r1 = src[i];
+    }
+
+    size_t csize = count * sizeof(uint16_t);
+    size_t osize = outliers.size() * sizeof(T);
+    if (kLossyHeader + osize >= cap) {
+        return 0;
+    }
+
+    // high bytes of codes are nearly constant
+    std::vector<uint8_t> shuffled(csize);
+    shuffle(reinterpret_cast<uint8_t*>(codes.data()), csize,
+            sizeof(uint16_t), shuffled.data());
+    uint8_t* body = dst + kLossyHeader;
+    size_t n = (csize > 0) ? lz_compress(shuffled.data(), csize, body,
+            std::min(csize - 1, cap - kLossyHeader - osize), table) : 0;
+    if (n == 0) {
+        if (kLossyHeader + csize + osize >= cap) {
+            return 0;
+        }
+        std::memcpy(body, shuffled.data(), csize);
+        n = csize;
+    }
+
+    store<double>(dst, bound);
+    store<double>(dst + 8, error);
+    store<uint64_t>(dst + 16, outliers.size());
+    store<uint64_t>(dst + 24, n);
+    std::memcpy(body + n, outliers.data(), osize);
+    return kLossyHeader + n + osize;
+}
+
+template<typename T>
+bool lossy_decompress(const uint8_t* src, size_t csize,
+        T* dst, size_t count, double& error) {
+    if (csize < kLossyHeader) {
+        return false;
+    }
+    double bound = load<double>(src);
+    error = load<double>(src + 8);
+    uint64_t noutliers = load<uint64_t>(src + 16);
+    uint64_t n = load<uint64_t>(src + 24);
+    size_t size = count * sizeof(uint16_t);
+    if (n > csize - kLossyHeader || noutliers > count
+            || noutliers * sizeof(T) != csize - kLossyHeader - n) {
+        return false;
+    }
+
+    std::vector<uint8_t> shuffled(size);
+    std::vector<uint16_t> codes(count);
+    const uint8_t* body = src + kLossyHeader;
+    if (n == size) {
+        std::memcpy(shuffled.data(), body, size);
+    } else if (!lz_decompress(body, n, shuffled.data(), size)) {
+        return false;
+    }
+    unshuffle(shuffled.data(), size, sizeof(uint16_t),
+            reinterpret_cast<uint8_t*>(codes.data()));
+
+    const uint8_t* outliers = body + n;
+    size_t k = 0;
+    T r1 = 0;
+    T r2 = 0;
+    for (size_t i = 0; i < count; i++) {
+        T r;
+        if (codes[i] == 0) {
+            if (k == noutliers) {
+                return false;
+            }
+            r = load<T>(outliers + k++ * sizeof(T));
+        } else {
+            r = reconstruct<T>(2.0 * r1 - r2, int(codes[i]) - kRadius, bound);
+        }
+        dst[i] = r;
+        r2 = r1;
+        r1 = r;
+    }
+    return k == noutliers;
+}
+
+size_t chunk_count(size_t size, size_t chunk) {
+    return (size + chunk - 1) / chunk;
+}
+
+}  // namespace
+
+size_t Codec::bound(size_t size) {
+    return kHeader + chunk_count(size, kChunk) * sizeof(uint64_t) + size;
+}
+
+size_t Codec::compress(SDMT_CC codec,
+                size_t esize,
+                const void* src,
+                size_t size,
+                void* dst,
+                int threads,
+                double bound) {
+    const uint8_t* in = reinterpret_cast<const uint8_t*>(src);
+    uint8_t* out = reinterpret_cast<uint8_t*>(dst);
+    size_t count = chunk_count(size, kChunk);
+    bool shuffled = codec == SDMT_CC_SHUFFLE_LZ && esize > 1;
+    bool lossy = codec == SDMT_CC_LOSSY && bound > 0
+        && (esize == sizeof(float) || esize == sizeof(double));
+
+    store<uint32_t>(out, codec);
+    store<uint32_t>(out + 4, esize);
+    store<uint64_t>(out + 8, size);
+    store<uint32_t>(out + 16, kChunk);
+    store<uint32_t>(out + 20, count);
+    uint8_t* sizes = out + kHeader;
+    uint8_t* body = sizes + count * sizeof(uint64_t);
+
+    // each chunk is compressed into its own slot of chunk size,
+    // slots are packed afterwards
+    std::vector<uint64_t> csizes(count);
+    parallel::for_each(threads, count, [&](size_t i) {
+        size_t len = std::min(kChunk, size - i * kChunk);
+        const uint8_t* chunk = in + i * kChunk;
+        uint8_t* slot = body + i * kChunk;
+
+        std::vector<uint32_t> table(1 << kHashLog);
+        std::vector<uint8_t> tmp;
+        if (shuffled) {
+            tmp.resize(len);
+            shuffle(chunk, len, esize, tmp.data());
+            chunk = tmp.data();
+        }
+
+        // a chunk which does not shrink is stored as is
+        size_t n = 0;
+        if (len > 0 && lossy && len % esize == 0) {
+            n = (esize == sizeof(float))
+                ? lossy_compress(reinterpret_cast<const float*>(chunk),
+                        len / esize, bound, slot, len - 1, table.data())
+                : lossy_compress(reinterpret_cast<const double*>(chunk),
+                        len / esize, bound, slot, len - 1, table.data());
+        } else if (len > 0 && codec != SDMT_CC_LOSSY) {
+            n = lz_compress(chunk, len, slot, len - 1, table.data());
+        }
+        if (n == 0) {
+            std::memcpy(slot, in + i * kChunk, len);
+            n = len;
+        }
+        csizes[i] = n;
+    });
+
+    uint8_t* op = body;
+    for (size_t i = 0; i < count; i++) {
+        store<uint64_t>(sizes + i * sizeof(uint64_t), csizes[i]);
+        std::memmove(op, body + i * kChunk, csizes[i]);
+        op += csizes[i];
+    }
+    return op - out;
+}
+
+bool Codec::decoded_size(const void* src, size_t csize, size_t& size) {
+    if (csize < kHeader) {
+        return false;
+    }
+    size = load<uint64_t>(reinterpret_cast<const uint8_t*>(src) + 8);
+    return true;
+}
+
+bool Codec::decompress(const void* src,
+                size_t csize,
+                void* dst,
+                size_t size,
+                int threads,
+                double* error) {
+    const uint8_t* in = reinterpret_cast<const uint8_t*>(src);
+    uint8_t* out = reinterpret_cast<uint8_t*>(dst);
+    if (error != nullptr) {
+        *error = 0;
+    }
+    if (csize < kHeader) {
+        return false;
+    }
+
+    uint32_t codec = load<uint32_t>(in);
+    size_t esize = load<uint32_t>(in + 4);
+    size_t chunk = load<uint32_t>(in + 16);
+    size_t count = load<uint32_t>(in + 20);
+    if (load<uint64_t>(in + 8) != size
+            || codec < SDMT_CC_LZ || codec > SDMT_CC_LOSSY
+            || chunk == 0 || count != chunk_count(size, chunk)
+            || csize < kHeader + count * sizeof(uint64_t)) {
+        return false;
+    }
+    bool shuffled = codec == SDMT_CC_SHUFFLE_LZ && esize > 1;
+
+    // offsets of chunks in compressed data
+    std::vector<size_t> offsets(count + 1);
+    offsets[0] = kHeader + count * sizeof(uint64_t);
+    for (size_t i = 0; i < count; i++) {
+        uint64_t n = load<uint64_t>(in + kHeader + i * sizeof(uint64_t));
+        if (n > csize - offsets[i]) {
+            return false;
+        }
+        offsets[i + 1] = offsets[i] + n;
+    }
+
+    std::atomic<bool> ok(true);
+    std::vector<double> errors(count);
+    parallel::for_each(threads, count, [&](size_t i) {
+        size_t len = std::min(chunk, size - i * chunk);
+        size_t n = offsets[i + 1] - offsets[i];
+        const uint8_t* p = in + offsets[i];
+        uint8_t* q = out + i * chunk;
+
+        if (n == len) {
+            std::memcpy(q, p, len);
+        } else if (codec == SDMT_CC_LOSSY) {
+            bool done = false;
+            if (len % esize == 0 && esize == sizeof(float)) {
+                done = lossy_decompress(p, n, reinterpret_cast<float*>(q),
+                        len / esize, errors[i]);
+            } else if (len % esize == 0 && esize == sizeof(double)) {
+                done = lossy_decompress(p, n, reinterpret_cast<double*>(q),
+                        len / esize, errors[i]);
+            }
+            if (!done) {
+                ok = false;
+            }
+        } else if (!shuffled) {
+            if (!lz_decompress(p, n, q, len)) {
+                ok = false;
+            }
+        } else {
+            std::vector<uint8_t> tmp(len);
+            if (lz_decompress(p, n, tmp.data(), len)) {
+                unshuffle(tmp.data(), len, esize, q);
+            } else {
+                ok = false;
+            }
+        }
+    });
+
+    if (error != nullptr && !errors.empty()) {
+        *error = *std::max_element(errors.begin(), errors.end());
+    }
+    return ok;
+}
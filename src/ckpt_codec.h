@@ -0,0 +1,88 @@
+/**
+Copyright 2021 PIDL(Petabyte-scale In-memory Database Lab) http://kdb.snu.ac.kr
+This work was supported by Next-Generation Information Computing Development
+Program through the National Research Foundation of Korea(NRF)
+funded by the Ministry of Science, ICT (NRF-2016M3C4A7952587)
+Author: Ilju Lee, Jongin Kim, Hyerim Jeon, Youngjune Park
+Contact: sdmt@kdb.snu.ac.kr
+ */
+
+#ifndef CKPT_CODEC_H_
+#define CKPT_CODEC_H_
+
+#include "common.h"
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief compression of checkpoint payloads
+ * @details input is split into chunks compressed independently,
+ *  so chunks are processed by several threads.<p>
+ *  layout: [codec][element size][size][chunk size][count]
+ *  [compressed size]*count[chunk]*count<p>
+ *  a chunk which does not shrink is stored as is<p>
+ *  SDMT_CC_LOSSY keeps every float or double value within an absolute
+ *  error bound, see lossy_compress() in ckpt_codec.cc
+ */
+class Codec
+{
+  public:
+    /** @brief default byte size of a chunk */
+    static const size_t kChunk = 1 << 20;
+
+    /**
+     * @brief upper bound of compressed size
+     * @param size byte size of input
+     * @return byte size of buffer enough for compress()
+     */
+    static size_t bound(size_t size);
+
+    /**
+     * @brief compress a memory block
+     * @param codec compression codec, not SDMT_CC_NONE
+     * @param esize byte size of an element, used by byte shuffle
+     * @param src input
+     * @param size byte size of input
+     * @param dst destination, at least bound(size) bytes
+     * @param threads number of threads, 0 for hardware concurrency
+     * @param bound absolute error bound of SDMT_CC_LOSSY
+     * @return byte size of compressed data
+     */
+    static size_t compress(SDMT_CC codec,
+                    size_t esize,
+                    const void* src,
+                    size_t size,
+                    void* dst,
+                    int threads,
+                    double bound = 0);
+
+    /**
+     * @brief get byte size of decompressed data
+     * @param src compressed data
+     * @param csize byte size of compressed data
+     * @param size [out] byte size of decompressed data
+     * @return false if the data is malformed
+     */
+    static bool decoded_size(const void* src, size_t csize, size_t& size);
+
+    /**
+     * @brief decompress a memory block
+     * @param src compressed data
+     * @param csize byte size of compressed data
+     * @param dst destination
+     * @param size byte size of destination, must be decoded_size()
+     * @param threads number of threads, 0 for hardware concurrency
+     * @param error [out] maximum absolute error of decompressed values,
+     *  0 unless the data is lossy
+     * @return false if the data is malformed
+     */
+    static bool decompress(const void* src,
+                    size_t csize,
+                    void* dst,
+                    size_t size,
+                    int threads,
+                    double* error = nullptr);
+};
+
+#endif  // CKPT_CODEC_H_
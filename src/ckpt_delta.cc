@@ -0,0 +1,95 @@
+/**
+Copyright 2021 PIDL(Petabyte-scale In-memory Database Lab) http://kdb.snu.ac.kr
+This work was supported by Next-Generation Information Computing Development
+Program through the National Research Foundation of Korea(NRF)
+funded by the Ministry of Science, ICT (NRF-2016M3C4A7952587)
+Author: Ilju Lee, Jongin Kim, Hyerim Jeon, Youngjune Park
+Contact: sdmt@kdb.snu.ac.kr
+ */
+
+#include "ckpt_delta.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+size_t block_bytes(size_t rawsize, size_t block, uint64_t index) {
+    size_t begin = index * block;
+    if (begin >= rawsize) {
+        return 0;
+    }
+    return std::min(block, rawsize - begin);
+}
+
+}  // namespace
+
+size_t Delta::size(size_t rawsize,
+                size_t block,
+                const std::vector<uint64_t>& blocks) {
+    size_t size = 2 * sizeof(uint64_t) + blocks.size() * sizeof(uint64_t);
+    for (auto b : blocks) {
+        size += block_bytes(rawsize, block, b);
+    }
+    return size;
+}
+
+void Delta::encode(const void* src,
+                size_t rawsize,
+                size_t block,
+                const std::vector<uint64_t>& blocks,
+                void* dst) {
+    const char* s = reinterpret_cast<const char*>(src);
+    char* d = reinterpret_cast<char*>(dst);
+
+    uint64_t header[2] = {block, blocks.size()};
+    std::memcpy(d, header, sizeof(header));
+    d += sizeof(header);
+
+    if (!blocks.empty()) {
+        std::memcpy(d, blocks.data(), blocks.size() * sizeof(uint64_t));
+        d += blocks.size() * sizeof(uint64_t);
+    }
+
+    for (auto b : blocks) {
+        size_t n = block_bytes(rawsize, block, b);
+        std::memcpy(d, s + b * block, n);
+        d += n;
+    }
+}
+
+bool Delta::apply(const void* delta,
+                size_t size,
+                void* dst,
+                size_t rawsize) {
+    const char* s = reinterpret_cast<const char*>(delta);
+    const char* end = s + size;
+    char* d = reinterpret_cast<char*>(dst);
+
+    uint64_t header[2];
+    if (size < sizeof(header)) {
+        return false;
+    }
+    std::memcpy(header, s, sizeof(header));
+    s += sizeof(header);
+
+    size_t block = header[0];
+    uint64_t count = header[1];
+    if (block == 0 || count > (uint64_t)(end - s) / sizeof(uint64_t)) {
+        return false;
+    }
+
+    const char* index = s;
+    s += count * sizeof(uint64_t);
+    for (uint64_t i = 0; i < count; i++) {
+        uint64_t b;
+        std::memcpy(&b, index + i * sizeof(uint64_t), sizeof(b));
+        size_t n = block_bytes(rawsize, block, b);
+        if (n == 0 || n > (size_t)(end - s)) {
+            return false;
+        }
+        std::memcpy(d + b * block, s, n);
+        s += n;
+    }
+    return s == end;
+}
@@ -0,0 +1,66 @@
+/**
+Copyright 2021 PIDL(Petabyte-scale In-memory Database Lab) http://kdb.snu.ac.kr
+This work was supported by Next-Generation Information Computing Development
+Program through the National Research Foundation of Korea(NRF)
+funded by the Ministry of Science, ICT (NRF-2016M3C4A7952587)
+Author: Ilju Lee, Jongin Kim, Hyerim Jeon, Youngjune Park
+Contact: sdmt@kdb.snu.ac.kr
+ */
+
+#ifndef CKPT_DELTA_H_
+#define CKPT_DELTA_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief encoding of an incremental checkpoint
+ * @details a delta holds the blocks of a Snapshot changed since
+ *  the previous checkpoint.<p>
+ *  layout: [block size][count][block index]*count[block data]*count<p>
+ *  the last block of a Snapshot may be shorter than block size
+ */
+class Delta
+{
+  public:
+    /**
+     * @brief byte size of an encoded delta
+     * @param rawsize byte size of Snapshot
+     * @param block byte size of a block
+     * @param blocks ascending indices of changed blocks
+     * @return byte size of the delta
+     */
+    static size_t size(size_t rawsize,
+                    size_t block,
+                    const std::vector<uint64_t>& blocks);
+
+    /**
+     * @brief encode changed blocks of a Snapshot
+     * @param src Snapshot memory
+     * @param rawsize byte size of Snapshot
+     * @param block byte size of a block
+     * @param blocks ascending indices of changed blocks
+     * @param dst destination, at least size() bytes
+     */
+    static void encode(const void* src,
+                    size_t rawsize,
+                    size_t block,
+                    const std::vector<uint64_t>& blocks,
+                    void* dst);
+
+    /**
+     * @brief apply a delta on top of the previous Snapshot image
+     * @param delta encoded delta
+     * @param size byte size of the delta
+     * @param dst Snapshot memory holding the previous image
+     * @param rawsize byte size of Snapshot
+     * @return false if the delta is malformed
+     */
+    static bool apply(const void* delta,
+                    size_t size,
+                    void* dst,
+                    size_t rawsize);
+};
+
+#endif  // CKPT_DELTA_H_
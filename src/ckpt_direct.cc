@@ -0,0 +1,425 @@
+/**
+Copyright 2021 PIDL(Petabyte-scale In-memory Database Lab) http://kdb.snu.ac.kr
+This work was supported by Next-Generation Information Computing Development
+Program through the National Research Foundation of Korea(NRF)
+funded by the Ministry of Science, ICT (NRF-2016M3C4A7952587)
+Author: Ilju Lee, Jongin Kim, Hyerim Jeon, Youngjune Park
+Contact: sdmt@kdb.snu.ac.kr
+ */
+
+#include "ckpt_direct.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#define SDMT_HAVE_IO_URING
+#endif
+#endif
+
+namespace {
+
+uint64_t align_up(uint64_t size, uint64_t align) {
+    return (size + align - 1) / align * align;
+}
+
+bool aligned(const void* ptr, size_t align) {
+    return reinterpret_cast<uintptr_t>(ptr) % align == 0;
+}
+
+bool pwrite_all(int fd, const char* p, size_t size, uint64_t offset) {
+    while (size > 0) {
+        ssize_t n = ::pwrite(fd, p, size, offset);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        } else if (n == 0) {
+            return false;
+        }
+        p += n;
+        size -= n;
+        offset += n;
+    }
+    return true;
+}
+
+}  // namespace
+
+CkptDirect::CkptDirect()
+    : m_fd(-1),
+    m_pool(nullptr),
+    m_failed(false),
+    m_ring(-1),
+    m_registered(false),
+    m_queued(0),
+    m_inflight(0),
+    m_sq(nullptr),
+    m_sq_size(0),
+    m_cq(nullptr),
+    m_cq_size(0),
+    m_sqes(nullptr),
+    m_sqes_size(0),
+    m_sq_tail(nullptr),
+    m_sq_mask(nullptr),
+    m_sq_array(nullptr),
+    m_cq_head(nullptr),
+    m_cq_tail(nullptr),
+    m_cq_mask(nullptr),
+    m_cqes(nullptr) {}
+
+CkptDirect::~CkptDirect() {
+    teardown_();
+}
+
+bool CkptDirect::write(const std::string& path,
+        const CkptFile::Header& header,
+        std::vector<CkptFile::Record>& records,
+        const Tuning& tuning) {
+    if (!setup_(tuning)) {
+        return CkptFile::write(path, header, records);
+    }
+
+    std::string head;
+    uint64_t end = CkptFile::layout(header, records, head, m_tuning.m_align);
+
+    // write to temporary file, then publish it by rename
+    std::string tmp = path + ".tmp";
+    m_fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_DIRECT, 0644);
+    if (m_fd < 0) {
+        // file system without direct I/O
+        return errno == EINVAL && CkptFile::write(path, header, records);
+    }
+
+    m_failed = false;
+    copy_(head.data(), head.size(), 0);
+    for (auto& r : records) {
+        const char* p = reinterpret_cast<const char*>(r.m_data);
+        if (aligned(p, m_tuning.m_align)) {
+            direct_(p, r.m_size, r.m_offset);
+        } else {
+            copy_(p, r.m_size, r.m_offset);
+        }
+    }
+    reap_(m_slots.size() - m_free.size());
+
+    // the last block was padded
+    bool ok = !m_failed && ::ftruncate(m_fd, end) == 0 && ::fsync(m_fd) == 0;
+    ok = (::close(m_fd) == 0) && ok;
+    m_fd = -1;
+
+    if (!ok || ::rename(tmp.c_str(), path.c_str()) != 0) {
+        ::unlink(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool CkptDirect::setup_(const Tuning& tuning) {
+    Tuning t = tuning;
+    t.m_align = std::max<size_t>(t.m_align, 512);
+    t.m_block = align_up(std::max(t.m_block, t.m_align), t.m_align);
+    t.m_depth = std::max(t.m_depth, 1);
+    if (m_pool != nullptr && t.m_depth == m_tuning.m_depth
+            && t.m_block == m_tuning.m_block
+            && t.m_align == m_tuning.m_align) {
+        return true;
+    }
+    teardown_();
+    m_tuning = t;
+
+    void* pool = nullptr;
+    if (posix_memalign(&pool, t.m_align, t.m_block * t.m_depth) != 0) {
+        return false;
+    }
+    m_pool = reinterpret_cast<char*>(pool);
+    m_slots.assign(t.m_depth, Slot());
+    m_free.clear();
+    for (int i = t.m_depth - 1; i >= 0; i--) {
+        m_free.push_back(i);
+    }
+
+#ifdef SDMT_HAVE_IO_URING
+    struct io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    int ring = syscall(__NR_io_uring_setup, t.m_depth, &params);
+    if (ring < 0) {
+        // kernel without io_uring or forbidden by seccomp
+        return true;
+    }
+
+    // IORING_OP_WRITE came with the probe in Linux 5.6, earlier kernels
+    // fail every write with it, so they write with pwrite() instead
+    std::vector<char> buf(sizeof(struct io_uring_probe)
+            + IORING_OP_LAST * sizeof(struct io_uring_probe_op), 0);
+    struct io_uring_probe* probe =
+        reinterpret_cast<struct io_uring_probe*>(buf.data());
+    if (syscall(__NR_io_uring_register, ring, IORING_REGISTER_PROBE,
+                probe, IORING_OP_LAST) != 0
+            || probe->last_op < IORING_OP_WRITE
+            || !(probe->ops[IORING_OP_WRITE].flags & IO_URING_OP_SUPPORTED)) {
+        ::close(ring);
+        return true;
+    }
+
+    m_sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    m_cq_size = params.cq_off.cqes
+        + params.cq_entries * sizeof(struct io_uring_cqe);
+    bool single = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single) {
+        m_sq_size = m_cq_size = std::max(m_sq_size, m_cq_size);
+    }
+    m_sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+
+    m_sq = ::mmap(nullptr, m_sq_size, PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_POPULATE, ring, IORING_OFF_SQ_RING);
+    m_cq = single ? m_sq : ::mmap(nullptr, m_cq_size, PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_POPULATE, ring, IORING_OFF_CQ_RING);
+    m_sqes = ::mmap(nullptr, m_sqes_size, PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_POPULATE, ring, IORING_OFF_SQES);
+    m_ring = ring;
+    if (m_sq == MAP_FAILED || m_cq == MAP_FAILED || m_sqes == MAP_FAILED) {
+        close_ring_();
+        return true;
+    }
+
+    char* sq = reinterpret_cast<char*>(m_sq);
+    char* cq = reinterpret_cast<char*>(m_cq);
+    m_sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    m_sq_mask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    m_sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    m_cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    m_cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    m_cq_mask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    m_cqes = cq + params.cq_off.cqes;
+
+    // pin bounce buffers once, so fixed writes skip mapping them
+    std::vector<struct iovec> iov(t.m_depth);
+    for (int i = 0; i < t.m_depth; i++) {
+        iov[i].iov_base = m_pool + i * t.m_block;
+        iov[i].iov_len = t.m_block;
+    }
+    // bounce buffers are written as plain memory if it fails
+    m_registered = syscall(__NR_io_uring_register, m_ring,
+            IORING_REGISTER_BUFFERS, iov.data(), t.m_depth) == 0;
+#endif
+    return true;
+}
+
+void CkptDirect::teardown_() {
+    close_ring_();
+    std::free(m_pool);
+    m_pool = nullptr;
+    m_slots.clear();
+    m_free.clear();
+}
+
+void CkptDirect::close_ring_() {
+#ifdef SDMT_HAVE_IO_URING
+    if (m_sqes != nullptr && m_sqes != MAP_FAILED) {
+        ::munmap(m_sqes, m_sqes_size);
+    }
+    if (m_cq != nullptr && m_cq != MAP_FAILED && m_cq != m_sq) {
+        ::munmap(m_cq, m_cq_size);
+    }
+    if (m_sq != nullptr && m_sq != MAP_FAILED) {
+        ::munmap(m_sq, m_sq_size);
+    }
+#endif
+    m_sq = m_cq = m_sqes = nullptr;
+    if (m_ring >= 0) {
+        ::close(m_ring);
+        m_ring = -1;
+    }
+    m_queued = 0;
+    m_inflight = 0;
+    m_registered = false;
+}
+
+void CkptDirect::copy_(const char* src, size_t size, uint64_t offset) {
+    size_t block = m_tuning.m_block;
+    for (size_t done = 0; done < size; done += block) {
+        size_t n = std::min(block, size - done);
+        int slot = acquire_();
+        if (slot < 0) {
+            return;
+        }
+        char* buf = m_pool + slot * block;
+        std::memcpy(buf, src + done, n);
+        size_t padded = align_up(n, m_tuning.m_align);
+        std::memset(buf + n, 0, padded - n);
+
+        m_slots[slot] = Slot{buf, padded, offset + done, true};
+        submit_(slot);
+    }
+}
+
+void CkptDirect::direct_(const char* src, size_t size, uint64_t offset) {
+    size_t block = m_tuning.m_block;
+    size_t body = size / m_tuning.m_align * m_tuning.m_align;
+    for (size_t done = 0; done < body; done += block) {
+        int slot = acquire_();
+        if (slot < 0) {
+            return;
+        }
+        m_slots[slot] = Slot{src + done, std::min(block, body - done),
+            offset + done, false};
+        submit_(slot);
+    }
+    copy_(src + body, size - body, offset + body);
+}
+
+int CkptDirect::acquire_() {
+    if (m_free.empty()) {
+        reap_(1);
+    }
+    if (m_free.empty()) {
+        // writes in flight could not be waited for, see fallback_()
+        m_failed = true;
+        return -1;
+    }
+    int slot = m_free.back();
+    m_free.pop_back();
+    return slot;
+}
+
+void CkptDirect::submit_(int slot) {
+    const Slot& s = m_slots[slot];
+#ifdef SDMT_HAVE_IO_URING
+    if (m_ring >= 0) {
+        unsigned tail = *m_sq_tail;
+        unsigned index = tail & *m_sq_mask;
+        struct io_uring_sqe* sqe =
+            reinterpret_cast<struct io_uring_sqe*>(m_sqes) + index;
+        std::memset(sqe, 0, sizeof(*sqe));
+        sqe->opcode = (s.m_fixed && m_registered)
+            ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+        sqe->fd = m_fd;
+        sqe->addr = reinterpret_cast<uintptr_t>(s.m_ptr);
+        sqe->len = s.m_size;
+        sqe->off = s.m_offset;
+        sqe->buf_index = sqe->opcode == IORING_OP_WRITE_FIXED ? slot : 0;
+        sqe->user_data = slot;
+        m_sq_array[index] = index;
+
+        // the kernel sees the entry once the tail is published
+        __atomic_store_n(m_sq_tail, tail + 1, __ATOMIC_RELEASE);
+        m_queued++;
+        return;
+    }
+#endif
+    complete_(slot, pwrite_all(m_fd, s.m_ptr, s.m_size, s.m_offset)
+            ? (int64_t)s.m_size : -EIO);
+}
+
+void CkptDirect::reap_(unsigned wait) {
+#ifdef SDMT_HAVE_IO_URING
+    if (m_ring < 0) {
+        return;
+    }
+    while (wait > 0 || m_queued > 0) {
+        // submit the batch and wait in one system call
+        int n = syscall(__NR_io_uring_enter, m_ring, m_queued, wait,
+                wait > 0 ? IORING_ENTER_GETEVENTS : 0, nullptr, 0);
+        if (n < 0) {
+            if (errno == EINTR || errno == EAGAIN || errno == EBUSY) continue;
+            fallback_();
+            return;
+        }
+        n = std::min<unsigned>(n, m_queued);
+        m_queued -= n;
+        m_inflight += n;
+
+        unsigned freed = harvest_();
+        wait -= std::min(freed, wait);
+    }
+#else
+    (void)wait;
+#endif
+}
+
+unsigned CkptDirect::harvest_() {
+    unsigned freed = 0;
+#ifdef SDMT_HAVE_IO_URING
+    unsigned head = *m_cq_head;
+    unsigned tail = __atomic_load_n(m_cq_tail, __ATOMIC_ACQUIRE);
+    for (; head != tail; head++) {
+        const struct io_uring_cqe* cqe =
+            reinterpret_cast<const struct io_uring_cqe*>(m_cqes)
+            + (head & *m_cq_mask);
+        m_inflight--;
+        freed += complete_(cqe->user_data, cqe->res) ? 1 : 0;
+    }
+    __atomic_store_n(m_cq_head, head, __ATOMIC_RELEASE);
+#endif
+    return freed;
+}
+
+void CkptDirect::fallback_() {
+#ifdef SDMT_HAVE_IO_URING
+    // the kernel may still read the memory of submitted writes,
+    // so they are waited for before a slot is reused
+    while (m_inflight > 0) {
+        int n = syscall(__NR_io_uring_enter, m_ring, 0, m_inflight,
+                IORING_ENTER_GETEVENTS, nullptr, 0);
+        if (n < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+            break;
+        }
+        harvest_();
+    }
+    bool drained = m_inflight == 0;
+    close_ring_();
+
+    if (!drained) {
+        // bounce buffers are left to the kernel, the next write sets up
+        // new ones
+        m_failed = true;
+        m_pool = nullptr;
+        m_slots.clear();
+        m_free.clear();
+        return;
+    }
+
+    // queued writes never reached the kernel, write them by pwrite()
+    std::vector<bool> free(m_slots.size(), false);
+    for (int slot : m_free) {
+        free[slot] = true;
+    }
+    for (size_t slot = 0; slot < m_slots.size(); slot++) {
+        if (!free[slot]) {
+            submit_(slot);
+        }
+    }
+#endif
+}
+
+bool CkptDirect::complete_(int slot, int64_t res) {
+    Slot& s = m_slots[slot];
+    if (res <= 0) {
+        m_failed = true;
+    } else if ((uint64_t)res < s.m_size) {
+        // short writes are rare, the rest is written again from the last
+        // aligned offset, as O_DIRECT takes aligned offsets only
+        uint64_t done = (uint64_t)res / m_tuning.m_align * m_tuning.m_align;
+        if (done == 0) {
+            m_failed = true;
+        } else {
+            s.m_ptr += done;
+            s.m_size -= done;
+            s.m_offset += done;
+            submit_(slot);
+            return false;
+        }
+    }
+    m_free.push_back(slot);
+    return true;
+}
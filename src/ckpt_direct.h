@@ -0,0 +1,233 @@
+/**
+Copyright 2021 PIDL(Petabyte-scale In-memory Database Lab) http://kdb.snu.ac.kr
+This work was supported by Next-Generation Information Computing Development
+Program through the National Research Foundation of Korea(NRF)
+funded by the Ministry of Science, ICT (NRF-2016M3C4A7952587)
+Author: Ilju Lee, Jongin Kim, Hyerim Jeon, Youngjune Park
+Contact: sdmt@kdb.snu.ac.kr
+ */
+
+#ifndef CKPT_DIRECT_H_
+#define CKPT_DIRECT_H_
+
+#include "ckpt_file.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief native checkpoint file writer bypassing the page cache
+ * @details the file is opened with O_DIRECT and payloads are laid out at
+ *  aligned offsets. aligned Snapshot memory is written as it is, without
+ *  a copy, other memory and the unaligned tails go through a pool of
+ *  aligned bounce buffers registered to the kernel.<p>
+ *  writes are batched into an io_uring submission queue, up to the queue
+ *  depth in flight. without io_uring, writes are pwrite() calls, and
+ *  without O_DIRECT(e.g. tmpfs), CkptFile::write() is used.<p>
+ *  not thread safe, one writer at a time
+ */
+class CkptDirect
+{
+  public:
+    /**
+     * @brief direct I/O tuning
+     */
+    struct Tuning {
+        /**
+         * @brief create default Tuning
+         */
+        Tuning()
+            : m_depth(16),
+            m_block(1 << 20),
+            m_align(4096) {}
+
+        /** @brief number of writes in flight */
+        int m_depth;
+
+        /** @brief byte size of a write, also of a bounce buffer */
+        size_t m_block;
+
+        /** @brief alignment of memory, offsets and sizes of O_DIRECT */
+        size_t m_align;
+    };
+
+    /**
+     * @brief create a CkptDirect, the queue is set up on first write
+     */
+    CkptDirect();
+
+    /**
+     * @brief release the queue and bounce buffers
+     */
+    ~CkptDirect();
+
+    /**
+     * @brief write a checkpoint file atomically
+     * @param path path of the file
+     * @param header checkpoint metadata
+     * @param records Snapshots to write, offsets are assigned
+     * @param tuning direct I/O tuning
+     * @return true if success
+     */
+    bool write(const std::string& path,
+            const CkptFile::Header& header,
+            std::vector<CkptFile::Record>& records,
+            const Tuning& tuning);
+
+    /**
+     * @brief check whether writes are submitted by io_uring
+     * @return true if io_uring is set up
+     */
+    bool uring() const { return m_ring >= 0; }
+
+  private:
+    /**
+     * @brief a write in flight
+     */
+    struct Slot {
+        /** @brief source memory */
+        const char* m_ptr;
+
+        /** @brief byte size to write */
+        size_t m_size;
+
+        /** @brief byte offset in the file */
+        uint64_t m_offset;
+
+        /** @brief whether the slot writes its registered bounce buffer */
+        bool m_fixed;
+    };
+
+    /**
+     * @brief set up bounce buffers and io_uring for the tuning
+     * @param tuning direct I/O tuning
+     * @return false if bounce buffers cannot be allocated
+     */
+    bool setup_(const Tuning& tuning);
+
+    /**
+     * @brief release io_uring and bounce buffers
+     */
+    void teardown_();
+
+    /**
+     * @brief release io_uring, writes fall back to pwrite()
+     */
+    void close_ring_();
+
+    /**
+     * @brief write memory through bounce buffers
+     * @param src source memory
+     * @param size byte size, the last block is padded with zeros
+     * @param offset aligned byte offset in the file
+     */
+    void copy_(const char* src, size_t size, uint64_t offset);
+
+    /**
+     * @brief write aligned memory as it is, the unaligned tail is copied
+     * @param src aligned source memory
+     * @param size byte size
+     * @param offset aligned byte offset in the file
+     */
+    void direct_(const char* src, size_t size, uint64_t offset);
+
+    /**
+     * @brief get a free slot, waiting for writes in flight if none
+     * @return index of the slot, -1 if io_uring fails while waiting
+     */
+    int acquire_();
+
+    /**
+     * @brief queue a write of a slot
+     * @param slot index of the slot
+     */
+    void submit_(int slot);
+
+    /**
+     * @brief submit queued writes and handle completed ones
+     * @param wait number of slots to wait for to be free
+     */
+    void reap_(unsigned wait);
+
+    /**
+     * @brief handle completed writes in the completion queue
+     * @return number of slots set free
+     */
+    unsigned harvest_();
+
+    /**
+     * @brief release io_uring after it fails, once submitted writes are
+     *  done. queued writes are written by pwrite()
+     */
+    void fallback_();
+
+    /**
+     * @brief finish a write of a slot, resubmitting the rest of a short one
+     * @param slot index of the slot
+     * @param res result of the write
+     * @return true if the slot is free
+     */
+    bool complete_(int slot, int64_t res);
+
+    /** @brief file being written */
+    int m_fd;
+
+    /** @brief tuning of the current setup */
+    Tuning m_tuning;
+
+    /** @brief aligned bounce buffers, m_block bytes for each slot */
+    char* m_pool;
+
+    /** @brief writes of each slot */
+    std::vector<Slot> m_slots;
+
+    /** @brief indices of free slots */
+    std::vector<int> m_free;
+
+    /** @brief true if a write of the current file failed */
+    bool m_failed;
+
+    /** @brief io_uring file descriptor, -1 to write by pwrite() */
+    int m_ring;
+
+    /** @brief true if bounce buffers are registered to io_uring */
+    bool m_registered;
+
+    /** @brief number of queued writes not submitted yet */
+    unsigned m_queued;
+
+    /** @brief number of submitted writes not completed yet */
+    unsigned m_inflight;
+
+    /** @brief mapped submission queue ring */
+    void* m_sq;
+
+    /** @brief byte size of m_sq */
+    size_t m_sq_size;
+
+    /** @brief mapped completion queue ring, may be the same as m_sq */
+    void* m_cq;
+
+    /** @brief byte size of m_cq */
+    size_t m_cq_size;
+
+    /** @brief mapped submission queue entries */
+    void* m_sqes;
+
+    /** @brief byte size of m_sqes */
+    size_t m_sqes_size;
+
+    /** @brief submission queue fields in m_sq */
+    unsigned* m_sq_tail;
+    unsigned* m_sq_mask;
+    unsigned* m_sq_array;
+
+    /** @brief completion queue fields in m_cq */
+    unsigned* m_cq_head;
+    unsigned* m_cq_tail;
+    unsigned* m_cq_mask;
+    void* m_cqes;
+};
+
+#endif  // CKPT_DIRECT_H_
@@ -0,0 +1,177 @@
+/**
+Copyright 2021 PIDL(Petabyte-scale In-memory Database Lab) http://kdb.snu.ac.kr
+This work was supported by Next-Generation Information Computing Development
+Program through the National Research Foundation of Korea(NRF)
+funded by the Ministry of Science, ICT (NRF-2016M3C4A7952587)
+Author: Ilju Lee, Jongin Kim, Hyerim Jeon, Youngjune Park
+Contact: sdmt@kdb.snu.ac.kr
+ */
+
+#include "ckpt_drain.h"
+#include "ckpt_file.h"
+
+#include <cerrno>
+#include <chrono>
+#include <set>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+/** @brief byte size of a piece read and written at once */
+const size_t kPiece = 4 << 20;
+
+}  // namespace
+
+CkptDrain::CkptDrain()
+    : m_busy(false),
+    m_failed(false),
+    m_stop(false) {}
+
+CkptDrain::~CkptDrain() {
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cv.notify_all();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+void CkptDrain::submit(const std::string& src,
+        const std::string& dst,
+        int id,
+        int rank,
+        const CkptFile::Retention& retention,
+        double bandwidth) {
+    // the local checkpoint and its bases are kept until copied
+    CkptFile::pin(src, id, rank);
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_queue.push_back(Item{src, dst, id, rank, retention, bandwidth});
+    if (!m_thread.joinable()) {
+        m_thread = std::thread(&CkptDrain::run_, this);
+    }
+    m_cv.notify_all();
+}
+
+bool CkptDrain::wait() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cv.wait(lock, [this] { return m_queue.empty() && !m_busy; });
+    bool ok = !m_failed;
+    m_failed = false;
+    return ok;
+}
+
+void CkptDrain::run_() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        // copy queued checkpoints before exiting
+        m_cv.wait(lock, [this] { return !m_queue.empty() || m_stop; });
+        if (m_queue.empty()) {
+            return;
+        }
+        Item item = m_queue.front();
+        m_queue.pop_front();
+        m_busy = true;
+
+        lock.unlock();
+        bool ok = CkptFile::make_dir(item.m_dst) && drain_(item, item.m_id);
+        if (ok) {
+            CkptFile::prune(item.m_dst, item.m_rank, item.m_retention);
+        }
+        CkptFile::unpin(item.m_src, item.m_id, item.m_rank);
+        lock.lock();
+
+        m_failed = m_failed || !ok;
+        m_busy = false;
+        m_cv.notify_all();
+    }
+}
+
+bool CkptDrain::drain_(const Item& item, int id) {
+    std::string src = CkptFile::path(item.m_src, id, item.m_rank);
+    std::string dst = CkptFile::path(item.m_dst, id, item.m_rank);
+    if (::access(dst.c_str(), F_OK) == 0) {
+        return true;
+    }
+
+    // the global directory must hold the whole chain of deltas,
+    // bases are kept in the local directory as long as they are needed
+    CkptFile::Header header;
+    std::vector<CkptFile::Record> records;
+    if (!CkptFile::read_index(src, header, records)) {
+        return false;
+    }
+    std::set<int> bases;
+    for (auto& r : records) {
+        if (r.m_base >= 0 && r.m_base < id) {
+            bases.insert(r.m_base);
+        }
+    }
+    for (int base : bases) {
+        if (!drain_(item, base)) {
+            return false;
+        }
+    }
+    return copy_(src, dst, item.m_bandwidth);
+}
+
+bool CkptDrain::copy_(const std::string& from, const std::string& to,
+        double bandwidth) {
+    int in = ::open(from.c_str(), O_RDONLY);
+    if (in < 0) {
+        return false;
+    }
+    std::string tmp = to + ".tmp";
+    int out = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (out < 0) {
+        ::close(in);
+        return false;
+    }
+
+    std::vector<char> buf(kPiece);
+    auto begin = std::chrono::steady_clock::now();
+    double copied = 0;
+    bool ok = true;
+    while (ok) {
+        ssize_t n = ::read(in, buf.data(), buf.size());
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            ok = (n == 0);
+            break;
+        }
+        for (ssize_t w = 0; ok && w < n; ) {
+            ssize_t m = ::write(out, buf.data() + w, n - w);
+            if (m < 0 && errno != EINTR) {
+                ok = false;
+            }
+            w += (m > 0) ? m : 0;
+        }
+        copied += n;
+
+        // sleep until the copied bytes are due at the bandwidth,
+        // or the destructor asks for full speed
+        if (bandwidth > 0) {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait_until(lock, begin
+                + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                    std::chrono::duration<double>(copied / bandwidth)),
+                [this] { return m_stop.load(); });
+        }
+    }
+    ok = ok && ::fsync(out) == 0;
+    ok = (::close(out) == 0) && ok;
+    ::close(in);
+
+    if (!ok || ::rename(tmp.c_str(), to.c_str()) != 0) {
+        ::unlink(tmp.c_str());
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,127 @@
+/**
+Copyright 2021 PIDL(Petabyte-scale In-memory Database Lab) http://kdb.snu.ac.kr
+This work was supported by Next-Generation Information Computing Development
+Program through the National Research Foundation of Korea(NRF)
+funded by the Ministry of Science, ICT (NRF-2016M3C4A7952587)
+Author: Ilju Lee, Jongin Kim, Hyerim Jeon, Youngjune Park
+Contact: sdmt@kdb.snu.ac.kr
+ */
+
+#ifndef CKPT_DRAIN_H_
+#define CKPT_DRAIN_H_
+
+#include "ckpt_file.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+/**
+ * @brief background copier of native checkpoint files
+ *  from a node-local directory to a global one
+ * @details checkpoints are written to a fast node-local directory first,
+ *  a dedicated thread copies them to the global directory in order,
+ *  with the bases of their deltas, at a limited bandwidth.<p>
+ *  a file is copied to a temporary path and renamed when complete,
+ *  so a file in the global directory is always a complete checkpoint.
+ *  a queued checkpoint is pinned in the node-local directory, so it is
+ *  not pruned before it is copied
+ */
+class CkptDrain
+{
+  public:
+    /**
+     * @brief CkptDrain constructor, the thread starts on first submit
+     */
+    CkptDrain();
+
+    /**
+     * @brief CkptDrain destructor, copies queued checkpoints at full speed
+     */
+    ~CkptDrain();
+
+    /**
+     * @brief queue a written checkpoint to copy
+     * @details thread safe
+     * @param src node-local checkpoint directory
+     * @param dst global checkpoint directory
+     * @param id checkpoint id
+     * @param rank MPI rank
+     * @param retention checkpoints to keep in dst
+     * @param bandwidth bytes per second, 0 for unlimited
+     */
+    void submit(const std::string& src,
+            const std::string& dst,
+            int id,
+            int rank,
+            const CkptFile::Retention& retention,
+            double bandwidth);
+
+    /**
+     * @brief block until queued checkpoints are copied
+     * @return false if a copy failed since the last wait
+     */
+    bool wait();
+
+  private:
+    /**
+     * @brief a checkpoint to copy
+     */
+    struct Item {
+        std::string m_src;
+        std::string m_dst;
+        int m_id;
+        int m_rank;
+        CkptFile::Retention m_retention;
+        double m_bandwidth;
+    };
+
+    /**
+     * @brief main loop of the thread
+     */
+    void run_();
+
+    /**
+     * @brief copy a checkpoint after the bases of its deltas
+     * @param item queued checkpoint
+     * @param id checkpoint id to copy, item's or one of its bases
+     * @return true if copied or already in dst
+     */
+    bool drain_(const Item& item, int id);
+
+    /**
+     * @brief copy a file at a limited bandwidth
+     * @param from source path
+     * @param to destination path
+     * @param bandwidth bytes per second, 0 for unlimited
+     * @return true if success
+     */
+    bool copy_(const std::string& from, const std::string& to,
+            double bandwidth);
+
+    /** @brief copier thread */
+    std::thread m_thread;
+
+    /** @brief lock for the fields below */
+    std::mutex m_mutex;
+
+    /** @brief signaled when a checkpoint is queued or copied */
+    std::condition_variable m_cv;
+
+    /** @brief checkpoints to copy */
+    std::deque<Item> m_queue;
+
+    /** @brief true while a checkpoint is being copied */
+    bool m_busy;
+
+    /** @brief true if a copy failed since the last wait */
+    bool m_failed;
+
+    /** @brief true when the thread has to exit, bandwidth is not limited */
+    std::atomic<bool> m_stop;
+};
+
+#endif  // CKPT_DRAIN_H_
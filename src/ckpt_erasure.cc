@@ -0,0 +1,565 @@
+/**
+Copyright 2021 PIDL(Petabyte-scale In-memory Database Lab) http://kdb.snu.ac.kr
+This work was supported by Next-Generation Information Computing Development
+Program through the National Research Foundation of Korea(NRF)
+funded by the Ministry of Science, ICT (NRF-2016M3C4A7952587)
+Author: Ilju Lee, Jongin Kim, Hyerim Jeon, Youngjune Park
+Contact: sdmt@kdb.snu.ac.kr
+ */
+
+#include "ckpt_erasure.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <immintrin.h>
+
+namespace {
+
+/** @brief message tag of data, parity index is added */
+const int kTagData = 22000;
+
+/** @brief message tag of chunks sent for rebuild */
+const int kTagRebuild = 22999;
+
+/** @brief byte size of a block encoded at once */
+const size_t kBlock = 1 << 20;
+
+/** @brief alignment of a chunk */
+const size_t kAlign = 64;
+
+/** @brief largest group, coefficients are distinct in GF(2^8) */
+const int kMaxGroup = 256;
+
+/** @brief largest message, MPI counts are int */
+const size_t kMaxMessage = 1 << 30;
+
+/**
+ * @brief header of packed Snapshots: [iter][count]
+ *  followed by [id][size][data] of each Snapshot
+ */
+const size_t kHeader = sizeof(int32_t) + sizeof(uint32_t);
+
+const size_t kEntry = sizeof(int32_t) + sizeof(uint64_t);
+
+/**
+ * @brief log and exp tables of GF(2^8) with polynomial 0x11d
+ */
+struct Gf {
+    uint8_t m_exp[512];
+    uint8_t m_log[256];
+
+    Gf() {
+        int x = 1;
+        for (int i = 0; i < 255; i++) {
+            m_exp[i] = x;
+            m_log[x] = i;
+            x <<= 1;
+            if (x & 0x100) {
+                x ^= 0x11d;
+            }
+        }
+        for (int i = 255; i < 512; i++) {
+            m_exp[i] = m_exp[i - 255];
+        }
+        m_log[0] = 0;
+    }
+};
+
+const Gf& gf() {
+    static Gf tables;
+    return tables;
+}
+
+uint8_t gf_mul(uint8_t a, uint8_t b) {
+    if (a == 0 || b == 0) {
+        return 0;
+    }
+    return gf().m_exp[gf().m_log[a] + gf().m_log[b]];
+}
+
+uint8_t gf_inv(uint8_t a) {
+    return gf().m_exp[255 - gf().m_log[a]];
+}
+
+/**
+ * @brief invert a matrix in GF(2^8) by Gauss-Jordan elimination
+ * @param m [in,out] n x n matrix, row major, replaced by its inverse
+ * @param n order of matrix
+ * @return false if singular
+ */
+bool gf_invert(std::vector<uint8_t>& m, int n) {
+    std::vector<uint8_t> inv(n * n, 0);
+    for (int i = 0; i < n; i++) {
+        inv[i * n + i] = 1;
+    }
+    for (int c = 0; c < n; c++) {
+        int pivot = c;
+        while (pivot < n && m[pivot * n + c] == 0) {
+            pivot++;
+        }
+        if (pivot == n) {
+            return false;
+        }
+        for (int i = 0; i < n; i++) {
+            std::swap(m[c * n + i], m[pivot * n + i]);
+            std::swap(inv[c * n + i], inv[pivot * n + i]);
+        }
+        uint8_t s = gf_inv(m[c * n + c]);
+        for (int i = 0; i < n; i++) {
+            m[c * n + i] = gf_mul(m[c * n + i], s);
+            inv[c * n + i] = gf_mul(inv[c * n + i], s);
+        }
+        for (int r = 0; r < n; r++) {
+            uint8_t f = m[r * n + c];
+            if (r == c || f == 0) {
+                continue;
+            }
+            for (int i = 0; i < n; i++) {
+                m[r * n + i] ^= gf_mul(f, m[c * n + i]);
+                inv[r * n + i] ^= gf_mul(f, inv[c * n + i]);
+            }
+        }
+    }
+    m.swap(inv);
+    return true;
+}
+
+/**
+ * @brief dst ^= c * src in GF(2^8)
+ * @details a product is looked up by the low and high nibbles
+ *  of each byte, 16 or 32 bytes at once with byte shuffles
+ */
+void gf_mul_add(char* dst, const char* src, uint8_t c, size_t size) {
+    if (c == 0) {
+        return;
+    }
+    uint8_t* d = reinterpret_cast<uint8_t*>(dst);
+    const uint8_t* s = reinterpret_cast<const uint8_t*>(src);
+    size_t i = 0;
+
+    if (c == 1) {
+#if defined(__AVX2__)
+        for (; i + 32 <= size; i += 32) {
+            __m256i x = _mm256_loadu_si256((const __m256i*)(s + i));
+            __m256i y = _mm256_loadu_si256((const __m256i*)(d + i));
+            _mm256_storeu_si256((__m256i*)(d + i), _mm256_xor_si256(x, y));
+        }
+#elif defined(__SSE2__)
+        for (; i + 16 <= size; i += 16) {
+            __m128i x = _mm_loadu_si128((const __m128i*)(s + i));
+            __m128i y = _mm_loadu_si128((const __m128i*)(d + i));
+            _mm_storeu_si128((__m128i*)(d + i), _mm_xor_si128(x, y));
+        }
+#endif
+        for (; i < size; i++) {
+            d[i] ^= s[i];
+        }
+        return;
+    }
+
+    alignas(16) uint8_t lo[16];
+    alignas(16) uint8_t hi[16];
+    for (int n = 0; n < 16; n++) {
+        lo[n] = gf_mul(c, n);
+        hi[n] = gf_mul(c, n << 4);
+    }
+
+#if defined(__AVX2__)
+    __m256i tlo = _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i*)lo));
+    __m256i thi = _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i*)hi));
+    __m256i mask = _mm256_set1_epi8(0x0f);
+    for (; i + 32 <= size; i += 32) {
+        __m256i x = _mm256_loadu_si256((const __m256i*)(s + i));
+        __m256i l = _mm256_shuffle_epi8(tlo, _mm256_and_si256(x, mask));
+        __m256i h = _mm256_shuffle_epi8(thi,
+                _mm256_and_si256(_mm256_srli_epi64(x, 4), mask));
+        __m256i y = _mm256_loadu_si256((const __m256i*)(d + i));
+        _mm256_storeu_si256((__m256i*)(d + i),
+                _mm256_xor_si256(y, _mm256_xor_si256(l, h)));
+    }
+#elif defined(__SSSE3__)
+    __m128i tlo = _mm_load_si128((const __m128i*)lo);
+    __m128i thi = _mm_load_si128((const __m128i*)hi);
+    __m128i mask = _mm_set1_epi8(0x0f);
+    for (; i + 16 <= size; i += 16) {
+        __m128i x = _mm_loadu_si128((const __m128i*)(s + i));
+        __m128i l = _mm_shuffle_epi8(tlo, _mm_and_si128(x, mask));
+        __m128i h = _mm_shuffle_epi8(thi,
+                _mm_and_si128(_mm_srli_epi64(x, 4), mask));
+        __m128i y = _mm_loadu_si128((const __m128i*)(d + i));
+        _mm_storeu_si128((__m128i*)(d + i),
+                _mm_xor_si128(y, _mm_xor_si128(l, h)));
+    }
+#endif
+    for (; i < size; i++) {
+        d[i] ^= lo[s[i] & 0x0f] ^ hi[s[i] >> 4];
+    }
+}
+
+template<typename T>
+void put(char*& p, T v) {
+    std::memcpy(p, &v, sizeof(v));
+    p += sizeof(v);
+}
+
+template<typename T>
+T get(const char*& p) {
+    T v;
+    std::memcpy(&v, p, sizeof(v));
+    p += sizeof(v);
+    return v;
+}
+
+void post(std::vector<MPI_Request>& reqs, bool send, char* buf, size_t size,
+        int rank, int tag, MPI_Comm comm) {
+    for (size_t off = 0; off < size; off += kMaxMessage) {
+        int n = std::min(kMaxMessage, size - off);
+        MPI_Request req;
+        if (send) {
+            MPI_Isend(buf + off, n, MPI_BYTE, rank, tag, comm, &req);
+        } else {
+            MPI_Irecv(buf + off, n, MPI_BYTE, rank, tag, comm, &req);
+        }
+        reqs.push_back(req);
+    }
+}
+
+/**
+ * @brief check a decoded checkpoint matches the regions
+ * @param buf data chunks of the checkpoint
+ * @param regions regions to load
+ * @param data [out] data of each region in buf
+ * @param iter [out] iteration sequence at checkpoint
+ * @return true if buf holds every region with its size
+ */
+bool parse(const std::vector<char>& buf,
+        const std::vector<CkptRing::Region>& regions,
+        std::vector<const char*>& data, int32_t& iter) {
+    const char* p = buf.data();
+    const char* end = buf.data() + buf.size();
+    if (buf.size() < kHeader) {
+        return false;
+    }
+    iter = get<int32_t>(p);
+    if (get<uint32_t>(p) != regions.size()) {
+        return false;
+    }
+    for (auto& r : regions) {
+        if (size_t(end - p) < kEntry || get<int32_t>(p) != r.m_id
+                || get<uint64_t>(p) != r.m_size
+                || size_t(end - p) < r.m_size) {
+            return false;
+        }
+        data.push_back(p);
+        p += r.m_size;
+    }
+    return true;
+}
+
+}  // namespace
+
+CkptErasure::CkptErasure()
+    : m_group(MPI_COMM_NULL),
+    m_config(0),
+    m_index(0),
+    m_size(0),
+    m_parity(0),
+    m_chunk(0),
+    m_valid(false) {}
+
+CkptErasure::~CkptErasure() {
+    int finalized;
+    MPI_Finalized(&finalized);
+    if (!finalized) {
+        clear();
+    }
+}
+
+bool CkptErasure::encode(MPI_Comm comm,
+        const std::vector<CkptRing::Region>& regions,
+        int group,
+        int parity,
+        int32_t iter) {
+    // a replaced process has no group yet, and the others split with it
+    int fresh = m_group == MPI_COMM_NULL || group != m_config
+        || parity != m_parity;
+    int any = 0;
+    MPI_Allreduce(&fresh, &any, 1, MPI_INT, MPI_MAX, comm);
+    if (any) {
+        setup_(comm, group, parity);
+    }
+    m_valid = false;
+    // every member of a group sees the same size
+    if (m_parity < 1 || m_size <= m_parity || m_size > kMaxGroup) {
+        return false;
+    }
+    int n = m_size;
+    int k = m_parity;
+
+    // chunks are as large as the largest member needs
+    uint64_t size = kHeader;
+    for (auto& r : regions) {
+        size += kEntry + r.m_size;
+    }
+    uint64_t largest;
+    MPI_Allreduce(&size, &largest, 1, MPI_UINT64_T, MPI_MAX, m_group);
+    m_chunk = (largest + n - k - 1) / (n - k);
+    m_chunk = (m_chunk + kAlign - 1) / kAlign * kAlign;
+
+    m_data.resize((n - k) * m_chunk);
+    char* p = m_data.data();
+    put<int32_t>(p, iter);
+    put<uint32_t>(p, regions.size());
+    for (auto& r : regions) {
+        put<int32_t>(p, r.m_id);
+        put<uint64_t>(p, r.m_size);
+        std::memcpy(p, r.m_ptr, r.m_size);
+        p += r.m_size;
+    }
+    std::memset(p, 0, m_data.data() + m_data.size() - p);
+    m_code.resize(k * m_chunk);
+
+    // the next block is in flight while the current one is encoded
+    size_t block = std::min(kBlock, m_chunk);
+    size_t blocks = (m_chunk + block - 1) / block;
+    std::vector<char> recv[2];
+    std::vector<MPI_Request> reqs[2];
+    recv[0].resize(k * (n - k) * block);
+    recv[1].resize(k * (n - k) * block);
+    post_(0, std::min(block, m_chunk), recv[0].data(), reqs[0]);
+    for (size_t b = 0; b < blocks; b++) {
+        size_t offset = b * block;
+        size_t len = std::min(block, m_chunk - offset);
+        if (b + 1 < blocks) {
+            size_t next = offset + block;
+            post_(next, std::min(block, m_chunk - next),
+                    recv[(b + 1) % 2].data(), reqs[(b + 1) % 2]);
+        }
+        std::vector<MPI_Request>& mine = reqs[b % 2];
+        MPI_Waitall(mine.size(), mine.data(), MPI_STATUSES_IGNORE);
+        mine.clear();
+
+        const char* in = recv[b % 2].data();
+        for (int q = 0; q < k; q++) {
+            char* out = m_code.data() + q * m_chunk + offset;
+            std::memset(out, 0, len);
+            for (int t = 0; t < n - k; t++) {
+                gf_mul_add(out, in + (q * (n - k) + t) * len, coef_(q, t), len);
+            }
+        }
+    }
+
+    m_valid = true;
+    return true;
+}
+
+bool CkptErasure::decode(MPI_Comm comm,
+        const std::vector<CkptRing::Region>& regions,
+        int group,
+        int parity,
+        int32_t& iter) {
+    // lost ranks have no group yet, so every rank splits again
+    bool valid = m_valid && group == m_config && parity == m_parity;
+    setup_(comm, group, parity);
+
+    // members of a group agree on its size and its lost members,
+    // so a group rebuilds or fails as a whole
+    bool ok = m_parity >= 1 && m_size > m_parity && m_size <= kMaxGroup;
+    if (ok) {
+        std::vector<int> lost(m_size);
+        int mine = valid ? 0 : 1;
+        MPI_Allgather(&mine, 1, MPI_INT, lost.data(), 1, MPI_INT, m_group);
+        int count = std::count(lost.begin(), lost.end(), 1);
+        ok = count <= m_parity;
+        if (ok) {
+            uint64_t chunk = valid ? m_chunk : 0;
+            uint64_t largest;
+            MPI_Allreduce(&chunk, &largest, 1, MPI_UINT64_T, MPI_MAX,
+                    m_group);
+            m_chunk = largest;
+            if (count > 0) {
+                ok = rebuild_(lost);
+            }
+            m_valid = valid;
+        }
+    }
+
+    // every rank of every group has to match before any region is touched
+    std::vector<const char*> data;
+    int32_t it = 0;
+    int mine = ok && parse(m_data, regions, data, it);
+    int every = 0;
+    MPI_Allreduce(&mine, &every, 1, MPI_INT, MPI_LAND, comm);
+    if (!every) {
+        return false;
+    }
+
+    for (size_t i = 0; i < regions.size(); i++) {
+        std::memcpy(regions[i].m_ptr, data[i], regions[i].m_size);
+    }
+    iter = it;
+    return true;
+}
+
+void CkptErasure::clear() {
+    if (m_group != MPI_COMM_NULL) {
+        MPI_Comm_free(&m_group);
+    }
+    m_group = MPI_COMM_NULL;
+    m_chunk = 0;
+    m_data.clear();
+    m_code.clear();
+    m_valid = false;
+}
+
+void CkptErasure::setup_(MPI_Comm comm, int group, int parity) {
+    if (m_group != MPI_COMM_NULL) {
+        MPI_Comm_free(&m_group);
+    }
+    int rank;
+    int size;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+
+    // members of a group are strided, neighboring ranks share a node
+    int groups = std::max(1, size / std::max(1, group));
+    MPI_Comm_split(comm, rank % groups, rank, &m_group);
+    MPI_Comm_rank(m_group, &m_index);
+    MPI_Comm_size(m_group, &m_size);
+    m_config = group;
+    m_parity = parity;
+}
+
+void CkptErasure::post_(size_t offset, size_t size, char* recv,
+        std::vector<MPI_Request>& reqs) {
+    int n = m_size;
+    int k = m_parity;
+
+    // stripe j has parity q on member j+q and data chunk t on j+k+t,
+    // so this rank keeps parity q of stripe index-q
+    for (int q = 0; q < k; q++) {
+        int j = (m_index - q + n) % n;
+        for (int t = 0; t < n - k; t++) {
+            int source = (j + k + t) % n;
+            post(reqs, false, recv + (q * (n - k) + t) * size, size,
+                    source, kTagData + q, m_group);
+        }
+    }
+
+    // and its chunk t is in stripe index-k-t
+    for (int t = 0; t < n - k; t++) {
+        int j = (m_index - k - t + 2 * n) % n;
+        for (int q = 0; q < k; q++) {
+            post(reqs, true, m_data.data() + t * m_chunk + offset, size,
+                    (j + q) % n, kTagData + q, m_group);
+        }
+    }
+}
+
+bool CkptErasure::rebuild_(const std::vector<int>& lost) {
+    int n = m_size;
+    int k = m_parity;
+    bool rebuilt = lost[m_index];
+    bool ok = true;
+    if (rebuilt) {
+        m_data.assign((n - k) * m_chunk, 0);
+        m_code.clear();
+    }
+
+    // a lost member of a stripe gets the other data chunks and
+    // as many parity chunks as lost members, and solves for its chunk
+    std::vector<char> buf;
+    for (int j = 0; j < n; j++) {
+        std::vector<int> missing;
+        std::vector<int> parity;
+        for (int t = 0; t < n - k; t++) {
+            if (lost[(j + k + t) % n]) {
+                missing.push_back(t);
+            }
+        }
+        if (missing.empty()) {
+            continue;
+        }
+        for (int q = 0; q < k; q++) {
+            if (!lost[(j + q) % n]) {
+                parity.push_back(q);
+            }
+        }
+        parity.resize(missing.size());
+        int a = missing.size();
+
+        int self = -1;
+        std::vector<MPI_Request> reqs;
+        for (int c = 0; c < a; c++) {
+            int dest = (j + k + missing[c]) % n;
+            if (dest == m_index) {
+                self = c;
+                buf.resize((n - k + a) * m_chunk);
+                for (int t = 0; t < n - k; t++) {
+                    if (!lost[(j + k + t) % n]) {
+                        post(reqs, false, buf.data() + t * m_chunk, m_chunk,
+                                (j + k + t) % n, kTagRebuild, m_group);
+                    }
+                }
+                for (int q = 0; q < a; q++) {
+                    post(reqs, false, buf.data() + (n - k + q) * m_chunk,
+                            m_chunk, (j + parity[q]) % n, kTagRebuild, m_group);
+                }
+                continue;
+            }
+            if (rebuilt) {
+                continue;
+            }
+            int t = (m_index - j - k + 2 * n) % n;
+            if (t < n - k) {
+                post(reqs, true, m_data.data() + t * m_chunk, m_chunk,
+                        dest, kTagRebuild, m_group);
+            }
+            int q = (m_index - j + n) % n;
+            if (std::find(parity.begin(), parity.end(), q) != parity.end()) {
+                post(reqs, true, m_code.data() + q * m_chunk, m_chunk,
+                        dest, kTagRebuild, m_group);
+            }
+        }
+        MPI_Waitall(reqs.size(), reqs.data(), MPI_STATUSES_IGNORE);
+        if (self < 0) {
+            continue;
+        }
+
+        // remove known chunks from parity, then invert the lost part
+        std::vector<uint8_t> m(a * a);
+        for (int q = 0; q < a; q++) {
+            char* code = buf.data() + (n - k + q) * m_chunk;
+            for (int t = 0; t < n - k; t++) {
+                if (!lost[(j + k + t) % n]) {
+                    gf_mul_add(code, buf.data() + t * m_chunk,
+                            coef_(parity[q], t), m_chunk);
+                }
+            }
+            for (int c = 0; c < a; c++) {
+                m[q * a + c] = coef_(parity[q], missing[c]);
+            }
+        }
+        if (!gf_invert(m, a)) {
+            // the other stripes are still served to the other members
+            ok = false;
+            continue;
+        }
+        char* out = m_data.data() + missing[self] * m_chunk;
+        for (int q = 0; q < a; q++) {
+            gf_mul_add(out, buf.data() + (n - k + q) * m_chunk,
+                    m[self * a + q], m_chunk);
+        }
+    }
+    return ok;
+}
+
+uint8_t CkptErasure::coef_(int p, int t) const {
+    // XOR for a single parity, Cauchy matrix otherwise
+    // as every square submatrix of it is invertible
+    if (m_parity == 1) {
+        return 1;
+    }
+    return gf_inv(p ^ (m_parity + t));
+}
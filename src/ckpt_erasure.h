@@ -0,0 +1,146 @@
+/**
+Copyright 2021 PIDL(Petabyte-scale In-memory Database Lab) http://kdb.snu.ac.kr
+This work was supported by Next-Generation Information Computing Development
+Program through the National Research Foundation of Korea(NRF)
+funded by the Ministry of Science, ICT (NRF-2016M3C4A7952587)
+Author: Ilju Lee, Jongin Kim, Hyerim Jeon, Youngjune Park
+Contact: sdmt@kdb.snu.ac.kr
+ */
+
+#ifndef CKPT_ERASURE_H_
+#define CKPT_ERASURE_H_
+
+#include "ckpt_ring.h"
+
+#include <cstdint>
+#include <vector>
+#include <mpi.h>
+
+/**
+ * @brief in-memory checkpoints protected by erasure codes over rank groups
+ * @details ranks are split into groups of about the given size, members of
+ *  a group are ranks far apart so that they are likely on different nodes.
+ *  in a group of n ranks with k parity, every rank keeps its own Snapshots
+ *  split into n-k chunks and k parity chunks of others, laid out in
+ *  rotated stripes as RAID does. any k ranks of a group can be lost.<p>
+ *  with one parity the code is XOR, otherwise a Cauchy Reed-Solomon code
+ *  over GF(2^8) computed with SIMD table lookups. encoding is pipelined,
+ *  the next block is in flight while the current one is encoded.<p>
+ *  encode() and decode() are collective over the communicator
+ */
+class CkptErasure
+{
+  public:
+    /**
+     * @brief create an empty CkptErasure
+     */
+    CkptErasure();
+
+    /**
+     * @brief release the group communicator
+     */
+    ~CkptErasure();
+
+    /**
+     * @brief keep regions and encode parity of the group
+     * @param comm communicator, the same at every call
+     * @param regions regions to save
+     * @param group number of ranks in a group
+     * @param parity number of parity chunks in a stripe, lost ranks tolerated
+     * @param iter iteration sequence at checkpoint
+     * @return false if a group is smaller than parity + 1
+     *  or larger than 256
+     */
+    bool encode(MPI_Comm comm,
+            const std::vector<CkptRing::Region>& regions,
+            int group,
+            int parity,
+            int32_t iter);
+
+    /**
+     * @brief restore regions, rebuilding those of lost ranks
+     * @details a rank is lost if it does not hold a checkpoint encoded
+     *  with the same group and parity. rebuilt ranks hold no parity,
+     *  so the next encode() is needed to protect them again
+     * @param comm communicator, the same at every call
+     * @param regions regions to load, same as saved
+     * @param group number of ranks in a group
+     * @param parity number of parity chunks in a stripe
+     * @param iter [out] iteration sequence at checkpoint
+     * @return false if more ranks than parity are lost in any group
+     *  or the checkpoint of any rank does not match the regions
+     */
+    bool decode(MPI_Comm comm,
+            const std::vector<CkptRing::Region>& regions,
+            int group,
+            int parity,
+            int32_t& iter);
+
+    /**
+     * @brief drop the checkpoint of this rank, as a lost rank does
+     */
+    void clear();
+
+  private:
+    /**
+     * @brief split ranks into groups
+     * @param comm communicator
+     * @param group number of ranks in a group
+     * @param parity number of parity chunks in a stripe
+     */
+    void setup_(MPI_Comm comm, int group, int parity);
+
+    /**
+     * @brief post sends and receives of a block of every stripe
+     * @param offset byte offset of the block in a chunk
+     * @param size byte size of the block
+     * @param recv receive buffer of the block
+     * @param reqs [out] requests of posted messages
+     */
+    void post_(size_t offset, size_t size, char* recv,
+            std::vector<MPI_Request>& reqs);
+
+    /**
+     * @brief rebuild chunks of lost ranks stripe by stripe
+     * @param lost whether each member of the group is lost
+     * @return false if a system of a stripe cannot be solved
+     */
+    bool rebuild_(const std::vector<int>& lost);
+
+    /**
+     * @brief get the coefficient of a data chunk in a parity chunk
+     * @param p index of parity in a stripe
+     * @param t index of data chunk in a stripe
+     * @return coefficient in GF(2^8)
+     */
+    uint8_t coef_(int p, int t) const;
+
+    /** @brief communicator of the group */
+    MPI_Comm m_group;
+
+    /** @brief number of ranks in a group, as configured */
+    int m_config;
+
+    /** @brief index of this rank in the group */
+    int m_index;
+
+    /** @brief number of ranks in the group */
+    int m_size;
+
+    /** @brief number of parity chunks in a stripe */
+    int m_parity;
+
+    /** @brief byte size of a chunk */
+    size_t m_chunk;
+
+    /** @brief packed Snapshots of this rank, split into chunks */
+    std::vector<char> m_data;
+
+    /** @brief parity chunks kept by this rank */
+    std::vector<char> m_code;
+
+    /** @brief whether this rank holds an encoded checkpoint */
+    bool m_valid;
+};
+
+#endif  // CKPT_ERASURE_H_
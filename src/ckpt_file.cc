@@ -0,0 +1,339 @@
+/**
+Copyright 2021 PIDL(Petabyte-scale In-memory Database Lab) http://kdb.snu.ac.kr
+This work was supported by Next-Generation Information Computing Development
+Program through the National Research Foundation of Korea(NRF)
+funded by the Ministry of Science, ICT (NRF-2016M3C4A7952587)
+Author: Ilju Lee, Jongin Kim, Hyerim Jeon, Youngjune Park
+Contact: sdmt@kdb.snu.ac.kr
+ */
+
+#include "ckpt_file.h"
+#include "serialization.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <set>
+#include <sstream>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+/** @brief magic number at the beginning of a checkpoint file */
+const char kMagic[8] = {'S', 'D', 'M', 'T', 'C', 'K', 'P', 'T'};
+
+/** @brief byte size of magic number and index size */
+const uint64_t kPreamble = sizeof(kMagic) + sizeof(uint64_t);
+
+/** @brief lock of pinned checkpoints, held while pruning */
+std::mutex g_pin_mutex;
+
+/** @brief pin counts of checkpoint files by path */
+std::map<std::string, int> g_pinned;
+
+void write_index(std::ostream& os,
+            const CkptFile::Header& header,
+            std::vector<CkptFile::Record>& records) {
+    CkptFile::Header h = header;
+    serialize::write(os, h.m_id);
+    serialize::write(os, h.m_level);
+    serialize::write(os, h.m_iter);
+    serialize::write(os, h.m_rank);
+    serialize::write(os, h.m_time);
+
+    uint32_t count = records.size();
+    serialize::write(os, count);
+    for (auto& r : records) {
+        serialize::write(os, r.m_name);
+        serialize::write(os, r.m_id);
+        serialize::write(os, r.m_valuetype);
+        serialize::write(os, r.m_encoding);
+        serialize::write(os, r.m_base);
+        serialize::write(os, r.m_codec);
+        serialize::write(os, r.m_rawsize);
+        serialize::write(os, r.m_size);
+        serialize::write(os, r.m_offset);
+    }
+}
+
+bool read_index(std::istream& is,
+            CkptFile::Header& header,
+            std::vector<CkptFile::Record>& records) {
+    char magic[sizeof(kMagic)];
+    uint64_t isize = 0;
+    is.read(magic, sizeof(magic));
+    is.read(reinterpret_cast<char*>(&isize), sizeof(isize));
+    if (!is.good() || !std::equal(magic, magic + sizeof(magic), kMagic)) {
+        return false;
+    }
+
+    serialize::read(is, header.m_id);
+    serialize::read(is, header.m_level);
+    serialize::read(is, header.m_iter);
+    serialize::read(is, header.m_rank);
+    serialize::read(is, header.m_time);
+
+    uint32_t count = 0;
+    serialize::read(is, count);
+    records.clear();
+    records.resize(count);
+    for (auto& r : records) {
+        serialize::read(is, r.m_name);
+        serialize::read(is, r.m_id);
+        serialize::read(is, r.m_valuetype);
+        serialize::read(is, r.m_encoding);
+        serialize::read(is, r.m_base);
+        serialize::read(is, r.m_codec);
+        serialize::read(is, r.m_rawsize);
+        serialize::read(is, r.m_size);
+        serialize::read(is, r.m_offset);
+    }
+
+    return is.good();
+}
+
+bool write_all(int fd, const void* buf, size_t size) {
+    const char* p = reinterpret_cast<const char*>(buf);
+    while (size > 0) {
+        ssize_t n = ::write(fd, p, size);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        p += n;
+        size -= n;
+    }
+    return true;
+}
+
+bool read_all(int fd, void* buf, size_t size, uint64_t offset) {
+    char* p = reinterpret_cast<char*>(buf);
+    while (size > 0) {
+        ssize_t n = ::pread(fd, p, size, offset);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        } else if (n == 0) {
+            return false;
+        }
+        p += n;
+        size -= n;
+        offset += n;
+    }
+    return true;
+}
+
+}  // namespace
+
+std::string CkptFile::path(const std::string& dir, int id, int rank) {
+    return dir + "/Ckpt" + std::to_string(id)
+        + "-Rank" + std::to_string(rank) + ".sdmt";
+}
+
+bool CkptFile::make_dir(const std::string& dir) {
+    if (dir.empty()) {
+        return false;
+    }
+
+    // create parents first
+    for (size_t pos = dir.find('/', 1); pos != std::string::npos;
+            pos = dir.find('/', pos + 1)) {
+        ::mkdir(dir.substr(0, pos).c_str(), 0755);
+    }
+    ::mkdir(dir.c_str(), 0755);
+
+    struct stat st;
+    return ::stat(dir.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+uint64_t CkptFile::layout(const Header& header,
+                std::vector<Record>& records,
+                std::string& head,
+                uint64_t align) {
+    // the index has fixed size fields only,
+    // so its size does not depend on the offsets stored in it
+    std::ostringstream probe;
+    write_index(probe, header, records);
+    uint64_t isize = probe.str().size();
+
+    uint64_t offset = kPreamble + isize;
+    for (auto& r : records) {
+        offset = (offset + align - 1) / align * align;
+        r.m_offset = offset;
+        offset += r.m_size;
+    }
+
+    std::ostringstream index;
+    index.write(kMagic, sizeof(kMagic));
+    index.write(reinterpret_cast<const char*>(&isize), sizeof(isize));
+    write_index(index, header, records);
+    head = index.str();
+    return offset;
+}
+
+bool CkptFile::parse(const char* buf,
+                size_t size,
+                Header& header,
+                std::vector<Record>& records) {
+    std::istringstream is(std::string(buf, size));
+    if (!::read_index(is, header, records)) {
+        return false;
+    }
+    for (auto& r : records) {
+        if (r.m_offset > size || r.m_size > size - r.m_offset) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool CkptFile::write(const std::string& path,
+                const Header& header,
+                std::vector<Record>& records) {
+    std::string head;
+    layout(header, records, head);
+
+    // write to temporary file, then publish it by rename
+    std::string tmp = path + ".tmp";
+    int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+
+    bool ok = write_all(fd, head.data(), head.size());
+    for (auto& r : records) {
+        if (!ok) break;
+        ok = write_all(fd, r.m_data, r.m_size);
+    }
+    ok = ok && ::fsync(fd) == 0;
+    ok = (::close(fd) == 0) && ok;
+
+    if (!ok || ::rename(tmp.c_str(), path.c_str()) != 0) {
+        ::unlink(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool CkptFile::read_index(const std::string& path,
+                Header& header,
+                std::vector<Record>& records) {
+    return read_index(path, 0, header, records);
+}
+
+bool CkptFile::read_index(const std::string& path,
+                uint64_t offset,
+                Header& header,
+                std::vector<Record>& records) {
+    std::ifstream is(path, std::ios::in | std::ios::binary);
+    if (!is.good() || !is.seekg(offset).good()) {
+        return false;
+    }
+    return ::read_index(is, header, records);
+}
+
+bool CkptFile::read_payload(const std::string& path,
+                const Record& record,
+                void* buf) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    bool ok = read_all(fd, buf, record.m_size, record.m_offset);
+    ::close(fd);
+    return ok;
+}
+
+std::vector<int> CkptFile::list(const std::string& dir, int rank) {
+    std::vector<int> ids;
+    DIR* d = ::opendir(dir.c_str());
+    if (d == nullptr) {
+        return ids;
+    }
+
+    struct dirent* e;
+    while ((e = ::readdir(d)) != nullptr) {
+        int id, r;
+        char tail[8] = {0};
+        // temporary files have ".sdmt.tmp" suffix and are skipped
+        if (std::sscanf(e->d_name, "Ckpt%d-Rank%d.%7s", &id, &r, tail) == 3
+                && r == rank && std::string(tail) == "sdmt") {
+            ids.push_back(id);
+        }
+    }
+    ::closedir(d);
+
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+int CkptFile::latest(const std::string& dir, int rank) {
+    std::vector<int> ids = list(dir, rank);
+    return ids.empty() ? -1 : ids.back();
+}
+
+bool CkptFile::remove(const std::string& dir, int id, int rank) {
+    return ::unlink(path(dir, id, rank).c_str()) == 0;
+}
+
+void CkptFile::pin(const std::string& dir, int id, int rank) {
+    std::unique_lock<std::mutex> lock(g_pin_mutex);
+    g_pinned[path(dir, id, rank)]++;
+}
+
+void CkptFile::unpin(const std::string& dir, int id, int rank) {
+    std::unique_lock<std::mutex> lock(g_pin_mutex);
+    auto itr = g_pinned.find(path(dir, id, rank));
+    if (itr != g_pinned.end() && --itr->second == 0) {
+        g_pinned.erase(itr);
+    }
+}
+
+void CkptFile::prune(const std::string& dir, int rank,
+                const Retention& retention) {
+    // a checkpoint is not pinned while it is decided to be deleted
+    std::unique_lock<std::mutex> lock(g_pin_mutex);
+    std::vector<int> ids = list(dir, rank);
+    int keep = std::max(retention.m_keep, 0);
+    if ((int)ids.size() <= keep) {
+        return;
+    }
+
+    // keep the newest checkpoints, milestones, pinned ones
+    // and every base of their deltas
+    std::set<int> needed(ids.end() - keep, ids.end());
+    for (auto id : ids) {
+        if (retention.milestone(id) || g_pinned.count(path(dir, id, rank))) {
+            needed.insert(id);
+        }
+    }
+    std::vector<int> todo(needed.begin(), needed.end());
+    while (!todo.empty()) {
+        int id = todo.back();
+        todo.pop_back();
+
+        Header header;
+        std::vector<Record> records;
+        if (!read_index(path(dir, id, rank), header, records)) {
+            continue;
+        }
+        for (auto& r : records) {
+            if (r.m_base >= 0 && needed.insert(r.m_base).second) {
+                todo.push_back(r.m_base);
+            }
+        }
+    }
+
+    for (auto id : ids) {
+        if (needed.count(id) == 0) {
+            remove(dir, id, rank);
+        }
+    }
+}
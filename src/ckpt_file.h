@@ -0,0 +1,291 @@
+/**
+Copyright 2021 PIDL(Petabyte-scale In-memory Database Lab) http://kdb.snu.ac.kr
+This work was supported by Next-Generation Information Computing Development
+Program through the National Research Foundation of Korea(NRF)
+funded by the Ministry of Science, ICT (NRF-2016M3C4A7952587)
+Author: Ilju Lee, Jongin Kim, Hyerim Jeon, Youngjune Park
+Contact: sdmt@kdb.snu.ac.kr
+ */
+
+#ifndef CKPT_FILE_H_
+#define CKPT_FILE_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief native checkpoint file written by SDMT itself(not by FTI)
+ * @details a file holds every Snapshot of a rank at one checkpoint id<p>
+ *  layout: [magic][index size][index][payload 0][payload 1]...<p>
+ *  a payload is a Snapshot image or a Delta, compressed by Codec if any<p>
+ *  files are written to a temporary path and renamed when complete,
+ *  so an existing file is always a complete checkpoint
+ */
+class CkptFile
+{
+  public:
+    /**
+     * @brief encoding of a Record payload
+     */
+    enum Encoding {
+        /** Snapshot memory as is */
+        ENC_FULL,
+        /** blocks changed since the base checkpoint, see Delta */
+        ENC_DELTA
+    };
+
+    /**
+     * @brief checkpoint-wide metadata
+     */
+    struct Header {
+        /**
+         * @brief create an empty Header
+         */
+        Header()
+            : m_id(-1),
+            m_level(0),
+            m_iter(0),
+            m_rank(0),
+            m_time(0) {}
+
+        /** @brief checkpoint id */
+        int32_t m_id;
+
+        /** @brief checkpoint level requested by application */
+        int32_t m_level;
+
+        /** @brief iteration sequence at checkpoint */
+        int32_t m_iter;
+
+        /** @brief rank which wrote the file */
+        int32_t m_rank;
+
+        /** @brief wall clock time of checkpoint(seconds since epoch) */
+        double m_time;
+    };
+
+    /**
+     * @brief a Snapshot stored in a checkpoint file
+     */
+    struct Record {
+        /**
+         * @brief create an empty Record
+         */
+        Record()
+            : m_id(-1),
+            m_valuetype(0),
+            m_encoding(ENC_FULL),
+            m_base(-1),
+            m_codec(0),
+            m_rawsize(0),
+            m_size(0),
+            m_offset(0),
+            m_data(nullptr) {}
+
+        /** @brief name of Snapshot */
+        std::string m_name;
+
+        /** @brief id of Snapshot */
+        int32_t m_id;
+
+        /** @brief value type of Snapshot */
+        int32_t m_valuetype;
+
+        /** @brief encoding of payload */
+        int32_t m_encoding;
+
+        /** @brief checkpoint id a delta applies on, -1 if full */
+        int32_t m_base;
+
+        /** @brief compression codec of payload, see Codec */
+        int32_t m_codec;
+
+        /** @brief byte size of Snapshot in memory */
+        uint64_t m_rawsize;
+
+        /** @brief byte size of payload in file */
+        uint64_t m_size;
+
+        /** @brief file offset of payload, assigned on write */
+        uint64_t m_offset;
+
+        /** @brief payload to write, not stored in file */
+        const void* m_data;
+    };
+
+    /**
+     * @brief which checkpoints survive when older ones are deleted
+     */
+    struct Retention {
+        /**
+         * @brief create a Retention
+         * @param keep number of newest checkpoints to keep
+         * @param every ids which are multiples of it are kept, 0 for none
+         */
+        Retention(int keep = 0, int every = 0)
+            : m_keep(keep),
+            m_every(every) {}
+
+        /**
+         * @brief check whether a checkpoint is kept regardless of its age
+         * @param id checkpoint id
+         * @return true if kept
+         */
+        bool milestone(int id) const
+        { return m_every > 0 && id % m_every == 0; }
+
+        /** @brief number of newest checkpoints to keep */
+        int m_keep;
+
+        /** @brief every checkpoint whose id is a multiple of it is kept,
+         *  0 for none */
+        int m_every;
+    };
+
+    /**
+     * @brief path of a checkpoint file
+     * @param dir checkpoint directory
+     * @param id checkpoint id
+     * @param rank MPI rank
+     * @return path of the file
+     */
+    static std::string path(const std::string& dir, int id, int rank);
+
+    /**
+     * @brief create a directory and its parents
+     * @param dir path of directory
+     * @return true if directory exists after call
+     */
+    static bool make_dir(const std::string& dir);
+
+    /**
+     * @brief write a checkpoint file atomically
+     * @param path path of the file
+     * @param header checkpoint metadata
+     * @param records Snapshots to write, offsets are assigned
+     * @return true if success
+     */
+    static bool write(const std::string& path,
+                    const Header& header,
+                    std::vector<Record>& records);
+
+    /**
+     * @brief lay out a checkpoint image in memory
+     * @details the image is the same as a checkpoint file,
+     *  payloads follow the head at the assigned offsets
+     * @param header checkpoint metadata
+     * @param records Snapshots to write, offsets are assigned
+     * @param head [out] magic, index size and index
+     * @param align payload offsets are multiples of align,
+     *  the gaps are padding
+     * @return byte size of the whole image
+     */
+    static uint64_t layout(const Header& header,
+                    std::vector<Record>& records,
+                    std::string& head,
+                    uint64_t align = 1);
+
+    /**
+     * @brief read metadata of a checkpoint image in memory
+     * @param buf beginning of the image
+     * @param size byte size of buf
+     * @param header [out] checkpoint metadata
+     * @param records [out] Snapshots in the image, without payload
+     * @return true if success
+     */
+    static bool parse(const char* buf,
+                    size_t size,
+                    Header& header,
+                    std::vector<Record>& records);
+
+    /**
+     * @brief read metadata of a checkpoint file
+     * @param path path of the file
+     * @param header [out] checkpoint metadata
+     * @param records [out] Snapshots in the file, without payload
+     * @return true if success
+     */
+    static bool read_index(const std::string& path,
+                    Header& header,
+                    std::vector<Record>& records);
+
+    /**
+     * @brief read header and index of an image embedded in a file
+     * @param path path of the file
+     * @param offset byte offset of the image in the file
+     * @param header [out] checkpoint metadata
+     * @param records [out] Records, offsets relative to the image
+     * @return true if success
+     */
+    static bool read_index(const std::string& path,
+                    uint64_t offset,
+                    Header& header,
+                    std::vector<Record>& records);
+
+    /**
+     * @brief read payload of a Record
+     * @param path path of the file
+     * @param record Record from read_index
+     * @param buf destination, at least record.m_size bytes
+     * @return true if success
+     */
+    static bool read_payload(const std::string& path,
+                    const Record& record,
+                    void* buf);
+
+    /**
+     * @brief list ids of complete checkpoint files of a rank
+     * @param dir checkpoint directory
+     * @param rank MPI rank
+     * @return ascending checkpoint ids
+     */
+    static std::vector<int> list(const std::string& dir, int rank);
+
+    /**
+     * @brief get the newest complete checkpoint id of a rank
+     * @param dir checkpoint directory
+     * @param rank MPI rank
+     * @return checkpoint id, -1 if none
+     */
+    static int latest(const std::string& dir, int rank);
+
+    /**
+     * @brief delete a checkpoint file
+     * @param dir checkpoint directory
+     * @param id checkpoint id
+     * @param rank MPI rank
+     * @return true if success
+     */
+    static bool remove(const std::string& dir, int id, int rank);
+
+    /**
+     * @brief keep a checkpoint file from being pruned
+     * @details thread safe, pins are counted
+     * @param dir checkpoint directory
+     * @param id checkpoint id
+     * @param rank MPI rank
+     */
+    static void pin(const std::string& dir, int id, int rank);
+
+    /**
+     * @brief release a pin of a checkpoint file
+     * @param dir checkpoint directory
+     * @param id checkpoint id
+     * @param rank MPI rank
+     */
+    static void unpin(const std::string& dir, int id, int rank);
+
+    /**
+     * @brief delete old checkpoint files of a rank
+     * @details pinned checkpoints and bases of the kept checkpoints are
+     *  kept as well. thread safe
+     * @param dir checkpoint directory
+     * @param rank MPI rank
+     * @param retention checkpoints to keep
+     */
+    static void prune(const std::string& dir, int rank,
+                    const Retention& retention);
+};
+
+#endif  // CKPT_FILE_H_
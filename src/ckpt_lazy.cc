@@ -0,0 +1,256 @@
+/**
+Copyright 2021 PIDL(Petabyte-scale In-memory Database Lab) http://kdb.snu.ac.kr
+This work was supported by Next-Generation Information Computing Development
+Program through the National Research Foundation of Korea(NRF)
+funded by the Ministry of Science, ICT (NRF-2016M3C4A7952587)
+Author: Ilju Lee, Jongin Kim, Hyerim Jeon, Youngjune Park
+Contact: sdmt@kdb.snu.ac.kr
+ */
+
+#include "ckpt_lazy.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/userfaultfd.h>)
+#include <linux/userfaultfd.h>
+#include <sys/syscall.h>
+#define SDMT_HAVE_USERFAULTFD
+#endif
+#endif
+
+namespace {
+
+/** @brief number of pages populated at a page fault */
+const size_t kFaultPages = 16;
+
+/** @brief byte size prefetched between checks for page faults */
+const size_t kPrefetch = 1 << 20;
+
+bool pread_all(int fd, char* p, size_t size, uint64_t offset) {
+    while (size > 0) {
+        ssize_t n = ::pread(fd, p, size, offset);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        } else if (n == 0) {
+            return false;
+        }
+        p += n;
+        size -= n;
+        offset += n;
+    }
+    return true;
+}
+
+}  // namespace
+
+CkptLazy::CkptLazy()
+    : m_uffd(-1),
+    m_fd(-1),
+    m_page(::sysconf(_SC_PAGESIZE)),
+    m_cursor(0),
+    m_failed(false) {}
+
+CkptLazy::~CkptLazy() {
+    wait();
+}
+
+bool CkptLazy::open(const std::string& path) {
+    wait();
+#ifdef SDMT_HAVE_USERFAULTFD
+    m_fd = ::open(path.c_str(), O_RDONLY);
+    if (m_fd < 0) {
+        return false;
+    }
+    m_uffd = ::syscall(SYS_userfaultfd, O_CLOEXEC | O_NONBLOCK);
+    struct uffdio_api api;
+    std::memset(&api, 0, sizeof(api));
+    api.api = UFFD_API;
+    if (m_uffd < 0 || ::ioctl(m_uffd, UFFDIO_API, &api) != 0) {
+        close_();
+        return false;
+    }
+    m_failed = false;
+    return true;
+#else
+    (void)path;
+    return false;
+#endif
+}
+
+bool CkptLazy::add(void* ptr, size_t size, uint64_t offset) {
+#ifdef SDMT_HAVE_USERFAULTFD
+    if (m_uffd < 0 || m_thread.joinable() || size == 0
+            || reinterpret_cast<uintptr_t>(ptr) % m_page != 0) {
+        return false;
+    }
+    Region region;
+    region.m_ptr = reinterpret_cast<char*>(ptr);
+    region.m_size = size;
+    region.m_span = (size + m_page - 1) / m_page * m_page;
+    region.m_offset = offset;
+    region.m_next = 0;
+
+    // pages populated so far would not fault
+    if (::madvise(region.m_ptr, region.m_span, MADV_DONTNEED) != 0) {
+        return false;
+    }
+    struct uffdio_register reg;
+    std::memset(&reg, 0, sizeof(reg));
+    reg.range.start = reinterpret_cast<uintptr_t>(region.m_ptr);
+    reg.range.len = region.m_span;
+    reg.mode = UFFDIO_REGISTER_MODE_MISSING;
+    if (::ioctl(m_uffd, UFFDIO_REGISTER, &reg) != 0) {
+        return false;
+    }
+    m_regions.push_back(region);
+    return true;
+#else
+    (void)ptr;
+    (void)size;
+    (void)offset;
+    return false;
+#endif
+}
+
+void CkptLazy::start() {
+    if (m_uffd < 0 || m_thread.joinable()) {
+        return;
+    }
+    m_cursor = 0;
+    m_thread = std::thread(&CkptLazy::run_, this);
+}
+
+bool CkptLazy::wait() {
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+    close_();
+    bool ok = !m_failed;
+    m_failed = false;
+    return ok;
+}
+
+void CkptLazy::run_() {
+    while (m_cursor < m_regions.size()) {
+        // faults block the application, prefetch only while there are none
+        struct pollfd p;
+        p.fd = m_uffd;
+        p.events = POLLIN;
+        if (::poll(&p, 1, 0) > 0 && serve_()) {
+            continue;
+        }
+        prefetch_();
+    }
+}
+
+bool CkptLazy::serve_() {
+#ifdef SDMT_HAVE_USERFAULTFD
+    struct uffd_msg msgs[16];
+    ssize_t n = ::read(m_uffd, msgs, sizeof(msgs));
+    if (n <= 0) {
+        return false;
+    }
+    for (size_t i = 0; i < n / sizeof(struct uffd_msg); i++) {
+        if (msgs[i].event != UFFD_EVENT_PAGEFAULT) {
+            continue;
+        }
+        uint64_t addr = msgs[i].arg.pagefault.address / m_page * m_page;
+        for (auto& region : m_regions) {
+            uint64_t base = reinterpret_cast<uintptr_t>(region.m_ptr);
+            if (addr < base || addr >= base + region.m_span) {
+                continue;
+            }
+            // accesses are likely sequential, read a few pages ahead
+            size_t begin = addr - base;
+            fill_(region, begin,
+                    std::min(kFaultPages * m_page, region.m_span - begin));
+            break;
+        }
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+void CkptLazy::prefetch_() {
+    Region& region = m_regions[m_cursor];
+    size_t size = std::min(kPrefetch, region.m_span - region.m_next);
+    fill_(region, region.m_next, size);
+    region.m_next += size;
+    if (region.m_next == region.m_span) {
+        m_cursor++;
+    }
+}
+
+void CkptLazy::fill_(Region& region, size_t begin, size_t size) {
+#ifdef SDMT_HAVE_USERFAULTFD
+    // the tail of the last page is not in the image
+    m_buf.resize(std::max(m_buf.size(), size));
+    size_t bytes = std::min(size, region.m_size - begin);
+    std::memset(m_buf.data() + bytes, 0, size - bytes);
+    if (!pread_all(m_fd, m_buf.data(), bytes, region.m_offset + begin)) {
+        // the page is populated anyway, or the application would hang
+        std::memset(m_buf.data(), 0, bytes);
+        m_failed = true;
+    }
+
+    size_t done = 0;
+    while (done < size) {
+        struct uffdio_copy copy;
+        copy.dst = reinterpret_cast<uintptr_t>(region.m_ptr + begin + done);
+        copy.src = reinterpret_cast<uintptr_t>(m_buf.data() + done);
+        copy.len = size - done;
+        copy.mode = 0;
+        copy.copy = 0;
+        if (::ioctl(m_uffd, UFFDIO_COPY, &copy) == 0) {
+            break;
+        }
+        if (copy.copy > 0) {
+            done += copy.copy;
+        }
+        if (errno == EAGAIN) {
+            continue;
+        }
+        // a page populated by an earlier fault is skipped
+        if (errno != EEXIST) {
+            m_failed = true;
+        }
+        done += m_page;
+    }
+#else
+    (void)region;
+    (void)begin;
+    (void)size;
+#endif
+}
+
+void CkptLazy::close_() {
+#ifdef SDMT_HAVE_USERFAULTFD
+    for (auto& region : m_regions) {
+        struct uffdio_range range;
+        range.start = reinterpret_cast<uintptr_t>(region.m_ptr);
+        range.len = region.m_span;
+        ::ioctl(m_uffd, UFFDIO_UNREGISTER, &range);
+    }
+#endif
+    m_regions.clear();
+    if (m_uffd >= 0) {
+        ::close(m_uffd);
+        m_uffd = -1;
+    }
+    if (m_fd >= 0) {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+}
@@ -0,0 +1,150 @@
+/**
+Copyright 2021 PIDL(Petabyte-scale In-memory Database Lab) http://kdb.snu.ac.kr
+This work was supported by Next-Generation Information Computing Development
+Program through the National Research Foundation of Korea(NRF)
+funded by the Ministry of Science, ICT (NRF-2016M3C4A7952587)
+Author: Ilju Lee, Jongin Kim, Hyerim Jeon, Youngjune Park
+Contact: sdmt@kdb.snu.ac.kr
+ */
+
+#ifndef CKPT_LAZY_H_
+#define CKPT_LAZY_H_
+
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief on-demand recovery of Snapshots from a native checkpoint file
+ * @details Snapshot memory is registered to userfaultfd and left unpopulated,
+ *  its pages are read from the checkpoint file when first accessed.
+ *  a thread serves page faults and, while there are none, prefetches the
+ *  remaining pages in order, so every page is populated in the end.<p>
+ *  only raw images can be faulted in. registered memory has to be page
+ *  aligned, owned up to the end of its last page, and must not be freed
+ *  or inherited by a forked process before wait()
+ */
+class CkptLazy
+{
+  public:
+    /**
+     * @brief create an idle CkptLazy
+     */
+    CkptLazy();
+
+    /**
+     * @brief finish recovery in progress
+     */
+    ~CkptLazy();
+
+    /**
+     * @brief open a checkpoint file to fault pages in from
+     * @param path path of the native checkpoint file
+     * @return false if the file or userfaultfd is not available
+     */
+    bool open(const std::string& path);
+
+    /**
+     * @brief register memory to fault in, call between open() and start()
+     * @param ptr page aligned memory, left unpopulated
+     * @param size byte size of the image
+     * @param offset byte offset of the image in the file
+     * @return false if the memory cannot be registered,
+     *  it has to be restored otherwise
+     */
+    bool add(void* ptr, size_t size, uint64_t offset);
+
+    /**
+     * @brief start serving page faults and prefetching
+     */
+    void start();
+
+    /**
+     * @brief block until every page is populated and release the file
+     * @return false if a page could not be read
+     */
+    bool wait();
+
+    /**
+     * @brief check whether registered memory is not fully populated yet
+     * @return true if open
+     */
+    bool active() const { return m_uffd >= 0; }
+
+  private:
+    /**
+     * @brief memory registered to fault in
+     */
+    struct Region {
+        /** @brief page aligned memory */
+        char* m_ptr;
+
+        /** @brief byte size of the image */
+        size_t m_size;
+
+        /** @brief byte size of registered pages */
+        size_t m_span;
+
+        /** @brief byte offset of the image in the file */
+        uint64_t m_offset;
+
+        /** @brief byte offset in memory of the next page to prefetch */
+        size_t m_next;
+    };
+
+    /**
+     * @brief main loop of the thread, exits when every page is populated
+     */
+    void run_();
+
+    /**
+     * @brief populate pages of pending page faults
+     * @return false if no page fault is pending
+     */
+    bool serve_();
+
+    /**
+     * @brief populate the next pages not accessed yet
+     */
+    void prefetch_();
+
+    /**
+     * @brief read pages from the file and populate those still missing
+     * @param region registered memory
+     * @param begin page aligned byte offset in memory
+     * @param size byte size, a multiple of pages
+     */
+    void fill_(Region& region, size_t begin, size_t size);
+
+    /**
+     * @brief release userfaultfd and the file
+     */
+    void close_();
+
+    /** @brief userfaultfd, -1 if idle */
+    int m_uffd;
+
+    /** @brief checkpoint file */
+    int m_fd;
+
+    /** @brief byte size of a page */
+    size_t m_page;
+
+    /** @brief registered memory */
+    std::vector<Region> m_regions;
+
+    /** @brief index of the Region being prefetched */
+    size_t m_cursor;
+
+    /** @brief pages read from the file */
+    std::vector<char> m_buf;
+
+    /** @brief true if a page could not be read */
+    bool m_failed;
+
+    /** @brief fault handling thread */
+    std::thread m_thread;
+};
+
+#endif  // CKPT_LAZY_H_
@@ -0,0 +1,255 @@
+/**
+Copyright 2021 PIDL(Petabyte-scale In-memory Database Lab) http://kdb.snu.ac.kr
+This work was supported by Next-Generation Information Computing Development
+Program through the National Research Foundation of Korea(NRF)
+funded by the Ministry of Science, ICT (NRF-2016M3C4A7952587)
+Author: Ilju Lee, Jongin Kim, Hyerim Jeon, Youngjune Park
+Contact: sdmt@kdb.snu.ac.kr
+ */
+
+#include "ckpt_partner.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+/** @brief message tag of buffer sizes */
+const int kTagSize = 21000;
+
+/** @brief message tag of buffer data */
+const int kTagData = 21001;
+
+/** @brief largest message, MPI counts are int */
+const size_t kMaxMessage = 1 << 30;
+
+/**
+ * @brief header of packed Snapshots: [iter][count]
+ *  followed by [id][size][data] of each Snapshot
+ */
+const size_t kHeader = sizeof(int32_t) + sizeof(uint32_t);
+
+const size_t kEntry = sizeof(int32_t) + sizeof(uint64_t);
+
+template<typename T>
+void put(char*& p, T v) {
+    std::memcpy(p, &v, sizeof(v));
+    p += sizeof(v);
+}
+
+template<typename T>
+T get(const char*& p) {
+    T v;
+    std::memcpy(&v, p, sizeof(v));
+    p += sizeof(v);
+    return v;
+}
+
+void post(std::vector<MPI_Request>& reqs, bool send, char* buf, size_t size,
+        int rank, MPI_Comm comm) {
+    for (size_t off = 0; off < size; off += kMaxMessage) {
+        int n = std::min(kMaxMessage, size - off);
+        MPI_Request req;
+        if (send) {
+            MPI_Isend(buf + off, n, MPI_BYTE, rank, kTagData, comm, &req);
+        } else {
+            MPI_Irecv(buf + off, n, MPI_BYTE, rank, kTagData, comm, &req);
+        }
+        reqs.push_back(req);
+    }
+}
+
+/**
+ * @brief check packed Snapshots match the regions
+ * @param buf packed Snapshots
+ * @param regions regions to load
+ * @param data [out] data of each region in buf
+ * @param iter [out] iteration sequence at checkpoint
+ * @return true if buf holds every region with its size
+ */
+bool parse(const std::vector<char>& buf,
+        const std::vector<CkptRing::Region>& regions,
+        std::vector<const char*>& data, int32_t& iter) {
+    const char* p = buf.data();
+    const char* end = buf.data() + buf.size();
+    if (buf.size() < kHeader) {
+        return false;
+    }
+    iter = get<int32_t>(p);
+    if (get<uint32_t>(p) != regions.size()) {
+        return false;
+    }
+    data.clear();
+    for (auto& r : regions) {
+        if (size_t(end - p) < kEntry || get<int32_t>(p) != r.m_id
+                || get<uint64_t>(p) != r.m_size
+                || size_t(end - p) < r.m_size) {
+            return false;
+        }
+        data.push_back(p);
+        p += r.m_size;
+    }
+    return true;
+}
+
+}  // namespace
+
+CkptPartner::CkptPartner()
+    : m_rank(0),
+    m_partner(-1) {}
+
+bool CkptPartner::save(MPI_Comm comm,
+        const std::vector<CkptRing::Region>& regions,
+        int32_t iter) {
+    // a replaced process has no partner yet, and the others find theirs
+    // again with it
+    int fresh = m_partner < 0;
+    int any = 0;
+    MPI_Allreduce(&fresh, &any, 1, MPI_INT, MPI_MAX, comm);
+    if (any) {
+        setup_(comm);
+    }
+
+    size_t size = kHeader;
+    for (auto& r : regions) {
+        size += kEntry + r.m_size;
+    }
+    m_send.resize(size);
+    char* p = m_send.data();
+    put<int32_t>(p, iter);
+    put<uint32_t>(p, regions.size());
+    for (auto& r : regions) {
+        put<int32_t>(p, r.m_id);
+        put<uint64_t>(p, r.m_size);
+        std::memcpy(p, r.m_ptr, r.m_size);
+        p += r.m_size;
+    }
+
+    std::vector<const std::vector<char>*> sends(1, &m_send);
+    std::vector<std::vector<char>*> recvs;
+    for (int s : m_sources) {
+        recvs.push_back(&m_copies[s]);
+    }
+    exchange_(comm, std::vector<int>(1, m_partner), sends, m_sources, recvs);
+    return true;
+}
+
+bool CkptPartner::load(MPI_Comm comm,
+        const std::vector<CkptRing::Region>& regions,
+        int32_t& iter) {
+    // on every rank, so a replaced process takes part and finds
+    // the same partner as before
+    setup_(comm);
+
+    // send copies back to their owners
+    std::vector<const std::vector<char>*> sends;
+    for (int s : m_sources) {
+        sends.push_back(&m_copies[s]);
+    }
+    std::vector<char> copy;
+    std::vector<std::vector<char>*> recvs(1, &copy);
+    exchange_(comm, m_sources, sends, std::vector<int>(1, m_partner), recvs);
+
+    // a replaced partner holds no copy, then the one kept since save()
+    // is used. every rank has to match before any region is touched
+    std::vector<const char*> data;
+    int32_t it = 0;
+    int mine = parse(copy, regions, data, it)
+        || parse(m_send, regions, data, it);
+    int every = 0;
+    MPI_Allreduce(&mine, &every, 1, MPI_INT, MPI_LAND, comm);
+    if (!every) {
+        return false;
+    }
+
+    for (size_t i = 0; i < regions.size(); i++) {
+        std::memcpy(regions[i].m_ptr, data[i], regions[i].m_size);
+    }
+    iter = it;
+    return true;
+}
+
+void CkptPartner::setup_(MPI_Comm comm) {
+    int size;
+    MPI_Comm_rank(comm, &m_rank);
+    MPI_Comm_size(comm, &size);
+
+    // ranks on the same node share a leader, the lowest rank of the node
+    MPI_Comm node;
+    MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, m_rank,
+            MPI_INFO_NULL, &node);
+    int leader = m_rank;
+    MPI_Bcast(&leader, 1, MPI_INT, 0, node);
+    MPI_Comm_free(&node);
+
+    std::vector<int> leaders(size);
+    MPI_Allgather(&leader, 1, MPI_INT, leaders.data(), 1, MPI_INT, comm);
+
+    // members of each node in rank order, nodes in leader order
+    std::map<int, std::vector<int>> nodes;
+    for (int r = 0; r < size; r++) {
+        nodes[leaders[r]].push_back(r);
+    }
+    std::vector<std::vector<int>> members;
+    std::map<int, int> index;
+    for (auto& n : nodes) {
+        index[n.first] = members.size();
+        members.push_back(n.second);
+    }
+
+    // partner of every rank, the same local index on the next node
+    auto partner_of = [&](int r) {
+        if (members.size() == 1) {
+            return (r + 1) % size;
+        }
+        int k = index[leaders[r]];
+        const std::vector<int>& mine = members[k];
+        int l = std::find(mine.begin(), mine.end(), r) - mine.begin();
+        const std::vector<int>& next = members[(k + 1) % members.size()];
+        return next[l % next.size()];
+    };
+
+    m_partner = partner_of(m_rank);
+    m_sources.clear();
+    for (int r = 0; r < size; r++) {
+        if (partner_of(r) == m_rank) {
+            m_sources.push_back(r);
+        }
+    }
+}
+
+void CkptPartner::exchange_(MPI_Comm comm,
+        const std::vector<int>& dests,
+        const std::vector<const std::vector<char>*>& sends,
+        const std::vector<int>& sources,
+        std::vector<std::vector<char>*>& recvs) {
+    // sizes first, so receivers can allocate
+    std::vector<uint64_t> ssizes(dests.size());
+    std::vector<uint64_t> rsizes(sources.size());
+    std::vector<MPI_Request> reqs;
+    for (size_t i = 0; i < sources.size(); i++) {
+        MPI_Request req;
+        MPI_Irecv(&rsizes[i], 1, MPI_UINT64_T, sources[i], kTagSize,
+                comm, &req);
+        reqs.push_back(req);
+    }
+    for (size_t i = 0; i < dests.size(); i++) {
+        MPI_Request req;
+        ssizes[i] = sends[i]->size();
+        MPI_Isend(&ssizes[i], 1, MPI_UINT64_T, dests[i], kTagSize,
+                comm, &req);
+        reqs.push_back(req);
+    }
+    MPI_Waitall(reqs.size(), reqs.data(), MPI_STATUSES_IGNORE);
+
+    reqs.clear();
+    for (size_t i = 0; i < sources.size(); i++) {
+        recvs[i]->resize(rsizes[i]);
+        post(reqs, false, recvs[i]->data(), rsizes[i], sources[i], comm);
+    }
+    for (size_t i = 0; i < dests.size(); i++) {
+        post(reqs, true, const_cast<char*>(sends[i]->data()),
+                sends[i]->size(), dests[i], comm);
+    }
+    MPI_Waitall(reqs.size(), reqs.data(), MPI_STATUSES_IGNORE);
+}
@@ -0,0 +1,108 @@
+/**
+Copyright 2021 PIDL(Petabyte-scale In-memory Database Lab) http://kdb.snu.ac.kr
+This work was supported by Next-Generation Information Computing Development
+Program through the National Research Foundation of Korea(NRF)
+funded by the Ministry of Science, ICT (NRF-2016M3C4A7952587)
+Author: Ilju Lee, Jongin Kim, Hyerim Jeon, Youngjune Park
+Contact: sdmt@kdb.snu.ac.kr
+ */
+
+#ifndef CKPT_PARTNER_H_
+#define CKPT_PARTNER_H_
+
+#include "ckpt_ring.h"
+
+#include <cstdint>
+#include <map>
+#include <vector>
+#include <mpi.h>
+
+/**
+ * @brief checkpoints replicated in the memory of a partner rank
+ * @details every rank sends its Snapshots to a partner rank
+ *  on the next node and keeps the copies it receives from others,
+ *  so a checkpoint survives the loss of one node without storage.<p>
+ *  the partner of a rank is the rank with the same node-local index on
+ *  the next node. on a single node the next rank is the partner.<p>
+ *  a rank keeps its own packed Snapshots too, so the ranks whose partner
+ *  was replaced load them instead.<p>
+ *  save() and load() are collective over the communicator
+ */
+class CkptPartner
+{
+  public:
+    /**
+     * @brief create an empty CkptPartner
+     */
+    CkptPartner();
+
+    /**
+     * @brief send regions to the partner, receive copies of others
+     * @param comm communicator, the same at every call
+     * @param regions regions to save
+     * @param iter iteration sequence at checkpoint
+     * @return true if success
+     */
+    bool save(MPI_Comm comm,
+            const std::vector<CkptRing::Region>& regions,
+            int32_t iter);
+
+    /**
+     * @brief get the copy of this rank back from the partner
+     * @param comm communicator, the same at every call
+     * @param regions regions to load, same as saved
+     * @param iter [out] iteration sequence at checkpoint
+     * @return false if any rank has no matching copy,
+     *  from the partner or of its own
+     */
+    bool load(MPI_Comm comm,
+            const std::vector<CkptRing::Region>& regions,
+            int32_t& iter);
+
+    /**
+     * @brief get the partner rank
+     * @return rank which keeps copies of this rank, -1 before save()
+     */
+    int partner() const { return m_partner; }
+
+  private:
+    /**
+     * @brief find the partner and the ranks this rank is a partner of
+     * @param comm communicator
+     */
+    void setup_(MPI_Comm comm);
+
+    /**
+     * @brief exchange buffers, sizes first then data
+     * @param comm communicator
+     * @param dests ranks to send to
+     * @param sends buffers to send, one for each dest
+     * @param sources ranks to receive from
+     * @param recvs [out] received buffers, one for each source
+     */
+    void exchange_(MPI_Comm comm,
+            const std::vector<int>& dests,
+            const std::vector<const std::vector<char>*>& sends,
+            const std::vector<int>& sources,
+            std::vector<std::vector<char>*>& recvs);
+
+    /** @brief rank of this process */
+    int m_rank;
+
+    /** @brief rank which keeps copies of this rank */
+    int m_partner;
+
+    /** @brief ranks whose copies this rank keeps */
+    std::vector<int> m_sources;
+
+    /**
+     * @brief packed Snapshots of this rank, reused by every save()
+     *  and loaded when the partner was replaced
+     */
+    std::vector<char> m_send;
+
+    /** @brief packed Snapshots of other ranks by rank */
+    std::map<int, std::vector<char>> m_copies;
+};
+
+#endif  // CKPT_PARTNER_H_
@@ -0,0 +1,140 @@
+/**
+Copyright 2021 PIDL(Petabyte-scale In-memory Database Lab) http://kdb.snu.ac.kr
+This work was supported by Next-Generation Information Computing Development
+Program through the National Research Foundation of Korea(NRF)
+funded by the Ministry of Science, ICT (NRF-2016M3C4A7952587)
+Author: Ilju Lee, Jongin Kim, Hyerim Jeon, Youngjune Park
+Contact: sdmt@kdb.snu.ac.kr
+ */
+
+#include "ckpt_redist.h"
+
+#include <algorithm>
+#include <cstring>
+
+int64_t CkptRedist::count(int64_t extent, int block, int ranks, int rank) {
+    if (block <= 0) {
+        int64_t size = (extent + ranks - 1) / ranks;
+        return std::max<int64_t>(0,
+                std::min(extent, (rank + 1) * size) - rank * size);
+    }
+    // whole rounds of blocks, then the rest of the last round
+    int64_t round = (int64_t)block * ranks;
+    int64_t n = extent / round * block;
+    int64_t rest = extent % round - (int64_t)rank * block;
+    return n + std::max<int64_t>(0, std::min<int64_t>(block, rest));
+}
+
+int CkptRedist::owner(int64_t g, int64_t extent, int block, int ranks) {
+    if (block <= 0) {
+        return g / ((extent + ranks - 1) / ranks);
+    }
+    return (g / block) % ranks;
+}
+
+int64_t CkptRedist::local(int64_t g, int64_t extent, int block, int ranks) {
+    if (block <= 0) {
+        return g % ((extent + ranks - 1) / ranks);
+    }
+    return g / block / ranks * block + g % block;
+}
+
+int64_t CkptRedist::global(int64_t l, int64_t extent, int block,
+        int ranks, int rank) {
+    if (block <= 0) {
+        return rank * ((extent + ranks - 1) / ranks) + l;
+    }
+    return ((l / block) * ranks + rank) * block + l % block;
+}
+
+bool CkptRedist::exchange(MPI_Comm comm,
+        int old_ranks,
+        const Layout& layout,
+        const std::vector<std::pair<int, const char*>>& images,
+        char* dst) {
+    int ranks;
+    int rank;
+    MPI_Comm_size(comm, &ranks);
+    MPI_Comm_rank(comm, &rank);
+    const int64_t extent = layout.m_extent;
+    const int block = layout.m_block;
+
+    // rows are sent in the order of old rank, outer index and local index,
+    // so receivers know where each row goes without a header
+    std::vector<int> scounts(ranks, 0);
+    for (auto& image : images) {
+        int p = image.first;
+        int64_t n = count(extent, block, old_ranks, p);
+        for (int64_t l = 0; l < n; l++) {
+            int64_t g = global(l, extent, block, old_ranks, p);
+            scounts[owner(g, extent, block, ranks)] += layout.m_outer;
+        }
+    }
+    std::vector<int> sdispls(ranks, 0);
+    for (int q = 1; q < ranks; q++) {
+        sdispls[q] = sdispls[q - 1] + scounts[q - 1];
+    }
+    std::vector<char> sbuf(
+            (size_t)(sdispls.back() + scounts.back()) * layout.m_row);
+    std::vector<int> filled(sdispls);
+    for (auto& image : images) {
+        int p = image.first;
+        int64_t n = count(extent, block, old_ranks, p);
+        for (int64_t o = 0; o < layout.m_outer; o++) {
+            for (int64_t l = 0; l < n; l++) {
+                int64_t g = global(l, extent, block, old_ranks, p);
+                int q = owner(g, extent, block, ranks);
+                std::memcpy(sbuf.data() + (size_t)filled[q]++ * layout.m_row,
+                        image.second + (size_t)(o * n + l) * layout.m_row,
+                        layout.m_row);
+            }
+        }
+    }
+
+    // every old rank is read by exactly one new rank
+    bool ok = true;
+    size_t expected = 0;
+    for (int p = rank; p < old_ranks; p += ranks) {
+        ok = ok && expected < images.size() && images[expected].first == p;
+        expected++;
+    }
+    ok = ok && expected == images.size();
+
+    // rows from sender r are of old ranks r, r + M, ...
+    int64_t mine = count(extent, block, ranks, rank);
+    std::vector<int> rcounts(ranks, 0);
+    std::vector<int64_t> places;
+    for (int r = 0; r < ranks; r++) {
+        for (int p = r; p < old_ranks; p += ranks) {
+            int64_t n = count(extent, block, old_ranks, p);
+            for (int64_t o = 0; o < layout.m_outer; o++) {
+                for (int64_t l = 0; l < n; l++) {
+                    int64_t g = global(l, extent, block, old_ranks, p);
+                    if (owner(g, extent, block, ranks) != rank) {
+                        continue;
+                    }
+                    places.push_back(o * mine + local(g, extent, block, ranks));
+                    rcounts[r]++;
+                }
+            }
+        }
+    }
+    std::vector<int> rdispls(ranks, 0);
+    for (int r = 1; r < ranks; r++) {
+        rdispls[r] = rdispls[r - 1] + rcounts[r - 1];
+    }
+    std::vector<char> rbuf(places.size() * layout.m_row);
+
+    MPI_Datatype row;
+    MPI_Type_contiguous(layout.m_row, MPI_BYTE, &row);
+    MPI_Type_commit(&row);
+    MPI_Alltoallv(sbuf.data(), scounts.data(), sdispls.data(), row,
+            rbuf.data(), rcounts.data(), rdispls.data(), row, comm);
+    MPI_Type_free(&row);
+
+    for (size_t i = 0; i < places.size(); i++) {
+        std::memcpy(dst + (size_t)places[i] * layout.m_row,
+                rbuf.data() + i * layout.m_row, layout.m_row);
+    }
+    return ok;
+}
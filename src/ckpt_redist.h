@@ -0,0 +1,109 @@
+/**
+Copyright 2021 PIDL(Petabyte-scale In-memory Database Lab) http://kdb.snu.ac.kr
+This work was supported by Next-Generation Information Computing Development
+Program through the National Research Foundation of Korea(NRF)
+funded by the Ministry of Science, ICT (NRF-2016M3C4A7952587)
+Author: Ilju Lee, Jongin Kim, Hyerim Jeon, Youngjune Park
+Contact: sdmt@kdb.snu.ac.kr
+ */
+
+#ifndef CKPT_REDIST_H_
+#define CKPT_REDIST_H_
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include <mpi.h>
+
+/**
+ * @brief redistribution of an array decomposed along a dimension
+ *  between different numbers of ranks
+ * @details the array is row major, split along one dimension into
+ *  contiguous blocks of ceil(extent / ranks) indices, or block-cyclic,
+ *  blocks of a given size dealt to ranks in turn. a slab is the part of
+ *  the array at an index of the split dimension.<p>
+ *  at an N-to-M restart, the image of old rank p is read by new rank
+ *  p % M, and slabs are sent to their new owners by MPI_Alltoallv.<p>
+ *  exchange() is collective over the communicator
+ */
+class CkptRedist
+{
+  public:
+    /**
+     * @brief shape of an array around the split dimension
+     */
+    struct Layout {
+        /** @brief number of slabs before the split dimension */
+        int64_t m_outer;
+
+        /** @brief global extent of the split dimension */
+        int64_t m_extent;
+
+        /** @brief byte size of a row, after the split dimension */
+        int64_t m_row;
+
+        /** @brief block size of block-cyclic decomposition,
+         *  0 for contiguous blocks */
+        int m_block;
+    };
+
+    /**
+     * @brief number of indices of the split dimension held by a rank
+     * @param extent global extent of the split dimension
+     * @param block block size, 0 for contiguous blocks
+     * @param ranks number of ranks
+     * @param rank rank
+     * @return local extent
+     */
+    static int64_t count(int64_t extent, int block, int ranks, int rank);
+
+    /**
+     * @brief rank holding a global index
+     * @param g global index of the split dimension
+     * @param extent global extent of the split dimension
+     * @param block block size, 0 for contiguous blocks
+     * @param ranks number of ranks
+     * @return rank
+     */
+    static int owner(int64_t g, int64_t extent, int block, int ranks);
+
+    /**
+     * @brief local index of a global index in its owner
+     * @param g global index of the split dimension
+     * @param extent global extent of the split dimension
+     * @param block block size, 0 for contiguous blocks
+     * @param ranks number of ranks
+     * @return local index
+     */
+    static int64_t local(int64_t g, int64_t extent, int block, int ranks);
+
+    /**
+     * @brief global index of a local index of a rank
+     * @param l local index of the split dimension
+     * @param extent global extent of the split dimension
+     * @param block block size, 0 for contiguous blocks
+     * @param ranks number of ranks
+     * @param rank rank
+     * @return global index
+     */
+    static int64_t global(int64_t l, int64_t extent, int block,
+            int ranks, int rank);
+
+    /**
+     * @brief send slabs of old images to their new owners
+     * @param comm communicator of new ranks
+     * @param old_ranks number of ranks the images were written by
+     * @param layout shape of the array
+     * @param images images of old ranks p with p % M == this rank,
+     *  ascending, as pairs of old rank and memory
+     * @param dst [out] local array of this rank
+     * @return false if an image is missing
+     */
+    static bool exchange(MPI_Comm comm,
+            int old_ranks,
+            const Layout& layout,
+            const std::vector<std::pair<int, const char*>>& images,
+            char* dst);
+};
+
+#endif  // CKPT_REDIST_H_
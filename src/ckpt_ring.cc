@@ -0,0 +1,210 @@
+/**
+Copyright 2021 PIDL(Petabyte-scale In-memory Database Lab) http://kdb.snu.ac.kr
+This work was supported by Next-Generation Information Computing Development
+Program through the National Research Foundation of Korea(NRF)
+funded by the Ministry of Science, ICT (NRF-2016M3C4A7952587)
+Author: Ilju Lee, Jongin Kim, Hyerim Jeon, Youngjune Park
+Contact: sdmt@kdb.snu.ac.kr
+ */
+
+#include "ckpt_ring.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <thread>
+
+#include <sys/mman.h>
+
+namespace {
+
+/** @brief byte size of a huge page */
+const size_t kHugePage = 2 << 20;
+
+/** @brief alignment of a region in a slot */
+const size_t kAlign = 64;
+
+/** @brief smallest piece of a copy given to a thread */
+const size_t kPiece = 4 << 20;
+
+/**
+ * @brief a piece of copy
+ */
+struct Piece {
+    char* m_dst;
+    const char* m_src;
+    size_t m_size;
+};
+
+size_t align_up(size_t size, size_t align) {
+    return (size + align - 1) / align * align;
+}
+
+/**
+ * @brief copy pieces on several threads
+ * @details small copies are done by the calling thread,
+ *  as starting threads costs more than copying
+ */
+void parallel_copy(const std::vector<Piece>& pieces) {
+    size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = std::min(threads, pieces.size());
+    if (threads <= 1) {
+        for (auto& p : pieces) {
+            std::memcpy(p.m_dst, p.m_src, p.m_size);
+        }
+        return;
+    }
+
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+        for (size_t i = next++; i < pieces.size(); i = next++) {
+            std::memcpy(pieces[i].m_dst, pieces[i].m_src, pieces[i].m_size);
+        }
+    };
+    std::vector<std::thread> pool;
+    for (size_t t = 1; t < threads; t++) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (auto& t : pool) {
+        t.join();
+    }
+}
+
+/**
+ * @brief split a copy into pieces of at least kPiece bytes
+ */
+void split(char* dst, const char* src, size_t size,
+        std::vector<Piece>& pieces) {
+    while (size > 0) {
+        size_t n = (size < 2 * kPiece) ? size : kPiece;
+        pieces.push_back(Piece{dst, src, n});
+        dst += n;
+        src += n;
+        size -= n;
+    }
+}
+
+}  // namespace
+
+CkptRing::CkptRing()
+    : m_base(nullptr),
+    m_mapped(0),
+    m_slot(0),
+    m_slots(0),
+    m_head(0),
+    m_count(0) {}
+
+CkptRing::~CkptRing() {
+    clear();
+}
+
+bool CkptRing::save(const std::vector<Region>& regions,
+        int slots,
+        int32_t iter) {
+    if (slots < 1) {
+        return false;
+    }
+
+    if (m_base == nullptr || slots != m_slots || !same_layout_(regions)) {
+        clear();
+        size_t size = 0;
+        for (auto& r : regions) {
+            size = align_up(size, kAlign) + r.m_size;
+            m_layout.push_back(std::make_pair(r.m_id, r.m_size));
+        }
+        if (!allocate_(slots, std::max(size, kAlign))) {
+            clear();
+            return false;
+        }
+    }
+
+    char* slot = m_base + m_head * m_slot;
+    std::vector<Piece> pieces;
+    size_t offset = 0;
+    for (auto& r : regions) {
+        offset = align_up(offset, kAlign);
+        split(slot + offset, reinterpret_cast<const char*>(r.m_ptr),
+                r.m_size, pieces);
+        offset += r.m_size;
+    }
+    parallel_copy(pieces);
+
+    m_iters[m_head] = iter;
+    m_head = (m_head + 1) % m_slots;
+    m_count = std::min(m_count + 1, m_slots);
+    return true;
+}
+
+bool CkptRing::load(int k,
+        const std::vector<Region>& regions,
+        int32_t& iter) {
+    if (k < 0 || k >= m_count || !same_layout_(regions)) {
+        return false;
+    }
+
+    int index = ((m_head - 1 - k) % m_slots + m_slots) % m_slots;
+    const char* slot = m_base + index * m_slot;
+    std::vector<Piece> pieces;
+    size_t offset = 0;
+    for (auto& r : regions) {
+        offset = align_up(offset, kAlign);
+        split(reinterpret_cast<char*>(r.m_ptr), slot + offset,
+                r.m_size, pieces);
+        offset += r.m_size;
+    }
+    parallel_copy(pieces);
+
+    iter = m_iters[index];
+    return true;
+}
+
+void CkptRing::clear() {
+    if (m_base != nullptr) {
+        ::munmap(m_base, m_mapped);
+    }
+    m_base = nullptr;
+    m_mapped = 0;
+    m_slot = 0;
+    m_slots = 0;
+    m_head = 0;
+    m_count = 0;
+    m_iters.clear();
+    m_layout.clear();
+}
+
+bool CkptRing::allocate_(int slots, size_t size) {
+    m_slot = align_up(size, kAlign);
+    m_mapped = align_up(m_slot * slots, kHugePage);
+
+    // explicit huge pages need a reserved pool,
+    // otherwise ask for transparent huge pages
+    void* p = ::mmap(nullptr, m_mapped, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (p == MAP_FAILED) {
+        p = ::mmap(nullptr, m_mapped, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) {
+            return false;
+        }
+        ::madvise(p, m_mapped, MADV_HUGEPAGE);
+    }
+
+    m_base = reinterpret_cast<char*>(p);
+    m_slots = slots;
+    m_iters.assign(slots, 0);
+    return true;
+}
+
+bool CkptRing::same_layout_(const std::vector<Region>& regions) const {
+    if (regions.size() != m_layout.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < regions.size(); i++) {
+        if (regions[i].m_id != m_layout[i].first
+                || regions[i].m_size != m_layout[i].second) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,123 @@
+/**
+Copyright 2021 PIDL(Petabyte-scale In-memory Database Lab) http://kdb.snu.ac.kr
+This work was supported by Next-Generation Information Computing Development
+Program through the National Research Foundation of Korea(NRF)
+funded by the Ministry of Science, ICT (NRF-2016M3C4A7952587)
+Author: Ilju Lee, Jongin Kim, Hyerim Jeon, Youngjune Park
+Contact: sdmt@kdb.snu.ac.kr
+ */
+
+#ifndef CKPT_RING_H_
+#define CKPT_RING_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief in-memory checkpoints kept in a ring of preallocated slots
+ * @details a slot holds every Snapshot of a checkpoint back to back.
+ *  slots are mapped on huge pages if possible, and copies are split
+ *  over several threads.<p>
+ *  the newest checkpoint overwrites the oldest one when the ring is full
+ */
+class CkptRing
+{
+  public:
+    /**
+     * @brief a memory region to save or load
+     */
+    struct Region {
+        /** @brief id of Snapshot */
+        int32_t m_id;
+
+        /** @brief memory pointer of Snapshot */
+        void* m_ptr;
+
+        /** @brief byte size of Snapshot */
+        size_t m_size;
+    };
+
+    /**
+     * @brief create an empty ring
+     */
+    CkptRing();
+
+    /**
+     * @brief release slots
+     */
+    ~CkptRing();
+
+    /**
+     * @brief copy regions into the next slot
+     * @details the ring is reallocated and emptied
+     *  if the regions differ from the saved ones
+     * @param regions regions to save
+     * @param slots number of slots
+     * @param iter iteration sequence at checkpoint
+     * @return false if slots can not be allocated
+     */
+    bool save(const std::vector<Region>& regions, int slots, int32_t iter);
+
+    /**
+     * @brief copy a saved checkpoint back to regions
+     * @param k 0 for the newest checkpoint, 1 for the one before, ...
+     * @param regions regions to load, same as saved
+     * @param iter [out] iteration sequence at checkpoint
+     * @return false if there is no such checkpoint
+     */
+    bool load(int k, const std::vector<Region>& regions, int32_t& iter);
+
+    /**
+     * @brief number of saved checkpoints
+     * @return number of checkpoints which can be loaded
+     */
+    int count() const { return m_count; }
+
+    /**
+     * @brief drop saved checkpoints and release slots
+     */
+    void clear();
+
+  private:
+    /**
+     * @brief allocate slots
+     * @param slots number of slots
+     * @param size byte size of a slot
+     * @return true if success
+     */
+    bool allocate_(int slots, size_t size);
+
+    /**
+     * @brief check regions have the layout of saved checkpoints
+     * @param regions regions to check
+     * @return true if same
+     */
+    bool same_layout_(const std::vector<Region>& regions) const;
+
+    /** @brief mapped memory of every slot */
+    char* m_base;
+
+    /** @brief byte size of mapped memory */
+    size_t m_mapped;
+
+    /** @brief byte size of a slot */
+    size_t m_slot;
+
+    /** @brief number of slots */
+    int m_slots;
+
+    /** @brief slot to write next */
+    int m_head;
+
+    /** @brief number of saved checkpoints */
+    int m_count;
+
+    /** @brief iteration sequence of each slot */
+    std::vector<int32_t> m_iters;
+
+    /** @brief Snapshot ids and sizes of saved checkpoints */
+    std::vector<std::pair<int32_t, size_t>> m_layout;
+};
+
+#endif  // CKPT_RING_H_
@@ -0,0 +1,316 @@
+/**
+Copyright 2021 PIDL(Petabyte-scale In-memory Database Lab) http://kdb.snu.ac.kr
+This work was supported by Next-Generation Information Computing Development
+Program through the National Research Foundation of Korea(NRF)
+funded by the Ministry of Science, ICT (NRF-2016M3C4A7952587)
+Author: Ilju Lee, Jongin Kim, Hyerim Jeon, Youngjune Park
+Contact: sdmt@kdb.snu.ac.kr
+ */
+
+#include "ckpt_shared.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#include <dirent.h>
+#include <unistd.h>
+
+namespace {
+
+/** @brief magic number at the beginning of a shared checkpoint file */
+const char kMagic[8] = {'S', 'D', 'M', 'T', 'S', 'H', 'R', 'D'};
+
+/** @brief byte size of magic number and number of ranks */
+const uint64_t kPreamble = sizeof(kMagic) + 2 * sizeof(uint32_t);
+
+/** @brief largest transfer of a rank in a collective call */
+const uint64_t kMaxIO = 1 << 30;
+
+/**
+ * @brief contiguous memory to write or read
+ */
+struct Piece {
+    char* m_ptr;
+    uint64_t m_size;
+};
+
+uint64_t align_up(uint64_t size, uint64_t align) {
+    return (size + align - 1) / align * align;
+}
+
+MPI_Info hints(const CkptShared::Tuning& tuning) {
+    MPI_Info info;
+    MPI_Info_create(&info);
+    // collective buffering is the two-phase I/O of ROMIO
+    MPI_Info_set(info, "romio_cb_write", "enable");
+    MPI_Info_set(info, "romio_cb_read", "enable");
+    if (tuning.m_aggregators > 0) {
+        MPI_Info_set(info, "cb_nodes",
+                std::to_string(tuning.m_aggregators).c_str());
+    }
+    if (tuning.m_stripe > 0) {
+        MPI_Info_set(info, "striping_unit",
+                std::to_string(tuning.m_stripe).c_str());
+    }
+    return info;
+}
+
+bool all(bool ok, MPI_Comm comm) {
+    int mine = ok ? 1 : 0;
+    int every = 0;
+    MPI_Allreduce(&mine, &every, 1, MPI_INT, MPI_LAND, comm);
+    return every != 0;
+}
+
+/**
+ * @brief write or read pieces to or from contiguous file range
+ * @details pieces are described by a datatype, so they are not copied.
+ *  every rank makes the same number of collective calls
+ *  of at most kMaxIO bytes each
+ */
+bool transfer(MPI_File fh, bool write, const std::vector<Piece>& pieces,
+        uint64_t offset, MPI_Comm comm) {
+    std::vector<std::vector<Piece>> rounds(1);
+    uint64_t filled = 0;
+    for (auto p : pieces) {
+        while (p.m_size > 0) {
+            if (filled == kMaxIO) {
+                rounds.emplace_back();
+                filled = 0;
+            }
+            uint64_t n = std::min(p.m_size, kMaxIO - filled);
+            rounds.back().push_back(Piece{p.m_ptr, n});
+            filled += n;
+            p.m_ptr += n;
+            p.m_size -= n;
+        }
+    }
+    int mine = rounds.size();
+    int count = 0;
+    MPI_Allreduce(&mine, &count, 1, MPI_INT, MPI_MAX, comm);
+
+    bool ok = true;
+    for (int r = 0; r < count; r++) {
+        std::vector<int> lens;
+        std::vector<MPI_Aint> displs;
+        uint64_t bytes = 0;
+        if (r < mine) {
+            for (auto& p : rounds[r]) {
+                MPI_Aint addr;
+                MPI_Get_address(p.m_ptr, &addr);
+                lens.push_back(p.m_size);
+                displs.push_back(addr);
+                bytes += p.m_size;
+            }
+        }
+        MPI_Datatype type;
+        MPI_Type_create_hindexed(lens.size(), lens.data(), displs.data(),
+                MPI_BYTE, &type);
+        MPI_Type_commit(&type);
+        int n = lens.empty() ? 0 : 1;
+        MPI_Status status;
+        int rc = write
+            ? MPI_File_write_at_all(fh, offset, MPI_BOTTOM, n, type, &status)
+            : MPI_File_read_at_all(fh, offset, MPI_BOTTOM, n, type, &status);
+        MPI_Type_free(&type);
+        ok = ok && rc == MPI_SUCCESS;
+        offset += bytes;
+    }
+    return ok;
+}
+
+}  // namespace
+
+std::string CkptShared::path(const std::string& dir, int id) {
+    return dir + "/Ckpt" + std::to_string(id) + "-Shared.sdmt";
+}
+
+bool CkptShared::write(MPI_Comm comm,
+        const std::string& path,
+        const CkptFile::Header& header,
+        std::vector<CkptFile::Record>& records,
+        const Tuning& tuning) {
+    int rank;
+    int size;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+
+    // sections follow the table at stripe aligned offsets
+    std::string head;
+    uint64_t bytes = CkptFile::layout(header, records, head);
+    uint64_t stripe = std::max<uint64_t>(1, tuning.m_stripe);
+    uint64_t aligned = align_up(bytes, stripe);
+    uint64_t before = 0;
+    MPI_Exscan(&aligned, &before, 1, MPI_UINT64_T, MPI_SUM, comm);
+    if (rank == 0) {
+        before = 0;
+    }
+    uint64_t table = kPreamble + 2 * sizeof(uint64_t) * size;
+    uint64_t entry[2] = {align_up(table, stripe) + before, bytes};
+    std::vector<char> buf(rank == 0 ? table : 0);
+    MPI_Gather(entry, 2, MPI_UINT64_T,
+            rank == 0 ? buf.data() + kPreamble : nullptr,
+            2, MPI_UINT64_T, 0, comm);
+    uint64_t end = entry[0] + bytes;
+    MPI_Allreduce(MPI_IN_PLACE, &end, 1, MPI_UINT64_T, MPI_MAX, comm);
+
+    std::string tmp = path + ".tmp";
+    MPI_Info info = hints(tuning);
+    MPI_File fh;
+    bool ok = MPI_File_open(comm, tmp.c_str(), MPI_MODE_CREATE | MPI_MODE_WRONLY,
+            info, &fh) == MPI_SUCCESS;
+    MPI_Info_free(&info);
+    if (!all(ok, comm)) {
+        if (ok) {
+            MPI_File_close(&fh);
+        }
+        return false;
+    }
+
+    // a stale temporary file may be longer
+    ok = MPI_File_set_size(fh, end) == MPI_SUCCESS;
+    if (rank == 0) {
+        uint32_t n[2] = {(uint32_t)size, 0};
+        std::memcpy(buf.data(), kMagic, sizeof(kMagic));
+        std::memcpy(buf.data() + sizeof(kMagic), n, sizeof(n));
+        MPI_Status status;
+        ok = ok && MPI_File_write_at(fh, 0, buf.data(), buf.size(), MPI_BYTE,
+                &status) == MPI_SUCCESS;
+    }
+
+    std::vector<Piece> pieces;
+    pieces.push_back(Piece{&head[0], head.size()});
+    for (auto& r : records) {
+        pieces.push_back(Piece{(char*)r.m_data, r.m_size});
+    }
+    ok = transfer(fh, true, pieces, entry[0], comm) && ok;
+    ok = MPI_File_sync(fh) == MPI_SUCCESS && ok;
+    ok = MPI_File_close(&fh) == MPI_SUCCESS && ok;
+
+    // publish the file once every rank has written
+    ok = all(ok, comm);
+    if (rank == 0) {
+        if (ok) {
+            ok = std::rename(tmp.c_str(), path.c_str()) == 0;
+        } else {
+            std::remove(tmp.c_str());
+        }
+    }
+    int published = ok ? 1 : 0;
+    MPI_Bcast(&published, 1, MPI_INT, 0, comm);
+    return published != 0;
+}
+
+bool CkptShared::read(MPI_Comm comm,
+        const std::string& path,
+        const Tuning& tuning,
+        std::vector<char>& section) {
+    int rank;
+    int size;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+
+    MPI_Info info = hints(tuning);
+    MPI_File fh;
+    bool ok = MPI_File_open(comm, path.c_str(), MPI_MODE_RDONLY,
+            info, &fh) == MPI_SUCCESS;
+    MPI_Info_free(&info);
+    if (!all(ok, comm)) {
+        if (ok) {
+            MPI_File_close(&fh);
+        }
+        return false;
+    }
+
+    // rank 0 reads the table for every rank
+    std::vector<uint64_t> table(rank == 0 ? 2 * size : 0);
+    if (rank == 0) {
+        char preamble[kPreamble];
+        uint32_t n[2];
+        MPI_Status status;
+        ok = MPI_File_read_at(fh, 0, preamble, kPreamble, MPI_BYTE,
+                    &status) == MPI_SUCCESS
+            && MPI_File_read_at(fh, kPreamble, table.data(), table.size(),
+                    MPI_UINT64_T, &status) == MPI_SUCCESS;
+        std::memcpy(n, preamble + sizeof(kMagic), sizeof(n));
+        ok = ok && std::equal(kMagic, kMagic + sizeof(kMagic), preamble)
+            && n[0] == (uint32_t)size;
+    }
+    int valid = ok ? 1 : 0;
+    MPI_Bcast(&valid, 1, MPI_INT, 0, comm);
+    if (!valid) {
+        MPI_File_close(&fh);
+        return false;
+    }
+    uint64_t entry[2];
+    MPI_Scatter(table.data(), 2, MPI_UINT64_T, entry, 2, MPI_UINT64_T,
+            0, comm);
+
+    section.resize(entry[1]);
+    std::vector<Piece> pieces(1, Piece{section.data(), section.size()});
+    ok = transfer(fh, false, pieces, entry[0], comm);
+    ok = MPI_File_close(&fh) == MPI_SUCCESS && ok;
+    return all(ok, comm);
+}
+
+std::vector<int> CkptShared::list(const std::string& dir) {
+    std::vector<int> ids;
+    DIR* d = ::opendir(dir.c_str());
+    if (d == nullptr) {
+        return ids;
+    }
+
+    struct dirent* e;
+    while ((e = ::readdir(d)) != nullptr) {
+        int id;
+        char tail[8] = {0};
+        // temporary files have ".sdmt.tmp" suffix and are skipped
+        if (std::sscanf(e->d_name, "Ckpt%d-Shared.%7s", &id, tail) == 2
+                && std::string(tail) == "sdmt") {
+            ids.push_back(id);
+        }
+    }
+    ::closedir(d);
+
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+int CkptShared::latest(const std::string& dir) {
+    std::vector<int> ids = list(dir);
+    return ids.empty() ? -1 : ids.back();
+}
+
+bool CkptShared::read_index(const std::string& path,
+        int rank,
+        CkptFile::Header& header,
+        std::vector<CkptFile::Record>& records) {
+    std::ifstream is(path, std::ios::in | std::ios::binary);
+    char preamble[kPreamble];
+    uint32_t n[2];
+    uint64_t entry[2];
+    if (!is.read(preamble, kPreamble).good()) {
+        return false;
+    }
+    std::memcpy(n, preamble + sizeof(kMagic), sizeof(n));
+    if (!std::equal(kMagic, kMagic + sizeof(kMagic), preamble)
+            || rank < 0 || (uint32_t)rank >= n[0]
+            || !is.seekg(kPreamble + 2 * sizeof(uint64_t) * rank).good()
+            || !is.read(reinterpret_cast<char*>(entry), sizeof(entry))
+                .good()) {
+        return false;
+    }
+    return CkptFile::read_index(path, entry[0], header, records);
+}
+
+void CkptShared::prune(const std::string& dir,
+        const CkptFile::Retention& retention) {
+    std::vector<int> ids = list(dir);
+    for (int i = 0; i + retention.m_keep < (int)ids.size(); i++) {
+        if (!retention.milestone(ids[i])) {
+            ::unlink(path(dir, ids[i]).c_str());
+        }
+    }
+}
@@ -0,0 +1,124 @@
+/**
+Copyright 2021 PIDL(Petabyte-scale In-memory Database Lab) http://kdb.snu.ac.kr
+This work was supported by Next-Generation Information Computing Development
+Program through the National Research Foundation of Korea(NRF)
+funded by the Ministry of Science, ICT (NRF-2016M3C4A7952587)
+Author: Ilju Lee, Jongin Kim, Hyerim Jeon, Youngjune Park
+Contact: sdmt@kdb.snu.ac.kr
+ */
+
+#ifndef CKPT_SHARED_H_
+#define CKPT_SHARED_H_
+
+#include "ckpt_file.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <mpi.h>
+
+/**
+ * @brief checkpoint of every rank in one shared file written by MPI-IO
+ * @details layout: [magic][number of ranks][offset and size of each rank]
+ *  followed by a section of each rank, which is a CkptFile image.
+ *  sections start at stripe aligned offsets, so no stripe is written
+ *  by two ranks. sections are written and read by collective MPI-IO,
+ *  which aggregates them on a few aggregator ranks(two-phase I/O).<p>
+ *  a file is written to a temporary path and renamed when complete.<p>
+ *  write() and read() are collective over the communicator
+ */
+class CkptShared
+{
+  public:
+    /**
+     * @brief MPI-IO tuning
+     */
+    struct Tuning {
+        /**
+         * @brief create default Tuning
+         */
+        Tuning()
+            : m_aggregators(0),
+            m_stripe(1 << 20) {}
+
+        /** @brief number of aggregator ranks, 0 for MPI default */
+        int m_aggregators;
+
+        /** @brief stripe size of the file system, sections are aligned */
+        size_t m_stripe;
+    };
+
+    /**
+     * @brief path of a shared checkpoint file
+     * @param dir checkpoint directory
+     * @param id checkpoint id
+     * @return path of the file
+     */
+    static std::string path(const std::string& dir, int id);
+
+    /**
+     * @brief write Records of every rank into a shared file
+     * @param comm communicator
+     * @param path path of the file
+     * @param header checkpoint metadata of this rank
+     * @param records Snapshots of this rank, offsets in section are assigned
+     * @param tuning MPI-IO tuning
+     * @return true if every rank succeeded
+     */
+    static bool write(MPI_Comm comm,
+                    const std::string& path,
+                    const CkptFile::Header& header,
+                    std::vector<CkptFile::Record>& records,
+                    const Tuning& tuning);
+
+    /**
+     * @brief read the section of this rank from a shared file
+     * @param comm communicator, the same size as written
+     * @param path path of the file
+     * @param tuning MPI-IO tuning
+     * @param section [out] CkptFile image of this rank
+     * @return true if every rank succeeded
+     */
+    static bool read(MPI_Comm comm,
+                    const std::string& path,
+                    const Tuning& tuning,
+                    std::vector<char>& section);
+
+    /**
+     * @brief list ids of complete shared checkpoint files
+     * @param dir checkpoint directory
+     * @return ascending checkpoint ids
+     */
+    static std::vector<int> list(const std::string& dir);
+
+    /**
+     * @brief get the newest complete shared checkpoint id
+     * @param dir checkpoint directory
+     * @return checkpoint id, -1 if none
+     */
+    static int latest(const std::string& dir);
+
+    /**
+     * @brief read header and index of the section of a rank
+     * @details not collective, only the table and the index are read
+     * @param path path of the file
+     * @param rank rank of the section
+     * @param header [out] checkpoint metadata of the rank
+     * @param records [out] Records, offsets relative to the section
+     * @return true if success
+     */
+    static bool read_index(const std::string& path,
+                    int rank,
+                    CkptFile::Header& header,
+                    std::vector<CkptFile::Record>& records);
+
+    /**
+     * @brief delete old shared checkpoint files
+     * @param dir checkpoint directory
+     * @param retention checkpoints to keep
+     */
+    static void prune(const std::string& dir,
+                    const CkptFile::Retention& retention);
+};
+
+#endif  // CKPT_SHARED_H_
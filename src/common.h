@@ -43,6 +43,63 @@ enum SDMT_DT {
     SDMT_NUM_DT
 };
 
+/**
+ * @brief an enum type of incremental checkpoint mode
+ */
+enum SDMT_IM {
+    /** write whole Snapshot at every checkpoint */
+    SDMT_IM_NONE,
+    /** write pages modified since the previous checkpoint,
+        detected by write protection of Snapshot memory */
+    SDMT_IM_PAGE,
+    /** write blocks modified since the previous checkpoint,
+        detected by comparing hashes of blocks */
+    SDMT_IM_HASH
+};
+
+/**
+ * @brief an enum type of compression codec of checkpoint data
+ */
+enum SDMT_CC {
+    /** write Snapshot as is */
+    SDMT_CC_NONE,
+    /** LZ77 family fast compression */
+    SDMT_CC_LZ,
+    /** byte shuffle of elements followed by LZ,
+        effective on smooth floating point data */
+    SDMT_CC_SHUFFLE_LZ,
+    /** error bounded lossy compression of floating point data
+        by prediction and quantization */
+    SDMT_CC_LOSSY
+};
+
+/**
+ * @brief an enum type of huge page backing of Snapshot memory
+ */
+enum SDMT_HP {
+    /** base pages */
+    SDMT_HP_NONE,
+    /** transparent huge pages, memory 2MB aligned and advised */
+    SDMT_HP_TRANSPARENT,
+    /** huge pages of the hugetlb pool mapped by mmap,
+        transparent ones if the pool is exhausted */
+    SDMT_HP_EXPLICIT
+};
+
+/**
+ * @brief an enum type of NUMA placement of Snapshot memory
+ */
+enum SDMT_NP {
+    /** pages on the node of the thread touching them first */
+    SDMT_NP_DEFAULT,
+    /** pages on a chosen node */
+    SDMT_NP_BIND,
+    /** pages interleaved over every node */
+    SDMT_NP_INTERLEAVE,
+    /** pages touched first by threads of an OpenMP static schedule */
+    SDMT_NP_FIRST_TOUCH
+};
+
 /**
  * @brief an enum type of return code
  */
@@ -62,7 +119,25 @@ enum SDMT_Code {
     /** failed to allocate new memory */
     SDMT_ERR_FAILED_ALLOCATION,
     /** failed to checkpoint */
-    SDMT_ERR_FAILED_CHECKPOINT
+    SDMT_ERR_FAILED_CHECKPOINT,
+    /** failed to recover checkpoint */
+    SDMT_ERR_FAILED_RECOVERY,
+    /** invalid optional attribute */
+    SDMT_ERR_WRONG_OPTION
+};
+
+/**
+ * @brief an enum type of asynchronous checkpoint status
+ */
+enum SDMT_CS {
+    /** no asynchronous checkpoint has been requested */
+    SDMT_CKPT_NONE,
+    /** checkpoint is staged and being written in background */
+    SDMT_CKPT_PENDING,
+    /** the last checkpoint has been written completely */
+    SDMT_CKPT_COMPLETED,
+    /** the last checkpoint could not be written */
+    SDMT_CKPT_FAILED
 };
 
 #endif  // COMMON_H_
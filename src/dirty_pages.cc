@@ -0,0 +1,175 @@
+/**
+Copyright 2021 PIDL(Petabyte-scale In-memory Database Lab) http://kdb.snu.ac.kr
+This work was supported by Next-Generation Information Computing Development
+Program through the National Research Foundation of Korea(NRF)
+funded by the Ministry of Science, ICT (NRF-2016M3C4A7952587)
+Author: Ilju Lee, Jongin Kim, Hyerim Jeon, Youngjune Park
+Contact: sdmt@kdb.snu.ac.kr
+ */
+
+#include "dirty_pages.h"
+
+#include <atomic>
+#include <csignal>
+#include <mutex>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace {
+
+/** @brief maximum number of tracked regions */
+const int kMaxRegions = 1024;
+
+/**
+ * @brief a tracked region
+ * @details read by the signal handler without locking,
+ *  m_base is published last and cleared first
+ */
+struct Region {
+    std::atomic<char*> m_base;
+    size_t m_size;
+    uint8_t* m_dirty;
+};
+
+Region g_regions[kMaxRegions];
+
+/** @brief serializes track/untrack, never taken in the signal handler */
+std::mutex g_mutex;
+
+/** @brief handler replaced by ours */
+struct sigaction g_prev;
+
+bool g_installed = false;
+
+size_t g_page = 0;
+
+void on_fault(int sig, siginfo_t* info, void* ctx) {
+    char* addr = reinterpret_cast<char*>(info->si_addr);
+    for (int i = 0; i < kMaxRegions; i++) {
+        char* base = g_regions[i].m_base.load(std::memory_order_acquire);
+        if (base != nullptr && addr >= base
+                && addr < base + g_regions[i].m_size) {
+            size_t page = (addr - base) / g_page;
+            g_regions[i].m_dirty[page] = 1;
+            ::mprotect(base + page * g_page, g_page, PROT_READ | PROT_WRITE);
+            return;
+        }
+    }
+
+    // not a tracked page, forward to the previous handler
+    if ((g_prev.sa_flags & SA_SIGINFO) && g_prev.sa_sigaction != nullptr) {
+        g_prev.sa_sigaction(sig, info, ctx);
+    } else if (g_prev.sa_handler != SIG_DFL && g_prev.sa_handler != SIG_IGN) {
+        g_prev.sa_handler(sig);
+    } else {
+        // the faulting instruction runs again and crashes as usual
+        ::signal(sig, SIG_DFL);
+    }
+}
+
+Region* find(void* ptr) {
+    for (int i = 0; i < kMaxRegions; i++) {
+        if (g_regions[i].m_base.load(std::memory_order_acquire) == ptr) {
+            return &g_regions[i];
+        }
+    }
+    return nullptr;
+}
+
+}  // namespace
+
+size_t DirtyPages::page_size() {
+    if (g_page == 0) {
+        g_page = ::sysconf(_SC_PAGESIZE);
+    }
+    return g_page;
+}
+
+bool DirtyPages::track(void* ptr, size_t size) {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    size_t page = page_size();
+    if (ptr == nullptr || reinterpret_cast<uintptr_t>(ptr) % page != 0) {
+        return false;
+    }
+
+    if (!g_installed) {
+        struct sigaction sa;
+        sa.sa_sigaction = on_fault;
+        sa.sa_flags = SA_SIGINFO | SA_RESTART;
+        sigemptyset(&sa.sa_mask);
+        if (::sigaction(SIGSEGV, &sa, &g_prev) != 0) {
+            return false;
+        }
+        g_installed = true;
+    }
+
+    for (int i = 0; i < kMaxRegions; i++) {
+        Region& r = g_regions[i];
+        if (r.m_base.load(std::memory_order_acquire) == nullptr) {
+            size_t npages = (size + page - 1) / page;
+            r.m_size = npages * page;
+            r.m_dirty = new uint8_t[npages]();
+            r.m_base.store(reinterpret_cast<char*>(ptr),
+                    std::memory_order_release);
+            if (::mprotect(ptr, r.m_size, PROT_READ) != 0) {
+                r.m_base.store(nullptr, std::memory_order_release);
+                delete[] r.m_dirty;
+                return false;
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+void DirtyPages::untrack(void* ptr) {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    Region* r = find(ptr);
+    if (r == nullptr) {
+        return;
+    }
+    ::mprotect(ptr, r->m_size, PROT_READ | PROT_WRITE);
+    r->m_base.store(nullptr, std::memory_order_release);
+    delete[] r->m_dirty;
+    r->m_dirty = nullptr;
+}
+
+bool DirtyPages::tracked(void* ptr) {
+    return ptr != nullptr && find(ptr) != nullptr;
+}
+
+bool DirtyPages::collect(void* ptr, std::vector<uint64_t>& pages) {
+    Region* r = find(ptr);
+    if (r == nullptr) {
+        return false;
+    }
+
+    // protect first, a write after this point faults again
+    // and is reported by the next collection
+    if (::mprotect(ptr, r->m_size, PROT_READ) != 0) {
+        return false;
+    }
+
+    pages.clear();
+    size_t npages = r->m_size / page_size();
+    for (size_t i = 0; i < npages; i++) {
+        if (r->m_dirty[i]) {
+            r->m_dirty[i] = 0;
+            pages.push_back(i);
+        }
+    }
+    return true;
+}
+
+void DirtyPages::release(void* ptr) {
+    Region* r = find(ptr);
+    if (r == nullptr) {
+        return;
+    }
+    size_t npages = r->m_size / page_size();
+    for (size_t i = 0; i < npages; i++) {
+        r->m_dirty[i] = 1;
+    }
+    ::mprotect(ptr, r->m_size, PROT_READ | PROT_WRITE);
+}
@@ -0,0 +1,73 @@
+/**
+Copyright 2021 PIDL(Petabyte-scale In-memory Database Lab) http://kdb.snu.ac.kr
+This work was supported by Next-Generation Information Computing Development
+Program through the National Research Foundation of Korea(NRF)
+funded by the Ministry of Science, ICT (NRF-2016M3C4A7952587)
+Author: Ilju Lee, Jongin Kim, Hyerim Jeon, Youngjune Park
+Contact: sdmt@kdb.snu.ac.kr
+ */
+
+#ifndef DIRTY_PAGES_H_
+#define DIRTY_PAGES_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief tracks pages written since the last collection
+ * @details a tracked region is write-protected with mprotect,
+ *  the first write to a page raises SIGSEGV, the handler marks the page
+ *  dirty and makes it writable again.<p>
+ *  system calls which write into a protected page(read, MPI receive
+ *  by the network card, ...) fail instead of faulting,
+ *  so tracked memory must only be written from user space
+ */
+class DirtyPages
+{
+  public:
+    /**
+     * @brief get size of a memory page
+     * @return byte size of a page
+     */
+    static size_t page_size();
+
+    /**
+     * @brief start tracking a memory region
+     * @param ptr page aligned base address
+     * @param size byte size of the region
+     * @return true if success
+     */
+    static bool track(void* ptr, size_t size);
+
+    /**
+     * @brief stop tracking a memory region and make it writable
+     * @param ptr base address given to track
+     */
+    static void untrack(void* ptr);
+
+    /**
+     * @brief check a memory region is tracked
+     * @param ptr base address given to track
+     * @return true if tracked
+     */
+    static bool tracked(void* ptr);
+
+    /**
+     * @brief collect dirty pages and write-protect the region again
+     * @param ptr base address given to track
+     * @param pages [out] ascending indices of dirty pages
+     * @return true if success
+     */
+    static bool collect(void* ptr, std::vector<uint64_t>& pages);
+
+    /**
+     * @brief make a region writable and mark all of its pages dirty
+     * @details used before the region is filled by system calls,
+     *  such as reading a checkpoint file
+     * @param ptr base address given to track
+     */
+    static void release(void* ptr);
+};
+
+#endif  // DIRTY_PAGES_H_
@@ -0,0 +1,124 @@
+/**
+Copyright 2021 PIDL(Petabyte-scale In-memory Database Lab) http://kdb.snu.ac.kr
+This work was supported by Next-Generation Information Computing Development
+Program through the National Research Foundation of Korea(NRF)
+funded by the Ministry of Science, ICT (NRF-2016M3C4A7952587)
+Author: Ilju Lee, Jongin Kim, Hyerim Jeon, Youngjune Park
+Contact: sdmt@kdb.snu.ac.kr
+ */
+
+#include "numa_placement.h"
+#include "parallel.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/mempolicy.h>)
+#include <linux/mempolicy.h>
+#include <sys/syscall.h>
+#define SDMT_HAVE_MBIND
+#endif
+#endif
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace {
+
+#ifdef SDMT_HAVE_MBIND
+/** @brief bits in a word of a node mask */
+const size_t kMaskBits = sizeof(unsigned long) * 8;
+
+bool set_policy(void* ptr, size_t size, int mode,
+        const std::vector<unsigned long>& mask) {
+    // the end is rounded up to the page the caller owns, the start is not
+    // rounded down onto memory of others
+    size_t page = ::sysconf(_SC_PAGESIZE);
+    if (reinterpret_cast<uintptr_t>(ptr) % page != 0) {
+        return false;
+    }
+    size_t length = (std::max<size_t>(size, 1) + page - 1) / page * page;
+    // the kernel reads one bit less than maxnode
+    return ::syscall(SYS_mbind, ptr, length, mode, mask.data(),
+            mask.size() * kMaskBits + 1, MPOL_MF_MOVE) == 0;
+}
+#endif
+
+}  // namespace
+
+int NumaPlacement::nodes() {
+    // e.g. "0" or "0-1"
+    std::ifstream possible("/sys/devices/system/node/possible");
+    std::string range;
+    if (!(possible >> range)) {
+        return 1;
+    }
+    size_t dash = range.find_last_of("-,");
+    int last = std::atoi(range.c_str()
+            + (dash == std::string::npos ? 0 : dash + 1));
+    return std::max(last + 1, 1);
+}
+
+bool NumaPlacement::bind(void* ptr, size_t size, int node) {
+#ifdef SDMT_HAVE_MBIND
+    if (node < 0 || node >= nodes()) {
+        return false;
+    }
+    std::vector<unsigned long> mask(node / kMaskBits + 1, 0);
+    mask[node / kMaskBits] |= 1UL << (node % kMaskBits);
+    return set_policy(ptr, size, MPOL_BIND, mask);
+#else
+    (void)ptr;
+    (void)size;
+    (void)node;
+    return false;
+#endif
+}
+
+bool NumaPlacement::interleave(void* ptr, size_t size) {
+#ifdef SDMT_HAVE_MBIND
+    int n = nodes();
+    std::vector<unsigned long> mask((n + kMaskBits - 1) / kMaskBits, 0);
+    for (int node = 0; node < n; node++) {
+        mask[node / kMaskBits] |= 1UL << (node % kMaskBits);
+    }
+    return set_policy(ptr, size, MPOL_INTERLEAVE, mask);
+#else
+    (void)ptr;
+    (void)size;
+    return false;
+#endif
+}
+
+void NumaPlacement::first_touch(void* ptr, size_t size, int threads) {
+    char* p = reinterpret_cast<char*>(ptr);
+    size_t page = ::sysconf(_SC_PAGESIZE);
+    long pages = (size + page - 1) / page;
+#ifdef _OPENMP
+    (void)threads;
+    #pragma omp parallel for schedule(static)
+    for (long i = 0; i < pages; i++) {
+        std::memset(p + i * page, 0, std::min(page, size - i * page));
+    }
+#else
+    // contiguous blocks of pages in the order of threads,
+    // as schedule(static) would split them
+    size_t n = parallel::concurrency(threads);
+    parallel::for_each(n, n, [&](size_t t) {
+        size_t begin = pages * t / n * page;
+        size_t end = std::min(size, pages * (t + 1) / n * page);
+        if (begin < end) {
+            std::memset(p + begin, 0, end - begin);
+        }
+    });
+#endif
+}
@@ -0,0 +1,63 @@
+/**
+Copyright 2021 PIDL(Petabyte-scale In-memory Database Lab) http://kdb.snu.ac.kr
+This work was supported by Next-Generation Information Computing Development
+Program through the National Research Foundation of Korea(NRF)
+funded by the Ministry of Science, ICT (NRF-2016M3C4A7952587)
+Author: Ilju Lee, Jongin Kim, Hyerim Jeon, Youngjune Park
+Contact: sdmt@kdb.snu.ac.kr
+ */
+
+#ifndef NUMA_PLACEMENT_H_
+#define NUMA_PLACEMENT_H_
+
+#include <cstddef>
+
+/**
+ * @brief placement of Snapshot memory on NUMA nodes
+ * @details policies are set by the mbind system call on whole pages, and
+ *  pages already mapped are migrated. memory has to start at a page and
+ *  own the rest of its last page, which is placed with it, and memory
+ *  not starting at a page is refused. without NUMA support, every call
+ *  fails and memory stays where the kernel put it.<p>
+ *  first_touch() maps pages by the threads that will use them, with an
+ *  OpenMP static schedule when built with OpenMP
+ */
+class NumaPlacement
+{
+  public:
+    /**
+     * @brief get number of NUMA nodes
+     * @return number of possible nodes, 1 if unknown
+     */
+    static int nodes();
+
+    /**
+     * @brief place memory on a node
+     * @param ptr page aligned memory
+     * @param size byte size, rounded up to whole pages
+     * @param node NUMA node
+     * @return true if success, false if ptr is not page aligned
+     */
+    static bool bind(void* ptr, size_t size, int node);
+
+    /**
+     * @brief interleave pages of memory over every node
+     * @param ptr page aligned memory
+     * @param size byte size, rounded up to whole pages
+     * @return true if success, false if ptr is not page aligned
+     */
+    static bool interleave(void* ptr, size_t size);
+
+    /**
+     * @brief zero memory not mapped yet, page by page, by threads of
+     *  a static schedule, so each page lands on the node of the thread
+     *  which handles the same indices in a loop of schedule(static)
+     * @param ptr memory
+     * @param size byte size
+     * @param threads number of threads without OpenMP,
+     *  0 for hardware concurrency
+     */
+    static void first_touch(void* ptr, size_t size, int threads);
+};
+
+#endif  // NUMA_PLACEMENT_H_
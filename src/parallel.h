@@ -0,0 +1,62 @@
+/**
+Copyright 2021 PIDL(Petabyte-scale In-memory Database Lab) http://kdb.snu.ac.kr
+This work was supported by Next-Generation Information Computing Development
+Program through the National Research Foundation of Korea(NRF)
+funded by the Ministry of Science, ICT (NRF-2016M3C4A7952587)
+Author: Ilju Lee, Jongin Kim, Hyerim Jeon, Youngjune Park
+Contact: sdmt@kdb.snu.ac.kr
+ */
+
+#ifndef PARALLEL_H_
+#define PARALLEL_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace parallel {
+
+/**
+ * @brief get the number of threads to use
+ * @param threads requested number of threads, 0 for hardware concurrency
+ * @return number of threads, at least 1
+ */
+inline int concurrency(int threads) {
+    if (threads <= 0) {
+        threads = std::thread::hardware_concurrency();
+    }
+    return std::max(threads, 1);
+}
+
+/**
+ * @brief run f(i) for i in [0, count) on several threads
+ * @details the calling thread is one of them
+ * @param threads number of threads, 0 for hardware concurrency
+ * @param count number of calls
+ * @param f function to call
+ */
+template<typename F>
+void for_each(int threads, size_t count, F f) {
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+        for (size_t i = next++; i < count; i = next++) {
+            f(i);
+        }
+    };
+
+    size_t n = std::min<size_t>(concurrency(threads), count);
+    std::vector<std::thread> pool;
+    for (size_t t = 1; t < n; t++) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (auto& t : pool) {
+        t.join();
+    }
+}
+
+}  // namespace parallel
+
+#endif  // PARALLEL_H_
@@ -13,22 +13,193 @@ Contact: sdmt@kdb.snu.ac.kr
 #include <pybind11/stl.h>
 #include <pybind11/numpy.h>
 
+#include <map>
+#include <string>
+#include <vector>
+
 namespace py = pybind11;
 
+/**
+ * @brief value type of the elements of a buffer
+ * @param info buffer
+ * @param vt [out] value type
+ * @return false if not of int, long, float or double
+ */
+static bool buffer_type(const py::buffer_info& info, SDMT_VT& vt) {
+    if (info.format == py::format_descriptor<int>::format()) {
+        vt = SDMT_INT;
+    } else if (info.format == py::format_descriptor<long>::format()) {
+        vt = SDMT_LONG;
+    } else if (info.format == py::format_descriptor<float>::format()) {
+        vt = SDMT_FLOAT;
+    } else if (info.format == py::format_descriptor<double>::format()) {
+        vt = SDMT_DOUBLE;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief keep a buffer registered as a Snapshot alive
+ * @details never destroyed, the interpreter may be gone at exit
+ * @param name name of the Snapshot
+ * @param buffer buffer
+ */
+static void keep(const std::string& name, const py::buffer& buffer) {
+    static auto* kept = new std::map<std::string, py::object>();
+    (*kept)[name] = buffer;
+}
+
 PYBIND11_MODULE(sdmtpy, m) {
     m.doc() = "Simulation process and Data Management Tool";
 
+    py::enum_<SDMT_IM>(m, "im")
+        .value("none", SDMT_IM_NONE)
+        .value("page", SDMT_IM_PAGE)
+        .value("hash", SDMT_IM_HASH);
+
+    py::enum_<SDMT_CC>(m, "cc")
+        .value("none", SDMT_CC_NONE)
+        .value("lz", SDMT_CC_LZ)
+        .value("shuffle_lz", SDMT_CC_SHUFFLE_LZ)
+        .value("lossy", SDMT_CC_LOSSY);
+
+    py::enum_<SDMT_HP>(m, "hp")
+        .value("none", SDMT_HP_NONE)
+        .value("transparent", SDMT_HP_TRANSPARENT)
+        .value("explicit", SDMT_HP_EXPLICIT);
+
+    py::enum_<SDMT_NP>(m, "np")
+        .value("default", SDMT_NP_DEFAULT)
+        .value("bind", SDMT_NP_BIND)
+        .value("interleave", SDMT_NP_INTERLEAVE)
+        .value("first_touch", SDMT_NP_FIRST_TOUCH);
+
+    py::class_<SDMT::Options>(m, "options")
+        .def(py::init<>())
+        .def_readwrite("incremental", &SDMT::Options::m_incremental)
+        .def_readwrite("codec", &SDMT::Options::m_codec)
+        .def_readwrite("error_bound", &SDMT::Options::m_error_bound)
+        .def_readwrite("alignment", &SDMT::Options::m_alignment)
+        .def_readwrite("double_buffer", &SDMT::Options::m_double_buffer)
+        .def_readwrite("global_shape", &SDMT::Options::m_global)
+        .def_readwrite("axis", &SDMT::Options::m_axis)
+        .def_readwrite("block", &SDMT::Options::m_block)
+        .def_readwrite("huge_pages", &SDMT::Options::m_huge_pages)
+        .def_readwrite("prefault", &SDMT::Options::m_prefault)
+        .def_readwrite("placement", &SDMT::Options::m_placement)
+        .def_readwrite("numa_node", &SDMT::Options::m_numa_node);
+
+    py::class_<SDMT::CkptStats>(m, "ckpt_stats")
+        .def_readonly("id", &SDMT::CkptStats::m_id)
+        .def_readonly("rawsize", &SDMT::CkptStats::m_rawsize)
+        .def_readonly("size", &SDMT::CkptStats::m_size)
+        .def_property_readonly("ratio", &SDMT::CkptStats::ratio);
+
+    py::class_<SDMT::RecoveryStats>(m, "recovery_stats")
+        .def_readonly("id", &SDMT::RecoveryStats::m_id)
+        .def_readonly("threads", &SDMT::RecoveryStats::m_threads)
+        .def_readonly("lazy", &SDMT::RecoveryStats::m_lazy)
+        .def_readonly("allocate", &SDMT::RecoveryStats::m_allocate)
+        .def_readonly("restore", &SDMT::RecoveryStats::m_restore)
+        .def_property_readonly("total", &SDMT::RecoveryStats::total);
+
+    py::class_<SDMT::CatalogEntry>(m, "catalog_entry")
+        .def_readonly("id", &SDMT::CatalogEntry::m_id)
+        .def_readonly("level", &SDMT::CatalogEntry::m_level)
+        .def_readonly("iter", &SDMT::CatalogEntry::m_iter)
+        .def_readonly("time", &SDMT::CatalogEntry::m_time)
+        .def_readonly("rawsize", &SDMT::CatalogEntry::m_rawsize)
+        .def_readonly("size", &SDMT::CatalogEntry::m_size);
+
     m.def("init", &SDMT::init)
         .def("start", &SDMT::start)
         .def("finalize", &SDMT::finalize)
-        .def("checkpoint", &SDMT::checkpoint)
-        .def("recover", &SDMT::recover)
-        .def("register", &SDMT::register_snapshot)
+        .def("checkpoint", &SDMT::checkpoint,
+            py::arg("level"), py::arg("async_") = false)
+        .def("wait_checkpoint", &SDMT::wait_checkpoint)
+        .def("checkpoint_status", &SDMT::checkpoint_status)
+        .def("wait_drain", &SDMT::wait_drain)
+        .def("wait_recovery", &SDMT::wait_recovery)
+        .def("checkpoint_stats", &SDMT::checkpoint_stats)
+        .def("recovery_stats", &SDMT::recovery_stats)
+        .def("catalog", &SDMT::catalog)
+        .def("flip", &SDMT::flip)
+        .def("set_flip_hook", [](py::object hook) {
+            if (hook.is_none()) {
+                SDMT::set_flip_hook(SDMT::FlipHook());
+                return;
+            }
+            // the new buffer is read by get(name)
+            SDMT::set_flip_hook([hook](const std::string& name, void*) {
+                hook(name);
+            });
+        }, py::arg("hook"))
+        .def("recover", static_cast<SDMT_Code (*)()>(&SDMT::recover))
+        .def("recover",
+            static_cast<SDMT_Code (*)(const std::vector<std::string>&)>(
+                &SDMT::recover), py::arg("names"))
+        .def("recover", static_cast<SDMT_Code (*)(int)>(&SDMT::recover),
+            py::arg("id"))
+        .def("recover_snapshot", &SDMT::recover_snapshot)
+        .def("checkpoint_memory", &SDMT::checkpoint_memory)
+        .def("rollback", &SDMT::rollback, py::arg("k") = 0)
+        .def("checkpoint_partner", &SDMT::checkpoint_partner)
+        .def("recover_partner", &SDMT::recover_partner)
+        .def("checkpoint_erasure", &SDMT::checkpoint_erasure)
+        .def("recover_erasure", &SDMT::recover_erasure)
+        .def("register",
+            static_cast<SDMT_Code (*)(std::string, SDMT_VT, SDMT_DT,
+                std::vector<int>, const SDMT::Options&)>(
+                &SDMT::register_snapshot),
+            py::arg("name"), py::arg("vt"), py::arg("dt"), py::arg("dim"),
+            py::arg("options") = SDMT::Options())
+        .def("register_external", [](std::string name, py::buffer buffer,
+                const SDMT::Options& opts) {
+            py::buffer_info info = buffer.request(true);
+            SDMT_VT vt;
+            if (!buffer_type(info, vt)) {
+                return SDMT_ERR_WRONG_VALUE_TYPE;
+            }
+            std::vector<int> dim(info.shape.begin(), info.shape.end());
+            std::vector<int> strides(info.strides.begin(), info.strides.end());
+            SDMT_Code res = SDMT::register_external(name, info.ptr, vt,
+                    static_cast<SDMT_DT>(info.ndim), dim, strides, opts);
+            if (res == SDMT_SUCCESS) {
+                keep(name, buffer);
+            }
+            return res;
+        }, py::arg("name"), py::arg("buffer"),
+            py::arg("options") = SDMT::Options())
+        .def("rebind", [](const std::string& name, py::buffer buffer) {
+            py::buffer_info info = buffer.request(true);
+            // an unknown name is left to rebind
+            SDMT::SnapshotView view = SDMT::view(name);
+            SDMT_VT vt;
+            if (!buffer_type(info, vt)
+                    || (view.m_id >= 0 && vt != view.m_valuetype)) {
+                return SDMT_ERR_WRONG_VALUE_TYPE;
+            }
+            std::vector<int> dim(info.shape.begin(), info.shape.end());
+            std::vector<int> strides(info.strides.begin(), info.strides.end());
+            SDMT_Code res = SDMT::rebind(name, info.ptr, dim, strides);
+            if (res == SDMT_SUCCESS) {
+                keep(name, buffer);
+            }
+            return res;
+        }, py::arg("name"), py::arg("buffer"))
+        .def("local_extent", &SDMT::local_extent,
+            py::arg("extent"), py::arg("block") = 0)
 		.def("register_int", &SDMT::register_int_parameter)
 		.def("register_long", &SDMT::register_long_parameter)
 		.def("register_float", &SDMT::register_float_parameter)
 		.def("register_double", &SDMT::register_double_parameter)
-		.def("get", &SDMT::get_snapshot)
+		.def("get", static_cast<SDMT::SnapshotView (*)(const std::string&)>(
+			&SDMT::view))
+		.def("get", static_cast<SDMT::SnapshotView (*)(SDMT::SnapshotHandle)>(
+			&SDMT::view), py::arg("handle"))
+		.def("lookup", &SDMT::lookup)
 		.def("get_int", &SDMT::get_int_parameter)
 		.def("get_long", &SDMT::get_long_parameter)
 		.def("get_float", &SDMT::get_float_parameter)
@@ -57,42 +228,54 @@ PYBIND11_MODULE(sdmtpy, m) {
         .value("err_wrong_data_type", SDMT_ERR_WRONG_DATA_TYPE)
         .value("err_wrong_dimension", SDMT_ERR_WRONG_DIMENSION)
         .value("err_failed_allocation", SDMT_ERR_FAILED_ALLOCATION)
-        .value("err_failed_checkpoint", SDMT_ERR_FAILED_CHECKPOINT);
+        .value("err_failed_checkpoint", SDMT_ERR_FAILED_CHECKPOINT)
+        .value("err_failed_recovery", SDMT_ERR_FAILED_RECOVERY)
+        .value("err_wrong_option", SDMT_ERR_WRONG_OPTION);
+
+    py::enum_<SDMT_CS>(m, "ckpt_status")
+        .value("none", SDMT_CKPT_NONE)
+        .value("pending", SDMT_CKPT_PENDING)
+        .value("completed", SDMT_CKPT_COMPLETED)
+        .value("failed", SDMT_CKPT_FAILED);
 
-	py::class_<SDMT::Snapshot>(m, "snapshot", py::buffer_protocol())
-		.def_buffer([](SDMT::Snapshot& snapshot) -> py::buffer_info {
-			if (snapshot.m_valuetype == SDMT_INT) {
+	py::class_<SDMT::SnapshotView>(m, "snapshot", py::buffer_protocol())
+		.def_buffer([](SDMT::SnapshotView& view) -> py::buffer_info {
+			std::vector<ssize_t> shape(view.m_dimension,
+				view.m_dimension + view.m_rank);
+			std::vector<ssize_t> strides(view.m_strides,
+				view.m_strides + view.m_rank);
+			if (view.m_valuetype == SDMT_INT) {
 				return py::buffer_info(
-					snapshot.m_ptr,
+					view.m_ptr,
 					sizeof(int),
 					py::format_descriptor<int>::format(),
-					snapshot.m_dimension.size(),
-					snapshot.m_dimension,
-					snapshot.m_strides);
-			} else if (snapshot.m_valuetype == SDMT_LONG) {
+					view.m_rank,
+					shape,
+					strides);
+			} else if (view.m_valuetype == SDMT_LONG) {
 				return py::buffer_info(
-					snapshot.m_ptr,
+					view.m_ptr,
 					sizeof(long),
 					py::format_descriptor<long>::format(),
-					snapshot.m_dimension.size(),
-					snapshot.m_dimension,
-					snapshot.m_strides);
-			} else if (snapshot.m_valuetype == SDMT_FLOAT) {
+					view.m_rank,
+					shape,
+					strides);
+			} else if (view.m_valuetype == SDMT_FLOAT) {
 				return py::buffer_info(
-					snapshot.m_ptr,
+					view.m_ptr,
 					sizeof(float),
 					py::format_descriptor<float>::format(),
-					snapshot.m_dimension.size(),
-					snapshot.m_dimension,
-					snapshot.m_strides);
-			} else if (snapshot.m_valuetype == SDMT_DOUBLE) {
+					view.m_rank,
+					shape,
+					strides);
+			} else if (view.m_valuetype == SDMT_DOUBLE) {
 				return py::buffer_info(
-					snapshot.m_ptr,
+					view.m_ptr,
 					sizeof(double),
 					py::format_descriptor<double>::format(),
-					snapshot.m_dimension.size(),
-					snapshot.m_dimension,
-					snapshot.m_strides);
+					view.m_rank,
+					shape,
+					strides);
 			} else {
 				return py::buffer_info();
 			}
@@ -8,11 +8,157 @@ Contact: sdmt@kdb.snu.ac.kr
  */
 
 #include "sdmt.h"
+#include "ckpt_codec.h"
+#include "ckpt_delta.h"
+#include "ckpt_redist.h"
+#include "dirty_pages.h"
+#include "numa_placement.h"
+#include "parallel.h"
 #include "tinyxml2.h"
+#include "xxhash.h"
 
 #include <fti.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <fstream>
+#include <map>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+/**
+ * @brief number of native checkpoints kept per rank
+ * @details ranks drain asynchronous checkpoints independently,
+ *  keeping the previous one guarantees a checkpoint common to all ranks
+ */
+static const int kNativeKeep = 2;
+
+/** @brief byte size of a transparent huge page */
+static const size_t kHugePage = 2 << 20;
+
+/** @brief byte size of memory touched by a thread at a time */
+static const size_t kTouchPiece = 16 << 20;
+
+/** @brief name of the arena of small Snapshots in checkpoints */
+static const char* const kArena = "#arena";
+
+// an entry of the layout at the tail of the arena: id, offset, byte size
+static const size_t kLayoutEntry = 3 * sizeof(int64_t);
+
+/**
+ * @brief zero memory on several threads, mapping its pages
+ * @param ptr memory to touch
+ * @param size byte size
+ * @param threads number of threads, 0 for hardware concurrency
+ */
+static void touch(void* ptr, size_t size, int threads) {
+    char* p = reinterpret_cast<char*>(ptr);
+    size_t count = (size + kTouchPiece - 1) / kTouchPiece;
+    parallel::for_each(threads, count, [&](size_t i) {
+        size_t offset = i * kTouchPiece;
+        std::memset(p + offset, 0, std::min(kTouchPiece, size - offset));
+    });
+}
+
+/**
+ * @brief get element size and FTI type of an element type
+ * @param esize [out] byte size of an element
+ * @return FTI type
+ */
+template<typename T>
+static FTIT_type* element_type(int& esize) {
+    esize = sizeof(T);
+    return &ValueTraits<T>::fti_type();
+}
+
+/**
+ * @brief get element size and FTI type of a value type
+ * @param vt value type
+ * @param esize [out] byte size of an element
+ * @return FTI type, null if vt is incorrect
+ */
+static FTIT_type* element_type(SDMT_VT vt, int& esize) {
+    switch (vt) {
+        case SDMT_INT:
+            return element_type<int>(esize);
+        case SDMT_LONG:
+            return element_type<long>(esize);
+        case SDMT_FLOAT:
+            return element_type<float>(esize);
+        case SDMT_DOUBLE:
+            return element_type<double>(esize);
+        default:
+            return nullptr;
+    }
+}
+
+/**
+ * @brief check whether byte strides lay elements out without a gap
+ * @details any order of dimensions is dense, row major or column major.
+ *  the stride of a dimension of size 1 is not used
+ * @param dim size of each dimension
+ * @param esize byte size of an element
+ * @param strides byte strides for each index
+ * @return true if every element has a place of its own in bytes()
+ */
+static bool dense(const std::vector<int>& dim,
+        int esize,
+        const std::vector<int>& strides) {
+    if (strides.size() != dim.size()) {
+        return false;
+    }
+    std::vector<size_t> order(dim.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&strides](size_t a, size_t b) {
+        return strides[a] < strides[b];
+    });
+    int64_t expected = esize;
+    for (size_t i : order) {
+        if (dim[i] == 0) {
+            return true;
+        }
+        if (dim[i] == 1) {
+            continue;
+        }
+        if (strides[i] != expected) {
+            return false;
+        }
+        expected *= dim[i];
+    }
+    return true;
+}
+
+/**
+ * @brief get seconds elapsed since a time point
+ * @param start time point
+ * @return seconds
+ */
+static double elapsed(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start).count();
+}
+
+// reads ckpt_l1 ~ ckpt_l4 of a FTI configuration, 0 if not given
+static void fti_intervals(const std::string& path, int intervals[4]) {
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line)) {
+        int level = 0;
+        int value = 0;
+        if (std::sscanf(line.c_str(), " ckpt_l%d = %d", &level, &value) == 2
+                && level >= 1 && level <= 4) {
+            intervals[level - 1] = value;
+        }
+    }
+}
 
 SDMT_Code SDMT::init_(std::string config, bool restart) {
     if (!load_config_(config)) {
@@ -22,11 +168,36 @@ SDMT_Code SDMT::init_(std::string config, bool restart) {
     MPI_Init(nullptr, nullptr);
     FTI_Init(m_config.m_fti_config.c_str(), MPI_COMM_WORLD);
     m_comm = FTI_COMM_WORLD;
-
-    if (restart && FTI_Status()) {
+    MPI_Comm_rank(m_comm, &m_rank);
+    MPI_Comm_size(m_comm, &m_ckpt_ranks);
+    fti_intervals(m_config.m_fti_config, m_fti_intervals);
+    m_fti_start = MPI_Wtime();
+
+    // every probe is evaluated on every rank and the decision is agreed,
+    // as ranks added since the previous execution have no checkpoint
+    // of their own and restart with the others
+    int found = FTI_Status() != 0
+        || CkptFile::latest(m_config.m_native_dir, m_rank) >= 0
+        || CkptFile::latest(m_config.m_local_dir, m_rank) >= 0;
+    int any = 0;
+    MPI_Allreduce(&found, &any, 1, MPI_INT, MPI_MAX, m_comm);
+    int shared = latest_shared_();
+
+    if (restart && (any || shared >= 0)) {
         // recover from previous archive
         deserialize_();
     } else {
+        // native checkpoints of previous execution are not valid anymore
+        for (int id : CkptFile::list(m_config.m_native_dir, m_rank)) {
+            CkptFile::remove(m_config.m_native_dir, id, m_rank);
+        }
+        for (int id : CkptFile::list(m_config.m_local_dir, m_rank)) {
+            CkptFile::remove(m_config.m_local_dir, id, m_rank);
+        }
+        if (m_rank == 0) {
+            CkptShared::prune(m_config.m_native_dir, 0);
+        }
+
         // normal init
         // checkpoint id is assigned as follows
         // 0: checkpoint info
@@ -46,6 +217,14 @@ SDMT_Code SDMT::start_() {
 }
 
 SDMT_Code SDMT::finalize_() {
+    // flush checkpoint in flight, and its copy to global directory
+    m_async.wait();
+    m_drain.wait();
+    m_lazy.wait();
+
+    m_erasure.clear();
+    // a hook may hold objects of a language binding
+    m_flip_hook = FlipHook();
     FTI_Finalize();
     MPI_Finalize();
 
@@ -56,21 +235,19 @@ SDMT_Code SDMT::register_snapshot_(
         std::string name,
         SDMT_VT vt,
         SDMT_DT dt,
-        std::vector<int> dim) {
-    // check duplicated name in snapshot map
+        std::vector<int> dim,
+        const Options& opts) {
+    // check duplicated name in snapshot map, or names of SDMT's own
+    // such as the arena and shadows of compressed images, which carry '#'
     auto itr = m_snapshot_map.find(name);
-    if (itr != m_snapshot_map.end()) {
+    if (itr != m_snapshot_map.end()
+            || name.find('#') != std::string::npos) {
         return SDMT_ERR_DUPLICATED_NAME;
     }
 
-    // check the definition of data structure
-    if (dt < SDMT_SCALAR || dt >= SDMT_NUM_DT) {
-        return SDMT_ERR_WRONG_DATA_TYPE;
-    }
-
-    // check the definition of dimension
-    if (dim.size() != (int)dt) {
-        return SDMT_ERR_WRONG_DIMENSION;
+    SDMT_Code res = check_snapshot_(vt, dt, dim, opts);
+    if (res != SDMT_SUCCESS) {
+        return res;
     }
 
     // calculate the byte size of memory to allocate
@@ -79,33 +256,20 @@ SDMT_Code SDMT::register_snapshot_(
         size *= d;
     }
 
-    // allocate memory and register to checkpointing module
+    // allocate memory and register to checkpointing module,
+    // a small Snapshot is protected with the arena
     void* p = nullptr;
+    int64_t offset = -1;
     int esize;
+    FTIT_type* type = element_type(vt, esize);
+    if (type == nullptr) {
+        return SDMT_ERR_WRONG_VALUE_TYPE;
+    }
     try {
-        switch (vt) {
-            case SDMT_INT:
-                esize = sizeof(int);
-                p = std::malloc(size * esize);
-                FTI_Protect(m_cp_idx, p, size, FTI_INTG);
-                break;
-            case SDMT_LONG:
-                esize = sizeof(long);
-                p = std::malloc(size * esize);
-                FTI_Protect(m_cp_idx, p, size, FTI_LONG);
-                break;
-            case SDMT_FLOAT:
-                esize = sizeof(float);
-                p = std::malloc(size * esize);
-                FTI_Protect(m_cp_idx, p, size, FTI_SFLT);
-                break;
-            case SDMT_DOUBLE:
-                esize = sizeof(double);
-                p = std::malloc(size * esize);
-                FTI_Protect(m_cp_idx, p, size, FTI_DBLE);
-                break;
-            default:
-                return SDMT_ERR_WRONG_VALUE_TYPE;
+        p = arena_place_(size * esize, opts, offset);
+        if (p == nullptr) {
+            p = allocate_(size * esize, opts, prefault_(opts));
+            FTI_Protect(m_cp_idx, p, size, *type);
         }
     } catch (...) {
         return SDMT_ERR_FAILED_ALLOCATION;
@@ -113,7 +277,22 @@ SDMT_Code SDMT::register_snapshot_(
 
     if (p) {
         // register to sdmt manager
-        m_snapshot_map[name] = Snapshot(m_cp_idx++, vt, dt, dim, esize, p);
+        Snapshot snapshot(m_cp_idx, vt, dt, dim, esize, p, opts);
+        snapshot.m_offset = offset;
+        if (opts.m_double_buffer) {
+            snapshot.m_back = allocate_(size * esize, opts,
+                    prefault_(opts));
+            if (snapshot.m_back == nullptr) {
+                release_(snapshot);
+                return SDMT_ERR_FAILED_ALLOCATION;
+            }
+        }
+        m_snapshot_map[name] = snapshot;
+        m_cp_idx++;
+        rebuild_handles_();
+        if (offset >= 0) {
+            arena_layout_();
+        }
 
         // log current status
         serialize_();
@@ -124,6 +303,187 @@ SDMT_Code SDMT::register_snapshot_(
     }
 }
 
+SDMT_Code SDMT::register_external_(
+        std::string name,
+        void* ptr,
+        SDMT_VT vt,
+        SDMT_DT dt,
+        std::vector<int> dim,
+        std::vector<int> strides,
+        const Options& opts) {
+    // check duplicated name in snapshot map, or names of SDMT's own
+    // such as the arena and shadows of compressed images, which carry '#'
+    auto itr = m_snapshot_map.find(name);
+    if (itr != m_snapshot_map.end()
+            || name.find('#') != std::string::npos) {
+        return SDMT_ERR_DUPLICATED_NAME;
+    }
+
+    SDMT_Code res = check_snapshot_(vt, dt, dim, opts);
+    if (res != SDMT_SUCCESS) {
+        return res;
+    }
+
+    // the memory is not SDMT's to allocate, align, map, swap
+    // or write-protect
+    if (ptr == nullptr
+            || opts.m_alignment != 0
+            || opts.m_prefault
+            || opts.m_double_buffer
+            || opts.m_incremental == SDMT_IM_PAGE
+            || opts.m_huge_pages != SDMT_HP_NONE
+            || opts.m_placement != SDMT_NP_DEFAULT) {
+        return SDMT_ERR_WRONG_OPTION;
+    }
+
+    int esize;
+    FTIT_type* type = element_type(vt, esize);
+    if (type == nullptr) {
+        return SDMT_ERR_WRONG_VALUE_TYPE;
+    }
+
+    // a distributed Snapshot is exchanged in row major order
+    Snapshot snapshot(m_cp_idx, vt, dt, dim, esize, ptr, opts);
+    if (!strides.empty()) {
+        if (!dense(dim, esize, strides)
+                || (!opts.m_global.empty() && strides != snapshot.m_strides)) {
+            return SDMT_ERR_WRONG_DIMENSION;
+        }
+        snapshot.m_strides = strides;
+    }
+    snapshot.m_external = true;
+    FTI_Protect(m_cp_idx, ptr, snapshot.bytes() / esize, *type);
+
+    // register to sdmt manager
+    m_snapshot_map[name] = snapshot;
+    m_cp_idx++;
+    rebuild_handles_();
+
+    // log current status
+    serialize_();
+
+    return SDMT_SUCCESS;
+}
+
+SDMT_Code SDMT::rebind_(const std::string& name,
+        void* ptr,
+        const std::vector<int>* dim,
+        const std::vector<int>* strides) {
+    auto itr = m_snapshot_map.find(name);
+    if (itr == m_snapshot_map.end() || ptr == nullptr) {
+        return SDMT_ERR_WRONG_OPTION;
+    }
+
+    // a member of the arena or a Snapshot with two buffers or
+    // write-protected pages needs memory of SDMT
+    Snapshot& snapshot = itr->second;
+    const Options& opts = snapshot.m_options;
+    if (snapshot.m_offset >= 0 || opts.m_double_buffer
+            || opts.m_incremental == SDMT_IM_PAGE) {
+        return SDMT_ERR_WRONG_OPTION;
+    }
+
+    std::vector<int> cdim = dim != nullptr ? *dim : snapshot.m_dimension;
+    if (cdim.size() != snapshot.m_dimension.size()
+            || (!opts.m_global.empty()
+                && check_distribution_(cdim, opts) != SDMT_SUCCESS)) {
+        return SDMT_ERR_WRONG_DIMENSION;
+    }
+    Snapshot rebound(snapshot.m_id, snapshot.m_valuetype,
+            snapshot.m_datatype, cdim, snapshot.m_esize, ptr, opts);
+    if (strides != nullptr && !strides->empty()) {
+        if (!dense(cdim, snapshot.m_esize, *strides)
+                || (!opts.m_global.empty()
+                    && *strides != rebound.m_strides)) {
+            return SDMT_ERR_WRONG_DIMENSION;
+        }
+        rebound.m_strides = *strides;
+    } else if (dim == nullptr) {
+        rebound.m_strides = snapshot.m_strides;
+    }
+    rebound.m_external = true;
+
+    // memory of SDMT, as recovered at restart, is handed over
+    if (!snapshot.m_external) {
+        m_lazy.wait();
+        if (rebound.bytes() == snapshot.bytes()
+                && rebound.m_strides == snapshot.m_strides) {
+            std::memcpy(ptr, snapshot.m_ptr, snapshot.bytes());
+        }
+        release_(snapshot);
+    }
+
+    int esize;
+    FTIT_type* type = element_type(rebound.m_valuetype, esize);
+    if (type != nullptr) {
+        FTI_Protect(rebound.m_id, ptr, rebound.bytes() / esize, *type);
+        m_packed.erase(rebound.m_id);
+    }
+    snapshot = rebound;
+
+    // log current status
+    serialize_();
+
+    return SDMT_SUCCESS;
+}
+
+SDMT_Code SDMT::check_snapshot_(SDMT_VT vt,
+        SDMT_DT dt,
+        const std::vector<int>& dim,
+        const Options& opts) {
+    // check the definition of data structure
+    if (dt < SDMT_SCALAR || dt >= SDMT_NUM_DT) {
+        return SDMT_ERR_WRONG_DATA_TYPE;
+    }
+
+    // check the definition of dimension
+    if (dim.size() != (int)dt) {
+        return SDMT_ERR_WRONG_DIMENSION;
+    }
+
+    // check optional attributes
+    if (opts.m_incremental < SDMT_IM_NONE
+            || opts.m_incremental > SDMT_IM_HASH
+            || opts.m_codec < SDMT_CC_NONE
+            || opts.m_codec > SDMT_CC_LOSSY
+            || opts.m_huge_pages < SDMT_HP_NONE
+            || opts.m_huge_pages > SDMT_HP_EXPLICIT
+            || opts.m_placement < SDMT_NP_DEFAULT
+            || opts.m_placement > SDMT_NP_FIRST_TOUCH) {
+        return SDMT_ERR_WRONG_OPTION;
+    }
+    if (opts.m_placement == SDMT_NP_BIND && (opts.m_numa_node < 0
+                || opts.m_numa_node >= NumaPlacement::nodes())) {
+        return SDMT_ERR_WRONG_OPTION;
+    }
+    if (opts.m_alignment & (opts.m_alignment - 1)) {
+        return SDMT_ERR_WRONG_OPTION;
+    }
+
+    // dirty pages are tracked in one buffer only
+    if (opts.m_double_buffer && opts.m_incremental == SDMT_IM_PAGE) {
+        return SDMT_ERR_WRONG_OPTION;
+    }
+
+    // a distributed Snapshot holds the part of this rank
+    if (!opts.m_global.empty()) {
+        SDMT_Code res = check_distribution_(dim, opts);
+        if (res != SDMT_SUCCESS) {
+            return res;
+        }
+    }
+
+    // lossy compression needs a positive bound on floating point values,
+    // and a delta of it would accumulate errors
+    if (opts.m_codec == SDMT_CC_LOSSY
+            && (!(opts.m_error_bound > 0)
+                || (vt != SDMT_FLOAT && vt != SDMT_DOUBLE)
+                || opts.m_incremental != SDMT_IM_NONE)) {
+        return SDMT_ERR_WRONG_OPTION;
+    }
+    return SDMT_SUCCESS;
+}
+
 SDMT_Code SDMT::change_snapshot_(
         std::string name,
         SDMT_VT cvt,
@@ -134,13 +494,19 @@ SDMT_Code SDMT::change_snapshot_(
 	if (itr == m_snapshot_map.end()){
 		return SDMT_ERR_FAILED_ALLOCATION;
 	}
-    if (cdt < SDMT_SCALAR || cdt >= SDMT_NUM_DT) {
-        return SDMT_ERR_WRONG_DATA_TYPE;
+
+    // memory of the application is not reallocated by SDMT,
+    // the application binds new memory by rebind()
+    if (itr->second.m_external) {
+        return SDMT_ERR_WRONG_OPTION;
     }
 
-    // check the definition of dimension
-    if (cdim.size() != (int)cdt) {
-        return SDMT_ERR_WRONG_DIMENSION;
+    // the changed Snapshot keeps its options, which must still hold,
+    // e.g. lossy compression of floating point values only. the
+    // dimension of a distributed Snapshot is fixed by its global shape
+    SDMT_Code res = check_snapshot_(cvt, cdt, cdim, itr->second.m_options);
+    if (res != SDMT_SUCCESS) {
+        return res;
     }
 
     // calculate the byte size of memory to allocate
@@ -152,50 +518,61 @@ SDMT_Code SDMT::change_snapshot_(
 	void* p = nullptr;
 	SDMT::Snapshot sg = itr->second;
 	int32_t m_id = sg.m_id;
-    //p = sg.m_ptr;
-	free(sg.m_ptr);
     int esize;
+    FTIT_type* type = element_type(cvt, esize);
+    if (type == nullptr) {
+        return SDMT_ERR_WRONG_VALUE_TYPE;
+    }
+    // a member of the arena keeps its slot if it still fits, or takes
+    // another one. a Snapshot with memory of its own is protected by id
+    // already and stays out of the arena
+    int64_t offset = -1;
     try {
-        switch (cvt) {
-            case SDMT_INT:
-                esize = sizeof(int);
-				p = std::malloc(csize*esize);
-                FTI_Protect(m_id, p, csize, FTI_INTG);
-                break;
-            case SDMT_LONG:
-                esize = sizeof(long);
-				p = std::malloc(csize*esize);
-                FTI_Protect(m_id, p, csize, FTI_LONG);
-                break;
-            case SDMT_FLOAT:
-                esize = sizeof(float);
-				p = std::malloc(csize*esize);
-                FTI_Protect(m_id, p, csize, FTI_SFLT);
-                break;
-            case SDMT_DOUBLE:
-                esize = sizeof(double);
-				p = std::malloc(csize*esize);
-                FTI_Protect(m_id, p, csize, FTI_DBLE);
-                break;
-            default:
-                return SDMT_ERR_WRONG_VALUE_TYPE;
+        if (sg.m_offset >= 0 && csize * esize <= sg.bytes()) {
+            offset = sg.m_offset;
+            p = reinterpret_cast<char*>(m_arena.m_ptr) + offset;
+        } else if (sg.m_offset >= 0) {
+            p = arena_place_(csize * esize, sg.m_options, offset);
+        }
+        if (p == nullptr) {
+            p = allocate_(csize*esize, sg.m_options,
+                    prefault_(sg.m_options));
         }
     } catch (...) {
         return SDMT_ERR_FAILED_ALLOCATION;
     }
-	
-	if (p) {
-        // register to sdmt manager
-		m_snapshot_map.erase(name);
-        m_snapshot_map[name] = Snapshot(m_id, cvt, cdt, cdim, esize, p);
-
-        // log current status
-        serialize_();
-
-        return SDMT_SUCCESS;
-    } else {
+    if (p == nullptr) {
         return SDMT_ERR_FAILED_ALLOCATION;
     }
+
+    // every buffer is allocated before the old ones are released,
+    // so a failure leaves the Snapshot as it was
+    Snapshot snapshot(m_id, cvt, cdt, cdim, esize, p, sg.m_options);
+    snapshot.m_offset = offset;
+    if (sg.m_options.m_double_buffer) {
+        snapshot.m_back = allocate_(csize * esize, sg.m_options,
+                prefault_(sg.m_options));
+        if (snapshot.m_back == nullptr) {
+            release_(snapshot);
+            return SDMT_ERR_FAILED_ALLOCATION;
+        }
+    }
+    if (offset < 0) {
+        FTI_Protect(m_id, p, csize, *type);
+    }
+	release_(sg);
+    // FTI points at the new memory now, not at the compressed image
+    m_packed.erase(m_id);
+
+    // register to sdmt manager, in place so handles stay valid
+    itr->second = snapshot;
+    rebuild_handles_();
+    arena_layout_();
+
+    // log current status
+    serialize_();
+
+    return SDMT_SUCCESS;
 }
 
 SDMT_Code SDMT::register_int_parameter_(
@@ -394,7 +771,50 @@ double SDMT::get_double_parameter_(
     return 0;
 }
 
-SDMT_Code SDMT::checkpoint_(int level) {
+SDMT_Code SDMT::checkpoint_(int level, bool async) {
+    // pages not faulted in yet are not seen by a forked writer,
+    // and a checkpoint must not save pages that failed to load
+    if (!m_lazy.wait()) {
+        return SDMT_ERR_FAILED_RECOVERY;
+    }
+
+    // a restart reads this checkpoint as written by the ranks of now
+    MPI_Comm_size(m_comm, &m_ckpt_ranks);
+
+    if (async || m_config.m_backend == Config::NATIVE) {
+        return checkpoint_native_(level, async);
+    }
+    if (m_config.m_backend == Config::MPIIO) {
+        return checkpoint_shared_(level);
+    }
+
+    // FTI_Snapshot decides the level only after the images are handed
+    // over, so with compressed Snapshots its schedule is followed here
+    // and they are compressed only when a checkpoint is due
+    if (level == 0) {
+        for (auto& itr : stored_()) {
+            if (itr.second->m_options.m_codec != SDMT_CC_NONE) {
+                level = snapshot_level_();
+                if (level == 0) {
+                    return SDMT_SUCCESS;
+                }
+                break;
+            }
+        }
+    }
+
+    // compressed Snapshots are handed to FTI as compressed images
+    uint64_t rawsize = 0;
+    uint64_t size = 0;
+    if (level >= 0 && level <= 4) {
+        for (auto& itr : stored_()) {
+            Snapshot& snapshot = *itr.second;
+            rawsize += snapshot.bytes();
+            size += (snapshot.m_options.m_codec == SDMT_CC_NONE)
+                ? snapshot.bytes() : pack_(snapshot);
+        }
+    }
+
     // 0 level : frequency checkpoint
     if ( level == 0 ) {
         int res = FTI_Snapshot();
@@ -411,6 +831,13 @@ SDMT_Code SDMT::checkpoint_(int level) {
     else {
         int res = FTI_Checkpoint(m_cp_info.id, level);
         if (res == 0) {
+            // FTI writes every snapshot as a whole
+            m_stats = CkptStats();
+            m_stats.m_id = m_cp_info.id;
+            m_stats.m_rawsize = rawsize;
+            m_stats.m_size = size;
+
+            m_fti_id = m_cp_info.id;
             m_cp_info.id++;
             // log current status
             serialize_();
@@ -421,118 +848,1709 @@ SDMT_Code SDMT::checkpoint_(int level) {
     return SDMT_ERR_FAILED_CHECKPOINT;
 }
 
-SDMT_Code SDMT::recover_() {
-    FTI_Recover();
+SDMT_Code SDMT::wait_checkpoint_() {
+    if (m_async.wait() == SDMT_CKPT_FAILED) {
+        return SDMT_ERR_FAILED_CHECKPOINT;
+    }
     return SDMT_SUCCESS;
 }
 
-bool SDMT::exist_(std::string name) {
-    auto itr = m_snapshot_map.find(name);
-    if (itr == m_snapshot_map.end()) {
-        return false;
-    } else {
-        return true;
-    }
+SDMT_CS SDMT::checkpoint_status_() {
+    return m_async.status();
 }
 
-SDMT::Snapshot SDMT::get_snapshot_(std::string name) {
-    auto itr = m_snapshot_map.find(name);
-    if (itr == m_snapshot_map.end()) {
-        return Snapshot();
+SDMT_Code SDMT::wait_drain_() {
+    // a copy is queued once the asynchronous checkpoint is written
+    m_async.wait();
+    if (!m_drain.wait()) {
+        return SDMT_ERR_FAILED_CHECKPOINT;
     }
-    return itr->second;
+    return SDMT_SUCCESS;
 }
 
-int32_t& SDMT::iter_() {
-    return m_iter;
+SDMT_Code SDMT::wait_recovery_() {
+    if (!m_lazy.wait()) {
+        return SDMT_ERR_FAILED_RECOVERY;
+    }
+    return SDMT_SUCCESS;
 }
 
-int32_t SDMT::next_() {
-    return ++m_iter;
+SDMT::CkptStats SDMT::checkpoint_stats_() {
+    return m_stats;
 }
 
-MPI_Comm SDMT::comm_() {
-    return m_comm;
+SDMT::RecoveryStats SDMT::recovery_stats_() {
+    return m_recovery;
 }
 
-
-int* SDMT::intptr_(std::string name) {
+SDMT_Code SDMT::flip_(std::string name) {
     auto itr = m_snapshot_map.find(name);
-    if (itr== m_snapshot_map.end()) {
-        return nullptr;
+    if (itr == m_snapshot_map.end() || itr->second.m_back == nullptr) {
+        return SDMT_ERR_WRONG_OPTION;
     }
 
-    return reinterpret_cast<int*>(itr->second.m_ptr);
+    // the back buffer may be the one being written
+    m_async.wait();
+    swap_buffers_(name, itr->second);
+    return SDMT_SUCCESS;
 }
 
-long* SDMT::longptr_(std::string name) {
-    auto itr = m_snapshot_map.find(name);
-    if (itr == m_snapshot_map.end()) {
-        return nullptr;
-    }
-
-    return reinterpret_cast<long*>(itr->second.m_ptr);
+void SDMT::set_flip_hook_(FlipHook hook) {
+    m_flip_hook = hook;
 }
 
-float* SDMT::floatptr_(std::string name) {
-    auto itr = m_snapshot_map.find(name);
-    if (itr == m_snapshot_map.end()) {
-        return nullptr;
+void SDMT::swap_buffers_(const std::string& name, Snapshot& snapshot) {
+    std::swap(snapshot.m_ptr, snapshot.m_back);
+
+    // FTI checkpoints the active buffer
+    size_t count = snapshot.bytes() / snapshot.m_esize;
+    int esize;
+    FTIT_type* type = element_type(snapshot.m_valuetype, esize);
+    if (type != nullptr) {
+        FTI_Protect(snapshot.m_id, snapshot.m_ptr, count, *type);
     }
 
-    return reinterpret_cast<float*>(itr->second.m_ptr);
+    if (m_flip_hook) {
+        m_flip_hook(name, snapshot.m_ptr);
+    }
 }
 
-double* SDMT:: doubleptr_(std::string name) {
-    auto itr = m_snapshot_map.find(name);
-    if (itr == m_snapshot_map.end()) {
-        return nullptr;
+SDMT_Code SDMT::checkpoint_native_(int level, bool async) {
+    if (level < 0 || level > 4) {
+        return SDMT_ERR_FAILED_CHECKPOINT;
     }
 
-    return reinterpret_cast<double*>(itr->second.m_ptr);
-}
+    // shadow buffers are reused, so the previous checkpoint
+    // has to be drained before staging
+    if (m_async.wait() == SDMT_CKPT_FAILED) {
+        // deltas must not refer to a checkpoint which was not written
+        for (auto& itr : stored_()) {
+            itr.second->m_base = -1;
+        }
+    }
 
-bool SDMT::load_config_(std::string config) { 
-    namespace xml = tinyxml2;
-    xml::XMLDocument doc;
-    xml::XMLError err;
-    xml::XMLNode* node;
-    xml::XMLElement* element;
+    // checkpoints are written to the node-local directory if any
+    CkptAsync::Job job;
+    bool staging = !m_config.m_local_dir.empty();
+    job.m_dir = staging ? m_config.m_local_dir : m_config.m_native_dir;
+    job.m_retention = staging
+        ? CkptFile::Retention(kNativeKeep) : m_config.m_retention;
+    job.m_direct = m_config.m_direct_io;
+    job.m_tuning = m_config.m_direct;
+    job.m_fork = async && m_config.m_async_mode == Config::FORK;
+    job.m_written = false;
+    job.m_shared = false;
+    job.m_header.m_id = m_cp_info.id;
+    job.m_header.m_level = level;
+    job.m_header.m_iter = m_iter;
+    job.m_header.m_rank = m_rank;
+    job.m_header.m_time = std::chrono::duration<double>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+
+    // stage snapshots, asynchronous checkpoint copies them
+    // unless a forked child sees them as of now,
+    // or the application goes on in the other buffer
+    CkptStats stats;
+    stats.m_id = job.m_header.m_id;
+    std::vector<std::string> flipped;
+    for (auto& itr : stored_()) {
+        CkptFile::Record record;
+        bool flip = async && !job.m_fork && itr.second->m_back != nullptr;
+        stage_(itr.first, *itr.second, job.m_header.m_id,
+                async && !job.m_fork && !flip, record);
+        job.m_records.push_back(record);
+        if (flip) {
+            flipped.push_back(itr.first);
+        }
 
-    // load config file
-    err = doc.LoadFile(config.c_str());
-    if (err != 0) {
-        return false;
+        stats.m_rawsize += record.m_rawsize;
+        stats.m_size += record.m_size;
     }
 
-    // get root node
-    node = doc.FirstChild();
-    
-    // get path for sdmt archive
-    element = node->FirstChildElement("ArchivePath");
-    if (element == nullptr) {
-        return false;
-    } else {
-        m_config.m_archive = element->GetText();
+    // a synchronous checkpoint is written here, and old checkpoints
+    // are dropped in background after either
+    if (!async) {
+        if (!m_async.write(job)) {
+            for (auto& itr : stored_()) {
+                itr.second->m_base = -1;
+            }
+            return SDMT_ERR_FAILED_CHECKPOINT;
+        }
+        job.m_written = true;
+        job.m_records.clear();
     }
-
-    // get path for fti_config
-    element = node->FirstChildElement("FTIConfig");
-    if (element == nullptr) {
-        return false;
-    } else {
-        m_config.m_fti_config = element->GetText();
+    if (staging) {
+        int id = job.m_header.m_id;
+        job.m_done = [this, id]() { drain_(id); };
     }
-
-    // get path for parameter file
-    element = node->FirstChildElement("ParamPath");
-    if (element == nullptr) {
-        return false;
-    } else {
-        m_config.m_param_path = element->GetText();
+    m_async.submit(job);
+    for (auto& name : flipped) {
+        swap_buffers_(name, m_snapshot_map[name]);
     }
 
-    return true;
+    m_stats = stats;
+    m_cp_info.id++;
+
+    // log current status
+    serialize_();
+
+    return SDMT_SUCCESS;
+}
+
+SDMT_Code SDMT::checkpoint_shared_(int level) {
+    if (level < 0 || level > 4) {
+        return SDMT_ERR_FAILED_CHECKPOINT;
+    }
+
+    // shadow buffers are reused
+    m_async.wait();
+
+    CkptFile::Header header;
+    header.m_id = m_cp_info.id;
+    header.m_level = level;
+    header.m_iter = m_iter;
+    header.m_rank = m_rank;
+    header.m_time = std::chrono::duration<double>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+
+    // a shared file holds full images only,
+    // deltas of native checkpoints never refer to it
+    CkptStats stats;
+    stats.m_id = header.m_id;
+    std::vector<CkptFile::Record> records;
+    for (auto& itr : stored_()) {
+        CkptFile::Record record;
+        itr.second->m_base = -1;
+        stage_(itr.first, *itr.second, header.m_id, false, record);
+        itr.second->m_base = -1;
+        records.push_back(record);
+
+        stats.m_rawsize += record.m_rawsize;
+        stats.m_size += record.m_size;
+    }
+
+    CkptFile::make_dir(m_config.m_native_dir);
+    if (!CkptShared::write(m_comm,
+                CkptShared::path(m_config.m_native_dir, header.m_id),
+                header, records, m_config.m_mpiio)) {
+        return SDMT_ERR_FAILED_CHECKPOINT;
+    }
+
+    // old shared files are dropped by rank 0 in background
+    CkptAsync::Job job;
+    job.m_dir = m_config.m_native_dir;
+    job.m_header = header;
+    job.m_retention = m_config.m_retention;
+    job.m_direct = false;
+    job.m_fork = false;
+    job.m_written = true;
+    job.m_shared = true;
+    m_async.submit(job);
+
+    m_stats = stats;
+    m_cp_info.id++;
+
+    // log current status
+    serialize_();
+
+    return SDMT_SUCCESS;
+}
+
+void SDMT::drain_(int id) {
+    m_drain.submit(m_config.m_local_dir, m_config.m_native_dir, id, m_rank,
+            m_config.m_retention, m_config.m_drain_bandwidth * 1e6);
+}
+
+std::string SDMT::native_path_(int id, int rank) {
+    if (!m_config.m_local_dir.empty()) {
+        std::string local = CkptFile::path(m_config.m_local_dir, id, rank);
+        if (::access(local.c_str(), R_OK) == 0) {
+            return local;
+        }
+    }
+    return CkptFile::path(m_config.m_native_dir, id, rank);
+}
+
+void SDMT::stage_(const std::string& name,
+        Snapshot& snapshot,
+        int id,
+        bool copy,
+        CkptFile::Record& record) {
+    record.m_name = name;
+    record.m_id = snapshot.m_id;
+    record.m_valuetype = snapshot.m_valuetype;
+    record.m_rawsize = snapshot.bytes();
+
+    // find blocks written since the previous checkpoint
+    std::vector<uint64_t> blocks;
+    size_t block = 0;
+    bool delta = false;
+    switch (snapshot.m_options.m_incremental) {
+        case SDMT_IM_PAGE:
+            block = DirtyPages::page_size();
+            delta = DirtyPages::collect(snapshot.m_ptr, blocks);
+            break;
+        case SDMT_IM_HASH:
+            block = m_config.m_block_size;
+            delta = changed_blocks_(snapshot, block, blocks);
+            break;
+        default:
+            break;
+    }
+
+    // periodic full checkpoint bounds the chain to restore
+    delta = delta && snapshot.m_base >= 0
+        && snapshot.m_chain + 1 < m_config.m_full_interval;
+
+    if (delta) {
+        record.m_encoding = CkptFile::ENC_DELTA;
+        record.m_base = snapshot.m_base;
+        record.m_size = Delta::size(record.m_rawsize, block, blocks);
+
+        void* buf = m_async.shadow(name, record.m_size);
+        Delta::encode(snapshot.m_ptr, record.m_rawsize, block, blocks, buf);
+        record.m_data = buf;
+        snapshot.m_chain++;
+    } else {
+        record.m_encoding = CkptFile::ENC_FULL;
+        record.m_base = -1;
+        record.m_size = record.m_rawsize;
+
+        // compression below copies Snapshot memory anyway
+        if (copy && snapshot.m_options.m_codec == SDMT_CC_NONE) {
+            void* buf = m_async.shadow(name, record.m_size);
+            std::memcpy(buf, snapshot.m_ptr, record.m_size);
+            record.m_data = buf;
+        } else {
+            record.m_data = snapshot.m_ptr;
+        }
+        snapshot.m_chain = 0;
+    }
+
+    if (snapshot.m_options.m_codec != SDMT_CC_NONE) {
+        void* buf = m_async.shadow(name + "#codec",
+                Codec::bound(record.m_size));
+        record.m_size = Codec::compress(snapshot.m_options.m_codec,
+                snapshot.m_esize, record.m_data, record.m_size, buf,
+                m_config.m_compress_threads,
+                snapshot.m_options.m_error_bound);
+        record.m_data = buf;
+        record.m_codec = snapshot.m_options.m_codec;
+    }
+
+    snapshot.m_base = id;
+}
+
+bool SDMT::changed_blocks_(Snapshot& snapshot,
+        size_t block,
+        std::vector<uint64_t>& blocks) {
+    const char* p = reinterpret_cast<const char*>(snapshot.m_ptr);
+    size_t rawsize = snapshot.bytes();
+    size_t nblocks = (rawsize + block - 1) / block;
+
+    // hashes of the previous checkpoint,
+    // without them every block is reported as changed
+    std::vector<uint64_t>& hashes = m_hashes[snapshot.m_id];
+    bool valid = hashes.size() == nblocks;
+    hashes.resize(nblocks);
+
+    blocks.clear();
+    for (size_t b = 0; b < nblocks; b++) {
+        size_t n = std::min(block, rawsize - b * block);
+        uint64_t h = XXH64::hash(p + b * block, n);
+        if (!valid || h != hashes[b]) {
+            hashes[b] = h;
+            blocks.push_back(b);
+        }
+    }
+    return valid;
+}
+
+SDMT_Code SDMT::recover_(const std::set<std::string>& names, bool lazy,
+        int id) {
+    auto start = std::chrono::steady_clock::now();
+    m_recovery = RecoveryStats();
+    m_recovery.m_threads = parallel::concurrency(m_config.m_recover_threads);
+
+    // members of the arena are recovered with the arena,
+    // into a copy of it unless every Snapshot is recovered,
+    // and taken from their offsets in the layout saved with it
+    std::set<std::string> stored;
+    std::vector<Snapshot*> members;
+    for (auto& name : names) {
+        auto itr = m_snapshot_map.find(name);
+        if (itr != m_snapshot_map.end() && itr->second.m_offset >= 0) {
+            members.push_back(&itr->second);
+            stored.insert(kArena);
+        } else {
+            stored.insert(name);
+        }
+    }
+    void* arena = m_arena.m_ptr;
+    std::vector<long> copy;
+    if (!members.empty()) {
+        copy.resize(m_arena.bytes() / sizeof(long));
+        m_arena.m_ptr = copy.data();
+        FTI_Protect(m_arena.m_id, m_arena.m_ptr, copy.size(), FTI_LONG);
+    }
+
+    SDMT_Code res = (id < 0)
+        ? recover_latest_(stored, lazy) : recover_checkpoint_(id);
+
+    if (!members.empty()) {
+        m_arena.m_ptr = arena;
+        FTI_Protect(m_arena.m_id, m_arena.m_ptr, copy.size(), FTI_LONG);
+        if (res == SDMT_SUCCESS && !arena_restore_(
+                    reinterpret_cast<const char*>(copy.data()), members)) {
+            res = SDMT_ERR_FAILED_RECOVERY;
+        }
+    } else if (names.empty() && res == SDMT_SUCCESS) {
+        res = arena_relocate_();
+    } else if (names.empty()) {
+        arena_layout_();
+    }
+    m_recovery.m_restore = elapsed(start);
+    return res;
+}
+
+SDMT_Code SDMT::recover_snapshots_(const std::vector<std::string>& names) {
+    std::set<std::string> chosen;
+    for (auto& name : names) {
+        if (m_snapshot_map.find(name) == m_snapshot_map.end()) {
+            return SDMT_ERR_FAILED_RECOVERY;
+        }
+        chosen.insert(name);
+    }
+    if (chosen.empty()) {
+        return SDMT_SUCCESS;
+    }
+    return recover_(chosen, false, -1);
+}
+
+SDMT_Code SDMT::recover_latest_(const std::set<std::string>& names,
+        bool lazy) {
+    // checkpoint in flight may be the newest one
+    m_async.wait();
+    m_lazy.wait();
+    prepare_recovery_(names);
+
+    // the checkpoint was written by a different number of ranks
+    int ranks;
+    MPI_Comm_size(m_comm, &ranks);
+    if (m_ckpt_ranks != ranks) {
+        return recover_redistributed_(names, -1);
+    }
+
+    // recover from whichever of native, shared and FTI checkpoint is newer
+    int native = latest_native_();
+    int shared = latest_shared_();
+    if (shared >= 0 && shared > native && shared > m_fti_id) {
+        return recover_shared_(shared, names);
+    }
+    if (native >= 0 && native > m_fti_id) {
+        return recover_native_(native, names, lazy);
+    }
+    return recover_fti_(names);
+}
+
+SDMT_Code SDMT::recover_checkpoint_(int id) {
+    m_async.wait();
+    m_lazy.wait();
+    std::set<std::string> names;
+    prepare_recovery_(names);
+
+    int ranks;
+    MPI_Comm_size(m_comm, &ranks);
+    if (m_ckpt_ranks != ranks) {
+        return recover_redistributed_(names, id);
+    }
+
+    // native files of every rank, a shared file, or the last one of FTI
+    int local = ::access(native_path_(id, m_rank).c_str(), R_OK) == 0;
+    int native = 0;
+    MPI_Allreduce(&local, &native, 1, MPI_INT, MPI_MIN, m_comm);
+    if (native) {
+        return recover_native_(id, names, false);
+    }
+    std::vector<int> ids = CkptShared::list(m_config.m_native_dir);
+    local = std::find(ids.begin(), ids.end(), id) != ids.end();
+    int shared = 0;
+    MPI_Allreduce(&local, &shared, 1, MPI_INT, MPI_MIN, m_comm);
+    if (shared) {
+        return recover_shared_(id, names);
+    }
+    if (id == m_fti_id) {
+        return recover_fti_(names);
+    }
+    return SDMT_ERR_FAILED_RECOVERY;
+}
+
+std::vector<SDMT::CatalogEntry> SDMT::catalog_() {
+    // old checkpoints are being dropped after the last checkpoint
+    m_async.wait();
+
+    // checkpoints of this rank, native files first
+    std::map<int, CatalogEntry> found;
+    auto add = [&found](const CkptFile::Header& header,
+            const std::vector<CkptFile::Record>& records) {
+        CatalogEntry& entry = found[header.m_id];
+        entry.m_id = header.m_id;
+        entry.m_level = header.m_level;
+        entry.m_iter = header.m_iter;
+        entry.m_time = header.m_time;
+        for (auto& record : records) {
+            entry.m_rawsize += record.m_rawsize;
+            entry.m_size += record.m_size;
+        }
+    };
+    CkptFile::Header header;
+    std::vector<CkptFile::Record> records;
+    std::vector<int> ids = CkptFile::list(m_config.m_native_dir, m_rank);
+    std::vector<int> staged = CkptFile::list(m_config.m_local_dir, m_rank);
+    ids.insert(ids.end(), staged.begin(), staged.end());
+    for (int id : ids) {
+        if (found.count(id) == 0 && CkptFile::read_index(
+                    native_path_(id, m_rank), header, records)) {
+            add(header, records);
+        }
+    }
+    for (int id : CkptShared::list(m_config.m_native_dir)) {
+        if (found.count(id) == 0 && CkptShared::read_index(
+                    CkptShared::path(m_config.m_native_dir, id), m_rank,
+                    header, records)) {
+            add(header, records);
+        }
+    }
+
+    // ids every rank has are among the few retained by rank 0,
+    // so only those are agreed on whatever the ids have grown to
+    std::vector<int> common;
+    for (auto& itr : found) {
+        common.push_back(itr.first);
+    }
+    int count = static_cast<int>(common.size());
+    MPI_Bcast(&count, 1, MPI_INT, 0, m_comm);
+    common.resize(count);
+    MPI_Bcast(common.data(), count, MPI_INT, 0, m_comm);
+    std::vector<int> has(count, 0);
+    for (int i = 0; i < count; i++) {
+        has[i] = found.count(common[i]) ? 1 : 0;
+    }
+    MPI_Allreduce(MPI_IN_PLACE, has.data(), count, MPI_INT, MPI_MIN,
+            m_comm);
+
+    std::vector<CatalogEntry> entries;
+    for (int i = 0; i < count; i++) {
+        if (has[i]) {
+            entries.push_back(found[common[i]]);
+        }
+    }
+    return entries;
+}
+
+SDMT_Code SDMT::recover_fti_(const std::set<std::string>& names) {
+    // compressed Snapshots are recovered as compressed images
+    std::vector<Snapshot*> packed;
+    std::vector<Snapshot*> chosen;
+    for (auto& itr : stored_()) {
+        Snapshot& snapshot = *itr.second;
+        if (!names.empty() && names.count(itr.first) == 0) {
+            continue;
+        }
+        chosen.push_back(&snapshot);
+        if (snapshot.m_options.m_codec == SDMT_CC_NONE) {
+            continue;
+        }
+        long size = FTI_GetStoredSize(snapshot.m_id);
+        if (size > 0) {
+            std::vector<char>& buf = m_packed[snapshot.m_id];
+            buf.resize(size);
+            FTI_Protect(snapshot.m_id, buf.data(), size, FTI_CHAR);
+            packed.push_back(&snapshot);
+        }
+    }
+
+    if (names.empty()) {
+        FTI_Recover();
+    } else {
+        // other variables of the checkpoint are not read
+        for (auto snapshot : chosen) {
+            if (FTI_RecoverVar(snapshot->m_id) != FTI_SCES) {
+                return SDMT_ERR_FAILED_RECOVERY;
+            }
+        }
+    }
+
+    std::atomic<bool> ok(true);
+    parallel::for_each(m_config.m_recover_threads, packed.size(),
+            [&](size_t i) {
+        if (!unpack_(*packed[i])) {
+            ok = false;
+        }
+    });
+    return ok ? SDMT_SUCCESS : SDMT_ERR_FAILED_RECOVERY;
+}
+
+SDMT_Code SDMT::checkpoint_memory_() {
+    if (!m_ring.save(regions_(), m_config.m_memory_slots, m_iter)) {
+        return SDMT_ERR_FAILED_CHECKPOINT;
+    }
+    return SDMT_SUCCESS;
+}
+
+SDMT_Code SDMT::rollback_(int k) {
+    // writes to incremental Snapshots are tracked as usual
+    if (!m_ring.load(k, regions_(), m_iter)) {
+        return SDMT_ERR_FAILED_RECOVERY;
+    }
+    return arena_relocate_();
+}
+
+SDMT_Code SDMT::checkpoint_partner_() {
+    if (!m_partner.save(m_comm, regions_(), m_iter)) {
+        return SDMT_ERR_FAILED_CHECKPOINT;
+    }
+    return SDMT_SUCCESS;
+}
+
+SDMT_Code SDMT::recover_partner_() {
+    if (!m_partner.load(m_comm, regions_(), m_iter)) {
+        return SDMT_ERR_FAILED_RECOVERY;
+    }
+    return arena_relocate_();
+}
+
+SDMT_Code SDMT::checkpoint_erasure_() {
+    if (!m_erasure.encode(m_comm, regions_(), m_config.m_erasure_group,
+                m_config.m_erasure_parity, m_iter)) {
+        return SDMT_ERR_FAILED_CHECKPOINT;
+    }
+    return SDMT_SUCCESS;
+}
+
+SDMT_Code SDMT::recover_erasure_() {
+    if (!m_erasure.decode(m_comm, regions_(), m_config.m_erasure_group,
+                m_config.m_erasure_parity, m_iter)) {
+        return SDMT_ERR_FAILED_RECOVERY;
+    }
+    return arena_relocate_();
+}
+
+std::vector<CkptRing::Region> SDMT::regions_() {
+    std::vector<CkptRing::Region> regions;
+    for (auto& itr : stored_()) {
+        Snapshot& snapshot = *itr.second;
+        regions.push_back(CkptRing::Region{snapshot.m_id, snapshot.m_ptr,
+                snapshot.bytes()});
+    }
+    std::sort(regions.begin(), regions.end(),
+            [](const CkptRing::Region& a, const CkptRing::Region& b) {
+                return a.m_id < b.m_id;
+            });
+    return regions;
+}
+
+int SDMT::snapshot_level_() {
+    // as FTI_Snapshot, once a minute the highest level whose interval
+    // divides the minutes since init, and the clock of rank 0 decides
+    // as every rank has to enter FTI_Checkpoint
+    int level = 0;
+    if (m_rank == 0) {
+        long minute = static_cast<long>((MPI_Wtime() - m_fti_start) / 60);
+        for (int i = 4; i >= 1 && minute > m_fti_minute; i--) {
+            int interval = m_fti_intervals[i - 1];
+            if (interval > 0 && minute % interval == 0) {
+                level = i;
+                break;
+            }
+        }
+        m_fti_minute = minute;
+    }
+    MPI_Bcast(&level, 1, MPI_INT, 0, m_comm);
+    return level;
+}
+
+size_t SDMT::pack_(Snapshot& snapshot) {
+    // capacity is kept, so reallocation happens only when it grows
+    std::vector<char>& buf = m_packed[snapshot.m_id];
+    buf.resize(Codec::bound(snapshot.bytes()));
+    size_t size = Codec::compress(snapshot.m_options.m_codec,
+            snapshot.m_esize, snapshot.m_ptr, snapshot.bytes(), buf.data(),
+            m_config.m_compress_threads, snapshot.m_options.m_error_bound);
+    buf.resize(size);
+
+    FTI_Protect(snapshot.m_id, buf.data(), size, FTI_CHAR);
+    return size;
+}
+
+bool SDMT::unpack_(Snapshot& snapshot) {
+    // called on several threads, so the map is not modified
+    const std::vector<char>& buf = m_packed.at(snapshot.m_id);
+    size_t size = 0;
+    double error = 0;
+    return Codec::decoded_size(buf.data(), buf.size(), size)
+        && size == snapshot.bytes()
+        && Codec::decompress(buf.data(), buf.size(), snapshot.m_ptr, size,
+                m_config.m_compress_threads, &error)
+        && error <= snapshot.m_options.m_error_bound;
+}
+
+SDMT_Code SDMT::recover_native_(int id, const std::set<std::string>& names,
+        bool lazy) {
+    std::string path = native_path_(id, m_rank);
+    CkptFile::Header header;
+    std::vector<CkptFile::Record> records;
+    if (!CkptFile::read_index(path, header, records)
+            || !select_(names, records)) {
+        return SDMT_ERR_FAILED_RECOVERY;
+    }
+
+    std::vector<Snapshot*> targets;
+    for (auto& record : records) {
+        Snapshot* snapshot = stored_(record.m_name);
+        if (snapshot == nullptr || snapshot->bytes() != record.m_rawsize) {
+            return SDMT_ERR_FAILED_RECOVERY;
+        }
+        targets.push_back(snapshot);
+    }
+
+    // raw images are left to be faulted in, the others are restored now
+    std::vector<size_t> eager;
+    bool faulting = lazy && m_lazy.open(path);
+    for (size_t i = 0; i < records.size(); i++) {
+        const CkptFile::Record& record = records[i];
+        if (faulting && record.m_encoding == CkptFile::ENC_FULL
+                && record.m_codec == SDMT_CC_NONE
+                && record.m_size == record.m_rawsize
+                && faultable_(targets[i]->m_options)
+                && m_lazy.add(targets[i]->m_ptr, record.m_size,
+                    record.m_offset)) {
+            m_recovery.m_lazy++;
+            continue;
+        }
+        eager.push_back(i);
+    }
+    if (m_recovery.m_lazy > 0) {
+        m_lazy.start();
+    } else {
+        m_lazy.wait();
+    }
+
+    // Snapshots are independent, each thread reads and decodes its own
+    std::atomic<bool> ok(true);
+    parallel::for_each(m_config.m_recover_threads, eager.size(),
+            [&](size_t i) {
+        size_t k = eager[i];
+        if (!restore_(id, m_rank, records[k], targets[k]->m_ptr,
+                    targets[k]->m_options.m_error_bound)) {
+            ok = false;
+        }
+    });
+    if (!ok) {
+        return SDMT_ERR_FAILED_RECOVERY;
+    }
+    m_recovery.m_id = header.m_id;
+
+    // recover iteration sequence and checkpoint info
+    if (names.empty()) {
+        m_iter = header.m_iter;
+        m_cp_info.level = header.m_level;
+        if (m_cp_info.id <= header.m_id) {
+            m_cp_info.id = header.m_id + 1;
+        }
+    }
+
+    return SDMT_SUCCESS;
+}
+
+SDMT_Code SDMT::recover_shared_(int id, const std::set<std::string>& names) {
+    std::vector<char> section;
+    if (!CkptShared::read(m_comm, CkptShared::path(m_config.m_native_dir, id),
+                m_config.m_mpiio, section)) {
+        return SDMT_ERR_FAILED_RECOVERY;
+    }
+    CkptFile::Header header;
+    std::vector<CkptFile::Record> records;
+    if (!CkptFile::parse(section.data(), section.size(), header, records)
+            || !select_(names, records)) {
+        return SDMT_ERR_FAILED_RECOVERY;
+    }
+
+    std::vector<Snapshot*> targets;
+    for (auto& record : records) {
+        Snapshot* snapshot = stored_(record.m_name);
+        if (snapshot == nullptr || snapshot->bytes() != record.m_rawsize
+                || record.m_encoding != CkptFile::ENC_FULL) {
+            return SDMT_ERR_FAILED_RECOVERY;
+        }
+        targets.push_back(snapshot);
+    }
+
+    std::atomic<bool> ok(true);
+    parallel::for_each(m_config.m_recover_threads, records.size(),
+            [&](size_t i) {
+        if (!restore_full_(records[i], section.data() + records[i].m_offset,
+                    targets[i]->m_ptr, targets[i]->m_options.m_error_bound)) {
+            ok = false;
+        }
+    });
+    if (!ok) {
+        return SDMT_ERR_FAILED_RECOVERY;
+    }
+    m_recovery.m_id = header.m_id;
+
+    // recover iteration sequence and checkpoint info
+    if (names.empty()) {
+        m_iter = header.m_iter;
+        m_cp_info.level = header.m_level;
+        if (m_cp_info.id <= header.m_id) {
+            m_cp_info.id = header.m_id + 1;
+        }
+    }
+
+    return SDMT_SUCCESS;
+}
+
+SDMT_Code SDMT::recover_redistributed_(const std::set<std::string>& names,
+        int id) {
+    int ranks;
+    MPI_Comm_size(m_comm, &ranks);
+    const int old = m_ckpt_ranks;
+
+    // old ranks p with p % ranks == m_rank are read by this rank
+    std::vector<int> mine;
+    for (int p = m_rank; p < old; p += ranks) {
+        mine.push_back(p);
+    }
+
+    // newest native checkpoint written by every old rank,
+    // or the chosen one if every old rank wrote it
+    int local = INT_MAX;
+    for (int p : mine) {
+        if (id >= 0) {
+            bool found = ::access(native_path_(id, p).c_str(), R_OK) == 0;
+            local = std::min(local, found ? id : -1);
+            continue;
+        }
+        local = std::min(local, std::max(
+                    CkptFile::latest(m_config.m_native_dir, p),
+                    CkptFile::latest(m_config.m_local_dir, p)));
+    }
+    bool newest = id < 0;
+    MPI_Allreduce(&local, &id, 1, MPI_INT, MPI_MIN, m_comm);
+
+    // shared and FTI checkpoints hold the images of each rank as they are
+    int shared = latest_shared_();
+    if (id < 0 || id == INT_MAX
+            || (newest && (shared > id || m_fti_id > id))) {
+        return SDMT_ERR_FAILED_RECOVERY;
+    }
+
+    // Snapshots not distributed are read from the file of one old rank
+    const int home = m_rank % old;
+    bool ok = true;
+    CkptFile::Header header;
+    std::map<int, std::vector<CkptFile::Record>> indexes;
+    for (int p : mine) {
+        ok = CkptFile::read_index(native_path_(id, p), header, indexes[p])
+            && ok;
+    }
+    ok = CkptFile::read_index(native_path_(id, home), header, indexes[home])
+        && ok;
+    auto find = [&indexes](int p, const std::string& name)
+            -> const CkptFile::Record* {
+        for (auto& record : indexes[p]) {
+            if (record.m_name == name) {
+                return &record;
+            }
+        }
+        return nullptr;
+    };
+
+    // collectives of distributed Snapshots go in the same order on all ranks
+    std::vector<std::string> chosen;
+    for (auto& itr : stored_()) {
+        if (names.empty() || names.count(itr.first) > 0) {
+            chosen.push_back(itr.first);
+        }
+    }
+    std::sort(chosen.begin(), chosen.end());
+
+    std::vector<std::string> replicated;
+    for (auto& name : chosen) {
+        Snapshot& snapshot = *stored_(name);
+        const Options& opts = snapshot.m_options;
+        if (opts.m_global.empty()) {
+            replicated.push_back(name);
+            continue;
+        }
+
+        CkptRedist::Layout layout;
+        layout.m_outer = 1;
+        layout.m_extent = opts.m_global[opts.m_axis];
+        layout.m_row = snapshot.m_esize;
+        layout.m_block = opts.m_block;
+        for (int i = 0; i < (int)opts.m_global.size(); i++) {
+            if (i < opts.m_axis) {
+                layout.m_outer *= opts.m_global[i];
+            } else if (i > opts.m_axis) {
+                layout.m_row *= opts.m_global[i];
+            }
+        }
+
+        // a Snapshot registered after the checkpoint is not in any file
+        int found = 1;
+        for (int p : mine) {
+            found = found && find(p, name) != nullptr;
+        }
+        int any = 0;
+        MPI_Allreduce(&found, &any, 1, MPI_INT, MPI_MAX, m_comm);
+        if (!any) {
+            ok = ok && names.empty();
+            continue;
+        }
+
+        // images of old ranks are restored, then sent to new owners
+        std::vector<std::vector<char>> images(mine.size());
+        std::atomic<bool> restored(found != 0);
+        parallel::for_each(m_config.m_recover_threads, mine.size(),
+                [&](size_t i) {
+            const CkptFile::Record* record = find(mine[i], name);
+            images[i].resize(layout.m_outer * layout.m_row
+                    * CkptRedist::count(layout.m_extent, layout.m_block,
+                        old, mine[i]));
+            if (record == nullptr || record->m_rawsize != images[i].size()
+                    || !restore_(id, mine[i], *record, images[i].data(),
+                        opts.m_error_bound)) {
+                restored = false;
+            }
+        });
+        std::vector<std::pair<int, const char*>> parts;
+        for (size_t i = 0; i < mine.size(); i++) {
+            parts.emplace_back(mine[i], images[i].data());
+        }
+        ok = CkptRedist::exchange(m_comm, old, layout, parts,
+                reinterpret_cast<char*>(snapshot.m_ptr)) && restored && ok;
+    }
+
+    std::atomic<bool> restored(true);
+    parallel::for_each(m_config.m_recover_threads, replicated.size(),
+            [&](size_t i) {
+        Snapshot& snapshot = *stored_(replicated[i]);
+        const CkptFile::Record* record = find(home, replicated[i]);
+        if (record == nullptr) {
+            // not in the checkpoint, as recover_native_() leaves it
+            if (!names.empty()) {
+                restored = false;
+            }
+            return;
+        }
+        if (record->m_rawsize != snapshot.bytes()
+                || !restore_(id, home, *record, snapshot.m_ptr,
+                    snapshot.m_options.m_error_bound)) {
+            restored = false;
+        }
+    });
+
+    int good = ok && restored;
+    int all = 0;
+    MPI_Allreduce(&good, &all, 1, MPI_INT, MPI_MIN, m_comm);
+    if (!all) {
+        return SDMT_ERR_FAILED_RECOVERY;
+    }
+    m_recovery.m_id = id;
+
+    // recover iteration sequence and checkpoint info
+    if (names.empty()) {
+        m_iter = header.m_iter;
+        m_cp_info.level = header.m_level;
+        if (m_cp_info.id <= header.m_id) {
+            m_cp_info.id = header.m_id + 1;
+        }
+    }
+
+    return SDMT_SUCCESS;
+}
+
+SDMT_Code SDMT::check_distribution_(const std::vector<int>& dim,
+        const Options& opts) {
+    const std::vector<int>& global = opts.m_global;
+    if (global.size() != dim.size() || opts.m_axis < 0
+            || opts.m_axis >= (int)global.size() || opts.m_block < 0) {
+        return SDMT_ERR_WRONG_OPTION;
+    }
+    for (int i = 0; i < (int)dim.size(); i++) {
+        int extent = (i == opts.m_axis)
+            ? local_extent_(global[i], opts.m_block) : global[i];
+        if (dim[i] != extent) {
+            return SDMT_ERR_WRONG_DIMENSION;
+        }
+    }
+    return SDMT_SUCCESS;
+}
+
+int SDMT::local_extent_(int extent, int block) {
+    int ranks;
+    MPI_Comm_size(m_comm, &ranks);
+    return CkptRedist::count(extent, block, ranks, m_rank);
+}
+
+bool SDMT::select_(const std::set<std::string>& names,
+        std::vector<CkptFile::Record>& records) {
+    if (names.empty()) {
+        return true;
+    }
+    std::vector<CkptFile::Record> chosen;
+    for (auto& record : records) {
+        if (names.count(record.m_name) > 0) {
+            chosen.push_back(record);
+        }
+    }
+    records.swap(chosen);
+    return records.size() == names.size();
+}
+
+bool SDMT::restore_(int id,
+        int rank,
+        const CkptFile::Record& record,
+        void* dst,
+        double bound) {
+    std::string path = native_path_(id, rank);
+    if (record.m_encoding == CkptFile::ENC_FULL
+            && record.m_codec == SDMT_CC_NONE) {
+        return record.m_size == record.m_rawsize
+            && CkptFile::read_payload(path, record, dst);
+    }
+
+    // read payload and decompress it
+    std::vector<char> payload(record.m_size);
+    if (!CkptFile::read_payload(path, record, payload.data())) {
+        return false;
+    }
+    if (record.m_encoding == CkptFile::ENC_FULL) {
+        return restore_full_(record, payload.data(), dst, bound);
+    }
+    if (record.m_codec != SDMT_CC_NONE) {
+        size_t size = 0;
+        if (!Codec::decoded_size(payload.data(), payload.size(), size)) {
+            return false;
+        }
+        std::vector<char> plain(size);
+        if (!Codec::decompress(payload.data(), payload.size(),
+                    plain.data(), size, m_config.m_compress_threads)) {
+            return false;
+        }
+        payload.swap(plain);
+    }
+
+    if (record.m_encoding != CkptFile::ENC_DELTA
+            || record.m_base < 0 || record.m_base >= id) {
+        return false;
+    }
+
+    // restore base image first
+    std::string base_path = native_path_(record.m_base, rank);
+    CkptFile::Header header;
+    std::vector<CkptFile::Record> records;
+    if (!CkptFile::read_index(base_path, header, records)) {
+        return false;
+    }
+    auto base = std::find_if(records.begin(), records.end(),
+            [&record](const CkptFile::Record& r) {
+                return r.m_name == record.m_name;
+            });
+    if (base == records.end() || base->m_rawsize != record.m_rawsize
+            || !restore_(record.m_base, rank, *base, dst, bound)) {
+        return false;
+    }
+
+    // then apply changed blocks
+    return Delta::apply(payload.data(), payload.size(), dst, record.m_rawsize);
+}
+
+bool SDMT::restore_full_(const CkptFile::Record& record,
+        const char* payload,
+        void* dst,
+        double bound) {
+    if (record.m_codec == SDMT_CC_NONE) {
+        if (record.m_size != record.m_rawsize) {
+            return false;
+        }
+        std::memcpy(dst, payload, record.m_size);
+        return true;
+    }
+
+    // lossy image has to meet the bound of the Snapshot
+    size_t size = 0;
+    double error = 0;
+    return Codec::decoded_size(payload, record.m_size, size)
+        && size == record.m_rawsize
+        && Codec::decompress(payload, record.m_size, dst, size,
+                m_config.m_compress_threads, &error)
+        && error <= bound;
+}
+
+void SDMT::prepare_recovery_(const std::set<std::string>& names) {
+    for (auto& itr : stored_()) {
+        Snapshot& snapshot = *itr.second;
+        if (!names.empty() && names.count(itr.first) == 0) {
+            continue;
+        }
+
+        // file reads into write-protected memory fail
+        if (snapshot.m_options.m_incremental == SDMT_IM_PAGE) {
+            DirtyPages::release(snapshot.m_ptr);
+        }
+
+        // recovered image may differ from the last native checkpoint
+        snapshot.m_base = -1;
+        m_hashes.erase(snapshot.m_id);
+    }
+}
+
+void* SDMT::allocate_(size_t size, const Options& opts, bool touch) {
+    size_t alignment = std::max(opts.m_alignment, m_config.m_alignment);
+    // NUMA policies are set on whole pages
+    if (opts.m_placement != SDMT_NP_DEFAULT) {
+        alignment = std::max(alignment, DirtyPages::page_size());
+    }
+    if (opts.m_incremental == SDMT_IM_PAGE) {
+        // write protection works on whole pages
+        size_t page = DirtyPages::page_size();
+        size_t align = std::max(page, alignment);
+        void* p = nullptr;
+        if (posix_memalign(&p, align, (size + page - 1) / page * page) != 0) {
+            return nullptr;
+        }
+        // touched before pages are write-protected
+        place_(p, size, opts, touch);
+        if (!DirtyPages::track(p, size)) {
+            std::free(p);
+            return nullptr;
+        }
+        return p;
+    }
+
+    SDMT_HP huge = std::max(opts.m_huge_pages, m_config.m_huge_pages);
+    if (huge == SDMT_HP_EXPLICIT && alignment <= kHugePage) {
+        void* p = map_huge_(size);
+        if (p != nullptr) {
+            place_(p, size, opts, touch);
+            return p;
+        }
+    }
+    if (huge != SDMT_HP_NONE) {
+        alignment = std::max(alignment, kHugePage);
+    }
+
+    if (alignment > 0) {
+        size_t align = std::max(alignment, sizeof(void*));
+        size_t bytes = std::max<size_t>(size, 1);
+        if (opts.m_placement != SDMT_NP_DEFAULT) {
+            // the last page is placed too, so nothing else may share it
+            size_t page = DirtyPages::page_size();
+            bytes = (bytes + page - 1) / page * page;
+        }
+        void* p = nullptr;
+        if (posix_memalign(&p, align, bytes) != 0) {
+            return nullptr;
+        }
+        // fewer TLB misses when copying or writing large Snapshots
+        if (align >= kHugePage) {
+            ::madvise(p, (size + align - 1) / align * align, MADV_HUGEPAGE);
+        }
+        place_(p, size, opts, touch);
+        return p;
+    }
+
+    void* p = std::malloc(size);
+    if (p != nullptr) {
+        place_(p, size, opts, touch);
+    }
+    return p;
+}
+
+void SDMT::place_(void* ptr, size_t size, const Options& opts, bool touch) {
+    // policies apply to pages mapped from now on, and move mapped ones
+    if (opts.m_placement == SDMT_NP_BIND) {
+        NumaPlacement::bind(ptr, size, opts.m_numa_node);
+    } else if (opts.m_placement == SDMT_NP_INTERLEAVE) {
+        NumaPlacement::interleave(ptr, size);
+    }
+    if (opts.m_placement == SDMT_NP_FIRST_TOUCH) {
+        NumaPlacement::first_touch(ptr, size, m_config.m_recover_threads);
+    } else if (touch) {
+        ::touch(ptr, size, m_config.m_recover_threads);
+    }
+}
+
+void* SDMT::map_huge_(size_t size) {
+#ifdef MAP_HUGETLB
+    size_t length = (std::max<size_t>(size, 1) + kHugePage - 1)
+        / kHugePage * kHugePage;
+    void* p = ::mmap(nullptr, length, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (p == MAP_FAILED) {
+        return nullptr;
+    }
+    m_mapped[p] = length;
+    return p;
+#else
+    (void)size;
+    return nullptr;
+#endif
+}
+
+void SDMT::free_(void* ptr) {
+    auto itr = m_mapped.find(ptr);
+    if (itr != m_mapped.end()) {
+        ::munmap(ptr, itr->second);
+        m_mapped.erase(itr);
+        return;
+    }
+    std::free(ptr);
+}
+
+void SDMT::release_(Snapshot& snapshot) {
+    // freed memory may still be registered for page faults
+    m_lazy.wait();
+
+    // and the back buffer may still be written by an asynchronous
+    // checkpoint, staged without a copy at the last flip
+    if (snapshot.m_back != nullptr) {
+        m_async.wait();
+    }
+    if (snapshot.m_offset >= 0 || snapshot.m_external) {
+        // offsets of the other members stay as archived,
+        // and memory of the application is not SDMT's to free
+        snapshot.m_ptr = nullptr;
+        return;
+    }
+    if (snapshot.m_options.m_incremental == SDMT_IM_PAGE) {
+        DirtyPages::untrack(snapshot.m_ptr);
+    }
+    free_(snapshot.m_ptr);
+    free_(snapshot.m_back);
+    snapshot.m_ptr = nullptr;
+    snapshot.m_back = nullptr;
+}
+
+bool SDMT::arena_fits_(size_t size, const Options& opts) const {
+    // these need memory, buffers or records of the Snapshot's own
+    return m_config.m_arena_size > 0
+        && size <= m_config.m_arena_threshold
+        && opts.m_incremental == SDMT_IM_NONE
+        && opts.m_codec == SDMT_CC_NONE
+        && !opts.m_double_buffer
+        && opts.m_global.empty()
+        && opts.m_huge_pages == SDMT_HP_NONE
+        && opts.m_placement == SDMT_NP_DEFAULT
+        && std::max(opts.m_alignment, m_config.m_alignment)
+            <= DirtyPages::page_size();
+}
+
+void* SDMT::arena_place_(size_t size, const Options& opts, int64_t& offset) {
+    if (!arena_fits_(size, opts)) {
+        return nullptr;
+    }
+    if (m_arena.m_ptr == nullptr) {
+        // whole pages, so the arena can be faulted in lazily at restart
+        size_t page = DirtyPages::page_size();
+        size_t capacity = (m_config.m_arena_size + page - 1) / page * page;
+        Options aligned;
+        aligned.m_alignment = page;
+        void* p = allocate_(capacity, aligned, true);
+        if (p == nullptr) {
+            return nullptr;
+        }
+        m_arena = Snapshot(m_cp_idx++, SDMT_LONG, SDMT_ARRAY,
+                {(int)(capacity / sizeof(long))}, sizeof(long), p, aligned);
+        FTI_Protect(m_arena.m_id, p, capacity / sizeof(long), FTI_LONG);
+        m_arena_used = 0;
+    }
+
+    // slots are taken in order and never reused,
+    // and the layout at the tail grows by one entry
+    size_t align = std::max(std::max(opts.m_alignment, m_config.m_alignment),
+            sizeof(long));
+    size_t begin = (m_arena_used + align - 1) / align * align;
+    size_t tail = sizeof(int64_t) + kLayoutEntry;
+    for (auto& itr : m_snapshot_map) {
+        if (itr.second.m_offset >= 0) {
+            tail += kLayoutEntry;
+        }
+    }
+    if (begin + size + tail > m_arena.bytes()) {
+        return nullptr;
+    }
+    m_arena_used = begin + size;
+    offset = begin;
+    return reinterpret_cast<char*>(m_arena.m_ptr) + begin;
+}
+
+void SDMT::arena_layout_() {
+    if (m_arena.m_ptr == nullptr) {
+        return;
+    }
+    std::vector<int64_t> layout;
+    for (auto& itr : m_snapshot_map) {
+        const Snapshot& snapshot = itr.second;
+        if (snapshot.m_offset >= 0) {
+            layout.push_back(snapshot.m_id);
+            layout.push_back(snapshot.m_offset);
+            layout.push_back(snapshot.bytes());
+        }
+    }
+    layout.push_back(layout.size() / 3);
+
+    // placement keeps the tail free for it
+    size_t size = layout.size() * sizeof(int64_t);
+    std::memcpy(reinterpret_cast<char*>(m_arena.m_ptr) + m_arena.bytes()
+            - size, layout.data(), size);
+}
+
+bool SDMT::arena_restore_(const char* image,
+        const std::vector<Snapshot*>& members) {
+    size_t bytes = m_arena.bytes();
+    int64_t count = 0;
+    std::memcpy(&count, image + bytes - sizeof(int64_t), sizeof(int64_t));
+    if (count < 0 || (uint64_t)count > (bytes - sizeof(int64_t))
+            / kLayoutEntry) {
+        return false;
+    }
+    std::vector<int64_t> layout(count * 3);
+    std::memcpy(layout.data(), image + bytes - sizeof(int64_t)
+            - count * kLayoutEntry, count * kLayoutEntry);
+
+    // the image may be the arena itself, where a member may have moved
+    // onto the saved slot of another, so every member is gathered first
+    std::vector<std::vector<char>> saved(members.size());
+    for (size_t i = 0; i < members.size(); i++) {
+        const Snapshot& member = *members[i];
+        int64_t e = 0;
+        while (e < count && layout[3 * e] != member.m_id) {
+            e++;
+        }
+        if (e == count || layout[3 * e + 1] < 0
+                || (uint64_t)layout[3 * e + 2] != member.bytes()
+                || (uint64_t)layout[3 * e + 1] > bytes - member.bytes()) {
+            return false;
+        }
+        const char* p = image + layout[3 * e + 1];
+        saved[i].assign(p, p + member.bytes());
+    }
+    for (size_t i = 0; i < members.size(); i++) {
+        std::memcpy(members[i]->m_ptr, saved[i].data(), saved[i].size());
+    }
+    return true;
+}
+
+SDMT_Code SDMT::arena_relocate_() {
+    std::vector<Snapshot*> members;
+    for (auto& itr : m_snapshot_map) {
+        if (itr.second.m_offset >= 0) {
+            members.push_back(&itr.second);
+        }
+    }
+    if (members.empty()) {
+        return SDMT_SUCCESS;
+    }
+    bool ok = arena_restore_(reinterpret_cast<const char*>(m_arena.m_ptr),
+            members);
+
+    // the recovered layout is replaced by the one of now
+    arena_layout_();
+    return ok ? SDMT_SUCCESS : SDMT_ERR_FAILED_RECOVERY;
+}
+
+std::vector<std::pair<std::string, SDMT::Snapshot*>> SDMT::stored_() {
+    std::vector<std::pair<std::string, Snapshot*>> stored;
+    for (auto& itr : m_snapshot_map) {
+        if (itr.second.m_offset < 0) {
+            stored.emplace_back(itr.first, &itr.second);
+        }
+    }
+    if (m_arena.m_ptr != nullptr) {
+        stored.emplace_back(kArena, &m_arena);
+    }
+    return stored;
+}
+
+SDMT::Snapshot* SDMT::stored_(const std::string& name) {
+    if (name == kArena) {
+        return m_arena.m_ptr != nullptr ? &m_arena : nullptr;
+    }
+    auto itr = m_snapshot_map.find(name);
+    if (itr == m_snapshot_map.end() || itr->second.m_offset >= 0) {
+        return nullptr;
+    }
+    return &itr->second;
+}
+
+int SDMT::latest_native_() {
+    // the node-local directory may be ahead of the global one,
+    // or lost with the node
+    int local = std::max(CkptFile::latest(m_config.m_native_dir, m_rank),
+            CkptFile::latest(m_config.m_local_dir, m_rank));
+    int global = -1;
+    MPI_Allreduce(&local, &global, 1, MPI_INT, MPI_MIN, m_comm);
+    return global;
+}
+
+int SDMT::latest_shared_() {
+    // every rank sees the same directory unless it is node-local
+    int local = CkptShared::latest(m_config.m_native_dir);
+    int global = -1;
+    MPI_Allreduce(&local, &global, 1, MPI_INT, MPI_MIN, m_comm);
+    return global;
+}
+
+bool SDMT::exist_(const std::string& name) {
+    auto itr = m_snapshot_map.find(name);
+    if (itr == m_snapshot_map.end()) {
+        return false;
+    } else {
+        return true;
+    }
+}
+
+SDMT::Snapshot SDMT::get_snapshot_(const std::string& name) {
+    auto itr = m_snapshot_map.find(name);
+    if (itr == m_snapshot_map.end()) {
+        return Snapshot();
+    }
+    return itr->second;
+}
+
+int32_t& SDMT::iter_() {
+    return m_iter;
+}
+
+int32_t SDMT::next_() {
+    return ++m_iter;
+}
+
+MPI_Comm SDMT::comm_() {
+    return m_comm;
+}
+
+
+int* SDMT::intptr_(const std::string& name) {
+    auto itr = m_snapshot_map.find(name);
+    if (itr== m_snapshot_map.end()) {
+        return nullptr;
+    }
+
+    return reinterpret_cast<int*>(itr->second.m_ptr);
+}
+
+long* SDMT::longptr_(const std::string& name) {
+    auto itr = m_snapshot_map.find(name);
+    if (itr == m_snapshot_map.end()) {
+        return nullptr;
+    }
+
+    return reinterpret_cast<long*>(itr->second.m_ptr);
+}
+
+float* SDMT::floatptr_(const std::string& name) {
+    auto itr = m_snapshot_map.find(name);
+    if (itr == m_snapshot_map.end()) {
+        return nullptr;
+    }
+
+    return reinterpret_cast<float*>(itr->second.m_ptr);
+}
+
+double* SDMT:: doubleptr_(const std::string& name) {
+    auto itr = m_snapshot_map.find(name);
+    if (itr == m_snapshot_map.end()) {
+        return nullptr;
+    }
+
+    return reinterpret_cast<double*>(itr->second.m_ptr);
+}
+
+SDMT::SnapshotHandle SDMT::lookup_(const std::string& name) {
+    auto itr = m_snapshot_map.find(name);
+    if (itr == m_snapshot_map.end()) {
+        return -1;
+    }
+    return itr->second.m_id;
+}
+
+void SDMT::rebuild_handles_() {
+    // elements of the map stay in place until erased
+    m_handles.assign(m_cp_idx, nullptr);
+    for (auto& itr : m_snapshot_map) {
+        Snapshot& snapshot = itr.second;
+        if (snapshot.m_id >= (int32_t)m_handles.size()) {
+            m_handles.resize(snapshot.m_id + 1, nullptr);
+        }
+        m_handles[snapshot.m_id] = &snapshot;
+    }
+}
+
+bool SDMT::load_config_(std::string config) { 
+    namespace xml = tinyxml2;
+    xml::XMLDocument doc;
+    xml::XMLError err;
+    xml::XMLNode* node;
+    xml::XMLElement* element;
+
+    // load config file
+    err = doc.LoadFile(config.c_str());
+    if (err != 0) {
+        return false;
+    }
+
+    // get root node
+    node = doc.FirstChild();
+    
+    m_config = Config();
+
+    // get path for sdmt archive
+    element = node->FirstChildElement("ArchivePath");
+    if (element == nullptr) {
+        return false;
+    } else {
+        m_config.m_archive = element->GetText();
+    }
+
+    // get path for fti_config
+    element = node->FirstChildElement("FTIConfig");
+    if (element == nullptr) {
+        return false;
+    } else {
+        m_config.m_fti_config = element->GetText();
+    }
+
+    // get path for parameter file
+    element = node->FirstChildElement("ParamPath");
+    if (element == nullptr) {
+        return false;
+    } else {
+        m_config.m_param_path = element->GetText();
+    }
+
+    // get directory for native checkpoint files, optional
+    // default is 'Native' next to the archive
+    element = node->FirstChildElement("NativeDir");
+    if (element == nullptr) {
+        size_t pos = m_config.m_archive.find_last_of('/');
+        std::string dir = (pos == std::string::npos)
+            ? "." : m_config.m_archive.substr(0, pos);
+        m_config.m_native_dir = dir + "/Native";
+    } else {
+        m_config.m_native_dir = element->GetText();
+    }
+
+    // get node-local directory and drain bandwidth, optional
+    element = node->FirstChildElement("LocalDir");
+    if (element != nullptr && element->GetText() != nullptr) {
+        m_config.m_local_dir = element->GetText();
+    }
+    element = node->FirstChildElement("DrainBandwidth");
+    if (element != nullptr) {
+        if (element->QueryDoubleText(&m_config.m_drain_bandwidth) != 0
+                || m_config.m_drain_bandwidth < 0) {
+            return false;
+        }
+    }
+
+    // get direct I/O of native checkpoint files, optional
+    element = node->FirstChildElement("DirectIO");
+    if (element != nullptr) {
+        if (element->QueryBoolText(&m_config.m_direct_io) != 0) {
+            return false;
+        }
+    }
+    element = node->FirstChildElement("LazyRecovery");
+    if (element != nullptr) {
+        if (element->QueryBoolText(&m_config.m_lazy_recovery) != 0) {
+            return false;
+        }
+    }
+    element = node->FirstChildElement("QueueDepth");
+    if (element != nullptr) {
+        if (element->QueryIntText(&m_config.m_direct.m_depth) != 0
+                || m_config.m_direct.m_depth < 1) {
+            return false;
+        }
+    }
+
+    // get writer of asynchronous checkpoints, optional
+    element = node->FirstChildElement("AsyncMode");
+    if (element != nullptr && element->GetText() != nullptr) {
+        std::string mode = element->GetText();
+        if (mode == "thread") {
+            m_config.m_async_mode = Config::THREAD;
+        } else if (mode == "fork") {
+            m_config.m_async_mode = Config::FORK;
+        } else {
+            return false;
+        }
+    }
+
+    // get writer of synchronous checkpoints, optional
+    element = node->FirstChildElement("Backend");
+    if (element != nullptr && element->GetText() != nullptr) {
+        std::string backend = element->GetText();
+        if (backend == "fti") {
+            m_config.m_backend = Config::FTI;
+        } else if (backend == "native") {
+            m_config.m_backend = Config::NATIVE;
+        } else if (backend == "mpiio") {
+            m_config.m_backend = Config::MPIIO;
+        } else {
+            return false;
+        }
+    }
+
+    // get block size of hash based incremental checkpoint, optional
+    element = node->FirstChildElement("BlockSize");
+    if (element != nullptr) {
+        int block = 0;
+        if (element->QueryIntText(&block) != 0 || block < 1) {
+            return false;
+        }
+        m_config.m_block_size = block;
+    }
+
+    // get interval of full checkpoints of incremental snapshots, optional
+    element = node->FirstChildElement("FullInterval");
+    if (element != nullptr) {
+        if (element->QueryIntText(&m_config.m_full_interval) != 0
+                || m_config.m_full_interval < 1) {
+            return false;
+        }
+    }
+
+    // get number of in-memory checkpoints, optional
+    element = node->FirstChildElement("MemorySlots");
+    if (element != nullptr) {
+        if (element->QueryIntText(&m_config.m_memory_slots) != 0
+                || m_config.m_memory_slots < 1) {
+            return false;
+        }
+    }
+
+    // get MPI-IO aggregators and stripe size, optional
+    element = node->FirstChildElement("Aggregators");
+    if (element != nullptr) {
+        if (element->QueryIntText(&m_config.m_mpiio.m_aggregators) != 0
+                || m_config.m_mpiio.m_aggregators < 0) {
+            return false;
+        }
+    }
+    element = node->FirstChildElement("StripeSize");
+    if (element != nullptr) {
+        int stripe = 0;
+        if (element->QueryIntText(&stripe) != 0 || stripe < 1) {
+            return false;
+        }
+        m_config.m_mpiio.m_stripe = stripe;
+    }
+
+    // get erasure coding group, optional
+    element = node->FirstChildElement("ErasureGroup");
+    if (element != nullptr) {
+        if (element->QueryIntText(&m_config.m_erasure_group) != 0
+                || m_config.m_erasure_group < 2) {
+            return false;
+        }
+    }
+    element = node->FirstChildElement("ErasureParity");
+    if (element != nullptr) {
+        if (element->QueryIntText(&m_config.m_erasure_parity) != 0
+                || m_config.m_erasure_parity < 1
+                || m_config.m_erasure_parity >= m_config.m_erasure_group) {
+            return false;
+        }
+    }
+
+    // get number of compression threads, optional
+    element = node->FirstChildElement("CompressThreads");
+    if (element != nullptr) {
+        if (element->QueryIntText(&m_config.m_compress_threads) != 0
+                || m_config.m_compress_threads < 0) {
+            return false;
+        }
+    }
+
+    element = node->FirstChildElement("RecoverThreads");
+    if (element != nullptr) {
+        if (element->QueryIntText(&m_config.m_recover_threads) != 0
+                || m_config.m_recover_threads < 0) {
+            return false;
+        }
+    }
+
+    // get allocation policy of Snapshot memory, optional
+    element = node->FirstChildElement("Alignment");
+    if (element != nullptr) {
+        int alignment = 0;
+        if (element->QueryIntText(&alignment) != 0 || alignment < 0
+                || (alignment & (alignment - 1))) {
+            return false;
+        }
+        m_config.m_alignment = alignment;
+    }
+    element = node->FirstChildElement("HugePages");
+    if (element != nullptr && element->GetText() != nullptr) {
+        std::string huge = element->GetText();
+        if (huge == "none") {
+            m_config.m_huge_pages = SDMT_HP_NONE;
+        } else if (huge == "transparent") {
+            m_config.m_huge_pages = SDMT_HP_TRANSPARENT;
+        } else if (huge == "explicit") {
+            m_config.m_huge_pages = SDMT_HP_EXPLICIT;
+        } else {
+            return false;
+        }
+    }
+    element = node->FirstChildElement("Prefault");
+    if (element != nullptr) {
+        if (element->QueryBoolText(&m_config.m_prefault) != 0) {
+            return false;
+        }
+    }
+
+    // get arena of small Snapshots, optional
+    element = node->FirstChildElement("ArenaSize");
+    if (element != nullptr) {
+        int size = 0;
+        if (element->QueryIntText(&size) != 0 || size < 0) {
+            return false;
+        }
+        m_config.m_arena_size = size;
+    }
+    element = node->FirstChildElement("ArenaThreshold");
+    if (element != nullptr) {
+        int threshold = 0;
+        if (element->QueryIntText(&threshold) != 0 || threshold < 0) {
+            return false;
+        }
+        m_config.m_arena_threshold = threshold;
+    }
+
+    // get retention policy of checkpoints, optional
+    element = node->FirstChildElement("KeepLast");
+    if (element != nullptr) {
+        if (element->QueryIntText(&m_config.m_retention.m_keep) != 0
+                || m_config.m_retention.m_keep < kNativeKeep) {
+            return false;
+        }
+    }
+    element = node->FirstChildElement("KeepEvery");
+    if (element != nullptr) {
+        if (element->QueryIntText(&m_config.m_retention.m_every) != 0
+                || m_config.m_retention.m_every < 0) {
+            return false;
+        }
+    }
+
+    return true;
 }
 
 bool SDMT::serialize_() {
@@ -542,6 +2560,9 @@ bool SDMT::serialize_() {
     serialize::write(archive, m_snapshot_map);
     serialize::write(archive, m_cp_info);
     serialize::write(archive, m_cp_idx);
+    serialize::write(archive, m_fti_id);
+    serialize::write(archive, m_ckpt_ranks);
+    serialize::write(archive, m_arena);
 
     archive.flush();
     archive.close();
@@ -561,6 +2582,10 @@ bool SDMT::deserialize_() {
     serialize::read(archive, m_snapshot_map);
     serialize::read(archive, m_cp_info);
     serialize::read(archive, m_cp_idx);
+    serialize::read(archive, m_fti_id);
+    serialize::read(archive, m_ckpt_ranks);
+    serialize::read(archive, m_arena);
+    rebuild_handles_();
 
     // recover checkpoint info
     FTIT_type ckptInfo;
@@ -570,9 +2595,42 @@ bool SDMT::deserialize_() {
     // recover iteration sequence
     FTI_Protect(1, &m_iter, 1, FTI_INTG);
 
+    // pages are mapped on several threads here rather than
+    // one by one when recovery writes them
+    auto start = std::chrono::steady_clock::now();
+    if (m_arena.m_id >= 0) {
+        // left unpopulated to be faulted in, or touched as a whole
+        size_t count = m_arena.bytes() / sizeof(long);
+        m_arena.m_ptr = allocate_(m_arena.bytes(), m_arena.m_options,
+                !m_config.m_lazy_recovery);
+        FTI_Protect(m_arena.m_id, m_arena.m_ptr, count, FTI_LONG);
+    }
     for (auto& itr : m_snapshot_map) {
         Snapshot& snapshot = itr.second;
 
+        // memory of the application is not there anymore,
+        // the Snapshot is recovered into memory of SDMT until rebound
+        snapshot.m_external = false;
+
+        // members of the arena are at their archived offsets
+        if (snapshot.m_offset >= 0) {
+            snapshot.m_ptr = reinterpret_cast<char*>(m_arena.m_ptr)
+                + snapshot.m_offset;
+            m_arena_used = std::max(m_arena_used,
+                    (size_t)snapshot.m_offset + snapshot.bytes());
+            continue;
+        }
+
+        // the archive holds the part of any rank of a distributed Snapshot,
+        // and the number of ranks may have changed
+        const Options& opts = snapshot.m_options;
+        if (!opts.m_global.empty()) {
+            std::vector<int> dim = opts.m_global;
+            dim[opts.m_axis] = local_extent_(dim[opts.m_axis], opts.m_block);
+            snapshot = Snapshot(snapshot.m_id, snapshot.m_valuetype,
+                    snapshot.m_datatype, dim, snapshot.m_esize, nullptr, opts);
+        }
+
         // calculate the byte size of memory to allocate
         size_t size = 1;
         for (auto d: snapshot.m_dimension) {
@@ -580,28 +2638,37 @@ bool SDMT::deserialize_() {
         }
 
         // allocate memory and register to checkpointing module
-        snapshot.m_ptr = std::malloc(size * snapshot.m_esize);
+        if (m_config.m_lazy_recovery
+                && faultable_(snapshot.m_options)
+                && snapshot.m_options.m_codec == SDMT_CC_NONE) {
+            // whole pages are left unpopulated to be faulted in
+            size_t page = DirtyPages::page_size();
+            Options opts = snapshot.m_options;
+            opts.m_alignment = std::max(opts.m_alignment, page);
+            snapshot.m_ptr = allocate_((size * snapshot.m_esize + page - 1)
+                    / page * page, opts);
+        } else {
+            snapshot.m_ptr = allocate_(size * snapshot.m_esize,
+                    snapshot.m_options, true);
+        }
+        if (snapshot.m_options.m_double_buffer) {
+            snapshot.m_back = allocate_(size * snapshot.m_esize,
+                    snapshot.m_options, prefault_(snapshot.m_options));
+        }
 
-        switch (snapshot.m_valuetype) {
-            case SDMT_INT:
-                FTI_Protect(snapshot.m_id, snapshot.m_ptr, size, FTI_INTG);
-                break;
-            case SDMT_LONG:
-                FTI_Protect(snapshot.m_id, snapshot.m_ptr, size, FTI_LONG);
-                break;
-            case SDMT_FLOAT:
-                FTI_Protect(snapshot.m_id, snapshot.m_ptr, size, FTI_SFLT);
-                break;
-            case SDMT_DOUBLE:
-                FTI_Protect(snapshot.m_id, snapshot.m_ptr, size, FTI_DBLE);
-                break;
-            default:
-                return false;
+        int esize;
+        FTIT_type* type = element_type(snapshot.m_valuetype, esize);
+        if (type == nullptr) {
+            return false;
         }
+        FTI_Protect(snapshot.m_id, snapshot.m_ptr, size, *type);
     }
 
+    double allocate = elapsed(start);
+
     // recover snapshot
-    recover_();
+    recover_(std::set<std::string>(), m_config.m_lazy_recovery, -1);
+    m_recovery.m_allocate = allocate;
 
     return true;
 }
@@ -615,6 +2682,20 @@ inline std::ostream& serialize::write<SDMT::Snapshot>(
     serialize::write(os, snapshot.m_dimension);
     serialize::write(os, snapshot.m_strides);
     serialize::write(os, snapshot.m_esize);
+    serialize::write(os, snapshot.m_options.m_incremental);
+    serialize::write(os, snapshot.m_options.m_codec);
+    serialize::write(os, snapshot.m_options.m_error_bound);
+    serialize::write(os, snapshot.m_options.m_alignment);
+    serialize::write(os, snapshot.m_options.m_double_buffer);
+    serialize::write(os, snapshot.m_options.m_global);
+    serialize::write(os, snapshot.m_options.m_axis);
+    serialize::write(os, snapshot.m_options.m_block);
+    serialize::write(os, snapshot.m_options.m_huge_pages);
+    serialize::write(os, snapshot.m_options.m_prefault);
+    serialize::write(os, snapshot.m_options.m_placement);
+    serialize::write(os, snapshot.m_options.m_numa_node);
+    serialize::write(os, snapshot.m_offset);
+    serialize::write(os, snapshot.m_external);
 
     return os;
 }
@@ -628,6 +2709,20 @@ inline std::istream& serialize::read<SDMT::Snapshot>(
     serialize::read(is, snapshot.m_dimension);
     serialize::read(is, snapshot.m_strides);
     serialize::read(is, snapshot.m_esize);
+    serialize::read(is, snapshot.m_options.m_incremental);
+    serialize::read(is, snapshot.m_options.m_codec);
+    serialize::read(is, snapshot.m_options.m_error_bound);
+    serialize::read(is, snapshot.m_options.m_alignment);
+    serialize::read(is, snapshot.m_options.m_double_buffer);
+    serialize::read(is, snapshot.m_options.m_global);
+    serialize::read(is, snapshot.m_options.m_axis);
+    serialize::read(is, snapshot.m_options.m_block);
+    serialize::read(is, snapshot.m_options.m_huge_pages);
+    serialize::read(is, snapshot.m_options.m_prefault);
+    serialize::read(is, snapshot.m_options.m_placement);
+    serialize::read(is, snapshot.m_options.m_numa_node);
+    serialize::read(is, snapshot.m_offset);
+    serialize::read(is, snapshot.m_external);
 
     return is;
 }
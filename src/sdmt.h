@@ -11,11 +11,23 @@ Contact: sdmt@kdb.snu.ac.kr
 #define SDMT_H_
 
 #include "common.h"
+#include "sdmt_array.h"
 #include "serialization.h"
+#include "ckpt_async.h"
+#include "ckpt_drain.h"
+#include "ckpt_lazy.h"
+#include "ckpt_erasure.h"
+#include "ckpt_partner.h"
+#include "ckpt_shared.h"
+#include "ckpt_ring.h"
 
 //#include <string>
+#include <algorithm>
+#include <functional>
+#include <set>
 #include <vector>
 #include <unordered_map>
+#include <cstdint>
 #include <fti.h>
 
 /**
@@ -28,6 +40,73 @@ Contact: sdmt@kdb.snu.ac.kr
 class SDMT
 {
   public:
+    /**
+     * @brief optional attributes of a Snapshot given at registration
+     */
+    struct Options {
+        /**
+         * @brief create default Options
+         */
+        Options()
+            : m_incremental(SDMT_IM_NONE),
+            m_codec(SDMT_CC_NONE),
+            m_error_bound(0),
+            m_alignment(0),
+            m_double_buffer(false),
+            m_axis(0),
+            m_block(0),
+            m_huge_pages(SDMT_HP_NONE),
+            m_prefault(false),
+            m_placement(SDMT_NP_DEFAULT),
+            m_numa_node(0) {}
+
+        /** @brief incremental checkpoint mode */
+        SDMT_IM m_incremental;
+
+        /** @brief compression codec of checkpoint data */
+        SDMT_CC m_codec;
+
+        /** @brief absolute error bound of SDMT_CC_LOSSY */
+        double m_error_bound;
+
+        /** @brief byte alignment of Snapshot memory, a power of 2,
+         *  0 for default. aligned memory is written by direct I/O
+         *  without a copy, 2MB or more is backed by huge pages */
+        size_t m_alignment;
+
+        /** @brief whether the Snapshot has two buffers. an asynchronous
+         *  checkpoint writes the active buffer and makes the other active
+         *  instead of copying */
+        bool m_double_buffer;
+
+        /** @brief global shape of a Snapshot distributed over ranks,
+         *  empty if every rank holds a Snapshot of its own. the dimension
+         *  of each rank is its part of the global shape */
+        std::vector<int> m_global;
+
+        /** @brief dimension the global shape is split along */
+        int m_axis;
+
+        /** @brief block size of block-cyclic decomposition,
+         *  0 for a contiguous block of ceil(extent / ranks) per rank */
+        int m_block;
+
+        /** @brief huge page backing of Snapshot memory, the stronger of
+         *  this and Config::m_huge_pages is used. ignored by SDMT_IM_PAGE */
+        SDMT_HP m_huge_pages;
+
+        /** @brief whether pages are mapped at allocation, on several
+         *  threads, rather than on first touch by the application */
+        bool m_prefault;
+
+        /** @brief NUMA placement of Snapshot memory, applied again
+         *  when memory is allocated at restart */
+        SDMT_NP m_placement;
+
+        /** @brief NUMA node of SDMT_NP_BIND */
+        int m_numa_node;
+    };
+
     /**
      * @brief a chunk of memory 
      *  which is the unit of allocation and management
@@ -40,7 +119,12 @@ class SDMT
             : m_id(-1),
             m_valuetype(SDMT_NUM_VT),
             m_datatype(SDMT_NUM_DT),
-            m_ptr(nullptr) {}
+            m_ptr(nullptr),
+            m_back(nullptr),
+            m_offset(-1),
+            m_external(false),
+            m_base(-1),
+            m_chain(0) {}
 
         /**
          * @brief SDMT::Snapshot constructor
@@ -50,19 +134,27 @@ class SDMT
          * @param dim size of each dimension
          * @param esize size of an element
          * @param ptr assigned memory
+         * @param opts optional attributes
          */
         Snapshot(int32_t id,
                 SDMT_VT vt,
                 SDMT_DT dt,
                 std::vector<int> dim,
                 int32_t esize,
-                void* ptr)
+                void* ptr,
+                const Options& opts = Options())
             : m_id(id),
             m_valuetype(vt),
             m_datatype(dt),
             m_dimension(dim),
             m_esize(esize),
-            m_ptr(ptr) {
+            m_ptr(ptr),
+            m_back(nullptr),
+            m_options(opts),
+            m_offset(-1),
+            m_external(false),
+            m_base(-1),
+            m_chain(0) {
             for (unsigned int i = 0; i < dim.size(); i++) {
                 int s = esize; 
                 for (unsigned int j = dim.size() - 1; j > i; j--) {
@@ -83,13 +175,31 @@ class SDMT
             m_dimension(other.m_dimension),
             m_strides(other.m_strides),
             m_esize(other.m_esize),
-            m_ptr(other.m_ptr) {}
+            m_ptr(other.m_ptr),
+            m_back(other.m_back),
+            m_options(other.m_options),
+            m_offset(other.m_offset),
+            m_external(other.m_external),
+            m_base(other.m_base),
+            m_chain(other.m_chain) {}
 
         /**
          * @brief SDMT::Snapshot destructor
          */
         ~Snapshot() {}
 
+        /**
+         * @brief byte size of data
+         * @return number of elements times element size
+         */
+        size_t bytes() const {
+            size_t size = m_esize;
+            for (auto d : m_dimension) {
+                size *= d;
+            }
+            return size;
+        }
+
         /** @brief id of Snapshot*/
         int32_t m_id;
 
@@ -110,18 +220,211 @@ class SDMT
 
         /** @brief memory pointer of data */
         void* m_ptr;
+
+        /** @brief the other buffer of a double buffered Snapshot,
+         *  read only while a checkpoint of it is in flight */
+        void* m_back;
+
+        /** @brief optional attributes */
+        Options m_options;
+
+        /** @brief byte offset of the memory in the arena of small
+         *  Snapshots, -1 if the Snapshot has memory of its own */
+        int64_t m_offset;
+
+        /** @brief whether the memory is owned by the application,
+         *  see register_external() */
+        bool m_external;
+
+        /** @brief id of the last native checkpoint holding this Snapshot,
+         *  -1 if the next native checkpoint has to be full */
+        int32_t m_base;
+
+        /** @brief number of deltas since the last full checkpoint */
+        int32_t m_chain;
+    };
+
+    /**
+     * @brief non-owning view of a Snapshot
+     * @details metadata is held inline, so a view is copied without heap
+     *  allocation. the layout is shared with the C and Fortran APIs.
+     *  a view is valid until the Snapshot is changed, its buffers are
+     *  swapped or it is recovered lazily
+     */
+    struct SnapshotView {
+        /** @brief maximum number of dimensions */
+        static const int kMaxRank = SDMT_NUM_DT - 1;
+
+        /**
+         * @brief create a null SnapshotView
+         */
+        SnapshotView()
+            : m_id(-1),
+            m_valuetype(SDMT_NUM_VT),
+            m_datatype(SDMT_NUM_DT),
+            m_rank(0),
+            m_esize(0),
+            m_ptr(nullptr),
+            m_back(nullptr) {
+            for (int i = 0; i < kMaxRank; i++) {
+                m_dimension[i] = 0;
+                m_strides[i] = 0;
+            }
+        }
+
+        /**
+         * @brief create a view of a Snapshot
+         * @param snapshot Snapshot to view
+         */
+        explicit SnapshotView(const Snapshot& snapshot)
+            : m_id(snapshot.m_id),
+            m_valuetype(snapshot.m_valuetype),
+            m_datatype(snapshot.m_datatype),
+            m_rank(snapshot.m_dimension.size()),
+            m_esize(snapshot.m_esize),
+            m_ptr(snapshot.m_ptr),
+            m_back(snapshot.m_back) {
+            for (int i = 0; i < kMaxRank; i++) {
+                m_dimension[i] = i < m_rank ? snapshot.m_dimension[i] : 0;
+                m_strides[i] = i < m_rank ? snapshot.m_strides[i] : 0;
+            }
+        }
+
+        /**
+         * @brief byte size of data
+         * @return number of elements times element size
+         */
+        size_t bytes() const {
+            size_t size = m_esize;
+            for (int i = 0; i < m_rank; i++) {
+                size *= m_dimension[i];
+            }
+            return size;
+        }
+
+        /** @brief id of Snapshot, -1 if null */
+        int32_t m_id;
+
+        /** @brief value type of elements in Snapshot */
+        SDMT_VT m_valuetype;
+
+        /** @brief type of data structure */
+        SDMT_DT m_datatype;
+
+        /** @brief number of dimensions */
+        int32_t m_rank;
+
+        /** @brief dimension of data, m_rank of them are used */
+        int32_t m_dimension[kMaxRank];
+
+        /** @brief byte strides for each index */
+        int32_t m_strides[kMaxRank];
+
+        /** @brief byte size of an element in Snapshot */
+        int32_t m_esize;
+
+        /** @brief memory pointer of data */
+        void* m_ptr;
+
+        /** @brief the other buffer of a double buffered Snapshot */
+        void* m_back;
     };
 
     /**
      * @brief configurations
      */
     struct Config {
+        /** @brief writer of checkpoints */
+        enum Backend {
+            /** FTI library */
+            FTI,
+            /** native checkpoint files of SDMT */
+            NATIVE,
+            /** one shared file of every rank written by MPI-IO */
+            MPIIO
+        };
+
+        /** @brief writer of asynchronous checkpoints */
+        enum AsyncMode {
+            /** I/O thread writing staged copies */
+            THREAD,
+            /** forked child process sharing memory copy-on-write.
+             *  it writes with system calls only and never calls MPI,
+             *  but memory registered for RDMA needs fork support enabled
+             *  in MPI(e.g. RDMAV_FORK_SAFE=1) */
+            FORK
+        };
+
+        /**
+         * @brief create default Config
+         */
+        Config() : m_backend(FTI), m_full_interval(8), m_block_size(4096),
+            m_compress_threads(0), m_recover_threads(0), m_memory_slots(2),
+            m_erasure_group(4), m_erasure_parity(1),
+            m_drain_bandwidth(0), m_direct_io(false),
+            m_async_mode(THREAD), m_lazy_recovery(false), m_retention(2),
+            m_alignment(0), m_huge_pages(SDMT_HP_NONE), m_prefault(false),
+            m_arena_size(0), m_arena_threshold(4096) {}
+
         /** @brief path to archive sdmt manager */
         std::string m_archive;
         /** @brief path to fti lib configuration file */
         std::string m_fti_config;
         /** @brief path to registered parameter file */
         std::string m_param_path;
+        /** @brief directory of native(non-FTI) checkpoint files */
+        std::string m_native_dir;
+        /** @brief node-local directory native checkpoints are written to
+         *  before they are copied to m_native_dir, empty if none */
+        std::string m_local_dir;
+        /** @brief writer of synchronous checkpoints */
+        Backend m_backend;
+        /** @brief every n-th native checkpoint of
+         *  an incremental Snapshot is full */
+        int m_full_interval;
+        /** @brief byte size of a block of hash based incremental Snapshot */
+        size_t m_block_size;
+        /** @brief number of compression threads,
+         *  0 for hardware concurrency */
+        int m_compress_threads;
+        /** @brief number of threads restoring Snapshots,
+         *  0 for hardware concurrency */
+        int m_recover_threads;
+        /** @brief number of in-memory checkpoints kept for rollback */
+        int m_memory_slots;
+        /** @brief number of ranks in an erasure coding group */
+        int m_erasure_group;
+        /** @brief number of lost ranks tolerated in an erasure coding group,
+         *  1 for XOR, more for Reed-Solomon */
+        int m_erasure_parity;
+        /** @brief aggregators and stripe size of MPI-IO backend */
+        CkptShared::Tuning m_mpiio;
+        /** @brief bandwidth copying from m_local_dir to m_native_dir,
+         *  MB per second, 0 for unlimited */
+        double m_drain_bandwidth;
+        /** @brief whether native checkpoint files bypass the page cache */
+        bool m_direct_io;
+        /** @brief queue depth and block size of direct I/O */
+        CkptDirect::Tuning m_direct;
+        /** @brief writer of asynchronous checkpoints */
+        AsyncMode m_async_mode;
+        /** @brief whether raw Snapshots of a native checkpoint are
+         *  faulted in on first access at restart */
+        bool m_lazy_recovery;
+        /** @brief native and shared checkpoints kept in m_native_dir,
+         *  the newest two at least */
+        CkptFile::Retention m_retention;
+        /** @brief least byte alignment of Snapshot memory, 0 for default */
+        size_t m_alignment;
+        /** @brief least huge page backing of Snapshot memory */
+        SDMT_HP m_huge_pages;
+        /** @brief whether memory of every Snapshot is prefaulted */
+        bool m_prefault;
+        /** @brief byte size of the arena small Snapshots are packed in,
+         *  0 if every Snapshot has memory of its own */
+        size_t m_arena_size;
+        /** @brief largest byte size of a Snapshot packed in the arena */
+        size_t m_arena_threshold;
     };
 
     /**
@@ -140,15 +443,129 @@ class SDMT
         int level;
     };
 
+    /**
+     * @brief volume of the last checkpoint
+     */
+    struct CkptStats {
+        /**
+         * @brief create empty CkptStats
+         */
+        CkptStats() : m_id(-1), m_rawsize(0), m_size(0) {}
+
+        /**
+         * @brief written bytes over Snapshot bytes
+         * @return 1 for full checkpoint, less for incremental one
+         */
+        double ratio() const
+        { return m_rawsize ? double(m_size) / m_rawsize : 1.0; }
+
+        /** @brief checkpoint id */
+        int32_t m_id;
+
+        /** @brief byte size of Snapshots in memory */
+        uint64_t m_rawsize;
+
+        /** @brief byte size of written payload */
+        uint64_t m_size;
+    };
+
+    /**
+     * @brief time spent in phases of the last recovery
+     */
+    struct RecoveryStats {
+        /**
+         * @brief create empty RecoveryStats
+         */
+        RecoveryStats() : m_id(-1), m_threads(1), m_lazy(0),
+            m_allocate(0), m_restore(0) {}
+
+        /**
+         * @brief time of the whole recovery
+         * @return seconds
+         */
+        double total() const { return m_allocate + m_restore; }
+
+        /** @brief recovered native checkpoint id, -1 for FTI */
+        int32_t m_id;
+
+        /** @brief number of threads restoring Snapshots */
+        int m_threads;
+
+        /** @brief number of Snapshots faulted in on first access */
+        int m_lazy;
+
+        /** @brief seconds allocating and touching memory at restart */
+        double m_allocate;
+
+        /** @brief seconds reading and decoding checkpoint data */
+        double m_restore;
+    };
+
+    /**
+     * @brief a checkpoint which can be recovered
+     */
+    struct CatalogEntry {
+        /**
+         * @brief create an empty CatalogEntry
+         */
+        CatalogEntry() : m_id(-1), m_level(0), m_iter(0), m_time(0),
+            m_rawsize(0), m_size(0) {}
+
+        /** @brief checkpoint id */
+        int32_t m_id;
+
+        /** @brief checkpoint level requested by application */
+        int32_t m_level;
+
+        /** @brief iteration sequence at checkpoint */
+        int32_t m_iter;
+
+        /** @brief wall clock time of checkpoint(seconds since epoch) */
+        double m_time;
+
+        /** @brief byte size of Snapshots of this rank in memory */
+        uint64_t m_rawsize;
+
+        /** @brief byte size of stored payload of this rank */
+        uint64_t m_size;
+    };
+
     /**
      * @brief hash map that mapping Snapshot'nams and Snapshot
      */
     typedef std::unordered_map<std::string, Snapshot> SnapshotMap;
 
+    /**
+     * @brief function called with the name and the new active buffer
+     *  of a double buffered Snapshot after its buffers are swapped
+     */
+    typedef std::function<void(const std::string&, void*)> FlipHook;
+
+    /**
+     * @brief handle of a registered Snapshot, its id
+     * @details valid from registration until finalize(), across
+     *  change_snapshot(), flip() and restart. -1 is no Snapshot
+     */
+    typedef int32_t SnapshotHandle;
+
+    /**
+     * @brief typed view of Snapshot memory, see SnapshotArray
+     */
+    template<typename T, int Rank>
+    using Array = SnapshotArray<T, Rank>;
+
+    /**
+     * @brief view of contiguous elements, see SnapshotSpan
+     */
+    template<typename T>
+    using Span = SnapshotSpan<T>;
+
     /**
      * @brief SDMT constructor
      */
-    SDMT() : m_cp_info(1, 1), m_cp_idx(0), m_iter(0), m_comm(NULL) {}
+    SDMT() : m_cp_info(1, 1), m_cp_idx(0), m_iter(0), m_comm(NULL),
+        m_rank(0), m_fti_id(-1), m_ckpt_ranks(0), m_fti_intervals(),
+        m_fti_start(0), m_fti_minute(0), m_arena_used(0) {}
 
     /**
      * @brief [static]get SDMT manager singleton
@@ -188,13 +605,127 @@ class SDMT
      * @param vt value type
      * @param dt data type
      * @param dim size of each dimension
+     * @param opts optional attributes
+     * @return status code
+     */
+    static SDMT_Code register_snapshot(std::string name,
+                                SDMT_VT vt,
+                                SDMT_DT dt,
+                                std::vector<int> dim,
+                                const Options& opts = Options())
+    { return get_manager().register_snapshot_(name, vt, dt, dim, opts); }
+
+    /**
+     * @brief [static]register a Snapshot and get its handle
+     * @param name name of the Snapshot
+     * @param vt value type
+     * @param dt data type
+     * @param dim size of each dimension
+     * @param handle [out] handle of the Snapshot, -1 if failed
+     * @param opts optional attributes
      * @return status code
      */
     static SDMT_Code register_snapshot(std::string name,
                                 SDMT_VT vt,
                                 SDMT_DT dt,
-                                std::vector<int> dim)
-    { return get_manager().register_snapshot_(name, vt, dt, dim); }
+                                std::vector<int> dim,
+                                SnapshotHandle& handle,
+                                const Options& opts = Options()) {
+        SDMT_Code res = get_manager().register_snapshot_(name, vt, dt, dim,
+                opts);
+        handle = res == SDMT_SUCCESS ? lookup(name) : -1;
+        return res;
+    }
+
+    /**
+     * @brief [static]register a Snapshot of an element type
+     * @details the value type follows T and the data type the number of
+     *  dimensions, e.g. register_array<double>("u", {nx, ny}, handle)
+     * @tparam T element type, int, long, float or double
+     * @param name name of the Snapshot
+     * @param dim size of each dimension
+     * @param handle [out] handle of the Snapshot, -1 if failed
+     * @param opts optional attributes
+     * @return status code
+     */
+    template<typename T>
+    static SDMT_Code register_array(std::string name,
+                                std::vector<int> dim,
+                                SnapshotHandle& handle,
+                                const Options& opts = Options()) {
+        return register_snapshot(name, ValueTraits<T>::value_type(),
+                static_cast<SDMT_DT>(dim.size()), dim, handle, opts);
+    }
+
+    /**
+     * @brief [static]register memory of the application as a Snapshot
+     * @details the memory is protected in place, neither copied nor freed,
+     *  and has to be valid until it is rebound. change_snapshot() is not
+     *  accepted, rebind() resizes it. strides may describe any dense
+     *  layout, e.g. column major of Fortran. options allocating memory,
+     *  alignment, prefault, double buffer, SDMT_IM_PAGE, huge pages and
+     *  NUMA placement, are not accepted. at restart, the Snapshot is
+     *  recovered into memory of SDMT until rebind() adopts the application's
+     * @param name name of the Snapshot
+     * @param ptr memory of the application
+     * @param vt value type
+     * @param dt data type
+     * @param dim size of each dimension
+     * @param strides byte strides for each index, empty for row major
+     * @param opts optional attributes
+     * @return status code
+     */
+    static SDMT_Code register_external(std::string name,
+                                void* ptr,
+                                SDMT_VT vt,
+                                SDMT_DT dt,
+                                std::vector<int> dim,
+                                std::vector<int> strides = std::vector<int>(),
+                                const Options& opts = Options())
+    { return get_manager().register_external_(name, ptr, vt, dt, dim,
+            strides, opts); }
+
+    /**
+     * @brief [static]protect other memory of the application
+     *  as a Snapshot of the same shape
+     * @details memory of SDMT, e.g. recovered at restart, is copied to ptr
+     *  and freed, memory of the application is left as it is
+     * @param name name of the Snapshot
+     * @param ptr memory of the application
+     * @return status code
+     */
+    static SDMT_Code rebind(const std::string& name, void* ptr)
+    { return get_manager().rebind_(name, ptr, nullptr, nullptr); }
+
+    /**
+     * @brief [static]protect reallocated memory of the application
+     *  as a Snapshot of another shape
+     * @details the number of dimensions stays. memory of SDMT is copied
+     *  to ptr only if the byte size stays
+     * @param name name of the Snapshot
+     * @param ptr memory of the application
+     * @param dim size of each dimension
+     * @param strides byte strides for each index, empty for row major
+     * @return status code
+     */
+    static SDMT_Code rebind(const std::string& name,
+                                void* ptr,
+                                const std::vector<int>& dim,
+                                const std::vector<int>& strides
+                                    = std::vector<int>())
+    { return get_manager().rebind_(name, ptr, &dim, &strides); }
+
+    /**
+     * @brief [static]get the extent of a distributed dimension on this rank
+     * @details the dimension of a distributed Snapshot along its axis,
+     *  see Options::m_global
+     * @param extent global extent of the dimension
+     * @param block block size of block-cyclic decomposition,
+     *  0 for contiguous blocks
+     * @return local extent
+     */
+    static int local_extent(int extent, int block = 0)
+    { return get_manager().local_extent_(extent, block); }
    
     /**
      * @brief [static]register a int type parameter to be adjusted
@@ -283,33 +814,222 @@ class SDMT
     /**
      * @brief [static]create a checkpoint of a Snapshot
      * @param level checkpoint method
+     * @param async if true, return as soon as Snapshots are staged
+     *  and write them in background
      * @return status code
      */
-    static SDMT_Code checkpoint(int level)
-    { return get_manager().checkpoint_(level); }
+    static SDMT_Code checkpoint(int level, bool async = false)
+    { return get_manager().checkpoint_(level, async); }
+
+    /**
+     * @brief [static]wait until the asynchronous checkpoint is written
+     * @return status code
+     */
+    static SDMT_Code wait_checkpoint()
+    { return get_manager().wait_checkpoint_(); }
+
+    /**
+     * @brief [static]get status of the asynchronous checkpoint
+     * @return checkpoint status
+     */
+    static SDMT_CS checkpoint_status()
+    { return get_manager().checkpoint_status_(); }
+
+    /**
+     * @brief [static]wait until checkpoints are copied to the global directory
+     * @details asynchronous checkpoints are waited for first
+     * @return status code
+     */
+    static SDMT_Code wait_drain()
+    { return get_manager().wait_drain_(); }
+
+    /**
+     * @brief [static]wait until lazily recovered Snapshots are fully loaded
+     * @details returns immediately unless the last restart recovered lazily
+     * @return status code
+     */
+    static SDMT_Code wait_recovery()
+    { return get_manager().wait_recovery_(); }
+
+    /**
+     * @brief [static]get volume of the last checkpoint
+     * @return checkpoint statistics
+     */
+    static CkptStats checkpoint_stats()
+    { return get_manager().checkpoint_stats_(); }
+
+    /**
+     * @brief [static]get time spent in phases of the last recovery
+     * @return recovery statistics
+     */
+    static RecoveryStats recovery_stats()
+    { return get_manager().recovery_stats_(); }
+
+    /**
+     * @brief [static]swap the buffers of a double buffered Snapshot
+     * @details the buffer just written becomes the back buffer.
+     *  waits for the checkpoint in flight, which may write the other one
+     * @param name name of the Snapshot
+     * @return status code
+     */
+    static SDMT_Code flip(std::string name)
+    { return get_manager().flip_(name); }
+
+    /**
+     * @brief [static]set the function called after buffers are swapped
+     * @details called by flip() and by asynchronous checkpoints,
+     *  so that views of Snapshot memory can be rebound
+     * @param hook function to call, empty to remove
+     */
+    static void set_flip_hook(FlipHook hook)
+    { get_manager().set_flip_hook_(hook); }
 
     /**
      * @brief [static]recover checkpointed Snapshots
      * @return status code
      */
     static SDMT_Code recover()
-    { return get_manager().recover_(); }
+    { return get_manager().recover_(std::set<std::string>(), false, -1); }
+
+    /**
+     * @brief [static]recover every Snapshot from a checkpoint of the catalog
+     * @details collective. the iteration sequence goes back as well,
+     *  the next checkpoint id goes on from the newest
+     * @param id checkpoint id
+     * @return status code
+     */
+    static SDMT_Code recover(int id)
+    { return get_manager().recover_(std::set<std::string>(), false, id); }
+
+    /**
+     * @brief [static]list checkpoints every rank can recover from
+     * @details collective. native and shared checkpoints in the global or
+     *  node-local directory, old ones are deleted by the retention policy.
+     *  FTI keeps its last checkpoint only, which recover() reads
+     * @return entries in ascending order of id
+     */
+    static std::vector<CatalogEntry> catalog()
+    { return get_manager().catalog_(); }
+
+    /**
+     * @brief [static]recover chosen Snapshots only
+     * @details the others and the iteration sequence are left as they are.
+     *  collective if the newest checkpoint is written by MPI-IO backend
+     * @param names names of Snapshots to recover
+     * @return status code
+     */
+    static SDMT_Code recover(const std::vector<std::string>& names)
+    { return get_manager().recover_snapshots_(names); }
+
+    /**
+     * @brief [static]recover a Snapshot only
+     * @param name name of Snapshot to recover
+     * @return status code
+     */
+    static SDMT_Code recover_snapshot(std::string name)
+    { return get_manager().recover_snapshots_({name}); }
+
+    /**
+     * @brief [static]copy Snapshots to an in-memory checkpoint
+     * @details the last MemorySlots copies are kept, nothing goes to storage
+     * @return status code
+     */
+    static SDMT_Code checkpoint_memory()
+    { return get_manager().checkpoint_memory_(); }
+
+    /**
+     * @brief [static]restore Snapshots from an in-memory checkpoint
+     * @param k 0 for the newest in-memory checkpoint, 1 for the one before
+     * @return status code
+     */
+    static SDMT_Code rollback(int k = 0)
+    { return get_manager().rollback_(k); }
+
+    /**
+     * @brief [static]replicate Snapshots in the memory of a partner rank
+     * @details collective, the partner is on another node if any
+     * @return status code
+     */
+    static SDMT_Code checkpoint_partner()
+    { return get_manager().checkpoint_partner_(); }
+
+    /**
+     * @brief [static]restore Snapshots from the copy kept by the partner
+     * @details collective
+     * @return status code
+     */
+    static SDMT_Code recover_partner()
+    { return get_manager().recover_partner_(); }
+
+    /**
+     * @brief [static]keep Snapshots in memory protected by erasure codes
+     * @details collective, parity is computed over groups of ranks.
+     *  fails with SDMT_ERR_FAILED_CHECKPOINT on a single rank
+     * @return status code
+     */
+    static SDMT_Code checkpoint_erasure()
+    { return get_manager().checkpoint_erasure_(); }
+
+    /**
+     * @brief [static]restore Snapshots, rebuilding those of lost ranks
+     * @details collective
+     * @return status code
+     */
+    static SDMT_Code recover_erasure()
+    { return get_manager().recover_erasure_(); }
 
     /**
      * @brief [static] check a specific snapshot exsits
      * @param name name of snapshot
      * @return true if exists
      */
-    static bool exist(std::string name)
+    static bool exist(const std::string& name)
     { return get_manager().exist_(name); }
 
     /**
      * @brief [static] get Snapshot
      * @return Snapshot, null if name is incorrect
      */
-    static Snapshot get_snapshot(std::string name)
+    static Snapshot get_snapshot(const std::string& name)
     { return get_manager().get_snapshot_(name); }
 
+    /**
+     * @brief [static]get the handle of a registered Snapshot
+     * @param name name of the Snapshot
+     * @return handle, -1 if name is incorrect
+     */
+    static SnapshotHandle lookup(const std::string& name)
+    { return get_manager().lookup_(name); }
+
+    /**
+     * @brief [static]get Snapshot by handle
+     * @param handle handle of the Snapshot
+     * @return Snapshot, null if handle is incorrect
+     */
+    static Snapshot get_snapshot(SnapshotHandle handle) {
+        const Snapshot* snapshot = get_manager().handle_(handle);
+        return snapshot ? *snapshot : Snapshot();
+    }
+
+    /**
+     * @brief [static]get a view of Snapshot by handle
+     * @details unlike get_snapshot(), nothing is allocated
+     * @param handle handle of the Snapshot
+     * @return view, null if handle is incorrect
+     */
+    static SnapshotView view(SnapshotHandle handle) {
+        const Snapshot* snapshot = get_manager().handle_(handle);
+        return snapshot ? SnapshotView(*snapshot) : SnapshotView();
+    }
+
+    /**
+     * @brief [static]get a view of Snapshot by name
+     * @param name name of the Snapshot
+     * @return view, null if name is incorrect
+     */
+    static SnapshotView view(const std::string& name)
+    { return view(lookup(name)); }
+
     /**
      * @brierf get current iteration sequence
      * @return current iteration number
@@ -329,7 +1049,7 @@ class SDMT
      * @param name name of the Snapshot
      * @return integer pointer, null if name is incorrect
      */
-    static int* intptr(std::string name)
+    static int* intptr(const std::string& name)
     { return get_manager().intptr_(name); }
 
     /**
@@ -337,7 +1057,7 @@ class SDMT
      * @param name name of the Snapshot
      * @return long integer pointer, null if name is incorrect
      */
-    static long* longptr(std::string name)
+    static long* longptr(const std::string& name)
     { return get_manager().longptr_(name); }
 
     /**
@@ -345,7 +1065,7 @@ class SDMT
      * @param name name of the Snapshot
      * @return float pointer, null if name is incorrect
      */
-    static float* floatptr(std::string name)
+    static float* floatptr(const std::string& name)
     { return get_manager().floatptr_(name); }
 
     /**
@@ -353,24 +1073,113 @@ class SDMT
      * @param name name of the Snapshot
      * @return double pointer, null if name is incorrect
      */
-    static double* doubleptr(std::string name)
+    static double* doubleptr(const std::string& name)
     { return get_manager().doubleptr_(name); }
 
     /**
-     * @brief get MPI communicator
-     * @return FTI_COMM_WORLD
+     * @brief [static]get memory pointer of registered Snapshot by handle
+     * @details no hashing, for use in iteration loops. the pointer is
+     *  the active buffer of a double buffered Snapshot
+     * @param handle handle of the Snapshot
+     * @return integer pointer, null if handle is incorrect
+     *  or the Snapshot is not of int
      */
-    static MPI_Comm comm() 
-    { return get_manager().comm_(); }
+    static int* intptr(SnapshotHandle handle) {
+        return ptr<int>(handle);
+    }
 
-  private:
     /**
-     * @brief init sdmt module
-     * @param config path of config file
-     * @param restart if archive exists, recover manager
-     * @return status code
+     * @brief [static]get memory pointer of registered Snapshot by handle
+     * @param handle handle of the Snapshot
+     * @return long integer pointer, null if handle is incorrect
+     *  or the Snapshot is not of long
      */
-    SDMT_Code init_(std::string config, bool restart);
+    static long* longptr(SnapshotHandle handle) {
+        return ptr<long>(handle);
+    }
+
+    /**
+     * @brief [static]get memory pointer of registered Snapshot by handle
+     * @param handle handle of the Snapshot
+     * @return float pointer, null if handle is incorrect
+     *  or the Snapshot is not of float
+     */
+    static float* floatptr(SnapshotHandle handle) {
+        return ptr<float>(handle);
+    }
+
+    /**
+     * @brief [static]get memory pointer of registered Snapshot by handle
+     * @param handle handle of the Snapshot
+     * @return double pointer, null if handle is incorrect
+     *  or the Snapshot is not of double
+     */
+    static double* doubleptr(SnapshotHandle handle) {
+        return ptr<double>(handle);
+    }
+
+    /**
+     * @brief [static]get typed memory pointer of Snapshot by handle
+     * @tparam T element type, int, long, float or double
+     * @param handle handle of the Snapshot
+     * @return pointer, null if handle is incorrect
+     *  or the Snapshot is not of T
+     */
+    template<typename T>
+    static T* ptr(SnapshotHandle handle) {
+        return static_cast<T*>(get_manager().handle_ptr_(handle,
+                    ValueTraits<T>::value_type()));
+    }
+
+    /**
+     * @brief [static]get typed view of Snapshot memory by handle
+     * @details get it again after the Snapshot is changed, its buffers
+     *  are swapped or it is recovered
+     * @tparam T element type, int, long, float or double
+     * @tparam Rank number of dimensions
+     * @param handle handle of the Snapshot
+     * @return view, null if handle is incorrect, the Snapshot is not of T
+     *  or has another number of dimensions
+     */
+    template<typename T, int Rank>
+    static Array<T, Rank> array(SnapshotHandle handle) {
+        const Snapshot* snapshot = get_manager().handle_(handle);
+        if (snapshot == nullptr
+                || snapshot->m_valuetype != ValueTraits<T>::value_type()
+                || snapshot->m_dimension.size() != (size_t)Rank) {
+            return Array<T, Rank>();
+        }
+        return Array<T, Rank>(static_cast<T*>(snapshot->m_ptr),
+                snapshot->m_dimension.data(), snapshot->m_strides.data());
+    }
+
+    /**
+     * @brief [static]get typed view of Snapshot memory by name
+     * @tparam T element type, int, long, float or double
+     * @tparam Rank number of dimensions
+     * @param name name of the Snapshot
+     * @return view, null if name is incorrect, the Snapshot is not of T
+     *  or has another number of dimensions
+     */
+    template<typename T, int Rank>
+    static Array<T, Rank> array(const std::string& name)
+    { return array<T, Rank>(lookup(name)); }
+
+    /**
+     * @brief get MPI communicator
+     * @return FTI_COMM_WORLD
+     */
+    static MPI_Comm comm() 
+    { return get_manager().comm_(); }
+
+  private:
+    /**
+     * @brief init sdmt module
+     * @param config path of config file
+     * @param restart if archive exists, recover manager
+     * @return status code
+     */
+    SDMT_Code init_(std::string config, bool restart);
 
     /**
      * @brief start simulation process and data management
@@ -390,12 +1199,60 @@ class SDMT
      * @param vt value type
      * @param dt data type
      * @param dim size of each dimension
+     * @param opts optional attributes
      * @return status code
      */
     SDMT_Code register_snapshot_(std::string name,
                             SDMT_VT vt,
                             SDMT_DT dt,
-                            std::vector<int> dim);
+                            std::vector<int> dim,
+                            const Options& opts);
+
+    /**
+     * @brief register memory of the application as a Snapshot
+     * @param name name of the Snapshot
+     * @param ptr memory of the application
+     * @param vt value type
+     * @param dt data type
+     * @param dim size of each dimension
+     * @param strides byte strides for each index, empty for row major
+     * @param opts optional attributes
+     * @return status code
+     */
+    SDMT_Code register_external_(std::string name,
+                            void* ptr,
+                            SDMT_VT vt,
+                            SDMT_DT dt,
+                            std::vector<int> dim,
+                            std::vector<int> strides,
+                            const Options& opts);
+
+    /**
+     * @brief protect other memory of the application as a Snapshot
+     * @param name name of the Snapshot
+     * @param ptr memory of the application
+     * @param dim size of each dimension, nullptr for the same shape
+     * @param strides byte strides for each index, empty for row major
+     * @return status code
+     */
+    SDMT_Code rebind_(const std::string& name,
+                            void* ptr,
+                            const std::vector<int>* dim,
+                            const std::vector<int>* strides);
+
+    /**
+     * @brief check type, dimension and optional attributes of
+     *  a Snapshot to register
+     * @param vt value type
+     * @param dt data type
+     * @param dim size of each dimension
+     * @param opts optional attributes
+     * @return status code
+     */
+    SDMT_Code check_snapshot_(SDMT_VT vt,
+                            SDMT_DT dt,
+                            const std::vector<int>& dim,
+                            const Options& opts);
 
     /**
      * @brief register a int type parameter to be adjusted
@@ -476,28 +1333,471 @@ class SDMT
     /**
      * @brief create checkpoints of registered Snapshot
      * @param level checkpoint method
+     * @param async if true, write checkpoint in background
+     * @return status code
+     */
+    SDMT_Code checkpoint_(int level, bool async);
+
+    /**
+     * @brief wait until the asynchronous checkpoint is written
+     * @return status code
+     */
+    SDMT_Code wait_checkpoint_();
+
+    /**
+     * @brief get status of the asynchronous checkpoint
+     * @return checkpoint status
+     */
+    SDMT_CS checkpoint_status_();
+
+    /**
+     * @brief wait until checkpoints are copied to the global directory
+     * @return status code
+     */
+    SDMT_Code wait_drain_();
+
+    /**
+     * @brief wait until lazily recovered Snapshots are fully loaded
+     * @return status code
+     */
+    SDMT_Code wait_recovery_();
+
+    /**
+     * @brief get volume of the last checkpoint
+     * @return checkpoint statistics
+     */
+    CkptStats checkpoint_stats_();
+
+    /**
+     * @brief get time spent in phases of the last recovery
+     * @return recovery statistics
+     */
+    RecoveryStats recovery_stats_();
+
+    /**
+     * @brief [static]list checkpoints every rank can recover from
+     * @return entries in ascending order of id
+     */
+    std::vector<CatalogEntry> catalog_();
+
+    /**
+     * @brief swap the buffers of a double buffered Snapshot
+     * @param name name of the Snapshot
+     * @return status code
+     */
+    SDMT_Code flip_(std::string name);
+
+    /**
+     * @brief set the function called after buffers are swapped
+     * @param hook function to call
+     */
+    void set_flip_hook_(FlipHook hook);
+
+    /**
+     * @brief swap the buffers of a Snapshot and register the active one
+     * @param name name of the Snapshot
+     * @param snapshot double buffered Snapshot
+     */
+    void swap_buffers_(const std::string& name, Snapshot& snapshot);
+
+    /**
+     * @brief write registered Snapshots as a native checkpoint
+     * @param level checkpoint method
+     * @param async if true, stage Snapshots and write them in background
+     * @return status code
+     */
+    SDMT_Code checkpoint_native_(int level, bool async);
+
+    /**
+     * @brief write registered Snapshots of every rank into a shared file
+     * @param level checkpoint method
+     * @return status code
+     */
+    SDMT_Code checkpoint_shared_(int level);
+
+    /**
+     * @brief queue a native checkpoint to copy to the global directory
+     * @details thread safe
+     * @param id checkpoint id
+     */
+    void drain_(int id);
+
+    /**
+     * @brief get the path of a native checkpoint file of a rank
+     * @details the node-local copy is preferred as it is faster
+     * @param id checkpoint id
+     * @param rank rank which wrote the file
+     * @return path of the file
+     */
+    std::string native_path_(int id, int rank);
+
+    /**
+     * @brief encode a Snapshot into a native checkpoint Record
+     * @param name name of the Snapshot
+     * @param snapshot Snapshot to encode
+     * @param id checkpoint id
+     * @param copy if true, payload must not refer to Snapshot memory
+     * @param record [out] encoded Record
+     */
+    void stage_(const std::string& name,
+                Snapshot& snapshot,
+                int id,
+                bool copy,
+                CkptFile::Record& record);
+
+    /**
+     * @brief find blocks changed since the previous checkpoint by hashing
+     * @param snapshot Snapshot to scan
+     * @param block byte size of a block
+     * @param blocks [out] ascending indices of changed blocks
+     * @return false if there is no previous hash to compare with
+     */
+    bool changed_blocks_(Snapshot& snapshot,
+                size_t block,
+                std::vector<uint64_t>& blocks);
+
+    /**
+     * @brief level of FTI checkpoint due at a level 0 checkpoint,
+     * by the schedule of FTI_Snapshot as decided on rank 0
+     * @return level 1~4, or 0 if none is due
+     */
+    int snapshot_level_();
+
+    /**
+     * @brief compress a Snapshot and let FTI write the compressed image
+     * @param snapshot Snapshot to compress
+     * @return byte size of compressed image
+     */
+    size_t pack_(Snapshot& snapshot);
+
+    /**
+     * @brief decompress a Snapshot recovered by FTI
+     * @param snapshot Snapshot to decompress
+     * @return true if success
+     */
+    bool unpack_(Snapshot& snapshot);
+
+    /**
+     * @brief recover Snapshots from a native checkpoint file
+     * @param id checkpoint id
+     * @param names names of Snapshots to recover, empty for all
+     * @param lazy whether raw Snapshots are faulted in on first access
+     * @return status code
+     */
+    SDMT_Code recover_native_(int id, const std::set<std::string>& names,
+            bool lazy);
+
+    /**
+     * @brief recover Snapshots from a shared checkpoint file
+     * @param id checkpoint id
+     * @param names names of Snapshots to recover, empty for all
+     * @return status code
+     */
+    SDMT_Code recover_shared_(int id, const std::set<std::string>& names);
+
+    /**
+     * @brief recover Snapshots from native checkpoint files
+     *  written by a different number of ranks
+     * @details each rank reads the files of old ranks congruent to it
+     *  modulo the number of ranks, distributed Snapshots are
+     *  redistributed by collectives, the others are read from
+     *  the file of old rank (rank % old ranks)
+     * @param names names of Snapshots to recover, empty for all
+     * @param id checkpoint id, -1 for the newest
+     * @return status code
+     */
+    SDMT_Code recover_redistributed_(const std::set<std::string>& names,
+            int id);
+
+    /**
+     * @brief [static]get the extent of a distributed dimension on this rank
+     * @param extent global extent of the dimension
+     * @param block block size, 0 for contiguous blocks
+     * @return local extent
+     */
+    int local_extent_(int extent, int block);
+
+    /**
+     * @brief check the dimension of a distributed Snapshot on this rank
+     * @param dim dimension of this rank
+     * @param opts optional attributes with the global shape
      * @return status code
      */
-    SDMT_Code checkpoint_(int level);
+    SDMT_Code check_distribution_(const std::vector<int>& dim,
+            const Options& opts);
+
+    /**
+     * @brief keep Records of chosen Snapshots only
+     * @param names names of Snapshots to keep, empty for all
+     * @param records [in,out] Records of a checkpoint
+     * @return false if a chosen Snapshot is not in the checkpoint
+     */
+    bool select_(const std::set<std::string>& names,
+            std::vector<CkptFile::Record>& records);
+
+    /**
+     * @brief restore a Snapshot image from a native checkpoint
+     * @details deltas are applied on top of their bases recursively
+     * @param id checkpoint id
+     * @param rank rank which wrote the checkpoint file
+     * @param record Record of the Snapshot in the checkpoint
+     * @param dst destination memory
+     * @param bound error of lossy compression accepted by the Snapshot
+     * @return true if success
+     */
+    bool restore_(int id,
+                int rank,
+                const CkptFile::Record& record,
+                void* dst,
+                double bound);
+
+    /**
+     * @brief restore a full Snapshot image from its payload in memory
+     * @param record Record of the Snapshot
+     * @param payload payload of the Record
+     * @param dst destination memory
+     * @param bound error of lossy compression accepted by the Snapshot
+     * @return true if success
+     */
+    bool restore_full_(const CkptFile::Record& record,
+                const char* payload,
+                void* dst,
+                double bound);
+
+    /**
+     * @brief allocate memory of a Snapshot
+     * @param size byte size
+     * @param opts optional attributes of the Snapshot
+     * @param touch whether pages are zeroed by several threads,
+     *  so they are mapped before recovery writes them
+     * @return memory pointer, nullptr if failed
+     */
+    void* allocate_(size_t size, const Options& opts, bool touch = false);
+
+    /**
+     * @brief place memory of a Snapshot on NUMA nodes and map its pages
+     * @param ptr memory pointer
+     * @param size byte size
+     * @param opts optional attributes of the Snapshot
+     * @param touch whether pages are zeroed by several threads
+     */
+    void place_(void* ptr, size_t size, const Options& opts, bool touch);
+
+    /**
+     * @brief check whether memory of a Snapshot is prefaulted
+     * @param opts optional attributes of the Snapshot
+     * @return true if the Snapshot or the configuration asks for it
+     */
+    bool prefault_(const Options& opts) const
+    { return opts.m_prefault || m_config.m_prefault; }
+
+    /**
+     * @brief check whether memory of a Snapshot can be recovered lazily
+     * @details write-protected pages, pages touched by threads of the
+     *  application and explicit huge pages, which userfaultfd fills in
+     *  huge page units only, are restored eagerly
+     * @param opts optional attributes of the Snapshot
+     * @return true if its pages can be faulted in
+     */
+    bool faultable_(const Options& opts) const
+    {
+        return opts.m_incremental != SDMT_IM_PAGE
+            && opts.m_placement != SDMT_NP_FIRST_TOUCH
+            && std::max(opts.m_huge_pages, m_config.m_huge_pages)
+                != SDMT_HP_EXPLICIT;
+    }
+
+    /**
+     * @brief map memory on explicit huge pages
+     * @param size byte size
+     * @return memory pointer, nullptr if the hugetlb pool is exhausted
+     */
+    void* map_huge_(size_t size);
+
+    /**
+     * @brief free memory from allocate_()
+     * @param ptr memory pointer, may be nullptr
+     */
+    void free_(void* ptr);
+
+    /**
+     * @brief release memory of a Snapshot
+     * @details a slot of the arena is not reused
+     * @param snapshot Snapshot to release
+     */
+    void release_(Snapshot& snapshot);
+
+    /**
+     * @brief check whether a Snapshot is packed in the arena
+     * @param size byte size
+     * @param opts optional attributes of the Snapshot
+     * @return true if small and without options needing memory of its own
+     */
+    bool arena_fits_(size_t size, const Options& opts) const;
+
+    /**
+     * @brief take a slot of the arena, creating the arena at first
+     * @param size byte size
+     * @param opts optional attributes of the Snapshot
+     * @param offset [out] byte offset in the arena
+     * @return memory pointer, nullptr if the Snapshot does not fit
+     */
+    void* arena_place_(size_t size, const Options& opts, int64_t& offset);
+
+    /**
+     * @brief write the offsets of the members at the tail of the arena,
+     * so every checkpoint of the arena holds its layout
+     * @details called whenever a member is placed or the arena recovered
+     */
+    void arena_layout_();
+
+    /**
+     * @brief copy members out of a recovered arena image
+     * @details each member is taken from the offset in the layout saved
+     *  with the image, which may be the arena itself
+     * @param image recovered arena
+     * @param members members to recover
+     * @return true if every member is in the layout with its byte size
+     */
+    bool arena_restore_(const char* image,
+            const std::vector<Snapshot*>& members);
+
+    /**
+     * @brief move every member of an arena recovered in place
+     * from its saved offset to its current one
+     * @return SDMT_SUCCESS, or SDMT_ERR_FAILED_RECOVERY if the saved
+     *  layout does not hold a member
+     */
+    SDMT_Code arena_relocate_();
+
+    /**
+     * @brief Snapshots as written to checkpoints
+     * @details members of the arena are written as the arena
+     * @return pairs of name and Snapshot
+     */
+    std::vector<std::pair<std::string, Snapshot*>> stored_();
+
+    /**
+     * @brief find a Snapshot as written to checkpoints
+     * @param name name of the Snapshot or of the arena
+     * @return Snapshot, nullptr if name is incorrect or a member of the arena
+     */
+    Snapshot* stored_(const std::string& name);
+
+    /**
+     * @brief make Snapshot memory writable by system calls before recovery
+     * @details incremental Snapshots restart from a full checkpoint
+     */
+    void prepare_recovery_(const std::set<std::string>& names);
+
+    /**
+     * @brief get the newest native checkpoint completed by all ranks
+     * @return checkpoint id, -1 if none
+     */
+    int latest_native_();
+
+    /**
+     * @brief get the newest shared checkpoint
+     * @return checkpoint id, -1 if none
+     */
+    int latest_shared_();
 
     /**
      * @brief [static]recover checkpointed Snapshot
+     * @param names names of Snapshots to recover, empty for all
+     *  with the iteration sequence
+     * @param lazy whether raw Snapshots of a native checkpoint
+     *  are faulted in on first access
+     * @param id checkpoint id, -1 for the newest
+     * @return status code
+     */
+    SDMT_Code recover_(const std::set<std::string>& names, bool lazy, int id);
+
+    /**
+     * @brief [static]recover chosen Snapshots
+     * @param names names of Snapshots to recover
+     * @return status code
+     */
+    SDMT_Code recover_snapshots_(const std::vector<std::string>& names);
+
+    /**
+     * @brief recover from the newest of native, shared and FTI checkpoints
+     * @param names names of Snapshots to recover, empty for all
+     * @param lazy whether raw Snapshots of a native checkpoint
+     *  are faulted in on first access
      * @return status code
      */
-    SDMT_Code recover_();
+    SDMT_Code recover_latest_(const std::set<std::string>& names, bool lazy);
+
+    /**
+     * @brief recover every Snapshot from a checkpoint of the catalog
+     * @param id checkpoint id
+     * @return status code
+     */
+    SDMT_Code recover_checkpoint_(int id);
+
+    /**
+     * @brief recover Snapshots from the last FTI checkpoint
+     * @param names names of Snapshots to recover, empty for all
+     * @return status code
+     */
+    SDMT_Code recover_fti_(const std::set<std::string>& names);
+
+    /**
+     * @brief copy Snapshots to an in-memory checkpoint
+     * @return status code
+     */
+    SDMT_Code checkpoint_memory_();
+
+    /**
+     * @brief restore Snapshots from an in-memory checkpoint
+     * @param k 0 for the newest in-memory checkpoint, 1 for the one before
+     * @return status code
+     */
+    SDMT_Code rollback_(int k);
+
+    /**
+     * @brief replicate Snapshots in the memory of a partner rank
+     * @return status code
+     */
+    SDMT_Code checkpoint_partner_();
+
+    /**
+     * @brief restore Snapshots from the copy kept by the partner
+     * @return status code
+     */
+    SDMT_Code recover_partner_();
+
+    /**
+     * @brief keep Snapshots in memory protected by erasure codes
+     * @return status code
+     */
+    SDMT_Code checkpoint_erasure_();
+
+    /**
+     * @brief restore Snapshots, rebuilding those of lost ranks
+     * @return status code
+     */
+    SDMT_Code recover_erasure_();
+
+    /**
+     * @brief memory regions of Snapshots in the order of Snapshot id
+     * @return regions of every registered Snapshot
+     */
+    std::vector<CkptRing::Region> regions_();
 
     /**
      * @brief [static] check a specific snapshot exsits
      * @param name name of snapshot
      * @return true if exists
      */
-    bool exist_(std::string name);
+    bool exist_(const std::string& name);
 
     /**
      * @brief get Snapshot
      * @return Snapshot, null if name is incorrect
      */
-    Snapshot get_snapshot_(std::string name);
+    Snapshot get_snapshot_(const std::string& name);
 
     /**
      * @brierf get current iteration sequence
@@ -516,28 +1816,66 @@ class SDMT
      * @param name name of the Snapshot
      * @return integer pointer, null if name is incorrect
      */
-    int* intptr_(std::string name);
+    int* intptr_(const std::string& name);
 
     /**
      * @brief get memory pointer of registered Snapshot
      * @param name name of the Snapshot
      * @return long integer pointer, null if name is incorrect
      */
-    long* longptr_(std::string name);
+    long* longptr_(const std::string& name);
 
     /**
      * @brief get memory pointer of registered Snapshot
      * @param name name of the Snapshot
      * @return float pointer, null if name is incorrect
      */
-    float* floatptr_(std::string name);
+    float* floatptr_(const std::string& name);
 
     /**
      * @brief get memory pointer of registered Snapshot
      * @param name name of the Snapshot
      * @return double pointer, null if name is incorrect
      */
-    double* doubleptr_(std::string name);
+    double* doubleptr_(const std::string& name);
+
+    /**
+     * @brief get the handle of a registered Snapshot
+     * @param name name of the Snapshot
+     * @return handle, -1 if name is incorrect
+     */
+    SnapshotHandle lookup_(const std::string& name);
+
+    /**
+     * @brief get Snapshot by handle
+     * @param handle handle of the Snapshot
+     * @return Snapshot, null if handle is incorrect
+     */
+    const Snapshot* handle_(SnapshotHandle handle) const {
+        if (handle < 0 || handle >= (SnapshotHandle)m_handles.size()) {
+            return nullptr;
+        }
+        return m_handles[handle];
+    }
+
+    /**
+     * @brief get memory pointer of Snapshot by handle
+     * @param handle handle of the Snapshot
+     * @param vt expected value type
+     * @return memory pointer, null if handle or value type is incorrect
+     */
+    void* handle_ptr_(SnapshotHandle handle, SDMT_VT vt) const {
+        const Snapshot* snapshot = handle_(handle);
+        if (snapshot == nullptr || snapshot->m_valuetype != vt) {
+            return nullptr;
+        }
+        return snapshot->m_ptr;
+    }
+
+    /**
+     * @brief index Snapshots by id after the Snapshot map changes
+     */
+    void rebuild_handles_();
 
     /**
      * @brief get MPI communicator
@@ -567,6 +1905,9 @@ class SDMT
     /** @brief hash map of Segmen */
     SnapshotMap m_snapshot_map;
 
+    /** @brief Snapshots in m_snapshot_map by id, null if none */
+    std::vector<Snapshot*> m_handles;
+
     /** @brief configurations */
     Config m_config;
 
@@ -582,6 +1923,67 @@ class SDMT
     /** @brief MPI communicator */
     MPI_Comm m_comm;
 
+    /** @brief rank in m_comm */
+    int m_rank;
+
+    /** @brief id of the last checkpoint written by FTI */
+    int32_t m_fti_id;
+
+    /** @brief number of ranks which wrote the last checkpoint */
+    int32_t m_ckpt_ranks;
+
+    /** @brief ckpt_l1 ~ ckpt_l4 of FTI configuration in minutes */
+    int m_fti_intervals[4];
+
+    /** @brief MPI_Wtime of init, where the FTI schedule starts */
+    double m_fti_start;
+
+    /** @brief last minute of the FTI schedule checked */
+    long m_fti_minute;
+
+    /** @brief background checkpoint writer */
+    CkptAsync m_async;
+
+    /** @brief background copier from node-local to global directory */
+    CkptDrain m_drain;
+
+    /** @brief pages of Snapshots faulted in after a lazy restart */
+    CkptLazy m_lazy;
+
+    /** @brief block hashes of the last native checkpoint by Snapshot id */
+    std::unordered_map<int32_t, std::vector<uint64_t>> m_hashes;
+
+    /** @brief volume of the last checkpoint */
+    CkptStats m_stats;
+
+    /** @brief time spent in phases of the last recovery */
+    RecoveryStats m_recovery;
+
+    /** @brief compressed images handed to FTI by Snapshot id */
+    std::unordered_map<int32_t, std::vector<char>> m_packed;
+
+    /** @brief in-memory checkpoints */
+    CkptRing m_ring;
+
+    /** @brief checkpoints replicated on partner ranks */
+    CkptPartner m_partner;
+
+    /** @brief checkpoints protected by erasure codes */
+    CkptErasure m_erasure;
+
+    /** @brief called after buffers of a Snapshot are swapped */
+    FlipHook m_flip_hook;
+
+    /** @brief byte sizes of Snapshot memory mapped on explicit huge pages */
+    std::unordered_map<void*, size_t> m_mapped;
+
+    /** @brief arena small Snapshots are packed in, one array of longs
+     *  protected and written as a whole, null until the first member */
+    Snapshot m_arena;
+
+    /** @brief byte size of the arena taken by members so far */
+    size_t m_arena_used;
+
 };
 
 /**
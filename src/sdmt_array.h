@@ -0,0 +1,253 @@
+/**
+Copyright 2021 PIDL(Petabyte-scale In-memory Database Lab) http://kdb.snu.ac.kr
+This work was supported by Next-Generation Information Computing Development
+Program through the National Research Foundation of Korea(NRF)
+funded by the Ministry of Science, ICT (NRF-2016M3C4A7952587)
+Author: Ilju Lee, Jongin Kim, Hyerim Jeon, Youngjune Park
+Contact: sdmt@kdb.snu.ac.kr
+ */
+
+#ifndef SDMT_ARRAY_H_
+#define SDMT_ARRAY_H_
+
+#include "common.h"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <fti.h>
+
+/**
+ * @brief value type and FTI type of an element type of Snapshot
+ * @details defined for int, long, float and double only
+ */
+template<typename T>
+struct ValueTraits;
+
+template<>
+struct ValueTraits<int> {
+    /** @brief value type of Snapshot */
+    static constexpr SDMT_VT value_type() { return SDMT_INT; }
+
+    /** @brief FTI type of an element */
+    static FTIT_type& fti_type() { return FTI_INTG; }
+};
+
+template<>
+struct ValueTraits<long> {
+    /** @brief value type of Snapshot */
+    static constexpr SDMT_VT value_type() { return SDMT_LONG; }
+
+    /** @brief FTI type of an element */
+    static FTIT_type& fti_type() { return FTI_LONG; }
+};
+
+template<>
+struct ValueTraits<float> {
+    /** @brief value type of Snapshot */
+    static constexpr SDMT_VT value_type() { return SDMT_FLOAT; }
+
+    /** @brief FTI type of an element */
+    static FTIT_type& fti_type() { return FTI_SFLT; }
+};
+
+template<>
+struct ValueTraits<double> {
+    /** @brief value type of Snapshot */
+    static constexpr SDMT_VT value_type() { return SDMT_DOUBLE; }
+
+    /** @brief FTI type of an element */
+    static FTIT_type& fti_type() { return FTI_DBLE; }
+};
+
+/**
+ * @brief non-owning view of contiguous elements
+ */
+template<typename T>
+class SnapshotSpan
+{
+  public:
+    /**
+     * @brief create an empty SnapshotSpan
+     */
+    SnapshotSpan() : m_data(nullptr), m_size(0) {}
+
+    /**
+     * @brief create a SnapshotSpan
+     * @param data first element
+     * @param size number of elements
+     */
+    SnapshotSpan(T* data, size_t size) : m_data(data), m_size(size) {}
+
+    /** @brief first element */
+    T* data() const { return m_data; }
+
+    /** @brief number of elements */
+    size_t size() const { return m_size; }
+
+    /** @brief true if no element */
+    bool empty() const { return m_size == 0; }
+
+    /** @brief iterator to the first element */
+    T* begin() const { return m_data; }
+
+    /** @brief iterator past the last element */
+    T* end() const { return m_data + m_size; }
+
+    /** @brief element at an index */
+    T& operator[](size_t i) const {
+#ifdef SDMT_BOUNDS_CHECK
+        assert(i < m_size);
+#endif
+        return m_data[i];
+    }
+
+    /**
+     * @brief view of a part
+     * @param offset index of the first element
+     * @param count number of elements
+     * @return SnapshotSpan
+     */
+    SnapshotSpan subspan(size_t offset, size_t count) const {
+#ifdef SDMT_BOUNDS_CHECK
+        assert(offset + count <= m_size);
+#endif
+        return SnapshotSpan(m_data + offset, count);
+    }
+
+  private:
+    /** @brief first element */
+    T* m_data;
+
+    /** @brief number of elements */
+    size_t m_size;
+};
+
+/**
+ * @brief typed view of the memory of a Snapshot
+ * @details element access is pointer arithmetic on the strides of the
+ *  Snapshot, bounds are checked by assert() only if SDMT_BOUNDS_CHECK
+ *  is defined. a view is valid until the Snapshot is changed, its buffers
+ *  are swapped or it is recovered lazily, get it again by handle then
+ * @tparam T element type, int, long, float or double
+ * @tparam Rank number of dimensions, 0 for a scalar
+ */
+template<typename T, int Rank>
+class SnapshotArray
+{
+    static_assert(Rank >= 0 && Rank < SDMT_NUM_DT,
+            "rank of a Snapshot is 0 to 3");
+
+  public:
+    /**
+     * @brief create a null SnapshotArray
+     */
+    SnapshotArray() : m_ptr(nullptr) {
+        for (int d = 0; d < kDims; d++) {
+            m_dim[d] = 0;
+            m_stride[d] = 0;
+        }
+    }
+
+    /**
+     * @brief create a view of Snapshot memory
+     * @param ptr memory of the Snapshot
+     * @param dim size of each dimension
+     * @param strides byte strides for each index
+     */
+    SnapshotArray(T* ptr, const int* dim, const int* strides) : m_ptr(ptr) {
+        for (int d = 0; d < kDims; d++) {
+            m_dim[d] = d < Rank ? dim[d] : 1;
+            m_stride[d] = d < Rank ? strides[d] / (int64_t)sizeof(T) : 0;
+        }
+    }
+
+    /**
+     * @brief element at indices
+     * @param idx an index for each dimension
+     * @return element
+     */
+    template<typename... I>
+    T& operator()(I... idx) const {
+        static_assert(sizeof...(I) == Rank, "an index for each dimension");
+        return m_ptr[offset_(idx...)];
+    }
+
+    /**
+     * @brief last dimension at indices of the others
+     * @details the last dimension has to be contiguous, which a column
+     *  major Snapshot of register_external() is not unless its extent is 1
+     * @param idx an index for each dimension but the last
+     * @return contiguous elements
+     */
+    template<typename... I>
+    SnapshotSpan<T> row(I... idx) const {
+        static_assert(Rank > 0 && sizeof...(I) == Rank - 1,
+                "an index for each dimension but the last");
+#ifdef SDMT_BOUNDS_CHECK
+        assert(m_stride[kDims - 1] == 1 || m_dim[kDims - 1] == 1);
+#endif
+        return SnapshotSpan<T>(m_ptr + offset_(idx..., 0), m_dim[kDims - 1]);
+    }
+
+    /**
+     * @brief every element in memory order
+     * @return contiguous elements
+     */
+    SnapshotSpan<T> span() const { return SnapshotSpan<T>(m_ptr, size()); }
+
+    /** @brief memory of the Snapshot, null if none */
+    T* data() const { return m_ptr; }
+
+    /** @brief true if a view of a Snapshot */
+    explicit operator bool() const { return m_ptr != nullptr; }
+
+    /** @brief size of a dimension */
+    int extent(int d) const { return m_dim[d]; }
+
+    /** @brief element stride of a dimension */
+    int64_t stride(int d) const { return m_stride[d]; }
+
+    /** @brief number of elements */
+    size_t size() const {
+        size_t size = m_ptr ? 1 : 0;
+        for (int d = 0; d < Rank; d++) {
+            size *= m_dim[d];
+        }
+        return size;
+    }
+
+  private:
+    /** @brief length of arrays of dimensions, a scalar has one */
+    static const int kDims = Rank > 0 ? Rank : 1;
+
+    /**
+     * @brief element offset of indices
+     * @param idx an index for each dimension
+     * @return offset from m_ptr
+     */
+    template<typename... I>
+    int64_t offset_(I... idx) const {
+        // the leading 0 keeps the array non-empty for a scalar
+        const int64_t index[] = {0, static_cast<int64_t>(idx)...};
+        int64_t offset = 0;
+        for (int d = 0; d < Rank; d++) {
+#ifdef SDMT_BOUNDS_CHECK
+            assert(index[d + 1] >= 0 && index[d + 1] < m_dim[d]);
+#endif
+            offset += index[d + 1] * m_stride[d];
+        }
+        return offset;
+    }
+
+    /** @brief memory of the Snapshot */
+    T* m_ptr;
+
+    /** @brief size of each dimension */
+    int m_dim[kDims];
+
+    /** @brief element strides for each index */
+    int64_t m_stride[kDims];
+};
+
+#endif  // SDMT_ARRAY_H_
@@ -34,6 +34,39 @@ SDMT_Code sdmt_register_snapshot(char* name, SDMT_VT& vt, SDMT_DT& dt, std::vect
 	return SDMT::register_snapshot(name, vt, dt, dim);
 }
 
+SDMT_Code sdmt_register_snapshot_opt(char* name, SDMT_VT& vt, SDMT_DT& dt, std::vector<int>& dim, SDMT::Options& opts) {
+//	cout << "[SDMT] [C API] register_snapshot_opt" << endl;
+	return SDMT::register_snapshot(name, vt, dt, dim, opts);
+}
+
+SDMT_Code sdmt_register_distributed(char* name, SDMT_VT& vt, SDMT_DT& dt, std::vector<int>& dim, std::vector<int>& global, int axis, int block, SDMT::Options& opts) {
+//	cout << "[SDMT] [C API] register_distributed" << endl;
+	opts.m_global = global;
+	opts.m_axis = axis;
+	opts.m_block = block;
+	return SDMT::register_snapshot(name, vt, dt, dim, opts);
+}
+
+SDMT_Code sdmt_register_external(char* name, void* ptr, SDMT_VT& vt, SDMT_DT& dt, std::vector<int>& dim, std::vector<int>& strides, SDMT::Options& opts) {
+//	cout << "[SDMT] [C API] register_external" << endl;
+	return SDMT::register_external(name, ptr, vt, dt, dim, strides, opts);
+}
+
+SDMT_Code sdmt_rebind(char* name, void* ptr) {
+//	cout << "[SDMT] [C API] rebind" << endl;
+	return SDMT::rebind(name, ptr);
+}
+
+SDMT_Code sdmt_rebind_shape(char* name, void* ptr, std::vector<int>& dim, std::vector<int>& strides) {
+//	cout << "[SDMT] [C API] rebind_shape" << endl;
+	return SDMT::rebind(name, ptr, dim, strides);
+}
+
+int sdmt_local_extent(int extent, int block) {
+//	cout << "[SDMT] [C API] local_extent" << endl;
+	return SDMT::local_extent(extent, block);
+}
+
 SDMT_Code sdmt_register_int_parameter(char* name, int& value){
 //	cout << "[SDMT] [C API] register_int_parameter" << endl;
 	return SDMT::register_int_parameter(name, value);
@@ -79,19 +112,136 @@ SDMT_Code sdmt_checkpoint(int& level) {
     return SDMT::checkpoint(level);
 }
 
+SDMT_Code sdmt_checkpoint_async(int& level) {
+//    cout << "[SDMT] [C API] checkpoint_async" << endl;
+    return SDMT::checkpoint(level, true);
+}
+
+SDMT_Code sdmt_wait_checkpoint() {
+//    cout << "[SDMT] [C API] wait_checkpoint" << endl;
+    return SDMT::wait_checkpoint();
+}
+
+SDMT_CS sdmt_checkpoint_status() {
+//    cout << "[SDMT] [C API] checkpoint_status" << endl;
+    return SDMT::checkpoint_status();
+}
+
+SDMT_Code sdmt_wait_drain() {
+//    cout << "[SDMT] [C API] wait_drain" << endl;
+    return SDMT::wait_drain();
+}
+
+SDMT_Code sdmt_wait_recovery() {
+//    cout << "[SDMT] [C API] wait_recovery" << endl;
+    return SDMT::wait_recovery();
+}
+
+double sdmt_checkpoint_ratio() {
+//    cout << "[SDMT] [C API] checkpoint_ratio" << endl;
+    return SDMT::checkpoint_stats().ratio();
+}
+
+double sdmt_recovery_time() {
+//    cout << "[SDMT] [C API] recovery_time" << endl;
+    return SDMT::recovery_stats().total();
+}
+
 SDMT_Code sdmt_recover() {
 //    cout << "[SDMT] [C API] recover" << endl;
     return SDMT::recover();
 }
 
+SDMT_Code sdmt_recover_snapshot(char* name) {
+//    cout << "[SDMT] [C API] recover_snapshot" << endl;
+    return SDMT::recover_snapshot(name);
+}
+
+SDMT_Code sdmt_recover_checkpoint(int id) {
+//    cout << "[SDMT] [C API] recover_checkpoint" << endl;
+    return SDMT::recover(id);
+}
+
+// entries of the last sdmt_catalog call
+static std::vector<SDMT::CatalogEntry> catalog_entries;
+
+int sdmt_catalog() {
+//    cout << "[SDMT] [C API] catalog" << endl;
+    catalog_entries = SDMT::catalog();
+    return catalog_entries.size();
+}
+
+SDMT_Code sdmt_catalog_entry(int i, int& id, int& iter, int& level,
+        double& time) {
+//    cout << "[SDMT] [C API] catalog_entry" << endl;
+    if (i < 0 || i >= (int)catalog_entries.size()) {
+        return SDMT_ERR_FAILED_RECOVERY;
+    }
+    id = catalog_entries[i].m_id;
+    iter = catalog_entries[i].m_iter;
+    level = catalog_entries[i].m_level;
+    time = catalog_entries[i].m_time;
+    return SDMT_SUCCESS;
+}
+
+SDMT_Code sdmt_checkpoint_memory() {
+//    cout << "[SDMT] [C API] checkpoint_memory" << endl;
+    return SDMT::checkpoint_memory();
+}
+
+SDMT_Code sdmt_rollback(int& k) {
+//    cout << "[SDMT] [C API] rollback" << endl;
+    return SDMT::rollback(k);
+}
+
+SDMT_Code sdmt_checkpoint_partner() {
+//    cout << "[SDMT] [C API] checkpoint_partner" << endl;
+    return SDMT::checkpoint_partner();
+}
+
+SDMT_Code sdmt_recover_partner() {
+//    cout << "[SDMT] [C API] recover_partner" << endl;
+    return SDMT::recover_partner();
+}
+
+SDMT_Code sdmt_checkpoint_erasure() {
+//    cout << "[SDMT] [C API] checkpoint_erasure" << endl;
+    return SDMT::checkpoint_erasure();
+}
+
+SDMT_Code sdmt_recover_erasure() {
+//    cout << "[SDMT] [C API] recover_erasure" << endl;
+    return SDMT::recover_erasure();
+}
+
+SDMT_Code sdmt_flip(char* name) {
+//    cout << "[SDMT] [C API] flip" << endl;
+    return SDMT::flip(name);
+}
+
+void sdmt_set_flip_hook(void (*hook)(const char*, void*)) {
+//    cout << "[SDMT] [C API] set_flip_hook" << endl;
+    if (hook == nullptr) {
+        SDMT::set_flip_hook(SDMT::FlipHook());
+        return;
+    }
+    SDMT::set_flip_hook([hook](const std::string& name, void* ptr) {
+        hook(name.c_str(), ptr);
+    });
+}
+
 bool sdmt_exist(char* name){
 //	cout << "[SDMT] [C API] exist" << endl;
 	return SDMT::exist(name);
 }
 
-SDMT::Snapshot sdmt_get_snapshot(char* name){
+SDMT::SnapshotView sdmt_get_snapshot(char* name){
 //	cout << "[SDMT] [C API] get_snapshot" << endl;
-	return SDMT::get_snapshot(name);
+	return SDMT::view(name);
+}
+
+SDMT::SnapshotView sdmt_get_snapshot_handle(int32_t handle){
+	return SDMT::view(handle);
 }
 
 int32_t sdmt_iter(){
@@ -129,6 +279,27 @@ double* sdmt_doubleptr(char* name){
 	return SDMT::doubleptr(name);
 }
 
+int32_t sdmt_lookup(char* name){
+//	cout << "[SDMT] [C API] lookup" << endl;
+	return SDMT::lookup(name);
+}
+
+int* sdmt_intptr_handle(int32_t handle){
+	return SDMT::intptr(handle);
+}
+
+long* sdmt_longptr_handle(int32_t handle){
+	return SDMT::longptr(handle);
+}
+
+float* sdmt_floatptr_handle(int32_t handle){
+	return SDMT::floatptr(handle);
+}
+
+double* sdmt_doubleptr_handle(int32_t handle){
+	return SDMT::doubleptr(handle);
+}
+
 /*
 bool sdmt_load_config(std::string config){
 	cout << "[SDMT] [C API] load config" << endl;
@@ -150,7 +321,36 @@ extern "C" {
 	typedef SDMT_VT sdmt_vt;
 	typedef SDMT_DT sdmt_dt;
 	typedef SDMT_Code sdmt_code;
-	typedef SDMT::Snapshot snapshot;
+	typedef SDMT_CS sdmt_cs;
+	// layout of sdmt_snapshot of the Fortran module
+	typedef SDMT::SnapshotView snapshot;
+
+	// layout of sdmt_options of the Fortran module
+	typedef struct {
+		SDMT_IM incremental;
+		SDMT_CC codec;
+		double error_bound;
+		size_t alignment;
+		bool double_buffer;
+		SDMT_HP huge_pages;
+		bool prefault;
+		SDMT_NP placement;
+		int numa_node;
+	} options;
+
+	static SDMT::Options to_options(const options* opts) {
+		SDMT::Options res;
+		res.m_incremental = opts->incremental;
+		res.m_codec = opts->codec;
+		res.m_error_bound = opts->error_bound;
+		res.m_alignment = opts->alignment;
+		res.m_double_buffer = opts->double_buffer;
+		res.m_huge_pages = opts->huge_pages;
+		res.m_prefault = opts->prefault;
+		res.m_placement = opts->placement;
+		res.m_numa_node = opts->numa_node;
+		return res;
+	}
 	
 	typedef int* int_p;
 	typedef long* long_p;
@@ -180,6 +380,64 @@ extern "C" {
 		return sdmt_register_snapshot(name, *vt, *dt, dim_);
     }
 
+    sdmt_code sdmt_register_snapshot_opt_c_(char* name,
+            SDMT_VT* vt, SDMT_DT* dt, int* dim_numpara, int dim_format[],
+            options* opts) {
+		std::vector<int> dim_;
+		for(int i = 0; i< *dim_numpara; ++i){
+			dim_.push_back((dim_format)[i]);
+		}
+		SDMT::Options opts_ = to_options(opts);
+		return sdmt_register_snapshot_opt(name, *vt, *dt, dim_, opts_);
+    }
+
+    sdmt_code sdmt_register_distributed_c_(char* name,
+            SDMT_VT* vt, SDMT_DT* dt, int* dim_numpara, int dim_format[],
+            int global_format[], int* axis, int* block, options* opts) {
+		std::vector<int> dim_;
+		std::vector<int> global_;
+		for(int i = 0; i< *dim_numpara; ++i){
+			dim_.push_back((dim_format)[i]);
+			global_.push_back((global_format)[i]);
+		}
+		SDMT::Options opts_ = to_options(opts);
+		return sdmt_register_distributed(name, *vt, *dt, dim_, global_,
+				*axis, *block, opts_);
+    }
+
+    sdmt_code sdmt_register_external_c_(char* name, void* ptr,
+            SDMT_VT* vt, SDMT_DT* dt, int* dim_numpara, int dim_format[],
+            int strides_format[], options* opts) {
+		std::vector<int> dim_;
+		std::vector<int> strides_;
+		for(int i = 0; i< *dim_numpara; ++i){
+			dim_.push_back((dim_format)[i]);
+			strides_.push_back((strides_format)[i]);
+		}
+		SDMT::Options opts_ = to_options(opts);
+		return sdmt_register_external(name, ptr, *vt, *dt, dim_, strides_,
+				opts_);
+    }
+
+    sdmt_code sdmt_rebind_c_(char* name, void* ptr) {
+		return sdmt_rebind(name, ptr);
+    }
+
+    sdmt_code sdmt_rebind_shape_c_(char* name, void* ptr,
+            int* dim_numpara, int dim_format[], int strides_format[]) {
+		std::vector<int> dim_;
+		std::vector<int> strides_;
+		for(int i = 0; i< *dim_numpara; ++i){
+			dim_.push_back((dim_format)[i]);
+			strides_.push_back((strides_format)[i]);
+		}
+		return sdmt_rebind_shape(name, ptr, dim_, strides_);
+    }
+
+	int sdmt_local_extent_c_(int* extent, int* block) {
+		return sdmt_local_extent(*extent, *block);
+	}
+
 	sdmt_code sdmt_register_int_parameter_c_(char* name, int* value) {
 		return sdmt_register_int_parameter(name, *value);
 	}
@@ -207,15 +465,76 @@ extern "C" {
 	sdmt_code sdmt_checkpoint_c_(int *level) {
 		return sdmt_checkpoint(*level);
 	}
+	sdmt_code sdmt_checkpoint_async_c_(int *level) {
+		return sdmt_checkpoint_async(*level);
+	}
+	sdmt_code sdmt_wait_checkpoint_c_() {
+		return sdmt_wait_checkpoint();
+	}
+	sdmt_cs sdmt_checkpoint_status_c_() {
+		return sdmt_checkpoint_status();
+	}
+	sdmt_code sdmt_wait_drain_c_() {
+		return sdmt_wait_drain();
+	}
+	sdmt_code sdmt_wait_recovery_c_() {
+		return sdmt_wait_recovery();
+	}
+	double sdmt_checkpoint_ratio_c_() {
+		return sdmt_checkpoint_ratio();
+	}
+	double sdmt_recovery_time_c_() {
+		return sdmt_recovery_time();
+	}
 	sdmt_code sdmt_recover_c_() {
 		return sdmt_recover();
 	}
+	sdmt_code sdmt_recover_snapshot_c_(char* name) {
+		return sdmt_recover_snapshot(name);
+	}
+	sdmt_code sdmt_recover_checkpoint_c_(int* id) {
+		return sdmt_recover_checkpoint(*id);
+	}
+	int sdmt_catalog_c_() {
+		return sdmt_catalog();
+	}
+	sdmt_code sdmt_catalog_entry_c_(int* i, int* id, int* iter, int* level,
+			double* time) {
+		return sdmt_catalog_entry(*i, *id, *iter, *level, *time);
+	}
+	sdmt_code sdmt_checkpoint_memory_c_() {
+		return sdmt_checkpoint_memory();
+	}
+	sdmt_code sdmt_rollback_c_(int* k) {
+		return sdmt_rollback(*k);
+	}
+	sdmt_code sdmt_checkpoint_partner_c_() {
+		return sdmt_checkpoint_partner();
+	}
+	sdmt_code sdmt_recover_partner_c_() {
+		return sdmt_recover_partner();
+	}
+	sdmt_code sdmt_checkpoint_erasure_c_() {
+		return sdmt_checkpoint_erasure();
+	}
+	sdmt_code sdmt_recover_erasure_c_() {
+		return sdmt_recover_erasure();
+	}
+	sdmt_code sdmt_flip_c_(char* name) {
+		return sdmt_flip(name);
+	}
+	void sdmt_set_flip_hook_c_(void (*hook)(const char*, void*)) {
+		sdmt_set_flip_hook(hook);
+	}
 	bool sdmt_exist_c_(char* name) {
 		return sdmt_exist(name);
 	}
 	snapshot sdmt_get_snapshot_c_(char* name) {
 		return sdmt_get_snapshot(name);
 	}
+	snapshot sdmt_get_snapshot_handle_c_(int32_t* handle) {
+		return sdmt_get_snapshot_handle(*handle);
+	}
 	int32_t sdmt_iter_c_() {
 		return sdmt_iter();
 	}
@@ -237,6 +556,21 @@ extern "C" {
 	double_p sdmt_doubleptr_c_(char* name) {
 		return sdmt_doubleptr(name);
 	}
+	int32_t sdmt_lookup_c_(char* name) {
+		return sdmt_lookup(name);
+	}
+	int_p sdmt_intptr_handle_c_(int32_t* handle) {
+		return sdmt_intptr_handle(*handle);
+	}
+	long_p sdmt_longptr_handle_c_(int32_t* handle) {
+		return sdmt_longptr_handle(*handle);
+	}
+	float_p sdmt_floatptr_handle_c_(int32_t* handle) {
+		return sdmt_floatptr_handle(*handle);
+	}
+	double_p sdmt_doubleptr_handle_c_(int32_t* handle) {
+		return sdmt_doubleptr_handle(*handle);
+	}
 	int_p sdmt_intmat_c_(void* vptr) {
 	
 	}
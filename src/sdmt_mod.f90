@@ -2,6 +2,53 @@ module fortsdmt
 
 use iso_c_binding
 
+ENUM, BIND(C)
+ENUMERATOR :: SDMT_IM_NONE
+ENUMERATOR :: SDMT_IM_PAGE
+ENUMERATOR :: SDMT_IM_HASH
+END ENUM
+
+ENUM, BIND(C)
+ENUMERATOR :: SDMT_CC_NONE
+ENUMERATOR :: SDMT_CC_LZ
+ENUMERATOR :: SDMT_CC_SHUFFLE_LZ
+ENUMERATOR :: SDMT_CC_LOSSY
+END ENUM
+
+ENUM, BIND(C)
+ENUMERATOR :: SDMT_HP_NONE
+ENUMERATOR :: SDMT_HP_TRANSPARENT
+ENUMERATOR :: SDMT_HP_EXPLICIT
+END ENUM
+
+ENUM, BIND(C)
+ENUMERATOR :: SDMT_NP_DEFAULT
+ENUMERATOR :: SDMT_NP_BIND
+ENUMERATOR :: SDMT_NP_INTERLEAVE
+ENUMERATOR :: SDMT_NP_FIRST_TOUCH
+END ENUM
+
+type, bind(C) :: sdmt_options
+integer(c_int) :: incremental = SDMT_IM_NONE
+integer(c_int) :: codec = SDMT_CC_NONE
+real(c_double) :: error_bound = 0
+integer(c_size_t) :: alignment = 0
+logical(c_bool) :: double_buffer = .false.
+integer(c_int) :: huge_pages = SDMT_HP_NONE
+logical(c_bool) :: prefault = .false.
+integer(c_int) :: placement = SDMT_NP_DEFAULT
+integer(c_int) :: numa_node = 0
+end type
+
+type, bind(C) :: sdmt_snapshot
+integer(c_int) :: id = -1
+integer(c_int) :: valuetype, datatype, rank
+integer(c_int) :: dimension(3), strides(3)
+integer(c_int) :: esize
+type(c_ptr) :: ptr = c_null_ptr
+type(c_ptr) :: back = c_null_ptr
+end type
+
 interface
 
 function sdmt_init_c(config, restart) bind (C, name="sdmt_init_c_")
@@ -33,6 +80,73 @@ integer(c_int) :: vt, dt, dim_numpara
 integer(c_int) :: dim_format(dim_numpara)
 end function
 
+function sdmt_register_snapshot_opt_c(sname, vt, dt, dim_numpara, dim_format, opts) &
+bind (C, name = "sdmt_register_snapshot_opt_c_")
+use iso_c_binding
+import :: sdmt_options
+implicit none
+integer(c_int) :: sdmt_register_snapshot_opt_c
+character(kind=c_char) :: sname(*)
+integer(c_int) :: vt, dt, dim_numpara
+integer(c_int) :: dim_format(dim_numpara)
+type(sdmt_options) :: opts
+end function
+
+function sdmt_register_distributed_c(sname, vt, dt, dim_numpara, dim_format, global_format, axis, block, opts) &
+bind (C, name = "sdmt_register_distributed_c_")
+use iso_c_binding
+import :: sdmt_options
+implicit none
+integer(c_int) :: sdmt_register_distributed_c
+character(kind=c_char) :: sname(*)
+integer(c_int) :: vt, dt, dim_numpara
+integer(c_int) :: dim_format(dim_numpara)
+integer(c_int) :: global_format(dim_numpara)
+integer(c_int) :: axis, block
+type(sdmt_options) :: opts
+end function
+
+function sdmt_register_external_c(sname, ptr, vt, dt, dim_numpara, dim_format, strides_format, opts) &
+bind (C, name = "sdmt_register_external_c_")
+use iso_c_binding
+import :: sdmt_options
+implicit none
+integer(c_int) :: sdmt_register_external_c
+character(kind=c_char) :: sname(*)
+type(c_ptr), value :: ptr
+integer(c_int) :: vt, dt, dim_numpara
+integer(c_int) :: dim_format(dim_numpara)
+integer(c_int) :: strides_format(dim_numpara)
+type(sdmt_options) :: opts
+end function
+
+function sdmt_rebind_c(sname, ptr) bind (C, name = "sdmt_rebind_c_")
+use iso_c_binding
+implicit none
+integer(c_int) :: sdmt_rebind_c
+character(kind=c_char) :: sname(*)
+type(c_ptr), value :: ptr
+end function
+
+function sdmt_rebind_shape_c(sname, ptr, dim_numpara, dim_format, strides_format) &
+bind (C, name = "sdmt_rebind_shape_c_")
+use iso_c_binding
+implicit none
+integer(c_int) :: sdmt_rebind_shape_c
+character(kind=c_char) :: sname(*)
+type(c_ptr), value :: ptr
+integer(c_int) :: dim_numpara
+integer(c_int) :: dim_format(dim_numpara)
+integer(c_int) :: strides_format(dim_numpara)
+end function
+
+function sdmt_local_extent_c(extent, block) bind (C, name = "sdmt_local_extent_c_")
+use iso_c_binding
+implicit none
+integer(c_int) :: sdmt_local_extent_c
+integer(c_int) :: extent, block
+end function
+
 function sdmt_register_int_parameter_c(sname, val) bind (C, name = "sdmt_register_int_parameter_c_")
 use iso_c_binding
 implicit none
@@ -100,12 +214,133 @@ integer(c_int) :: sdmt_checkpoint_c
 integer(c_int) :: lev
 end function
 
+function sdmt_checkpoint_async_c(lev) bind (C, name="sdmt_checkpoint_async_c_")
+use iso_c_binding
+implicit none
+integer(c_int) :: sdmt_checkpoint_async_c
+integer(c_int) :: lev
+end function
+
+function sdmt_wait_checkpoint_c() bind (C, name="sdmt_wait_checkpoint_c_")
+use iso_c_binding
+implicit none
+integer(c_int) :: sdmt_wait_checkpoint_c
+end function
+
+function sdmt_checkpoint_status_c() bind (C, name="sdmt_checkpoint_status_c_")
+use iso_c_binding
+implicit none
+integer(c_int) :: sdmt_checkpoint_status_c
+end function
+
+function sdmt_wait_drain_c() bind (C, name="sdmt_wait_drain_c_")
+use iso_c_binding
+implicit none
+integer(c_int) :: sdmt_wait_drain_c
+end function
+
+function sdmt_wait_recovery_c() bind (C, name="sdmt_wait_recovery_c_")
+use iso_c_binding
+implicit none
+integer(c_int) :: sdmt_wait_recovery_c
+end function
+
+function sdmt_flip_c(sname) bind (C, name="sdmt_flip_c_")
+use iso_c_binding
+implicit none
+integer(c_int) :: sdmt_flip_c
+character(kind=c_char) :: sname(*)
+end function
+
+subroutine sdmt_set_flip_hook_c(hook) bind (C, name="sdmt_set_flip_hook_c_")
+use iso_c_binding
+implicit none
+type(c_funptr), value :: hook
+end subroutine
+
+function sdmt_checkpoint_ratio_c() bind (C, name="sdmt_checkpoint_ratio_c_")
+use iso_c_binding
+implicit none
+real(c_double) :: sdmt_checkpoint_ratio_c
+end function
+
+function sdmt_recovery_time_c() bind (C, name="sdmt_recovery_time_c_")
+use iso_c_binding
+implicit none
+real(c_double) :: sdmt_recovery_time_c
+end function
+
 function sdmt_recover_c() bind (C, name="sdmt_recover_c_")
 use iso_c_binding
 implicit none
 integer(c_int) :: sdmt_recover_c
 end function
 
+function sdmt_recover_snapshot_c(sname) bind (C, name="sdmt_recover_snapshot_c_")
+use iso_c_binding
+implicit none
+integer(c_int) :: sdmt_recover_snapshot_c
+character(kind=c_char) :: sname(*)
+end function
+
+function sdmt_recover_checkpoint_c(id) bind (C, name="sdmt_recover_checkpoint_c_")
+use iso_c_binding
+implicit none
+integer(c_int) :: sdmt_recover_checkpoint_c
+integer(c_int) :: id
+end function
+
+function sdmt_catalog_c() bind (C, name="sdmt_catalog_c_")
+use iso_c_binding
+implicit none
+integer(c_int) :: sdmt_catalog_c
+end function
+
+function sdmt_catalog_entry_c(i, id, iter, level, time) bind (C, name="sdmt_catalog_entry_c_")
+use iso_c_binding
+implicit none
+integer(c_int) :: sdmt_catalog_entry_c
+integer(c_int) :: i, id, iter, level
+real(c_double) :: time
+end function
+
+function sdmt_checkpoint_memory_c() bind (C, name="sdmt_checkpoint_memory_c_")
+use iso_c_binding
+implicit none
+integer(c_int) :: sdmt_checkpoint_memory_c
+end function
+
+function sdmt_rollback_c(k) bind (C, name="sdmt_rollback_c_")
+use iso_c_binding
+implicit none
+integer(c_int) :: sdmt_rollback_c
+integer(c_int) :: k
+end function
+
+function sdmt_checkpoint_partner_c() bind (C, name="sdmt_checkpoint_partner_c_")
+use iso_c_binding
+implicit none
+integer(c_int) :: sdmt_checkpoint_partner_c
+end function
+
+function sdmt_recover_partner_c() bind (C, name="sdmt_recover_partner_c_")
+use iso_c_binding
+implicit none
+integer(c_int) :: sdmt_recover_partner_c
+end function
+
+function sdmt_checkpoint_erasure_c() bind (C, name="sdmt_checkpoint_erasure_c_")
+use iso_c_binding
+implicit none
+integer(c_int) :: sdmt_checkpoint_erasure_c
+end function
+
+function sdmt_recover_erasure_c() bind (C, name="sdmt_recover_erasure_c_")
+use iso_c_binding
+implicit none
+integer(c_int) :: sdmt_recover_erasure_c
+end function
+
 function sdmt_exist_c(sname) bind (C, name="sdmt_exist_c_")
 use iso_c_binding
 implicit none
@@ -115,11 +350,20 @@ end function
 
 function sdmt_get_snapshot_c(sname) bind (C, name="sdmt_get_snapshot_c_")
 use iso_c_binding
+import :: sdmt_snapshot
 implicit none
-type(c_ptr) :: sdmt_get_snapshot_c
+type(sdmt_snapshot) :: sdmt_get_snapshot_c
 character(kind=c_char) :: sname(*)
 end function
 
+function sdmt_get_snapshot_handle_c(handle) bind (C, name="sdmt_get_snapshot_handle_c_")
+use iso_c_binding
+import :: sdmt_snapshot
+implicit none
+type(sdmt_snapshot) :: sdmt_get_snapshot_handle_c
+integer(c_int) :: handle
+end function
+
 function sdmt_iter_c() bind (C, name="sdmt_iter_c_")
 use iso_c_binding
 implicit none
@@ -166,6 +410,41 @@ type(c_ptr) :: sdmt_doubleptr_c
 character(kind=c_char) :: sname(*)
 end function
 
+function sdmt_lookup_c(sname) bind (C,name="sdmt_lookup_c_")
+use iso_c_binding
+implicit none
+integer(c_int) :: sdmt_lookup_c
+character(kind=c_char) :: sname(*)
+end function
+
+function sdmt_intptr_handle_c(handle) bind (C,name="sdmt_intptr_handle_c_")
+use iso_c_binding
+implicit none
+type(c_ptr) :: sdmt_intptr_handle_c
+integer(c_int) :: handle
+end function
+
+function sdmt_longptr_handle_c(handle) bind (C,name="sdmt_longptr_handle_c_")
+use iso_c_binding
+implicit none
+type(c_ptr) :: sdmt_longptr_handle_c
+integer(c_int) :: handle
+end function
+
+function sdmt_floatptr_handle_c(handle) bind (C,name="sdmt_floatptr_handle_c_")
+use iso_c_binding
+implicit none
+type(c_ptr) :: sdmt_floatptr_handle_c
+integer(c_int) :: handle
+end function
+
+function sdmt_doubleptr_handle_c(handle) bind (C,name="sdmt_doubleptr_handle_c_")
+use iso_c_binding
+implicit none
+type(c_ptr) :: sdmt_doubleptr_handle_c
+integer(c_int) :: handle
+end function
+
 end interface
 
 public::SDMT_INT, SDMT_LONG 
@@ -176,22 +455,43 @@ public::SDMT_SUCCESS, SDMT_ERR_WRONG_CONFIG
 public::SDMT_ERR_DUPLICATED_NAME, SDMT_ERR_WRONG_VALUE_TYPE
 public::SDMT_ERR_WRONG_DATA_TYPE, SDMT_ERR_WRONG_DIMENSION
 public::SDMT_ERR_FAILED_ALLOCATION, SDMT_ERR_FAILED_CHECKPOINT
+public::SDMT_ERR_FAILED_RECOVERY, SDMT_ERR_WRONG_OPTION
+public::SDMT_CKPT_NONE, SDMT_CKPT_PENDING
+public::SDMT_CKPT_COMPLETED, SDMT_CKPT_FAILED
+public::SDMT_IM_NONE, SDMT_IM_PAGE, SDMT_IM_HASH
+public::SDMT_CC_NONE, SDMT_CC_LZ, SDMT_CC_SHUFFLE_LZ, SDMT_CC_LOSSY
+public::SDMT_HP_NONE, SDMT_HP_TRANSPARENT, SDMT_HP_EXPLICIT
+public::SDMT_NP_DEFAULT, SDMT_NP_BIND, SDMT_NP_INTERLEAVE, SDMT_NP_FIRST_TOUCH
+public::sdmt_options, sdmt_snapshot
 
 
 public::sdmt_init
 public::sdmt_start 
 public::sdmt_finalize, sdmt_register_snapshot
+public::sdmt_register_snapshot_opt
+public::sdmt_register_distributed, sdmt_local_extent
+public::sdmt_register_external, sdmt_rebind, sdmt_rebind_shape
 public::sdmt_register_int_parameter, sdmt_get_int_parameter
 public::sdmt_register_long_parameter, sdmt_get_long_parameter
 public::sdmt_register_float_parameter, sdmt_get_float_parameter
 public::sdmt_register_double_parameter, sdmt_get_double_parameter
-public::sdmt_checkpoint, sdmt_recover
-public::sdmt_exist, sdmt_get_snapshot
+public::sdmt_checkpoint, sdmt_recover, sdmt_recover_snapshot
+public::sdmt_recover_checkpoint, sdmt_catalog, sdmt_catalog_entry
+public::sdmt_checkpoint_async, sdmt_wait_checkpoint
+public::sdmt_checkpoint_status, sdmt_checkpoint_ratio, sdmt_recovery_time
+public::sdmt_wait_drain
+public::sdmt_wait_recovery
+public::sdmt_flip, sdmt_set_flip_hook
+public::sdmt_checkpoint_memory, sdmt_rollback
+public::sdmt_checkpoint_partner, sdmt_recover_partner
+public::sdmt_checkpoint_erasure, sdmt_recover_erasure
+public::sdmt_exist, sdmt_get_snapshot, sdmt_get_snapshot_handle
 public::sdmt_iter, sdmt_next
 public::sdmt_comm
 public::sdmt_intptr
 public::sdmt_longptr, sdmt_floatptr
 public::sdmt_doubleptr
+public::sdmt_lookup
 
 ENUM, BIND(C)
 ENUMERATOR :: SDMT_INT
@@ -216,6 +516,14 @@ ENUMERATOR :: SDMT_ERR_WRONG_DATA_TYPE
 ENUMERATOR :: SDMT_ERR_WRONG_DIMENSION
 ENUMERATOR :: SDMT_ERR_FAILED_ALLOCATION
 ENUMERATOR :: SDMT_ERR_FAILED_CHECKPOINT
+ENUMERATOR :: SDMT_ERR_FAILED_RECOVERY
+ENUMERATOR :: SDMT_ERR_WRONG_OPTION
+END ENUM
+ENUM, BIND(C)
+ENUMERATOR :: SDMT_CKPT_NONE
+ENUMERATOR :: SDMT_CKPT_PENDING
+ENUMERATOR :: SDMT_CKPT_COMPLETED
+ENUMERATOR :: SDMT_CKPT_FAILED
 END ENUM
 
 contains
@@ -251,6 +559,94 @@ integer, optional :: dim_format(dim_numpara)
 sdmt_register_snapshot = sdmt_register_snapshot_c(sname, vt, dt, dim_numpara, dim_format)
 end function
 
+function sdmt_register_snapshot_opt(sname, vt, dt, dim_numpara, dim_format, opts)
+implicit none
+integer :: sdmt_register_snapshot_opt
+character(len=*) :: sname
+integer :: vt, dt
+integer ::dim_numpara
+integer :: dim_format(dim_numpara)
+type(sdmt_options) :: opts
+sdmt_register_snapshot_opt = sdmt_register_snapshot_opt_c(sname, vt, dt, dim_numpara, dim_format, opts)
+end function
+
+function sdmt_register_distributed(sname, vt, dt, dim_numpara, dim_format, global_format, axis, block, opts)
+implicit none
+integer :: sdmt_register_distributed
+character(len=*) :: sname
+integer :: vt, dt
+integer ::dim_numpara
+integer :: dim_format(dim_numpara)
+integer :: global_format(dim_numpara)
+integer :: axis, block
+type(sdmt_options) :: opts
+sdmt_register_distributed = sdmt_register_distributed_c(sname, vt, dt, dim_numpara, dim_format, global_format, &
+axis, block, opts)
+end function
+
+function sdmt_register_external(sname, ptr, vt, dt, dim_numpara, dim_format, opts)
+implicit none
+integer :: sdmt_register_external
+character(len=*) :: sname
+type(c_ptr) :: ptr
+integer :: vt, dt
+integer ::dim_numpara
+integer :: dim_format(dim_numpara)
+type(sdmt_options) :: opts
+integer :: strides_format(dim_numpara)
+integer :: i
+! the first index of an array of Fortran is contiguous
+do i = 1, dim_numpara
+if (i == 1) then
+if (vt == SDMT_INT .or. vt == SDMT_FLOAT) then
+strides_format(i) = 4
+else
+strides_format(i) = 8
+end if
+else
+strides_format(i) = strides_format(i - 1) * dim_format(i - 1)
+end if
+end do
+sdmt_register_external = sdmt_register_external_c(sname, ptr, vt, dt, dim_numpara, dim_format, &
+strides_format, opts)
+end function
+
+function sdmt_rebind(sname, ptr)
+implicit none
+integer :: sdmt_rebind
+character(len=*) :: sname
+type(c_ptr) :: ptr
+sdmt_rebind = sdmt_rebind_c(sname, ptr)
+end function
+
+function sdmt_rebind_shape(sname, ptr, dim_numpara, dim_format)
+implicit none
+integer :: sdmt_rebind_shape
+character(len=*) :: sname
+type(c_ptr) :: ptr
+integer ::dim_numpara
+integer :: dim_format(dim_numpara)
+type(sdmt_snapshot) :: snapshot
+integer :: strides_format(dim_numpara)
+integer :: i
+snapshot = sdmt_get_snapshot(sname)
+do i = 1, dim_numpara
+if (i == 1) then
+strides_format(i) = snapshot%esize
+else
+strides_format(i) = strides_format(i - 1) * dim_format(i - 1)
+end if
+end do
+sdmt_rebind_shape = sdmt_rebind_shape_c(sname, ptr, dim_numpara, dim_format, strides_format)
+end function
+
+function sdmt_local_extent(extent, block)
+implicit none
+integer :: sdmt_local_extent
+integer :: extent, block
+sdmt_local_extent = sdmt_local_extent_c(extent, block)
+end function
+
 function sdmt_register_int_parameter(sname, val)
 implicit none
 integer :: sdmt_register_int_parameter
@@ -318,12 +714,135 @@ integer :: lev
 sdmt_checkpoint = sdmt_checkpoint_c(lev)
 end function
 
+function sdmt_checkpoint_async(lev)
+implicit none
+integer :: sdmt_checkpoint_async
+integer :: lev
+sdmt_checkpoint_async = sdmt_checkpoint_async_c(lev)
+end function
+
+function sdmt_wait_checkpoint()
+implicit none
+integer :: sdmt_wait_checkpoint
+sdmt_wait_checkpoint = sdmt_wait_checkpoint_c()
+end function
+
+function sdmt_checkpoint_status()
+implicit none
+integer :: sdmt_checkpoint_status
+sdmt_checkpoint_status = sdmt_checkpoint_status_c()
+end function
+
+function sdmt_wait_drain()
+implicit none
+integer :: sdmt_wait_drain
+sdmt_wait_drain = sdmt_wait_drain_c()
+end function
+
+function sdmt_wait_recovery()
+implicit none
+integer :: sdmt_wait_recovery
+sdmt_wait_recovery = sdmt_wait_recovery_c()
+end function
+
+function sdmt_flip(sname)
+implicit none
+integer :: sdmt_flip
+character(len=*) :: sname
+sdmt_flip = sdmt_flip_c(sname)
+end function
+
+! hook is a bind(C) subroutine(name, ptr) with
+! character(kind=c_char) :: name(*) and type(c_ptr), value :: ptr
+subroutine sdmt_set_flip_hook(hook)
+implicit none
+type(c_funptr) :: hook
+call sdmt_set_flip_hook_c(hook)
+end subroutine
+
+function sdmt_checkpoint_ratio()
+implicit none
+real(kind=8) :: sdmt_checkpoint_ratio
+sdmt_checkpoint_ratio = sdmt_checkpoint_ratio_c()
+end function
+
+function sdmt_recovery_time()
+implicit none
+real(kind=8) :: sdmt_recovery_time
+sdmt_recovery_time = sdmt_recovery_time_c()
+end function
+
 function sdmt_recover()
 implicit none
 integer :: sdmt_recover
 sdmt_recover = sdmt_recover_c()
 end function
 
+function sdmt_recover_snapshot(sname)
+implicit none
+integer :: sdmt_recover_snapshot
+character(len=*) :: sname
+sdmt_recover_snapshot = sdmt_recover_snapshot_c(sname)
+end function
+
+function sdmt_recover_checkpoint(id)
+implicit none
+integer :: sdmt_recover_checkpoint
+integer :: id
+sdmt_recover_checkpoint = sdmt_recover_checkpoint_c(id)
+end function
+
+function sdmt_catalog()
+implicit none
+integer :: sdmt_catalog
+sdmt_catalog = sdmt_catalog_c()
+end function
+
+function sdmt_catalog_entry(i, id, iter, level, time)
+implicit none
+integer :: sdmt_catalog_entry
+integer :: i, id, iter, level
+real(kind=8) :: time
+sdmt_catalog_entry = sdmt_catalog_entry_c(i, id, iter, level, time)
+end function
+
+function sdmt_checkpoint_memory()
+implicit none
+integer :: sdmt_checkpoint_memory
+sdmt_checkpoint_memory = sdmt_checkpoint_memory_c()
+end function
+
+function sdmt_rollback(k)
+implicit none
+integer :: sdmt_rollback
+integer :: k
+sdmt_rollback = sdmt_rollback_c(k)
+end function
+
+function sdmt_checkpoint_partner()
+implicit none
+integer :: sdmt_checkpoint_partner
+sdmt_checkpoint_partner = sdmt_checkpoint_partner_c()
+end function
+
+function sdmt_recover_partner()
+implicit none
+integer :: sdmt_recover_partner
+sdmt_recover_partner = sdmt_recover_partner_c()
+end function
+
+function sdmt_checkpoint_erasure()
+implicit none
+integer :: sdmt_checkpoint_erasure
+sdmt_checkpoint_erasure = sdmt_checkpoint_erasure_c()
+end function
+
+function sdmt_recover_erasure()
+implicit none
+integer :: sdmt_recover_erasure
+sdmt_recover_erasure = sdmt_recover_erasure_c()
+end function
+
 function sdmt_exist(sname)
 implicit none
 logical(kind=1) :: sdmt_exist
@@ -333,11 +852,25 @@ end function
 
 function sdmt_get_snapshot(sname) 
 implicit none
-type(c_ptr) :: sdmt_get_snapshot
+type(sdmt_snapshot) :: sdmt_get_snapshot
 character(len=*) :: sname
 sdmt_get_snapshot = sdmt_get_snapshot_c(sname)
 end function
 
+function sdmt_get_snapshot_handle(handle)
+implicit none
+type(sdmt_snapshot) :: sdmt_get_snapshot_handle
+integer :: handle
+sdmt_get_snapshot_handle = sdmt_get_snapshot_handle_c(handle)
+end function
+
+function sdmt_lookup(sname)
+implicit none
+integer :: sdmt_lookup
+character(len=*) :: sname
+sdmt_lookup = sdmt_lookup_c(sname)
+end function
+
 function sdmt_iter()
 implicit none
 integer(kind=8) :: sdmt_iter
@@ -0,0 +1,126 @@
+/**
+Copyright 2021 PIDL(Petabyte-scale In-memory Database Lab) http://kdb.snu.ac.kr
+This work was supported by Next-Generation Information Computing Development
+Program through the National Research Foundation of Korea(NRF)
+funded by the Ministry of Science, ICT (NRF-2016M3C4A7952587)
+Author: Ilju Lee, Jongin Kim, Hyerim Jeon, Youngjune Park
+Contact: sdmt@kdb.snu.ac.kr
+
+XXH64 hash function
+the algorithm is designed by Yann Collet, https://github.com/Cyan4973/xxHash
+(BSD 2-Clause License), this is a compact re-implementation of it
+ */
+
+#ifndef XXHASH_H_
+#define XXHASH_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+/**
+ * @brief 64 bit non-cryptographic hash
+ * @details four independent accumulator lanes consume 32 bytes per step,
+ *  which keeps the multipliers of the cpu busy in parallel
+ */
+class XXH64
+{
+  public:
+    /**
+     * @brief hash a memory block
+     * @param data memory to hash
+     * @param len byte size of memory
+     * @param seed hash seed
+     * @return 64 bit hash value
+     */
+    static inline uint64_t hash(const void* data, size_t len, uint64_t seed = 0) {
+        const uint8_t* p = reinterpret_cast<const uint8_t*>(data);
+        const uint8_t* end = p + len;
+        uint64_t h;
+
+        if (len >= 32) {
+            uint64_t v1 = seed + kPrime1 + kPrime2;
+            uint64_t v2 = seed + kPrime2;
+            uint64_t v3 = seed;
+            uint64_t v4 = seed - kPrime1;
+            const uint8_t* limit = end - 32;
+            do {
+                v1 = round(v1, read64(p));
+                v2 = round(v2, read64(p + 8));
+                v3 = round(v3, read64(p + 16));
+                v4 = round(v4, read64(p + 24));
+                p += 32;
+            } while (p <= limit);
+
+            h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+            h = merge(h, v1);
+            h = merge(h, v2);
+            h = merge(h, v3);
+            h = merge(h, v4);
+        } else {
+            h = seed + kPrime5;
+        }
+
+        h += len;
+
+        while (p + 8 <= end) {
+            h ^= round(0, read64(p));
+            h = rotl(h, 27) * kPrime1 + kPrime4;
+            p += 8;
+        }
+        if (p + 4 <= end) {
+            h ^= (uint64_t)read32(p) * kPrime1;
+            h = rotl(h, 23) * kPrime2 + kPrime3;
+            p += 4;
+        }
+        while (p < end) {
+            h ^= (*p) * kPrime5;
+            h = rotl(h, 11) * kPrime1;
+            p++;
+        }
+
+        // avalanche
+        h ^= h >> 33;
+        h *= kPrime2;
+        h ^= h >> 29;
+        h *= kPrime3;
+        h ^= h >> 32;
+        return h;
+    }
+
+  private:
+    static const uint64_t kPrime1 = 0x9E3779B185EBCA87ULL;
+    static const uint64_t kPrime2 = 0xC2B2AE3D27D4EB4FULL;
+    static const uint64_t kPrime3 = 0x165667B19E3779F9ULL;
+    static const uint64_t kPrime4 = 0x85EBCA77C2B2AE63ULL;
+    static const uint64_t kPrime5 = 0x27D4EB2F165667C5ULL;
+
+    static inline uint64_t rotl(uint64_t x, int r) {
+        return (x << r) | (x >> (64 - r));
+    }
+
+    static inline uint64_t read64(const uint8_t* p) {
+        uint64_t v;
+        std::memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    static inline uint32_t read32(const uint8_t* p) {
+        uint32_t v;
+        std::memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    static inline uint64_t round(uint64_t acc, uint64_t input) {
+        acc += input * kPrime2;
+        acc = rotl(acc, 31);
+        return acc * kPrime1;
+    }
+
+    static inline uint64_t merge(uint64_t acc, uint64_t val) {
+        acc ^= round(0, val);
+        return acc * kPrime1 + kPrime4;
+    }
+};
+
+#endif  // XXHASH_H_
@@ -0,0 +1,97 @@
+/**
+Copyright 2021 PIDL(Petabyte-scale In-memory Database Lab) http://kdb.snu.ac.kr
+This work was supported by Next-Generation Information Computing Development
+Program through the National Research Foundation of Korea(NRF)
+funded by the Ministry of Science, ICT (NRF-2016M3C4A7952587)
+Author: Ilju Lee, Jongin Kim, Hyerim Jeon, Youngjune Park
+Contact: sdmt@kdb.snu.ac.kr
+ */
+#include "sdmt.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+
+static bool aligned(void* ptr, size_t align) {
+    return reinterpret_cast<uintptr_t>(ptr) % align == 0;
+}
+
+TEST(AllocTest, Policy) {
+    // initialize sdmt module
+    // every snapshot is 64 byte aligned and prefaulted by configuration
+    SDMT::init("./config_cpp_alloc.xml", false);
+    int rank;
+    MPI_Comm_rank(SDMT::comm(), &rank);
+
+    const int n = 1 << 20;
+    SDMT::register_snapshot("sdmttest_alloc_small", SDMT_INT, SDMT_ARRAY,
+            {3});
+    EXPECT_TRUE(aligned(SDMT::intptr("sdmttest_alloc_small"), 64));
+
+    // a snapshot may ask for more
+    SDMT::Options page;
+    page.m_alignment = 4096;
+    SDMT::register_snapshot("sdmttest_alloc_page", SDMT_DOUBLE, SDMT_ARRAY,
+            {n}, page);
+    EXPECT_TRUE(aligned(SDMT::doubleptr("sdmttest_alloc_page"), 4096));
+
+    SDMT::Options thp;
+    thp.m_huge_pages = SDMT_HP_TRANSPARENT;
+    SDMT::register_snapshot("sdmttest_alloc_thp", SDMT_DOUBLE, SDMT_ARRAY,
+            {n}, thp);
+    EXPECT_TRUE(aligned(SDMT::doubleptr("sdmttest_alloc_thp"), 2 << 20));
+
+    // explicit huge pages fall back to transparent ones without a pool
+    SDMT::Options explicit_huge;
+    explicit_huge.m_huge_pages = SDMT_HP_EXPLICIT;
+    explicit_huge.m_double_buffer = true;
+    SDMT::register_snapshot("sdmttest_alloc_huge", SDMT_DOUBLE, SDMT_ARRAY,
+            {n}, explicit_huge);
+    SDMT::Snapshot huge = SDMT::get_snapshot("sdmttest_alloc_huge");
+    EXPECT_TRUE(aligned(huge.m_ptr, 2 << 20));
+    EXPECT_TRUE(aligned(huge.m_back, 2 << 20));
+
+    SDMT::Options wrong;
+    wrong.m_huge_pages = static_cast<SDMT_HP>(7);
+    EXPECT_EQ(SDMT::register_snapshot("sdmttest_alloc_wrong", SDMT_INT,
+                SDMT_ARRAY, {n}, wrong), SDMT_ERR_WRONG_OPTION);
+
+    // memory is released by the way it was allocated
+    EXPECT_EQ(SDMT::change_snapshot("sdmttest_alloc_huge", SDMT_DOUBLE,
+                SDMT_ARRAY, {n / 2}), SDMT_SUCCESS);
+    EXPECT_TRUE(aligned(SDMT::doubleptr("sdmttest_alloc_huge"), 2 << 20));
+
+    // write rank dependent values to snapshot memory
+    double* dptr = SDMT::doubleptr("sdmttest_alloc_huge");
+    double* tptr = SDMT::doubleptr("sdmttest_alloc_thp");
+    for (int i = 0; i < n / 2; i++) {
+        dptr[i] = i * 0.25 + rank;
+    }
+    for (int i = 0; i < n; i++) {
+        tptr[i] = i - rank;
+    }
+
+    // start sdmt module
+    SDMT::start();
+
+    // generate checkpoint
+    EXPECT_EQ(SDMT::checkpoint(1), SDMT_SUCCESS);
+
+    // overwrite dummy values and recover
+    for (int i = 0; i < n / 2; i++) {
+        dptr[i] = 0;
+    }
+    for (int i = 0; i < n; i++) {
+        tptr[i] = 0;
+    }
+    EXPECT_EQ(SDMT::recover(), SDMT_SUCCESS);
+    for (int i = 0; i < n / 2; i++) {
+        ASSERT_EQ(dptr[i], i * 0.25 + rank);
+    }
+    for (int i = 0; i < n; i++) {
+        ASSERT_EQ(tptr[i], i - rank);
+    }
+
+    // finalize sdmt module
+    SDMT::finalize();
+}
@@ -0,0 +1,160 @@
+/**
+Copyright 2021 PIDL(Petabyte-scale In-memory Database Lab) http://kdb.snu.ac.kr
+This work was supported by Next-Generation Information Computing Development
+Program through the National Research Foundation of Korea(NRF)
+funded by the Ministry of Science, ICT (NRF-2016M3C4A7952587)
+Author: Ilju Lee, Jongin Kim, Hyerim Jeon, Youngjune Park
+Contact: sdmt@kdb.snu.ac.kr
+ */
+#include "sdmt.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+static const int kScalars = 200;
+static const int kLarge = 1 << 16;
+
+static std::string scalar(int i) {
+    return "sdmttest_arena_s" + std::to_string(i);
+}
+
+TEST(ArenaTest, 1st) {
+    // initialize sdmt module
+    // Snapshots of 64 bytes or less are packed in an arena of 64KB
+    SDMT::init("./config_cpp_arena.xml", false);
+    int rank;
+    MPI_Comm_rank(SDMT::comm(), &rank);
+
+    for (int i = 0; i < kScalars; i++) {
+        EXPECT_EQ(SDMT::register_snapshot(scalar(i), SDMT_DOUBLE,
+                    SDMT_SCALAR, {}), SDMT_SUCCESS);
+    }
+    SDMT::register_snapshot("sdmttest_arena_small", SDMT_INT, SDMT_ARRAY,
+            {5});
+    SDMT::register_snapshot("sdmttest_arena_large", SDMT_INT, SDMT_ARRAY,
+            {kLarge});
+    SDMT::register_snapshot("sdmttest_arena_moved", SDMT_INT, SDMT_ARRAY,
+            {2});
+
+    // small Snapshots are contiguous, a large one has memory of its own
+    char* arena = reinterpret_cast<char*>(SDMT::doubleptr(scalar(0)));
+    for (int i = 1; i < kScalars; i++) {
+        EXPECT_EQ(SDMT::doubleptr(scalar(i)), SDMT::doubleptr(scalar(0)) + i);
+    }
+    char* small = reinterpret_cast<char*>(SDMT::intptr("sdmttest_arena_small"));
+    char* large = reinterpret_cast<char*>(SDMT::intptr("sdmttest_arena_large"));
+    EXPECT_EQ(small, arena + kScalars * sizeof(double));
+    EXPECT_TRUE(large < arena || large >= arena + 65536);
+
+    // the name of the arena in checkpoints is reserved
+    EXPECT_EQ(SDMT::register_snapshot("#arena", SDMT_INT, SDMT_SCALAR, {}),
+            SDMT_ERR_DUPLICATED_NAME);
+
+    // a member keeps its slot while it fits, takes another one otherwise
+    EXPECT_EQ(SDMT::change_snapshot("sdmttest_arena_small", SDMT_INT,
+                SDMT_ARRAY, {4}), SDMT_SUCCESS);
+    EXPECT_EQ(reinterpret_cast<char*>(SDMT::intptr("sdmttest_arena_small")),
+            small);
+    EXPECT_EQ(SDMT::change_snapshot("sdmttest_arena_small", SDMT_INT,
+                SDMT_ARRAY, {16}), SDMT_SUCCESS);
+    small = reinterpret_cast<char*>(SDMT::intptr("sdmttest_arena_small"));
+    EXPECT_GE(small, arena + kScalars * sizeof(double) + 5 * sizeof(int));
+    EXPECT_LT(small, arena + 65536);
+
+    // write rank dependent values to snapshot memory
+    for (int i = 0; i < kScalars; i++) {
+        *SDMT::doubleptr(scalar(i)) = i * 0.5 + rank;
+    }
+    int* iptr = SDMT::intptr("sdmttest_arena_small");
+    int* lptr = SDMT::intptr("sdmttest_arena_large");
+    for (int i = 0; i < 16; i++) {
+        iptr[i] = i * 7 + rank;
+    }
+    for (int i = 0; i < kLarge; i++) {
+        lptr[i] = i - rank;
+    }
+    SDMT::intptr("sdmttest_arena_moved")[0] = 11 + rank;
+    SDMT::intptr("sdmttest_arena_moved")[1] = 13 + rank;
+
+    // start sdmt module
+    SDMT::start();
+
+    // generate checkpoint, the arena is written as a whole
+    EXPECT_EQ(SDMT::checkpoint(1), SDMT_SUCCESS);
+    EXPECT_EQ(SDMT::checkpoint_stats().m_rawsize,
+            65536 + kLarge * sizeof(int));
+
+    // a member is recovered alone
+    for (int i = 0; i < kScalars; i++) {
+        *SDMT::doubleptr(scalar(i)) = -1;
+    }
+    EXPECT_EQ(SDMT::recover({scalar(3), "sdmttest_arena_large"}),
+            SDMT_SUCCESS);
+    EXPECT_EQ(*SDMT::doubleptr(scalar(3)), 3 * 0.5 + rank);
+    EXPECT_EQ(*SDMT::doubleptr(scalar(2)), -1);
+    EXPECT_EQ(*SDMT::doubleptr(scalar(4)), -1);
+
+    // then every one
+    EXPECT_EQ(SDMT::recover(), SDMT_SUCCESS);
+    for (int i = 0; i < kScalars; i++) {
+        ASSERT_EQ(*SDMT::doubleptr(scalar(i)), i * 0.5 + rank);
+    }
+
+    // a member moved since the checkpoint is recovered from the offset
+    // it had then, alone or with every one
+    int* moved = SDMT::intptr("sdmttest_arena_moved");
+    EXPECT_EQ(SDMT::change_snapshot("sdmttest_arena_moved", SDMT_INT,
+                SDMT_ARRAY, {4}), SDMT_SUCCESS);
+    EXPECT_EQ(SDMT::change_snapshot("sdmttest_arena_moved", SDMT_INT,
+                SDMT_ARRAY, {2}), SDMT_SUCCESS);
+    EXPECT_NE(SDMT::intptr("sdmttest_arena_moved"), moved);
+    moved = SDMT::intptr("sdmttest_arena_moved");
+    moved[0] = moved[1] = -1;
+    EXPECT_EQ(SDMT::recover({"sdmttest_arena_moved"}), SDMT_SUCCESS);
+    EXPECT_EQ(moved[0], 11 + rank);
+    EXPECT_EQ(moved[1], 13 + rank);
+    moved[0] = moved[1] = -1;
+    EXPECT_EQ(SDMT::recover(), SDMT_SUCCESS);
+    EXPECT_EQ(moved[0], 11 + rank);
+    EXPECT_EQ(moved[1], 13 + rank);
+    EXPECT_EQ(*SDMT::doubleptr(scalar(kScalars - 1)),
+            (kScalars - 1) * 0.5 + rank);
+
+    // end process w/o finalize, restarted by the 2nd test
+}
+
+TEST(ArenaTest, 2nd) {
+    // initialize sdmt module
+    SDMT::init("./config_cpp_arena.xml", true);
+    int rank;
+    MPI_Comm_rank(SDMT::comm(), &rank);
+
+    // members are at their archived offsets
+    double* arena = SDMT::doubleptr(scalar(0));
+    ASSERT_NE(arena, nullptr);
+    for (int i = 1; i < kScalars; i++) {
+        EXPECT_EQ(SDMT::doubleptr(scalar(i)), arena + i);
+    }
+
+    // check recovered values
+    EXPECT_EQ(SDMT::wait_recovery(), SDMT_SUCCESS);
+    for (int i = 0; i < kScalars; i++) {
+        ASSERT_EQ(*SDMT::doubleptr(scalar(i)), i * 0.5 + rank);
+    }
+    int* iptr = SDMT::intptr("sdmttest_arena_small");
+    int* lptr = SDMT::intptr("sdmttest_arena_large");
+    for (int i = 0; i < 16; i++) {
+        ASSERT_EQ(iptr[i], i * 7 + rank);
+    }
+    for (int i = 0; i < kLarge; i++) {
+        ASSERT_EQ(lptr[i], i - rank);
+    }
+
+    // archived at its new offset, recovered from the saved one
+    EXPECT_EQ(SDMT::intptr("sdmttest_arena_moved")[0], 11 + rank);
+    EXPECT_EQ(SDMT::intptr("sdmttest_arena_moved")[1], 13 + rank);
+
+    // finalize sdmt module
+    SDMT::finalize();
+}
@@ -0,0 +1,93 @@
+/**
+Copyright 2021 PIDL(Petabyte-scale In-memory Database Lab) http://kdb.snu.ac.kr
+This work was supported by Next-Generation Information Computing Development
+Program through the National Research Foundation of Korea(NRF)
+funded by the Ministry of Science, ICT (NRF-2016M3C4A7952587)
+Author: Ilju Lee, Jongin Kim, Hyerim Jeon, Youngjune Park
+Contact: sdmt@kdb.snu.ac.kr
+ */
+#include "sdmt.h"
+
+#include <gtest/gtest.h>
+
+#include <numeric>
+#include <type_traits>
+
+static_assert(ValueTraits<long>::value_type() == SDMT_LONG,
+        "value type of long");
+
+TEST(ArrayTest, Access) {
+    // initialize sdmt module
+    SDMT::init("./config_cpp_test.xml", false);
+
+    // register typed snapshots, data types follow the number of dimensions
+    const int nx = 30, ny = 40, nz = 5;
+    SDMT::SnapshotHandle mh = -1, th = -1;
+    EXPECT_EQ(SDMT::register_array<double>("sdmttest_array_matrix",
+                {nx, ny}, mh), SDMT_SUCCESS);
+    EXPECT_EQ(SDMT::register_array<int>("sdmttest_array_tensor",
+                {nx, ny, nz}, th), SDMT_SUCCESS);
+    EXPECT_EQ(SDMT::get_snapshot(mh).m_valuetype, SDMT_DOUBLE);
+    EXPECT_EQ(SDMT::get_snapshot(mh).m_datatype, SDMT_MATRIX);
+    EXPECT_EQ(SDMT::get_snapshot(th).m_datatype, SDMT_TENSOR);
+    EXPECT_EQ(SDMT::ptr<double>(mh), SDMT::doubleptr(mh));
+    EXPECT_EQ(SDMT::ptr<float>(mh), nullptr);
+
+    // a view of another type or rank is null
+    EXPECT_FALSE((SDMT::array<float, 2>(mh)));
+    EXPECT_FALSE((SDMT::array<double, 1>(mh)));
+    EXPECT_FALSE((SDMT::array<double, 2>("sdmttest_array_none")));
+
+    // element access is row major pointer arithmetic
+    SDMT::Array<double, 2> m = SDMT::array<double, 2>(mh);
+    ASSERT_TRUE(m);
+    EXPECT_EQ(m.extent(0), nx);
+    EXPECT_EQ(m.extent(1), ny);
+    EXPECT_EQ(m.stride(0), ny);
+    EXPECT_EQ(m.stride(1), 1);
+    EXPECT_EQ(m.size(), (size_t)nx * ny);
+    EXPECT_EQ(&m(3, 7), SDMT::doubleptr(mh) + 3 * ny + 7);
+    for (int i = 0; i < nx; i++) {
+        SDMT::Span<double> row = m.row(i);
+        EXPECT_EQ(row.size(), (size_t)ny);
+        for (int j = 0; j < ny; j++) {
+            row[j] = i * 100 + j;
+        }
+    }
+
+    SDMT::Array<int, 3> t = SDMT::array<int, 3>("sdmttest_array_tensor");
+    ASSERT_TRUE(t);
+    EXPECT_EQ(&t(1, 2, 3), SDMT::intptr(th) + (1 * ny + 2) * nz + 3);
+    SDMT::Span<int> all = t.span();
+    std::iota(all.begin(), all.end(), 0);
+    EXPECT_EQ(t(2, 0, 1), 2 * ny * nz + 1);
+    EXPECT_EQ(t.row(2, 3).subspan(1, 2)[1], (2 * ny + 3) * nz + 2);
+
+    // start sdmt module
+    SDMT::start();
+
+    // generate checkpoint
+    SDMT::checkpoint(1);
+
+    // overwrite and recover through the same views
+    for (auto& v : m.span()) {
+        v = 0;
+    }
+    for (auto& v : all) {
+        v = -1;
+    }
+    EXPECT_EQ(SDMT::recover(), SDMT_SUCCESS);
+    m = SDMT::array<double, 2>(mh);
+    t = SDMT::array<int, 3>(th);
+    for (int i = 0; i < nx; i++) {
+        for (int j = 0; j < ny; j++) {
+            EXPECT_EQ(m(i, j), i * 100 + j);
+            for (int k = 0; k < nz; k++) {
+                EXPECT_EQ(t(i, j, k), (i * ny + j) * nz + k);
+            }
+        }
+    }
+
+    // finalize sdmt module
+    SDMT::finalize();
+}
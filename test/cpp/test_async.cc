@@ -0,0 +1,56 @@
+/**
+Copyright 2021 PIDL(Petabyte-scale In-memory Database Lab) http://kdb.snu.ac.kr
+This work was supported by Next-Generation Information Computing Development
+Program through the National Research Foundation of Korea(NRF)
+funded by the Ministry of Science, ICT (NRF-2016M3C4A7952587)
+Author: Ilju Lee, Jongin Kim, Hyerim Jeon, Youngjune Park
+Contact: sdmt@kdb.snu.ac.kr
+ */
+#include "sdmt.h"
+
+#include <gtest/gtest.h>
+
+TEST(AsyncTest, Int1D) {
+    // initialize sdmt module
+    SDMT::init("./config_cpp_test.xml", false);
+
+    // request a sdmt snapshot
+    // define 1 dimensional integer array
+    // the size of array is 1024
+    SDMT::register_snapshot("sdmttest_async1d", SDMT_INT, SDMT_ARRAY, {1024});
+
+    // get data snapshot
+    int* ptr = SDMT::intptr("sdmttest_async1d");
+
+    // write values to snapshot memory
+    for (int i = 0; i < 1024; i++) {
+        ptr[i] = i * i;
+    }
+
+    // start sdmt module
+    SDMT::start();
+
+    // generate checkpoint in background
+    EXPECT_EQ(SDMT::checkpoint(1, true), SDMT_SUCCESS);
+
+    // snapshot memory is staged already,
+    // overwriting it does not affect the checkpoint
+    for (int i = 0; i < 1024; i++) {
+        ptr[i] = 0;
+    }
+
+    // wait until checkpoint is written
+    EXPECT_EQ(SDMT::wait_checkpoint(), SDMT_SUCCESS);
+    EXPECT_EQ(SDMT::checkpoint_status(), SDMT_CKPT_COMPLETED);
+
+    // recover checkpoint
+    EXPECT_EQ(SDMT::recover(), SDMT_SUCCESS);
+
+    // check recovered values
+    for (int i = 0; i < 1024; i++) {
+        EXPECT_EQ(ptr[i], i * i);
+    }
+
+    // finalize sdmt module
+    SDMT::finalize();
+}
@@ -0,0 +1,75 @@
+/**
+Copyright 2021 PIDL(Petabyte-scale In-memory Database Lab) http://kdb.snu.ac.kr
+This work was supported by Next-Generation Information Computing Development
+Program through the National Research Foundation of Korea(NRF)
+funded by the Ministry of Science, ICT (NRF-2016M3C4A7952587)
+Author: Ilju Lee, Jongin Kim, Hyerim Jeon, Youngjune Park
+Contact: sdmt@kdb.snu.ac.kr
+ */
+#include "sdmt.h"
+
+#include <gtest/gtest.h>
+
+static std::vector<int> ids(const std::vector<SDMT::CatalogEntry>& entries) {
+    std::vector<int> res;
+    for (auto& entry : entries) {
+        res.push_back(entry.m_id);
+    }
+    return res;
+}
+
+TEST(CatalogTest, History) {
+    // initialize sdmt module keeping the last 2 and every 3rd checkpoint
+    SDMT::init("./config_cpp_catalog.xml", false);
+
+    int rank;
+    MPI_Comm_rank(SDMT::comm(), &rank);
+    const int n = 10000;
+    SDMT::register_snapshot("sdmttest_catalog", SDMT_INT, SDMT_ARRAY, {n});
+    int* ptr = SDMT::intptr("sdmttest_catalog");
+
+    // start sdmt module
+    SDMT::start();
+
+    // checkpoints 1 to 7, iteration and values follow the id
+    for (int id = 1; id <= 7; id++) {
+        for (int i = 0; i < n; i++) {
+            ptr[i] = id * 100 + rank + i;
+        }
+        SDMT::iter() = id * 10;
+        EXPECT_EQ(SDMT::checkpoint(1), SDMT_SUCCESS);
+    }
+
+    std::vector<SDMT::CatalogEntry> entries = SDMT::catalog();
+    EXPECT_EQ(ids(entries), std::vector<int>({3, 6, 7}));
+    for (auto& entry : entries) {
+        EXPECT_EQ(entry.m_iter, entry.m_id * 10);
+        EXPECT_EQ(entry.m_level, 1);
+        EXPECT_EQ(entry.m_rawsize, n * sizeof(int));
+        EXPECT_GT(entry.m_time, 0);
+    }
+
+    // roll back past the newest checkpoints
+    EXPECT_EQ(SDMT::recover(3), SDMT_SUCCESS);
+    EXPECT_EQ(SDMT::iter(), 30);
+    EXPECT_EQ(SDMT::recovery_stats().m_id, 3);
+    for (int i = 0; i < n; i++) {
+        EXPECT_EQ(ptr[i], 300 + rank + i);
+    }
+
+    // a deleted checkpoint cannot be recovered
+    EXPECT_EQ(SDMT::recover(5), SDMT_ERR_FAILED_RECOVERY);
+
+    // ids go on from the newest
+    ptr[0] = -1;
+    EXPECT_EQ(SDMT::checkpoint(1), SDMT_SUCCESS);
+    EXPECT_EQ(ids(SDMT::catalog()), std::vector<int>({3, 6, 7, 8}));
+    EXPECT_EQ(SDMT::recover(6), SDMT_SUCCESS);
+    EXPECT_EQ(SDMT::iter(), 60);
+    EXPECT_EQ(ptr[0], 600 + rank);
+    EXPECT_EQ(SDMT::recover(), SDMT_SUCCESS);
+    EXPECT_EQ(ptr[0], -1);
+
+    // finalize sdmt module
+    SDMT::finalize();
+}
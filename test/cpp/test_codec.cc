@@ -0,0 +1,184 @@
+/**
+Copyright 2021 PIDL(Petabyte-scale In-memory Database Lab) http://kdb.snu.ac.kr
+This work was supported by Next-Generation Information Computing Development
+Program through the National Research Foundation of Korea(NRF)
+funded by the Ministry of Science, ICT (NRF-2016M3C4A7952587)
+Author: Ilju Lee, Jongin Kim, Hyerim Jeon, Youngjune Park
+Contact: sdmt@kdb.snu.ac.kr
+ */
+#include "sdmt.h"
+
+#include <cmath>
+#include <gtest/gtest.h>
+
+TEST(CodecTest, Fti) {
+    // initialize sdmt module
+    SDMT::init("./config_cpp_test.xml", false);
+
+    // request compressed sdmt snapshots
+    // define 2 dimensional sparse integer matrix and
+    // 1 dimensional smooth double array
+    const int n = 512;
+    SDMT::Options lz;
+    lz.m_codec = SDMT_CC_LZ;
+    SDMT::register_snapshot("sdmttest_lz2d", SDMT_INT, SDMT_MATRIX, {n, n}, lz);
+    SDMT::Options shuffle;
+    shuffle.m_codec = SDMT_CC_SHUFFLE_LZ;
+    SDMT::register_snapshot("sdmttest_shuffle1d", SDMT_DOUBLE, SDMT_ARRAY,
+            {n * n}, shuffle);
+
+    // names with '#' are reserved for images of SDMT
+    EXPECT_EQ(SDMT::register_snapshot("sdmttest_lz2d#codec", SDMT_INT,
+                SDMT_ARRAY, {n}, lz), SDMT_ERR_DUPLICATED_NAME);
+
+    // get data snapshots
+    int* iptr = SDMT::intptr("sdmttest_lz2d");
+    double* dptr = SDMT::doubleptr("sdmttest_shuffle1d");
+
+    // write values to snapshot memory
+    for (int i = 0; i < n * n; i++) {
+        iptr[i] = (i % 97 == 0) ? i : 0;
+        dptr[i] = std::floor(std::sin(i * 1e-4) * 1e3) / 8;
+    }
+
+    // start sdmt module
+    SDMT::start();
+
+    // no level is due within the first minute, so nothing is compressed
+    EXPECT_EQ(SDMT::checkpoint(0), SDMT_SUCCESS);
+    EXPECT_EQ(SDMT::checkpoint_stats().m_id, -1);
+
+    // checkpoint written by FTI is compressed
+    EXPECT_EQ(SDMT::checkpoint(1), SDMT_SUCCESS);
+    EXPECT_LT(SDMT::checkpoint_stats().ratio(), 0.5);
+
+    // overwrite dummy values to snapshot memory
+    for (int i = 0; i < n * n; i++) {
+        iptr[i] = -1;
+        dptr[i] = -1;
+    }
+
+    // recover and decompress checkpoint
+    EXPECT_EQ(SDMT::recover(), SDMT_SUCCESS);
+
+    // check recovered values
+    for (int i = 0; i < n * n; i++) {
+        EXPECT_EQ(iptr[i], (i % 97 == 0) ? i : 0);
+        EXPECT_EQ(dptr[i], std::floor(std::sin(i * 1e-4) * 1e3) / 8);
+    }
+
+    // finalize sdmt module
+    SDMT::finalize();
+}
+
+TEST(CodecTest, Native) {
+    // initialize sdmt module
+    SDMT::init("./config_cpp_test.xml", false);
+
+    // request a compressed sdmt snapshot tracked by hashes of blocks
+    const int n = 64 * 1024;
+    SDMT::Options opts;
+    opts.m_incremental = SDMT_IM_HASH;
+    opts.m_codec = SDMT_CC_SHUFFLE_LZ;
+    SDMT::register_snapshot("sdmttest_codec1d", SDMT_LONG, SDMT_ARRAY, {n}, opts);
+
+    // get data snapshot
+    long* ptr = SDMT::longptr("sdmttest_codec1d");
+
+    // write values to snapshot memory
+    for (int i = 0; i < n; i++) {
+        ptr[i] = i;
+    }
+
+    // start sdmt module
+    SDMT::start();
+
+    // first checkpoint is a compressed full image
+    EXPECT_EQ(SDMT::checkpoint(1, true), SDMT_SUCCESS);
+    EXPECT_EQ(SDMT::wait_checkpoint(), SDMT_SUCCESS);
+    EXPECT_LT(SDMT::checkpoint_stats().ratio(), 0.5);
+
+    // update a small part of snapshot memory
+    for (int i = 0; i < n; i += 8192) {
+        ptr[i] = -i;
+    }
+
+    // second checkpoint is a compressed delta
+    EXPECT_EQ(SDMT::checkpoint(1, true), SDMT_SUCCESS);
+    EXPECT_EQ(SDMT::wait_checkpoint(), SDMT_SUCCESS);
+
+    // overwrite dummy values to snapshot memory
+    for (int i = 0; i < n; i++) {
+        ptr[i] = 0;
+    }
+
+    // recover checkpoint, base image and delta
+    EXPECT_EQ(SDMT::recover(), SDMT_SUCCESS);
+
+    // check recovered values
+    for (int i = 0; i < n; i++) {
+        EXPECT_EQ(ptr[i], (i % 8192 == 0) ? -i : i);
+    }
+
+    // finalize sdmt module
+    SDMT::finalize();
+}
+
+TEST(CodecTest, Lossy) {
+    // initialize sdmt module
+    SDMT::init("./config_cpp_test.xml", false);
+
+    // request sdmt snapshots compressed with an error bound
+    // lossy compression is allowed for floating point values only
+    const int n = 256 * 1024;
+    const double bound = 1e-6;
+    SDMT::Options opts;
+    opts.m_codec = SDMT_CC_LOSSY;
+    opts.m_error_bound = bound;
+    EXPECT_EQ(SDMT::register_snapshot("sdmttest_lossy_int", SDMT_INT,
+                SDMT_ARRAY, {n}, opts), SDMT_ERR_WRONG_OPTION);
+    SDMT::register_snapshot("sdmttest_lossy_float", SDMT_FLOAT, SDMT_ARRAY, {n}, opts);
+    SDMT::register_snapshot("sdmttest_lossy_double", SDMT_DOUBLE, SDMT_ARRAY, {n}, opts);
+
+    // get data snapshots
+    float* fptr = SDMT::floatptr("sdmttest_lossy_float");
+    double* dptr = SDMT::doubleptr("sdmttest_lossy_double");
+
+    // write smooth values to snapshot memory
+    for (int i = 0; i < n; i++) {
+        fptr[i] = std::sin(i * 1e-4);
+        dptr[i] = std::sin(i * 1e-4);
+    }
+
+    // start sdmt module
+    SDMT::start();
+
+    // lossy checkpoint is several times smaller
+    EXPECT_EQ(SDMT::checkpoint(1), SDMT_SUCCESS);
+    EXPECT_LT(SDMT::checkpoint_stats().ratio(), 0.5);
+
+    // overwrite dummy values to snapshot memory
+    for (int i = 0; i < n; i++) {
+        fptr[i] = -2;
+        dptr[i] = -2;
+    }
+
+    // recover checkpoint within the error bound
+    EXPECT_EQ(SDMT::recover(), SDMT_SUCCESS);
+
+    // check recovered values
+    for (int i = 0; i < n; i++) {
+        EXPECT_LE(std::fabs(fptr[i] - (float)std::sin(i * 1e-4)), bound);
+        EXPECT_LE(std::fabs(dptr[i] - std::sin(i * 1e-4)), bound);
+    }
+
+    // a lossy Snapshot cannot be changed to integer values
+    EXPECT_EQ(SDMT::change_snapshot("sdmttest_lossy_float", SDMT_INT,
+                SDMT_ARRAY, {n}), SDMT_ERR_WRONG_OPTION);
+    EXPECT_EQ(SDMT::get_snapshot("sdmttest_lossy_float").m_valuetype,
+            SDMT_FLOAT);
+    EXPECT_EQ(SDMT::floatptr("sdmttest_lossy_float"), fptr);
+
+    // finalize sdmt module
+    SDMT::finalize();
+}
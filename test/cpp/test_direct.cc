@@ -0,0 +1,95 @@
+/**
+Copyright 2021 PIDL(Petabyte-scale In-memory Database Lab) http://kdb.snu.ac.kr
+This work was supported by Next-Generation Information Computing Development
+Program through the National Research Foundation of Korea(NRF)
+funded by the Ministry of Science, ICT (NRF-2016M3C4A7952587)
+Author: Ilju Lee, Jongin Kim, Hyerim Jeon, Youngjune Park
+Contact: sdmt@kdb.snu.ac.kr
+ */
+#include "sdmt.h"
+
+#include <gtest/gtest.h>
+
+TEST(DirectTest, Write) {
+    // initialize sdmt module writing native checkpoints by direct I/O
+    SDMT::init("./config_cpp_direct.xml", false);
+
+    // request sdmt snapshots
+    // define page aligned integer array, huge page aligned double array
+    // and compressed array of odd size
+    int rank;
+    MPI_Comm_rank(SDMT::comm(), &rank);
+    const int n = 1000003;
+    SDMT::Options aligned;
+    aligned.m_alignment = 4096;
+    SDMT::register_snapshot("sdmttest_direct1d", SDMT_INT, SDMT_ARRAY, {n}, aligned);
+    SDMT::Options huge;
+    huge.m_alignment = 2 << 20;
+    SDMT::register_snapshot("sdmttest_direct_huge", SDMT_DOUBLE, SDMT_ARRAY, {n}, huge);
+    SDMT::Options lz;
+    lz.m_codec = SDMT_CC_LZ;
+    SDMT::register_snapshot("sdmttest_direct_lz", SDMT_INT, SDMT_ARRAY, {n}, lz);
+
+    // alignment must be a power of 2
+    SDMT::Options wrong;
+    wrong.m_alignment = 3000;
+    EXPECT_EQ(SDMT::register_snapshot("sdmttest_direct_wrong", SDMT_INT,
+                SDMT_ARRAY, {n}, wrong), SDMT_ERR_WRONG_OPTION);
+
+    // get data snapshots
+    int* iptr = SDMT::intptr("sdmttest_direct1d");
+    double* dptr = SDMT::doubleptr("sdmttest_direct_huge");
+    int* lptr = SDMT::intptr("sdmttest_direct_lz");
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(iptr) % 4096, 0u);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(dptr) % (2 << 20), 0u);
+
+    // write rank dependent values to snapshot memory
+    for (int i = 0; i < n; i++) {
+        iptr[i] = i * 5 + rank;
+        dptr[i] = i * 0.5 + rank;
+        lptr[i] = i % 1000 + rank;
+    }
+
+    // start sdmt module
+    SDMT::start();
+
+    // synchronous and asynchronous checkpoints
+    SDMT::iter() = 3;
+    EXPECT_EQ(SDMT::checkpoint(1), SDMT_SUCCESS);
+    SDMT::iter() = 6;
+    EXPECT_EQ(SDMT::checkpoint(1, true), SDMT_SUCCESS);
+    EXPECT_EQ(SDMT::wait_checkpoint(), SDMT_SUCCESS);
+
+    // payloads are at aligned offsets
+    int id = CkptFile::latest("./checkpoint/Native", rank);
+    CkptFile::Header header;
+    std::vector<CkptFile::Record> records;
+    EXPECT_TRUE(CkptFile::read_index(
+                CkptFile::path("./checkpoint/Native", id, rank), header, records));
+    EXPECT_EQ(records.size(), 3u);
+    for (auto& r : records) {
+        EXPECT_EQ(r.m_offset % 4096, 0u);
+    }
+
+    // overwrite dummy values to snapshot memory
+    for (int i = 0; i < n; i++) {
+        iptr[i] = -1;
+        dptr[i] = -1;
+        lptr[i] = -1;
+    }
+    SDMT::iter() = 0;
+
+    // recover from the last checkpoint
+    EXPECT_EQ(SDMT::recover(), SDMT_SUCCESS);
+    EXPECT_EQ(SDMT::iter(), 6);
+
+    // check recovered values
+    for (int i = 0; i < n; i++) {
+        EXPECT_EQ(iptr[i], i * 5 + rank);
+        EXPECT_EQ(dptr[i], i * 0.5 + rank);
+        EXPECT_EQ(lptr[i], i % 1000 + rank);
+    }
+
+    // finalize sdmt module
+    SDMT::finalize();
+}
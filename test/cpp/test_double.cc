@@ -0,0 +1,128 @@
+/**
+Copyright 2021 PIDL(Petabyte-scale In-memory Database Lab) http://kdb.snu.ac.kr
+This work was supported by Next-Generation Information Computing Development
+Program through the National Research Foundation of Korea(NRF)
+funded by the Ministry of Science, ICT (NRF-2016M3C4A7952587)
+Author: Ilju Lee, Jongin Kim, Hyerim Jeon, Youngjune Park
+Contact: sdmt@kdb.snu.ac.kr
+ */
+#include "sdmt.h"
+
+#include <gtest/gtest.h>
+
+TEST(DoubleBufferTest, Flip) {
+    // initialize sdmt module
+    SDMT::init("./config_cpp_test.xml", false);
+
+    // request sdmt snapshots
+    // define double buffered integer array
+    int rank;
+    MPI_Comm_rank(SDMT::comm(), &rank);
+    const int n = 300000;
+    SDMT::Options opts;
+    opts.m_double_buffer = true;
+    SDMT::register_snapshot("sdmttest_double1d", SDMT_INT, SDMT_ARRAY, {n}, opts);
+
+    // dirty pages are tracked in one buffer only
+    SDMT::Options page = opts;
+    page.m_incremental = SDMT_IM_PAGE;
+    EXPECT_EQ(SDMT::register_snapshot("sdmttest_double_page", SDMT_INT,
+                SDMT_ARRAY, {n}, page), SDMT_ERR_WRONG_OPTION);
+
+    // rebind the application pointer whenever buffers are swapped
+    int* iptr = SDMT::intptr("sdmttest_double1d");
+    int flips = 0;
+    SDMT::set_flip_hook([&](const std::string& name, void* ptr) {
+        EXPECT_EQ(name, "sdmttest_double1d");
+        iptr = reinterpret_cast<int*>(ptr);
+        flips++;
+    });
+
+    // write rank dependent values to snapshot memory
+    for (int i = 0; i < n; i++) {
+        iptr[i] = i * 9 + rank;
+    }
+    int* first = iptr;
+
+    // start sdmt module
+    SDMT::start();
+
+    // checkpoint writes the buffer just written and swaps buffers
+    SDMT::iter() = 2;
+    EXPECT_EQ(SDMT::checkpoint(1, true), SDMT_SUCCESS);
+    EXPECT_EQ(flips, 1);
+    EXPECT_NE(iptr, first);
+    EXPECT_EQ(iptr, SDMT::intptr("sdmttest_double1d"));
+    EXPECT_EQ(SDMT::get_snapshot("sdmttest_double1d").m_back, first);
+
+    // the application goes on in the other buffer
+    for (int i = 0; i < n; i++) {
+        iptr[i] = -1;
+    }
+    EXPECT_EQ(SDMT::wait_checkpoint(), SDMT_SUCCESS);
+
+    // swap back by hand
+    EXPECT_EQ(SDMT::flip("sdmttest_double1d"), SDMT_SUCCESS);
+    EXPECT_EQ(flips, 2);
+    EXPECT_EQ(iptr, first);
+    for (int i = 0; i < n; i++) {
+        iptr[i] = -2;
+    }
+    SDMT::iter() = 0;
+
+    // recover into the active buffer
+    EXPECT_EQ(SDMT::recover(), SDMT_SUCCESS);
+    EXPECT_EQ(SDMT::iter(), 2);
+    for (int i = 0; i < n; i++) {
+        EXPECT_EQ(iptr[i], i * 9 + rank);
+    }
+
+    // finalize sdmt module
+    SDMT::set_flip_hook(SDMT::FlipHook());
+    SDMT::finalize();
+}
+
+TEST(DoubleBufferTest, Change) {
+    // initialize sdmt module
+    SDMT::init("./config_cpp_test.xml", false);
+    int rank;
+    MPI_Comm_rank(SDMT::comm(), &rank);
+
+    // buffers large enough to be unmapped when freed
+    const int n = 1 << 24;
+    SDMT::Options opts;
+    opts.m_double_buffer = true;
+    EXPECT_EQ(SDMT::register_snapshot("sdmttest_double_change", SDMT_INT,
+                SDMT_ARRAY, {n}, opts), SDMT_SUCCESS);
+    int* iptr = SDMT::intptr("sdmttest_double_change");
+    for (int i = 0; i < n; i++) {
+        iptr[i] = i + rank;
+    }
+
+    // start sdmt module
+    SDMT::start();
+
+    // the buffer written by the checkpoint is not freed under it
+    EXPECT_EQ(SDMT::checkpoint(1, true), SDMT_SUCCESS);
+    EXPECT_EQ(SDMT::change_snapshot("sdmttest_double_change", SDMT_INT,
+                SDMT_ARRAY, {n / 2}), SDMT_SUCCESS);
+    EXPECT_EQ(SDMT::wait_checkpoint(), SDMT_SUCCESS);
+    EXPECT_EQ(SDMT::checkpoint_status(), SDMT_CKPT_COMPLETED);
+
+    // both buffers are of the new size
+    SDMT::Snapshot changed = SDMT::get_snapshot("sdmttest_double_change");
+    EXPECT_EQ(changed.m_dimension, std::vector<int>({n / 2}));
+    EXPECT_NE(changed.m_back, nullptr);
+
+    // the checkpoint holds the values of the released buffer
+    EXPECT_EQ(SDMT::change_snapshot("sdmttest_double_change", SDMT_INT,
+                SDMT_ARRAY, {n}), SDMT_SUCCESS);
+    EXPECT_EQ(SDMT::recover(), SDMT_SUCCESS);
+    iptr = SDMT::intptr("sdmttest_double_change");
+    for (int i = 0; i < n; i++) {
+        EXPECT_EQ(iptr[i], i + rank);
+    }
+
+    // finalize sdmt module
+    SDMT::finalize();
+}
@@ -0,0 +1,140 @@
+/**
+Copyright 2021 PIDL(Petabyte-scale In-memory Database Lab) http://kdb.snu.ac.kr
+This work was supported by Next-Generation Information Computing Development
+Program through the National Research Foundation of Korea(NRF)
+funded by the Ministry of Science, ICT (NRF-2016M3C4A7952587)
+Author: Ilju Lee, Jongin Kim, Hyerim Jeon, Youngjune Park
+Contact: sdmt@kdb.snu.ac.kr
+ */
+#include "sdmt.h"
+
+#include <gtest/gtest.h>
+
+TEST(ErasureTest, Xor) {
+    // initialize sdmt module
+    SDMT::init("./config_cpp_test.xml", false);
+
+    // request sdmt snapshots
+    // define 1 dimensional integer array and 2 dimensional double matrix
+    const int n = 512;
+    SDMT::register_snapshot("sdmttest_erasure1d", SDMT_INT, SDMT_ARRAY, {n * n});
+    SDMT::register_snapshot("sdmttest_erasure2d", SDMT_DOUBLE, SDMT_MATRIX, {n, n});
+
+    // get data snapshots
+    int* iptr = SDMT::intptr("sdmttest_erasure1d");
+    double* dptr = SDMT::doubleptr("sdmttest_erasure2d");
+
+    // write rank dependent values to snapshot memory
+    int rank;
+    MPI_Comm_rank(SDMT::comm(), &rank);
+    for (int i = 0; i < n * n; i++) {
+        iptr[i] = i + rank;
+        dptr[i] = i * 0.5 + rank;
+    }
+
+    // start sdmt module
+    SDMT::start();
+
+    // a rank has no other rank to keep its parity
+    int size;
+    MPI_Comm_size(SDMT::comm(), &size);
+    if (size < 2) {
+        EXPECT_EQ(SDMT::checkpoint_erasure(), SDMT_ERR_FAILED_CHECKPOINT);
+        SDMT::finalize();
+        return;
+    }
+
+    // encode XOR parity over groups of ranks
+    SDMT::iter() = 5;
+    EXPECT_EQ(SDMT::checkpoint_erasure(), SDMT_SUCCESS);
+
+    // overwrite dummy values to snapshot memory
+    for (int i = 0; i < n * n; i++) {
+        iptr[i] = -1;
+        dptr[i] = -1;
+    }
+    SDMT::iter() = 0;
+
+    // nothing is lost, every rank restores its own copy
+    EXPECT_EQ(SDMT::recover_erasure(), SDMT_SUCCESS);
+    EXPECT_EQ(SDMT::iter(), 5);
+
+    // check recovered values
+    for (int i = 0; i < n * n; i++) {
+        EXPECT_EQ(iptr[i], i + rank);
+        EXPECT_EQ(dptr[i], i * 0.5 + rank);
+    }
+
+    // finalize sdmt module
+    SDMT::finalize();
+}
+
+TEST(ErasureTest, Rebuild) {
+    // initialize sdmt module
+    SDMT::init("./config_cpp_test.xml", false);
+
+    // a group of every rank, tolerating 2 lost ranks if possible
+    int rank;
+    int size;
+    MPI_Comm_rank(SDMT::comm(), &rank);
+    MPI_Comm_size(SDMT::comm(), &size);
+    const int parity = (size > 2) ? 2 : 1;
+
+    // regions of different sizes in each rank
+    const int n = 300000 + rank * 1000;
+    std::vector<long> a(n);
+    std::vector<char> b(1234);
+    for (int i = 0; i < n; i++) {
+        a[i] = (long)i * (rank + 1);
+    }
+    for (int i = 0; i < 1234; i++) {
+        b[i] = i + rank;
+    }
+    std::vector<CkptRing::Region> regions = {
+        {0, a.data(), a.size() * sizeof(long)},
+        {1, b.data(), b.size()}};
+
+    CkptErasure erasure;
+    if (size < 2) {
+        // a group of one rank is smaller than parity + 1
+        EXPECT_FALSE(erasure.encode(SDMT::comm(), regions, size, parity, 3));
+        SDMT::finalize();
+        return;
+    }
+    EXPECT_TRUE(erasure.encode(SDMT::comm(), regions, size, parity, 3));
+
+    // first ranks lose their checkpoint and memory
+    if (rank < parity) {
+        erasure.clear();
+        std::fill(a.begin(), a.end(), 0);
+        std::fill(b.begin(), b.end(), 0);
+    }
+
+    // lost ranks are rebuilt from the others
+    int32_t iter = 0;
+    EXPECT_TRUE(erasure.decode(SDMT::comm(), regions, size, parity, iter));
+    EXPECT_EQ(iter, 3);
+    for (int i = 0; i < n; i++) {
+        EXPECT_EQ(a[i], (long)i * (rank + 1));
+    }
+    for (int i = 0; i < 1234; i++) {
+        EXPECT_EQ(b[i], (char)(i + rank));
+    }
+
+    // rebuilt ranks hold no parity, losing more than parity fails
+    if (rank == parity) {
+        erasure.clear();
+    }
+    EXPECT_FALSE(erasure.decode(SDMT::comm(), regions, size, parity, iter));
+
+    // a replaced process encodes with the others before it decodes
+    if (rank == 0) {
+        erasure.clear();
+    }
+    EXPECT_TRUE(erasure.encode(SDMT::comm(), regions, size, parity, 4));
+    EXPECT_TRUE(erasure.decode(SDMT::comm(), regions, size, parity, iter));
+    EXPECT_EQ(iter, 4);
+
+    // finalize sdmt module
+    SDMT::finalize();
+}
@@ -0,0 +1,164 @@
+/**
+Copyright 2021 PIDL(Petabyte-scale In-memory Database Lab) http://kdb.snu.ac.kr
+This work was supported by Next-Generation Information Computing Development
+Program through the National Research Foundation of Korea(NRF)
+funded by the Ministry of Science, ICT (NRF-2016M3C4A7952587)
+Author: Ilju Lee, Jongin Kim, Hyerim Jeon, Youngjune Park
+Contact: sdmt@kdb.snu.ac.kr
+ */
+#include "sdmt.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+static const int kRows = 30;
+static const int kCols = 20;
+
+TEST(ExternalTest, 1st) {
+    // initialize sdmt module
+    SDMT::init("./config_cpp_test.xml", false);
+    int rank;
+    MPI_Comm_rank(SDMT::comm(), &rank);
+
+    // memory of the application outlives the Snapshot
+    static std::vector<double> vec(1000);
+    static std::vector<double> other(1000);
+    static std::vector<int> mat(kRows * kCols);
+    EXPECT_EQ(SDMT::register_external("sdmttest_external_vec", vec.data(),
+                SDMT_DOUBLE, SDMT_ARRAY, {1000}), SDMT_SUCCESS);
+    EXPECT_EQ(SDMT::doubleptr("sdmttest_external_vec"), vec.data());
+
+    // a column major matrix, as of Fortran
+    std::vector<int> strides = {sizeof(int), kRows * sizeof(int)};
+    EXPECT_EQ(SDMT::register_external("sdmttest_external_mat", mat.data(),
+                SDMT_INT, SDMT_MATRIX, {kRows, kCols}, strides), SDMT_SUCCESS);
+    EXPECT_EQ(SDMT::intptr("sdmttest_external_mat"), mat.data());
+    EXPECT_EQ(SDMT::get_snapshot("sdmttest_external_mat").m_strides, strides);
+
+    // SDMT neither allocates nor swaps memory of the application
+    SDMT::Options double_buffer;
+    double_buffer.m_double_buffer = true;
+    EXPECT_EQ(SDMT::register_external("sdmttest_external_wrong", vec.data(),
+                SDMT_DOUBLE, SDMT_ARRAY, {1000}, {}, double_buffer),
+            SDMT_ERR_WRONG_OPTION);
+    SDMT::Options aligned;
+    aligned.m_alignment = 4096;
+    EXPECT_EQ(SDMT::register_external("sdmttest_external_wrong", vec.data(),
+                SDMT_DOUBLE, SDMT_ARRAY, {1000}, {}, aligned),
+            SDMT_ERR_WRONG_OPTION);
+    SDMT::Options prefault;
+    prefault.m_prefault = true;
+    EXPECT_EQ(SDMT::register_external("sdmttest_external_wrong", vec.data(),
+                SDMT_DOUBLE, SDMT_ARRAY, {1000}, {}, prefault),
+            SDMT_ERR_WRONG_OPTION);
+    EXPECT_EQ(SDMT::register_external("sdmttest_external_wrong", nullptr,
+                SDMT_DOUBLE, SDMT_ARRAY, {1000}), SDMT_ERR_WRONG_OPTION);
+    EXPECT_EQ(SDMT::register_external("sdmttest_external_wrong", mat.data(),
+                SDMT_INT, SDMT_MATRIX, {kRows, kCols},
+                {sizeof(int), 100 * sizeof(int)}), SDMT_ERR_WRONG_DIMENSION);
+    EXPECT_EQ(SDMT::register_external("sdmttest_external_vec", other.data(),
+                SDMT_DOUBLE, SDMT_ARRAY, {1000}), SDMT_ERR_DUPLICATED_NAME);
+    EXPECT_FALSE(SDMT::exist("sdmttest_external_wrong"));
+
+    // write rank dependent values to memory of the application
+    for (int i = 0; i < 1000; i++) {
+        vec[i] = i * 0.5 + rank;
+    }
+    for (int j = 0; j < kCols; j++) {
+        for (int i = 0; i < kRows; i++) {
+            mat[j * kRows + i] = i * 100 + j - rank;
+        }
+    }
+
+    // start sdmt module
+    SDMT::start();
+
+    // generate checkpoint
+    EXPECT_EQ(SDMT::checkpoint(1), SDMT_SUCCESS);
+
+    // overwrite dummy values, recovered in place
+    for (int i = 0; i < 1000; i++) {
+        vec[i] = 0;
+    }
+    for (int i = 0; i < kRows * kCols; i++) {
+        mat[i] = 0;
+    }
+    EXPECT_EQ(SDMT::recover(), SDMT_SUCCESS);
+    for (int i = 0; i < 1000; i++) {
+        ASSERT_EQ(vec[i], i * 0.5 + rank);
+    }
+    for (int j = 0; j < kCols; j++) {
+        for (int i = 0; i < kRows; i++) {
+            ASSERT_EQ(mat[j * kRows + i], i * 100 + j - rank);
+        }
+    }
+
+    // memory of the application is protected instead, as it is
+    EXPECT_EQ(SDMT::rebind("sdmttest_external_vec", other.data()),
+            SDMT_SUCCESS);
+    EXPECT_EQ(SDMT::doubleptr("sdmttest_external_vec"), other.data());
+    EXPECT_EQ(SDMT::rebind("sdmttest_external_none", other.data()),
+            SDMT_ERR_WRONG_OPTION);
+    EXPECT_EQ(SDMT::rebind("sdmttest_external_vec", other.data(), {10, 100}),
+            SDMT_ERR_WRONG_DIMENSION);
+
+    // the application resizes its memory, SDMT does not
+    EXPECT_EQ(SDMT::change_snapshot("sdmttest_external_mat", SDMT_INT,
+                SDMT_MATRIX, {kCols, kRows}), SDMT_ERR_WRONG_OPTION);
+    EXPECT_EQ(SDMT::intptr("sdmttest_external_mat"), mat.data());
+    EXPECT_EQ(SDMT::get_snapshot("sdmttest_external_mat").m_strides, strides);
+    for (int i = 0; i < 1000; i++) {
+        other[i] = i * 2 + rank;
+    }
+    EXPECT_EQ(SDMT::checkpoint(1), SDMT_SUCCESS);
+
+    // end process w/o finalize, restarted by the 2nd test
+}
+
+TEST(ExternalTest, 2nd) {
+    // initialize sdmt module
+    SDMT::init("./config_cpp_test.xml", true);
+    int rank;
+    MPI_Comm_rank(SDMT::comm(), &rank);
+
+    // recovered into memory of SDMT
+    EXPECT_EQ(SDMT::wait_recovery(), SDMT_SUCCESS);
+    double* dptr = SDMT::doubleptr("sdmttest_external_vec");
+    ASSERT_NE(dptr, nullptr);
+    for (int i = 0; i < 1000; i++) {
+        ASSERT_EQ(dptr[i], i * 2 + rank);
+    }
+    EXPECT_EQ(SDMT::get_snapshot("sdmttest_external_mat").m_strides,
+            std::vector<int>({sizeof(int), kRows * sizeof(int)}));
+
+    // and copied to memory of the application when rebound
+    static std::vector<double> vec(1000);
+    static std::vector<int> mat(kRows * kCols);
+    EXPECT_EQ(SDMT::rebind("sdmttest_external_vec", vec.data()),
+            SDMT_SUCCESS);
+    EXPECT_EQ(SDMT::rebind("sdmttest_external_mat", mat.data()),
+            SDMT_SUCCESS);
+    EXPECT_EQ(SDMT::doubleptr("sdmttest_external_vec"), vec.data());
+    EXPECT_EQ(SDMT::intptr("sdmttest_external_mat"), mat.data());
+    for (int i = 0; i < 1000; i++) {
+        ASSERT_EQ(vec[i], i * 2 + rank);
+    }
+    for (int j = 0; j < kCols; j++) {
+        for (int i = 0; i < kRows; i++) {
+            ASSERT_EQ(mat[j * kRows + i], i * 100 + j - rank);
+        }
+    }
+
+    // a new shape is not copied
+    static std::vector<int> larger(2 * kRows * kCols);
+    EXPECT_EQ(SDMT::rebind("sdmttest_external_mat", larger.data(),
+                {2 * kRows, kCols},
+                {sizeof(int), 2 * kRows * sizeof(int)}), SDMT_SUCCESS);
+    EXPECT_EQ(SDMT::get_snapshot("sdmttest_external_mat").m_dimension,
+            std::vector<int>({2 * kRows, kCols}));
+    EXPECT_EQ(SDMT::intptr("sdmttest_external_mat"), larger.data());
+
+    // finalize sdmt module
+    SDMT::finalize();
+}
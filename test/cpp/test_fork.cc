@@ -0,0 +1,73 @@
+/**
+Copyright 2021 PIDL(Petabyte-scale In-memory Database Lab) http://kdb.snu.ac.kr
+This work was supported by Next-Generation Information Computing Development
+Program through the National Research Foundation of Korea(NRF)
+funded by the Ministry of Science, ICT (NRF-2016M3C4A7952587)
+Author: Ilju Lee, Jongin Kim, Hyerim Jeon, Youngjune Park
+Contact: sdmt@kdb.snu.ac.kr
+ */
+#include "sdmt.h"
+
+#include <gtest/gtest.h>
+
+TEST(ForkTest, Cow) {
+    // initialize sdmt module writing asynchronous checkpoints by fork
+    SDMT::init("./config_cpp_fork.xml", false);
+
+    // request sdmt snapshots
+    // define 1 dimensional integer array and page tracked double array
+    int rank;
+    MPI_Comm_rank(SDMT::comm(), &rank);
+    const int n = 500000;
+    SDMT::register_snapshot("sdmttest_fork1d", SDMT_INT, SDMT_ARRAY, {n});
+    SDMT::Options opts;
+    opts.m_incremental = SDMT_IM_PAGE;
+    SDMT::register_snapshot("sdmttest_fork_page", SDMT_DOUBLE, SDMT_ARRAY, {n}, opts);
+
+    // get data snapshots
+    int* iptr = SDMT::intptr("sdmttest_fork1d");
+    double* dptr = SDMT::doubleptr("sdmttest_fork_page");
+
+    // write rank dependent values to snapshot memory
+    for (int i = 0; i < n; i++) {
+        iptr[i] = i * 3 + rank;
+        dptr[i] = i * 0.25 + rank;
+    }
+
+    // start sdmt module
+    SDMT::start();
+
+    // writes right after checkpoint do not reach the checkpoint
+    SDMT::iter() = 5;
+    EXPECT_EQ(SDMT::checkpoint(1, true), SDMT_SUCCESS);
+    for (int i = 0; i < n; i++) {
+        iptr[i] = -1;
+        dptr[i] = -1;
+    }
+    EXPECT_EQ(SDMT::wait_checkpoint(), SDMT_SUCCESS);
+
+    // an incremental checkpoint on top of the forked one
+    for (int i = 0; i < n; i += 1000) {
+        dptr[i] = i * 0.25 + rank;
+    }
+    for (int i = 0; i < n; i++) {
+        iptr[i] = i * 3 + rank;
+    }
+    SDMT::iter() = 6;
+    EXPECT_EQ(SDMT::checkpoint(1, true), SDMT_SUCCESS);
+    EXPECT_EQ(SDMT::wait_checkpoint(), SDMT_SUCCESS);
+    SDMT::iter() = 0;
+
+    // recover from the last checkpoint
+    EXPECT_EQ(SDMT::recover(), SDMT_SUCCESS);
+    EXPECT_EQ(SDMT::iter(), 6);
+
+    // check recovered values
+    for (int i = 0; i < n; i++) {
+        EXPECT_EQ(iptr[i], i * 3 + rank);
+        EXPECT_EQ(dptr[i], i % 1000 == 0 ? i * 0.25 + rank : -1);
+    }
+
+    // finalize sdmt module
+    SDMT::finalize();
+}
@@ -0,0 +1,102 @@
+/**
+Copyright 2021 PIDL(Petabyte-scale In-memory Database Lab) http://kdb.snu.ac.kr
+This work was supported by Next-Generation Information Computing Development
+Program through the National Research Foundation of Korea(NRF)
+funded by the Ministry of Science, ICT (NRF-2016M3C4A7952587)
+Author: Ilju Lee, Jongin Kim, Hyerim Jeon, Youngjune Park
+Contact: sdmt@kdb.snu.ac.kr
+ */
+#include "sdmt.h"
+
+#include <gtest/gtest.h>
+
+TEST(HandleTest, 1st) {
+    // initialize sdmt module
+    SDMT::init("./config_cpp_test.xml", false);
+
+    // get a handle at registration, or look it up once
+    SDMT::SnapshotHandle dh = -1;
+    SDMT::Options opts;
+    opts.m_double_buffer = true;
+    EXPECT_EQ(SDMT::register_snapshot("sdmttest_handle_double", SDMT_DOUBLE,
+                SDMT_ARRAY, {1000}, dh, opts), SDMT_SUCCESS);
+    SDMT::register_snapshot("sdmttest_handle_int", SDMT_INT, SDMT_ARRAY,
+            {512});
+    SDMT::SnapshotHandle ih = SDMT::lookup("sdmttest_handle_int");
+    EXPECT_GE(dh, 0);
+    EXPECT_GE(ih, 0);
+    EXPECT_NE(dh, ih);
+    EXPECT_EQ(SDMT::lookup("sdmttest_handle_double"), dh);
+    EXPECT_EQ(SDMT::lookup("sdmttest_handle_none"), -1);
+
+    // a duplicated name gives no handle
+    SDMT::SnapshotHandle none = 0;
+    EXPECT_EQ(SDMT::register_snapshot("sdmttest_handle_int", SDMT_INT,
+                SDMT_ARRAY, {512}, none), SDMT_ERR_DUPLICATED_NAME);
+    EXPECT_EQ(none, -1);
+
+    // typed access, null for a wrong handle or value type
+    EXPECT_EQ(SDMT::doubleptr(dh), SDMT::doubleptr("sdmttest_handle_double"));
+    EXPECT_EQ(SDMT::intptr(ih), SDMT::intptr("sdmttest_handle_int"));
+    EXPECT_EQ(SDMT::intptr(dh), nullptr);
+    EXPECT_EQ(SDMT::floatptr(ih), nullptr);
+    EXPECT_EQ(SDMT::doubleptr(-1), nullptr);
+    EXPECT_EQ(SDMT::doubleptr(dh + ih + 1), nullptr);
+    EXPECT_EQ(SDMT::get_snapshot(dh).m_dimension, std::vector<int>({1000}));
+    EXPECT_EQ(SDMT::get_snapshot(-1).m_ptr, nullptr);
+
+    // the handle follows a changed Snapshot
+    EXPECT_EQ(SDMT::change_snapshot("sdmttest_handle_int", SDMT_INT,
+                SDMT_ARRAY, {1024}), SDMT_SUCCESS);
+    EXPECT_EQ(SDMT::lookup("sdmttest_handle_int"), ih);
+    EXPECT_EQ(SDMT::intptr(ih), SDMT::intptr("sdmttest_handle_int"));
+    EXPECT_EQ(SDMT::get_snapshot(ih).m_dimension, std::vector<int>({1024}));
+
+    // and the active buffer of a double buffered one
+    SDMT::start();
+    double* front = SDMT::doubleptr(dh);
+    EXPECT_EQ(SDMT::flip("sdmttest_handle_double"), SDMT_SUCCESS);
+    EXPECT_NE(SDMT::doubleptr(dh), front);
+    EXPECT_EQ(SDMT::doubleptr(dh), SDMT::doubleptr("sdmttest_handle_double"));
+
+    // write values through handles in the loop
+    for (int i = 0; i < 1000; i++) {
+        SDMT::doubleptr(dh)[i] = i * 0.5;
+    }
+    for (int i = 0; i < 1024; i++) {
+        SDMT::intptr(ih)[i] = i * 3;
+    }
+
+    // generate checkpoint
+    SDMT::checkpoint(1);
+
+    // end process w/o finalize, restarted by the 2nd test
+}
+
+TEST(HandleTest, 2nd) {
+    // initialize sdmt module
+    SDMT::init("./config_cpp_test.xml", true);
+
+    // handles are the same after restart
+    SDMT::SnapshotHandle dh = SDMT::lookup("sdmttest_handle_double");
+    SDMT::SnapshotHandle ih = SDMT::lookup("sdmttest_handle_int");
+    EXPECT_GE(dh, 0);
+    EXPECT_GE(ih, 0);
+    EXPECT_EQ(SDMT::doubleptr(dh), SDMT::doubleptr("sdmttest_handle_double"));
+    EXPECT_EQ(SDMT::intptr(ih), SDMT::intptr("sdmttest_handle_int"));
+
+    // check recovered values
+    double* dptr = SDMT::doubleptr(dh);
+    int* iptr = SDMT::intptr(ih);
+    ASSERT_NE(dptr, nullptr);
+    ASSERT_NE(iptr, nullptr);
+    for (int i = 0; i < 1000; i++) {
+        EXPECT_EQ(dptr[i], i * 0.5);
+    }
+    for (int i = 0; i < 1024; i++) {
+        EXPECT_EQ(iptr[i], i * 3);
+    }
+
+    // finalize sdmt module
+    SDMT::finalize();
+}
@@ -0,0 +1,149 @@
+/**
+Copyright 2021 PIDL(Petabyte-scale In-memory Database Lab) http://kdb.snu.ac.kr
+This work was supported by Next-Generation Information Computing Development
+Program through the National Research Foundation of Korea(NRF)
+funded by the Ministry of Science, ICT (NRF-2016M3C4A7952587)
+Author: Ilju Lee, Jongin Kim, Hyerim Jeon, Youngjune Park
+Contact: sdmt@kdb.snu.ac.kr
+ */
+#include "sdmt.h"
+
+#include <gtest/gtest.h>
+
+TEST(IncrementalTest, Page) {
+    // initialize sdmt module
+    SDMT::init("./config_cpp_test.xml", false);
+
+    // request a sdmt snapshot tracked by dirty pages
+    // define 1 dimensional integer array
+    // the size of array is 64K(64 pages of 4KB)
+    const int n = 64 * 1024;
+    SDMT::Options opts;
+    opts.m_incremental = SDMT_IM_PAGE;
+    SDMT::register_snapshot("sdmttest_inc1d", SDMT_INT, SDMT_ARRAY, {n}, opts);
+
+    // get data snapshot
+    int* ptr = SDMT::intptr("sdmttest_inc1d");
+
+    // write values to snapshot memory
+    for (int i = 0; i < n; i++) {
+        ptr[i] = i;
+    }
+
+    // start sdmt module
+    SDMT::start();
+
+    // first checkpoint is full
+    EXPECT_EQ(SDMT::checkpoint(1, true), SDMT_SUCCESS);
+    EXPECT_EQ(SDMT::wait_checkpoint(), SDMT_SUCCESS);
+
+    // update a small part of snapshot memory
+    for (int i = 0; i < n; i += 8192) {
+        ptr[i] = -i;
+    }
+
+    // second checkpoint holds changed pages only
+    EXPECT_EQ(SDMT::checkpoint(1, true), SDMT_SUCCESS);
+    EXPECT_EQ(SDMT::wait_checkpoint(), SDMT_SUCCESS);
+
+    int rank;
+    MPI_Comm_rank(SDMT::comm(), &rank);
+    std::string dir = "./checkpoint/Native";
+    CkptFile::Header header;
+    std::vector<CkptFile::Record> records;
+    ASSERT_TRUE(CkptFile::read_index(
+                CkptFile::path(dir, CkptFile::latest(dir, rank), rank),
+                header, records));
+    ASSERT_EQ(records.size(), 1u);
+    EXPECT_EQ(records[0].m_encoding, CkptFile::ENC_DELTA);
+    EXPECT_LT(records[0].m_size, records[0].m_rawsize / 4);
+
+    // overwrite dummy values to snapshot memory
+    for (int i = 0; i < n; i++) {
+        ptr[i] = 0;
+    }
+
+    // recover checkpoint, base image and delta
+    EXPECT_EQ(SDMT::recover(), SDMT_SUCCESS);
+
+    // check recovered values
+    for (int i = 0; i < n; i++) {
+        EXPECT_EQ(ptr[i], (i % 8192 == 0) ? -i : i);
+    }
+
+    // finalize sdmt module
+    SDMT::finalize();
+}
+
+TEST(IncrementalTest, Hash) {
+    // initialize sdmt module
+    SDMT::init("./config_cpp_test.xml", false);
+
+    // request sdmt snapshots of every value type
+    // tracked by hashes of blocks
+    const int n = 64 * 1024;
+    SDMT::Options opts;
+    opts.m_incremental = SDMT_IM_HASH;
+    SDMT::register_snapshot("sdmttest_hash_int", SDMT_INT, SDMT_ARRAY, {n}, opts);
+    SDMT::register_snapshot("sdmttest_hash_long", SDMT_LONG, SDMT_ARRAY, {n}, opts);
+    SDMT::register_snapshot("sdmttest_hash_float", SDMT_FLOAT, SDMT_ARRAY, {n}, opts);
+    SDMT::register_snapshot("sdmttest_hash_double", SDMT_DOUBLE, SDMT_ARRAY, {n}, opts);
+
+    // get data snapshots
+    int* iptr = SDMT::intptr("sdmttest_hash_int");
+    long* lptr = SDMT::longptr("sdmttest_hash_long");
+    float* fptr = SDMT::floatptr("sdmttest_hash_float");
+    double* dptr = SDMT::doubleptr("sdmttest_hash_double");
+
+    // write values to snapshot memory
+    for (int i = 0; i < n; i++) {
+        iptr[i] = i;
+        lptr[i] = i;
+        fptr[i] = i;
+        dptr[i] = i;
+    }
+
+    // start sdmt module
+    SDMT::start();
+
+    // first checkpoint is full
+    EXPECT_EQ(SDMT::checkpoint(1, true), SDMT_SUCCESS);
+    EXPECT_EQ(SDMT::wait_checkpoint(), SDMT_SUCCESS);
+    EXPECT_EQ(SDMT::checkpoint_stats().ratio(), 1.0);
+
+    // update a small part of snapshot memory
+    for (int i = 0; i < n; i += 8192) {
+        iptr[i] = -i;
+        lptr[i] = -i;
+        fptr[i] = -i;
+        dptr[i] = -i;
+    }
+
+    // second checkpoint holds changed blocks only
+    EXPECT_EQ(SDMT::checkpoint(1, true), SDMT_SUCCESS);
+    EXPECT_EQ(SDMT::wait_checkpoint(), SDMT_SUCCESS);
+    EXPECT_LT(SDMT::checkpoint_stats().ratio(), 0.25);
+
+    // overwrite dummy values to snapshot memory
+    for (int i = 0; i < n; i++) {
+        iptr[i] = 0;
+        lptr[i] = 0;
+        fptr[i] = 0;
+        dptr[i] = 0;
+    }
+
+    // recover checkpoint, base image and delta
+    EXPECT_EQ(SDMT::recover(), SDMT_SUCCESS);
+
+    // check recovered values
+    for (int i = 0; i < n; i++) {
+        int v = (i % 8192 == 0) ? -i : i;
+        EXPECT_EQ(iptr[i], v);
+        EXPECT_EQ(lptr[i], v);
+        EXPECT_EQ(fptr[i], v);
+        EXPECT_EQ(dptr[i], v);
+    }
+
+    // finalize sdmt module
+    SDMT::finalize();
+}
@@ -0,0 +1,101 @@
+/**
+Copyright 2021 PIDL(Petabyte-scale In-memory Database Lab) http://kdb.snu.ac.kr
+This work was supported by Next-Generation Information Computing Development
+Program through the National Research Foundation of Korea(NRF)
+funded by the Ministry of Science, ICT (NRF-2016M3C4A7952587)
+Author: Ilju Lee, Jongin Kim, Hyerim Jeon, Youngjune Park
+Contact: sdmt@kdb.snu.ac.kr
+ */
+#include "sdmt.h"
+
+#include <gtest/gtest.h>
+
+TEST(LazyTest, 1st) {
+    // initialize sdmt module with native backend
+    SDMT::init("./config_cpp_lazy.xml", false);
+
+    // request sdmt snapshots
+    // define raw arrays to fault in and a compressed one restored at once
+    int rank;
+    MPI_Comm_rank(SDMT::comm(), &rank);
+    const int n = 500000;
+    SDMT::Options lz;
+    lz.m_codec = SDMT_CC_LZ;
+    SDMT::register_snapshot("sdmttest_lazy_int", SDMT_INT, SDMT_ARRAY, {n});
+    SDMT::register_snapshot("sdmttest_lazy_double", SDMT_DOUBLE, SDMT_ARRAY,
+            {1000});
+    SDMT::register_snapshot("sdmttest_lazy_lz", SDMT_INT, SDMT_ARRAY, {n}, lz);
+
+    // explicit huge pages are not filled by page faults
+    SDMT::Options huge;
+    huge.m_huge_pages = SDMT_HP_EXPLICIT;
+    SDMT::register_snapshot("sdmttest_lazy_huge", SDMT_INT, SDMT_ARRAY,
+            {1 << 19}, huge);
+
+    int* iptr = SDMT::intptr("sdmttest_lazy_int");
+    double* dptr = SDMT::doubleptr("sdmttest_lazy_double");
+    int* lptr = SDMT::intptr("sdmttest_lazy_lz");
+    int* hptr = SDMT::intptr("sdmttest_lazy_huge");
+    for (int i = 0; i < n; i++) {
+        iptr[i] = i * 5 + rank;
+        lptr[i] = i % 100 + rank;
+    }
+    for (int i = 0; i < (1 << 19); i++) {
+        hptr[i] = i - rank;
+    }
+    for (int i = 0; i < 1000; i++) {
+        dptr[i] = i * 0.5 + rank;
+    }
+
+    // start sdmt module
+    SDMT::start();
+    SDMT::iter() = 6;
+    EXPECT_EQ(SDMT::checkpoint(1), SDMT_SUCCESS);
+
+    // finalize sdmt module
+    SDMT::finalize();
+}
+
+TEST(LazyTest, 2nd) {
+    // restart, raw snapshots are faulted in on first access
+    SDMT::init("./config_cpp_lazy.xml", true);
+    EXPECT_EQ(SDMT::iter(), 6);
+
+    int rank;
+    MPI_Comm_rank(SDMT::comm(), &rank);
+    const int n = 500000;
+    SDMT::RecoveryStats stats = SDMT::recovery_stats();
+    EXPECT_GE(stats.m_id, 0);
+    EXPECT_LE(stats.m_lazy, 2);
+
+    // access pages out of order while the rest is prefetched
+    int* iptr = SDMT::intptr("sdmttest_lazy_int");
+    for (int i = n - 1; i >= 0; i -= 4099) {
+        EXPECT_EQ(iptr[i], i * 5 + rank);
+    }
+    double* dptr = SDMT::doubleptr("sdmttest_lazy_double");
+    for (int i = 0; i < 1000; i++) {
+        EXPECT_EQ(dptr[i], i * 0.5 + rank);
+    }
+    int* lptr = SDMT::intptr("sdmttest_lazy_lz");
+    for (int i = 0; i < n; i++) {
+        EXPECT_EQ(lptr[i], i % 100 + rank);
+    }
+    int* hptr = SDMT::intptr("sdmttest_lazy_huge");
+    for (int i = 0; i < (1 << 19); i++) {
+        ASSERT_EQ(hptr[i], i - rank);
+    }
+
+    // every page is loaded in the end
+    EXPECT_EQ(SDMT::wait_recovery(), SDMT_SUCCESS);
+    for (int i = 0; i < n; i++) {
+        EXPECT_EQ(iptr[i], i * 5 + rank);
+    }
+
+    // checkpoint after lazy restart
+    iptr[0] = -1;
+    EXPECT_EQ(SDMT::checkpoint(1), SDMT_SUCCESS);
+
+    // finalize sdmt module
+    SDMT::finalize();
+}
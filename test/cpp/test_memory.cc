@@ -0,0 +1,62 @@
+/**
+Copyright 2021 PIDL(Petabyte-scale In-memory Database Lab) http://kdb.snu.ac.kr
+This work was supported by Next-Generation Information Computing Development
+Program through the National Research Foundation of Korea(NRF)
+funded by the Ministry of Science, ICT (NRF-2016M3C4A7952587)
+Author: Ilju Lee, Jongin Kim, Hyerim Jeon, Youngjune Park
+Contact: sdmt@kdb.snu.ac.kr
+ */
+#include "sdmt.h"
+
+#include <gtest/gtest.h>
+
+TEST(MemoryTest, Rollback) {
+    // initialize sdmt module
+    SDMT::init("./config_cpp_test.xml", false);
+
+    // request sdmt snapshots
+    // define 1 dimensional integer array and 2 dimensional double matrix
+    const int n = 1024;
+    SDMT::register_snapshot("sdmttest_mem1d", SDMT_INT, SDMT_ARRAY, {n * n});
+    SDMT::register_snapshot("sdmttest_mem2d", SDMT_DOUBLE, SDMT_MATRIX, {n, n});
+
+    // get data snapshots
+    int* iptr = SDMT::intptr("sdmttest_mem1d");
+    double* dptr = SDMT::doubleptr("sdmttest_mem2d");
+
+    // start sdmt module
+    SDMT::start();
+
+    // keep in-memory checkpoints of 3 iterations,
+    // the ring holds the last 2 of them
+    for (int it = 0; it < 3; it++) {
+        for (int i = 0; i < n * n; i++) {
+            iptr[i] = i + it;
+            dptr[i] = i * 0.5 + it;
+        }
+        SDMT::iter() = it;
+        EXPECT_EQ(SDMT::checkpoint_memory(), SDMT_SUCCESS);
+    }
+
+    // the oldest one is overwritten
+    EXPECT_EQ(SDMT::rollback(2), SDMT_ERR_FAILED_RECOVERY);
+
+    // rollback to the previous state
+    EXPECT_EQ(SDMT::rollback(1), SDMT_SUCCESS);
+    EXPECT_EQ(SDMT::iter(), 1);
+    for (int i = 0; i < n * n; i++) {
+        EXPECT_EQ(iptr[i], i + 1);
+        EXPECT_EQ(dptr[i], i * 0.5 + 1);
+    }
+
+    // rollback to the newest state
+    EXPECT_EQ(SDMT::rollback(), SDMT_SUCCESS);
+    EXPECT_EQ(SDMT::iter(), 2);
+    for (int i = 0; i < n * n; i++) {
+        EXPECT_EQ(iptr[i], i + 2);
+        EXPECT_EQ(dptr[i], i * 0.5 + 2);
+    }
+
+    // finalize sdmt module
+    SDMT::finalize();
+}
@@ -0,0 +1,117 @@
+/**
+Copyright 2021 PIDL(Petabyte-scale In-memory Database Lab) http://kdb.snu.ac.kr
+This work was supported by Next-Generation Information Computing Development
+Program through the National Research Foundation of Korea(NRF)
+funded by the Ministry of Science, ICT (NRF-2016M3C4A7952587)
+Author: Ilju Lee, Jongin Kim, Hyerim Jeon, Youngjune Park
+Contact: sdmt@kdb.snu.ac.kr
+ */
+#include "sdmt.h"
+#include "numa_placement.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <unistd.h>
+
+static bool page_aligned(void* ptr) {
+    return reinterpret_cast<uintptr_t>(ptr) % ::sysconf(_SC_PAGESIZE) == 0;
+}
+
+TEST(NumaTest, Placement) {
+    // initialize sdmt module
+    SDMT::init("./config_cpp_test.xml", false);
+    int rank;
+    MPI_Comm_rank(SDMT::comm(), &rank);
+    ASSERT_GE(NumaPlacement::nodes(), 1);
+
+    const int n = 1 << 18;
+    SDMT::Options bind;
+    bind.m_placement = SDMT_NP_BIND;
+    bind.m_numa_node = 0;
+    EXPECT_EQ(SDMT::register_snapshot("sdmttest_numa_bind", SDMT_DOUBLE,
+                SDMT_ARRAY, {n}, bind), SDMT_SUCCESS);
+    EXPECT_TRUE(page_aligned(SDMT::doubleptr("sdmttest_numa_bind")));
+
+    SDMT::Options interleave;
+    interleave.m_placement = SDMT_NP_INTERLEAVE;
+    EXPECT_EQ(SDMT::register_snapshot("sdmttest_numa_interleave", SDMT_LONG,
+                SDMT_MATRIX, {512, 512}, interleave), SDMT_SUCCESS);
+    EXPECT_TRUE(page_aligned(SDMT::longptr("sdmttest_numa_interleave")));
+
+    // memory not starting at a page is refused rather than widened
+    // onto the page it shares with others
+    char* inner = reinterpret_cast<char*>(SDMT::doubleptr("sdmttest_numa_bind"))
+        + sizeof(double);
+    EXPECT_FALSE(NumaPlacement::bind(inner, 64, 0));
+    EXPECT_FALSE(NumaPlacement::interleave(inner, 64));
+
+    // pages are touched by the threads that compute on them
+    SDMT::Options first_touch;
+    first_touch.m_placement = SDMT_NP_FIRST_TOUCH;
+    first_touch.m_double_buffer = true;
+    EXPECT_EQ(SDMT::register_snapshot("sdmttest_numa_touch", SDMT_INT,
+                SDMT_ARRAY, {n}, first_touch), SDMT_SUCCESS);
+    SDMT::Snapshot touch = SDMT::get_snapshot("sdmttest_numa_touch");
+    EXPECT_TRUE(page_aligned(touch.m_ptr));
+    EXPECT_TRUE(page_aligned(touch.m_back));
+
+    SDMT::Options wrong_node;
+    wrong_node.m_placement = SDMT_NP_BIND;
+    wrong_node.m_numa_node = NumaPlacement::nodes();
+    EXPECT_EQ(SDMT::register_snapshot("sdmttest_numa_wrong", SDMT_INT,
+                SDMT_ARRAY, {n}, wrong_node), SDMT_ERR_WRONG_OPTION);
+    SDMT::Options wrong;
+    wrong.m_placement = static_cast<SDMT_NP>(7);
+    EXPECT_EQ(SDMT::register_snapshot("sdmttest_numa_wrong", SDMT_INT,
+                SDMT_ARRAY, {n}, wrong), SDMT_ERR_WRONG_OPTION);
+
+    // placement is kept by change
+    EXPECT_EQ(SDMT::change_snapshot("sdmttest_numa_bind", SDMT_DOUBLE,
+                SDMT_ARRAY, {n * 2}), SDMT_SUCCESS);
+    EXPECT_TRUE(page_aligned(SDMT::doubleptr("sdmttest_numa_bind")));
+
+    // write rank dependent values to snapshot memory
+    double* dptr = SDMT::doubleptr("sdmttest_numa_bind");
+    long* lptr = SDMT::longptr("sdmttest_numa_interleave");
+    int* iptr = SDMT::intptr("sdmttest_numa_touch");
+    for (int i = 0; i < n * 2; i++) {
+        dptr[i] = i * 0.5 + rank;
+    }
+    for (int i = 0; i < 512 * 512; i++) {
+        lptr[i] = i - rank;
+    }
+    for (int i = 0; i < n; i++) {
+        iptr[i] = i + rank;
+    }
+
+    // start sdmt module
+    SDMT::start();
+
+    // generate checkpoint
+    EXPECT_EQ(SDMT::checkpoint(1), SDMT_SUCCESS);
+
+    // overwrite dummy values and recover
+    for (int i = 0; i < n * 2; i++) {
+        dptr[i] = 0;
+    }
+    for (int i = 0; i < 512 * 512; i++) {
+        lptr[i] = 0;
+    }
+    for (int i = 0; i < n; i++) {
+        iptr[i] = 0;
+    }
+    EXPECT_EQ(SDMT::recover(), SDMT_SUCCESS);
+    for (int i = 0; i < n * 2; i++) {
+        ASSERT_EQ(dptr[i], i * 0.5 + rank);
+    }
+    for (int i = 0; i < 512 * 512; i++) {
+        ASSERT_EQ(lptr[i], i - rank);
+    }
+    for (int i = 0; i < n; i++) {
+        ASSERT_EQ(iptr[i], i + rank);
+    }
+
+    // finalize sdmt module
+    SDMT::finalize();
+}
@@ -0,0 +1,120 @@
+/**
+Copyright 2021 PIDL(Petabyte-scale In-memory Database Lab) http://kdb.snu.ac.kr
+This work was supported by Next-Generation Information Computing Development
+Program through the National Research Foundation of Korea(NRF)
+funded by the Ministry of Science, ICT (NRF-2016M3C4A7952587)
+Author: Ilju Lee, Jongin Kim, Hyerim Jeon, Youngjune Park
+Contact: sdmt@kdb.snu.ac.kr
+ */
+#include "sdmt.h"
+#include "ckpt_partner.h"
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <vector>
+
+TEST(PartnerTest, Exchange) {
+    // initialize sdmt module
+    SDMT::init("./config_cpp_test.xml", false);
+
+    // request sdmt snapshots
+    // define 1 dimensional integer array and 2 dimensional double matrix
+    const int n = 512;
+    SDMT::register_snapshot("sdmttest_partner1d", SDMT_INT, SDMT_ARRAY, {n * n});
+    SDMT::register_snapshot("sdmttest_partner2d", SDMT_DOUBLE, SDMT_MATRIX, {n, n});
+
+    // get data snapshots
+    int* iptr = SDMT::intptr("sdmttest_partner1d");
+    double* dptr = SDMT::doubleptr("sdmttest_partner2d");
+
+    // write rank dependent values to snapshot memory
+    int rank;
+    MPI_Comm_rank(SDMT::comm(), &rank);
+    for (int i = 0; i < n * n; i++) {
+        iptr[i] = i + rank;
+        dptr[i] = i * 0.5 + rank;
+    }
+
+    // start sdmt module
+    SDMT::start();
+
+    // nothing to recover before the first checkpoint
+    EXPECT_EQ(SDMT::recover_partner(), SDMT_ERR_FAILED_RECOVERY);
+
+    // send snapshots to the partner rank
+    SDMT::iter() = 7;
+    EXPECT_EQ(SDMT::checkpoint_partner(), SDMT_SUCCESS);
+
+    // overwrite dummy values to snapshot memory
+    for (int i = 0; i < n * n; i++) {
+        iptr[i] = -1;
+        dptr[i] = -1;
+    }
+    SDMT::iter() = 0;
+
+    // get snapshots back from the partner rank
+    EXPECT_EQ(SDMT::recover_partner(), SDMT_SUCCESS);
+    EXPECT_EQ(SDMT::iter(), 7);
+
+    // check recovered values
+    for (int i = 0; i < n * n; i++) {
+        EXPECT_EQ(iptr[i], i + rank);
+        EXPECT_EQ(dptr[i], i * 0.5 + rank);
+    }
+
+    // finalize sdmt module
+    SDMT::finalize();
+}
+
+TEST(PartnerTest, Replaced) {
+    // initialize sdmt module
+    SDMT::init("./config_cpp_test.xml", false);
+
+    int rank;
+    int size;
+    MPI_Comm_rank(SDMT::comm(), &rank);
+    MPI_Comm_size(SDMT::comm(), &size);
+
+    // regions of different sizes in each rank
+    const int n = 100000 + rank * 1000;
+    std::vector<long> a(n);
+    for (int i = 0; i < n; i++) {
+        a[i] = (long)i * (rank + 1);
+    }
+    std::vector<CkptRing::Region> regions = {
+        {0, a.data(), a.size() * sizeof(long)}};
+
+    CkptPartner partner;
+    EXPECT_TRUE(partner.save(SDMT::comm(), regions, 5));
+
+    // the first rank is replaced by a process without any copy
+    if (rank == 0) {
+        partner = CkptPartner();
+        std::fill(a.begin(), a.end(), 0);
+    }
+
+    // it gets its copy from the partner, and the rank whose copy it kept
+    // uses its own. a rank which is its own partner loses both
+    int32_t iter = 0;
+    if (size < 2) {
+        EXPECT_FALSE(partner.load(SDMT::comm(), regions, iter));
+        SDMT::finalize();
+        return;
+    }
+    EXPECT_TRUE(partner.load(SDMT::comm(), regions, iter));
+    EXPECT_EQ(iter, 5);
+    for (int i = 0; i < n; i++) {
+        EXPECT_EQ(a[i], (long)i * (rank + 1));
+    }
+
+    // a process replaced again saves with the others before it loads
+    if (rank == 0) {
+        partner = CkptPartner();
+    }
+    EXPECT_TRUE(partner.save(SDMT::comm(), regions, 6));
+    EXPECT_TRUE(partner.load(SDMT::comm(), regions, iter));
+    EXPECT_EQ(iter, 6);
+
+    // finalize sdmt module
+    SDMT::finalize();
+}
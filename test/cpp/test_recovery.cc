@@ -0,0 +1,70 @@
+/**
+Copyright 2021 PIDL(Petabyte-scale In-memory Database Lab) http://kdb.snu.ac.kr
+This work was supported by Next-Generation Information Computing Development
+Program through the National Research Foundation of Korea(NRF)
+funded by the Ministry of Science, ICT (NRF-2016M3C4A7952587)
+Author: Ilju Lee, Jongin Kim, Hyerim Jeon, Youngjune Park
+Contact: sdmt@kdb.snu.ac.kr
+ */
+#include "sdmt.h"
+
+#include <gtest/gtest.h>
+
+TEST(RecoveryTest, Parallel) {
+    // initialize sdmt module with 4 recovery threads
+    SDMT::init("./config_cpp_recovery.xml", false);
+
+    // request sdmt snapshots
+    // define several integer arrays, one of them compressed
+    int rank;
+    MPI_Comm_rank(SDMT::comm(), &rank);
+    const int n = 200000;
+    const int count = 6;
+    SDMT::Options lz;
+    lz.m_codec = SDMT_CC_LZ;
+    std::vector<int*> ptrs;
+    for (int s = 0; s < count; s++) {
+        std::string name = "sdmttest_recovery" + std::to_string(s);
+        SDMT::register_snapshot(name, SDMT_INT, SDMT_ARRAY, {n},
+                s == 0 ? lz : SDMT::Options());
+        ptrs.push_back(SDMT::intptr(name));
+    }
+
+    // write rank and snapshot dependent values to snapshot memory
+    for (int s = 0; s < count; s++) {
+        for (int i = 0; i < n; i++) {
+            ptrs[s][i] = i * 3 + s * 7 + rank;
+        }
+    }
+
+    // start sdmt module
+    SDMT::start();
+    SDMT::iter() = 4;
+    EXPECT_EQ(SDMT::checkpoint(1, true), SDMT_SUCCESS);
+    EXPECT_EQ(SDMT::wait_checkpoint(), SDMT_SUCCESS);
+
+    // overwrite and recover every snapshot
+    for (int s = 0; s < count; s++) {
+        for (int i = 0; i < n; i++) {
+            ptrs[s][i] = -1;
+        }
+    }
+    SDMT::iter() = 0;
+    EXPECT_EQ(SDMT::recover(), SDMT_SUCCESS);
+    EXPECT_EQ(SDMT::iter(), 4);
+    for (int s = 0; s < count; s++) {
+        for (int i = 0; i < n; i++) {
+            EXPECT_EQ(ptrs[s][i], i * 3 + s * 7 + rank);
+        }
+    }
+
+    // timings are reported for the native checkpoint
+    SDMT::RecoveryStats stats = SDMT::recovery_stats();
+    EXPECT_GE(stats.m_id, 0);
+    EXPECT_EQ(stats.m_threads, 4);
+    EXPECT_GE(stats.m_restore, 0);
+    EXPECT_EQ(stats.total(), stats.m_allocate + stats.m_restore);
+
+    // finalize sdmt module
+    SDMT::finalize();
+}
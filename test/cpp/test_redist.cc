@@ -0,0 +1,138 @@
+/**
+Copyright 2021 PIDL(Petabyte-scale In-memory Database Lab) http://kdb.snu.ac.kr
+This work was supported by Next-Generation Information Computing Development
+Program through the National Research Foundation of Korea(NRF)
+funded by the Ministry of Science, ICT (NRF-2016M3C4A7952587)
+Author: Ilju Lee, Jongin Kim, Hyerim Jeon, Youngjune Park
+Contact: sdmt@kdb.snu.ac.kr
+ */
+#include "sdmt.h"
+#include "ckpt_redist.h"
+
+#include <gtest/gtest.h>
+
+// a matrix split in contiguous row blocks, an array split in blocks of 2
+// dealt to ranks in turn, and a tensor split along its middle dimension
+static const std::vector<int> kMatrix = {10, 7};
+static const std::vector<int> kArray = {23};
+static const std::vector<int> kTensor = {4, 9, 3};
+
+static SDMT::Options distributed(const std::vector<int>& global,
+        int axis, int block) {
+    SDMT::Options opts;
+    opts.m_global = global;
+    opts.m_axis = axis;
+    opts.m_block = block;
+    return opts;
+}
+
+static std::vector<int> local_dim(const SDMT::Options& opts) {
+    std::vector<int> dim = opts.m_global;
+    dim[opts.m_axis] = SDMT::local_extent(dim[opts.m_axis], opts.m_block);
+    return dim;
+}
+
+// every element holds its index in the global shape
+template <typename F>
+static void each(const SDMT::Options& opts, F f) {
+    int ranks;
+    int rank;
+    MPI_Comm_size(SDMT::comm(), &ranks);
+    MPI_Comm_rank(SDMT::comm(), &rank);
+    std::vector<int> dim = local_dim(opts);
+    int outer = 1;
+    int inner = 1;
+    for (int i = 0; i < (int)dim.size(); i++) {
+        if (i < opts.m_axis) outer *= dim[i];
+        if (i > opts.m_axis) inner *= dim[i];
+    }
+    int extent = opts.m_global[opts.m_axis];
+    int n = dim[opts.m_axis];
+    for (int o = 0; o < outer; o++) {
+        for (int l = 0; l < n; l++) {
+            int g = CkptRedist::global(l, extent, opts.m_block, ranks, rank);
+            for (int i = 0; i < inner; i++) {
+                f((o * n + l) * inner + i, (o * extent + g) * inner + i);
+            }
+        }
+    }
+}
+
+TEST(RedistTest, 1st) {
+    // initialize sdmt module with native backend
+    SDMT::init("./config_cpp_redist.xml", false);
+
+    SDMT::Options matrix = distributed(kMatrix, 0, 0);
+    SDMT::Options array = distributed(kArray, 0, 2);
+    SDMT::Options tensor = distributed(kTensor, 1, 0);
+    ASSERT_EQ(SDMT::register_snapshot("sdmttest_redist_matrix", SDMT_DOUBLE,
+                SDMT_MATRIX, local_dim(matrix), matrix), SDMT_SUCCESS);
+    ASSERT_EQ(SDMT::register_snapshot("sdmttest_redist_array", SDMT_INT,
+                SDMT_ARRAY, local_dim(array), array), SDMT_SUCCESS);
+    ASSERT_EQ(SDMT::register_snapshot("sdmttest_redist_tensor", SDMT_LONG,
+                SDMT_TENSOR, local_dim(tensor), tensor), SDMT_SUCCESS);
+    ASSERT_EQ(SDMT::register_snapshot("sdmttest_redist_shared", SDMT_INT,
+                SDMT_ARRAY, {16}), SDMT_SUCCESS);
+
+    // a dimension which is not the part of this rank is rejected
+    std::vector<int> wrong = local_dim(matrix);
+    wrong[1]++;
+    EXPECT_EQ(SDMT::register_snapshot("sdmttest_redist_wrong", SDMT_DOUBLE,
+                SDMT_MATRIX, wrong, matrix), SDMT_ERR_WRONG_DIMENSION);
+
+    double* mptr = SDMT::doubleptr("sdmttest_redist_matrix");
+    int* aptr = SDMT::intptr("sdmttest_redist_array");
+    long* tptr = SDMT::longptr("sdmttest_redist_tensor");
+    int* sptr = SDMT::intptr("sdmttest_redist_shared");
+    each(matrix, [&](int l, int g) { mptr[l] = g * 0.5; });
+    each(array, [&](int l, int g) { aptr[l] = g; });
+    each(tensor, [&](int l, int g) { tptr[l] = g * 3L; });
+    for (int i = 0; i < 16; i++) {
+        sptr[i] = i * 7;
+    }
+
+    // start sdmt module
+    SDMT::start();
+    SDMT::iter() = 4;
+    EXPECT_EQ(SDMT::checkpoint(1), SDMT_SUCCESS);
+
+    // finalize sdmt module
+    SDMT::finalize();
+}
+
+TEST(RedistTest, 2nd) {
+    // restart on any number of ranks, each gets its part of the global shape
+    SDMT::init("./config_cpp_redist.xml", true);
+    EXPECT_EQ(SDMT::iter(), 4);
+    EXPECT_GE(SDMT::recovery_stats().m_id, 0);
+
+    SDMT::Options matrix = distributed(kMatrix, 0, 0);
+    SDMT::Options array = distributed(kArray, 0, 2);
+    SDMT::Options tensor = distributed(kTensor, 1, 0);
+    EXPECT_EQ(SDMT::get_snapshot("sdmttest_redist_matrix").m_dimension,
+            local_dim(matrix));
+    EXPECT_EQ(SDMT::get_snapshot("sdmttest_redist_array").m_dimension,
+            local_dim(array));
+    EXPECT_EQ(SDMT::get_snapshot("sdmttest_redist_tensor").m_dimension,
+            local_dim(tensor));
+
+    double* mptr = SDMT::doubleptr("sdmttest_redist_matrix");
+    int* aptr = SDMT::intptr("sdmttest_redist_array");
+    long* tptr = SDMT::longptr("sdmttest_redist_tensor");
+    int* sptr = SDMT::intptr("sdmttest_redist_shared");
+    each(matrix, [&](int l, int g) { EXPECT_EQ(mptr[l], g * 0.5); });
+    each(array, [&](int l, int g) { EXPECT_EQ(aptr[l], g); });
+    each(tensor, [&](int l, int g) { EXPECT_EQ(tptr[l], g * 3L); });
+    for (int i = 0; i < 16; i++) {
+        EXPECT_EQ(sptr[i], i * 7);
+    }
+
+    // the next checkpoint is of the new ranks
+    each(array, [&](int l, int g) { aptr[l] = -g; });
+    EXPECT_EQ(SDMT::checkpoint(1), SDMT_SUCCESS);
+    EXPECT_EQ(SDMT::recover_snapshot("sdmttest_redist_array"), SDMT_SUCCESS);
+    each(array, [&](int l, int g) { EXPECT_EQ(aptr[l], -g); });
+
+    // finalize sdmt module
+    SDMT::finalize();
+}
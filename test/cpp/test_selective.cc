@@ -0,0 +1,75 @@
+/**
+Copyright 2021 PIDL(Petabyte-scale In-memory Database Lab) http://kdb.snu.ac.kr
+This work was supported by Next-Generation Information Computing Development
+Program through the National Research Foundation of Korea(NRF)
+funded by the Ministry of Science, ICT (NRF-2016M3C4A7952587)
+Author: Ilju Lee, Jongin Kim, Hyerim Jeon, Youngjune Park
+Contact: sdmt@kdb.snu.ac.kr
+ */
+#include "sdmt.h"
+
+#include <gtest/gtest.h>
+
+TEST(SelectiveTest, Names) {
+    // initialize sdmt module
+    SDMT::init("./config_cpp_test.xml", false);
+
+    // request sdmt snapshots
+    // define three integer arrays, one of them compressed
+    int rank;
+    MPI_Comm_rank(SDMT::comm(), &rank);
+    const int n = 100000;
+    SDMT::Options lz;
+    lz.m_codec = SDMT_CC_LZ;
+    SDMT::register_snapshot("sdmttest_sel_a", SDMT_INT, SDMT_ARRAY, {n});
+    SDMT::register_snapshot("sdmttest_sel_b", SDMT_INT, SDMT_ARRAY, {n}, lz);
+    SDMT::register_snapshot("sdmttest_sel_c", SDMT_INT, SDMT_ARRAY, {n});
+    int* a = SDMT::intptr("sdmttest_sel_a");
+    int* b = SDMT::intptr("sdmttest_sel_b");
+    int* c = SDMT::intptr("sdmttest_sel_c");
+    for (int i = 0; i < n; i++) {
+        a[i] = i + rank;
+        b[i] = i % 10 + rank;
+        c[i] = i * 2 + rank;
+    }
+
+    // start sdmt module, checkpoint by FTI
+    SDMT::start();
+    SDMT::iter() = 3;
+    EXPECT_EQ(SDMT::checkpoint(1), SDMT_SUCCESS);
+
+    // recover two of three snapshots, the iteration sequence is kept
+    for (int i = 0; i < n; i++) {
+        a[i] = b[i] = c[i] = -1;
+    }
+    SDMT::iter() = 7;
+    EXPECT_EQ(SDMT::recover({"sdmttest_sel_a", "sdmttest_sel_b"}),
+            SDMT_SUCCESS);
+    EXPECT_EQ(SDMT::iter(), 7);
+    for (int i = 0; i < n; i++) {
+        EXPECT_EQ(a[i], i + rank);
+        EXPECT_EQ(b[i], i % 10 + rank);
+        EXPECT_EQ(c[i], -1);
+    }
+    EXPECT_EQ(SDMT::recover_snapshot("sdmttest_sel_none"),
+            SDMT_ERR_FAILED_RECOVERY);
+
+    // checkpoint natively, then recover a snapshot only
+    for (int i = 0; i < n; i++) {
+        c[i] = i * 3 + rank;
+    }
+    EXPECT_EQ(SDMT::checkpoint(1, true), SDMT_SUCCESS);
+    EXPECT_EQ(SDMT::wait_checkpoint(), SDMT_SUCCESS);
+    for (int i = 0; i < n; i++) {
+        a[i] = c[i] = -1;
+    }
+    EXPECT_EQ(SDMT::recover_snapshot("sdmttest_sel_c"), SDMT_SUCCESS);
+    EXPECT_GE(SDMT::recovery_stats().m_id, 0);
+    for (int i = 0; i < n; i++) {
+        EXPECT_EQ(a[i], -1);
+        EXPECT_EQ(c[i], i * 3 + rank);
+    }
+
+    // finalize sdmt module
+    SDMT::finalize();
+}
@@ -0,0 +1,65 @@
+/**
+Copyright 2021 PIDL(Petabyte-scale In-memory Database Lab) http://kdb.snu.ac.kr
+This work was supported by Next-Generation Information Computing Development
+Program through the National Research Foundation of Korea(NRF)
+funded by the Ministry of Science, ICT (NRF-2016M3C4A7952587)
+Author: Ilju Lee, Jongin Kim, Hyerim Jeon, Youngjune Park
+Contact: sdmt@kdb.snu.ac.kr
+ */
+#include "sdmt.h"
+
+#include <gtest/gtest.h>
+
+TEST(SharedTest, Mpiio) {
+    // initialize sdmt module writing one shared file by MPI-IO
+    SDMT::init("./config_cpp_mpiio.xml", false);
+
+    // request sdmt snapshots of different sizes in each rank
+    // define 1 dimensional integer array and compressed double array
+    int rank;
+    MPI_Comm_rank(SDMT::comm(), &rank);
+    const int n = 100000 + rank * 777;
+    SDMT::register_snapshot("sdmttest_shared1d", SDMT_INT, SDMT_ARRAY, {n});
+    SDMT::Options opts;
+    opts.m_codec = SDMT_CC_SHUFFLE_LZ;
+    SDMT::register_snapshot("sdmttest_shared_lz", SDMT_DOUBLE, SDMT_ARRAY, {n}, opts);
+
+    // get data snapshots
+    int* iptr = SDMT::intptr("sdmttest_shared1d");
+    double* dptr = SDMT::doubleptr("sdmttest_shared_lz");
+
+    // write rank dependent values to snapshot memory
+    for (int i = 0; i < n; i++) {
+        iptr[i] = i * 3 + rank;
+        dptr[i] = (i % 100) * 0.25 + rank;
+    }
+
+    // start sdmt module
+    SDMT::start();
+
+    // every rank writes into one file
+    SDMT::iter() = 9;
+    EXPECT_EQ(SDMT::checkpoint(1), SDMT_SUCCESS);
+    EXPECT_GE(CkptShared::latest("./checkpoint/Native"), 0);
+    EXPECT_LT(CkptFile::latest("./checkpoint/Native", rank), 0);
+
+    // overwrite dummy values to snapshot memory
+    for (int i = 0; i < n; i++) {
+        iptr[i] = -1;
+        dptr[i] = -1;
+    }
+    SDMT::iter() = 0;
+
+    // recover from the shared file
+    EXPECT_EQ(SDMT::recover(), SDMT_SUCCESS);
+    EXPECT_EQ(SDMT::iter(), 9);
+
+    // check recovered values
+    for (int i = 0; i < n; i++) {
+        EXPECT_EQ(iptr[i], i * 3 + rank);
+        EXPECT_EQ(dptr[i], (i % 100) * 0.25 + rank);
+    }
+
+    // finalize sdmt module
+    SDMT::finalize();
+}
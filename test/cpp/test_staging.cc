@@ -0,0 +1,82 @@
+/**
+Copyright 2021 PIDL(Petabyte-scale In-memory Database Lab) http://kdb.snu.ac.kr
+This work was supported by Next-Generation Information Computing Development
+Program through the National Research Foundation of Korea(NRF)
+funded by the Ministry of Science, ICT (NRF-2016M3C4A7952587)
+Author: Ilju Lee, Jongin Kim, Hyerim Jeon, Youngjune Park
+Contact: sdmt@kdb.snu.ac.kr
+ */
+#include "sdmt.h"
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include <vector>
+
+TEST(StagingTest, Drain) {
+    // initialize sdmt module staging checkpoints in a node-local directory
+    SDMT::init("./config_cpp_staging.xml", false);
+
+    // request sdmt snapshots
+    // define 1 dimensional integer array
+    int rank;
+    MPI_Comm_rank(SDMT::comm(), &rank);
+    const int n = 200000;
+    SDMT::register_snapshot("sdmttest_staging1d", SDMT_INT, SDMT_ARRAY, {n});
+
+    // get data snapshot
+    int* iptr = SDMT::intptr("sdmttest_staging1d");
+
+    // write rank dependent values to snapshot memory
+    for (int i = 0; i < n; i++) {
+        iptr[i] = i * 7 + rank;
+    }
+
+    // start sdmt module
+    SDMT::start();
+
+    // checkpoint is written to the node-local directory first
+    SDMT::iter() = 4;
+    EXPECT_EQ(SDMT::checkpoint(1, true), SDMT_SUCCESS);
+    EXPECT_EQ(SDMT::wait_checkpoint(), SDMT_SUCCESS);
+    int id = CkptFile::latest("./checkpoint/Staging", rank);
+    EXPECT_GE(id, 0);
+
+    // and copied to the global directory in background
+    EXPECT_EQ(SDMT::wait_drain(), SDMT_SUCCESS);
+    EXPECT_EQ(CkptFile::latest("./checkpoint/Native", rank), id);
+
+    // lose the node-local copy and overwrite dummy values
+    ::unlink(CkptFile::path("./checkpoint/Staging", id, rank).c_str());
+    for (int i = 0; i < n; i++) {
+        iptr[i] = -1;
+    }
+    SDMT::iter() = 0;
+
+    // recover from the global directory
+    EXPECT_EQ(SDMT::recover(), SDMT_SUCCESS);
+    EXPECT_EQ(SDMT::iter(), 4);
+
+    // check recovered values
+    for (int i = 0; i < n; i++) {
+        EXPECT_EQ(iptr[i], i * 7 + rank);
+    }
+
+    // a pinned checkpoint, e.g. one queued to copy, is not pruned
+    for (int i = 0; i < 3; i++) {
+        EXPECT_EQ(SDMT::checkpoint(1), SDMT_SUCCESS);
+    }
+    EXPECT_EQ(SDMT::wait_drain(), SDMT_SUCCESS);
+    std::vector<int> ids = CkptFile::list("./checkpoint/Staging", rank);
+    EXPECT_GE(ids.size(), 2u);
+    CkptFile::pin("./checkpoint/Staging", ids.front(), rank);
+    CkptFile::prune("./checkpoint/Staging", rank, CkptFile::Retention(1));
+    EXPECT_EQ(CkptFile::list("./checkpoint/Staging", rank),
+            std::vector<int>({ids.front(), ids.back()}));
+    CkptFile::unpin("./checkpoint/Staging", ids.front(), rank);
+    CkptFile::prune("./checkpoint/Staging", rank, CkptFile::Retention(1));
+    EXPECT_EQ(CkptFile::list("./checkpoint/Staging", rank),
+            std::vector<int>(1, ids.back()));
+
+    // finalize sdmt module
+    SDMT::finalize();
+}
@@ -0,0 +1,65 @@
+/**
+Copyright 2021 PIDL(Petabyte-scale In-memory Database Lab) http://kdb.snu.ac.kr
+This work was supported by Next-Generation Information Computing Development
+Program through the National Research Foundation of Korea(NRF)
+funded by the Ministry of Science, ICT (NRF-2016M3C4A7952587)
+Author: Ilju Lee, Jongin Kim, Hyerim Jeon, Youngjune Park
+Contact: sdmt@kdb.snu.ac.kr
+ */
+#include "sdmt.h"
+
+#include <gtest/gtest.h>
+
+#include <type_traits>
+
+static_assert(std::is_trivially_copyable<SDMT::SnapshotView>::value,
+        "a view is copied without allocation");
+
+TEST(ViewTest, Metadata) {
+    // initialize sdmt module
+    SDMT::init("./config_cpp_test.xml", false);
+
+    // request sdmt snapshots
+    SDMT::Options opts;
+    opts.m_double_buffer = true;
+    SDMT::register_snapshot("sdmttest_view_matrix", SDMT_FLOAT, SDMT_MATRIX,
+            {20, 30}, opts);
+    SDMT::register_snapshot("sdmttest_view_scalar", SDMT_LONG, SDMT_SCALAR,
+            {});
+    SDMT::SnapshotHandle h = SDMT::lookup("sdmttest_view_matrix");
+
+    // a view holds the same metadata as a Snapshot
+    SDMT::Snapshot snapshot = SDMT::get_snapshot("sdmttest_view_matrix");
+    SDMT::SnapshotView view = SDMT::view("sdmttest_view_matrix");
+    EXPECT_EQ(view.m_id, snapshot.m_id);
+    EXPECT_EQ(view.m_valuetype, SDMT_FLOAT);
+    EXPECT_EQ(view.m_datatype, SDMT_MATRIX);
+    EXPECT_EQ(view.m_rank, 2);
+    EXPECT_EQ(view.m_dimension[0], 20);
+    EXPECT_EQ(view.m_dimension[1], 30);
+    EXPECT_EQ(view.m_strides[0], snapshot.m_strides[0]);
+    EXPECT_EQ(view.m_strides[1], snapshot.m_strides[1]);
+    EXPECT_EQ(view.m_esize, (int)sizeof(float));
+    EXPECT_EQ(view.m_ptr, snapshot.m_ptr);
+    EXPECT_EQ(view.m_back, snapshot.m_back);
+    EXPECT_EQ(view.bytes(), snapshot.bytes());
+    EXPECT_EQ(SDMT::view(h).m_ptr, view.m_ptr);
+
+    SDMT::SnapshotView scalar = SDMT::view("sdmttest_view_scalar");
+    EXPECT_EQ(scalar.m_rank, 0);
+    EXPECT_EQ(scalar.bytes(), sizeof(long));
+
+    // null for an unknown snapshot
+    EXPECT_EQ(SDMT::view("sdmttest_view_none").m_id, -1);
+    EXPECT_EQ(SDMT::view("sdmttest_view_none").m_ptr, nullptr);
+    EXPECT_EQ(SDMT::view(-1).m_ptr, nullptr);
+
+    // a view taken after buffers are swapped has the active one
+    SDMT::start();
+    EXPECT_EQ(SDMT::flip("sdmttest_view_matrix"), SDMT_SUCCESS);
+    EXPECT_EQ(SDMT::view(h).m_ptr, view.m_back);
+    EXPECT_EQ(SDMT::view(h).m_back, view.m_ptr);
+
+    // finalize sdmt module
+    SDMT::finalize();
+}